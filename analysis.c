@@ -0,0 +1,472 @@
+#include "poxim_internal.h"
+
+/******************************************************
+ * Control flow analysis
+ *
+ * A static view of the loaded program. Code is found by following
+ * fall-through, branches and calls from address 0 and the interrupt
+ * vectors, then cut into basic blocks that start at jump targets and after
+ * every instruction that leaves its block. The blocks form a control flow
+ * graph in which a call reaches both its target and its return address, so
+ * a loop in the caller does not take in the functions it calls. Dominators
+ * come from the iterative algorithm of Cooper, Harvey and Kennedy over a
+ * virtual root above the entry points, and every edge to a block that
+ * dominates its source is the back edge of a natural loop.
+ *
+ * ret, reti and callf go to addresses known only at run time: code reached
+ * only through them is not found, and their edges are missing from the
+ * graph.
+ *******************************************************/
+
+Analysis *analyzeProgram(System *system)
+{
+  Analysis *analysis = (Analysis *)calloc(1, sizeof(Analysis));
+  uint32_t *code = (uint32_t *)malloc(ANALYZED_WORDS * sizeof(uint32_t));
+
+  if (analysis == NULL || code == NULL)
+  {
+    fprintf(stderr, "Failed to allocate memory for analysis.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  for (uint32_t index = 0; index < ANALYZED_WORDS; index++)
+    code[index] = readMemory32(system, index * 4);
+
+  findReachableCode(analysis, code);
+  formAnalyzedBlocks(analysis, code);
+  computeDominators(analysis);
+  findNaturalLoops(analysis);
+
+  free(code);
+
+  return analysis;
+}
+
+void freeAnalysis(Analysis *analysis)
+{
+  if (analysis == NULL)
+    return;
+
+  free(analysis->blocks);
+  free(analysis->predecessors);
+  free(analysis->loops);
+  free(analysis);
+}
+
+// Runs once per load for the consumers of the analysis that watch the
+// program run, the profiler's loop report today
+void analyzeLoadedProgram(System *system)
+{
+  freeAnalysis(system->analysis);
+  system->analysis = system->profiler.enabled ? analyzeProgram(system) : NULL;
+
+  attachProfilerLoops(&system->profiler, system->analysis);
+}
+
+uint32_t branchTarget(uint32_t address, uint32_t ir)
+{
+  return address + 4 + ((uint32_t)extendSign32(ir & 0x03FFFFFF, 26) << 2);
+}
+
+// Addresses control may reach next; ret and reti go to addresses known
+// only at run time, and callf to a register
+uint32_t findSuccessors(uint32_t address, uint32_t ir, uint32_t *successors)
+{
+  const uint8_t opcode = (ir >> 26) & 0x3F;
+
+  if (opcode == 0b011111 || opcode == 0b100000) // ret, reti
+    return 0;
+
+  if (opcode == 0b110111) // bun
+  {
+    successors[0] = branchTarget(address, ir);
+    return 1;
+  }
+
+  successors[0] = address + 4;
+
+  if ((opcode >= 0b101010 && opcode <= 0b111000) || opcode == 0b111001) // Conditional branches, calls
+  {
+    successors[1] = branchTarget(address, ir);
+    return 2;
+  }
+
+  return 1;
+}
+
+// Whether control does not simply fall through to the next word
+bool endsAnalyzedBlock(uint32_t ir)
+{
+  const uint8_t opcode = (ir >> 26) & 0x3F;
+
+  return (opcode >= 0b101010 && opcode <= 0b111001) || opcode == 0b011110 || opcode == 0b011111 || opcode == 0b100000;
+}
+
+// Marks the words reached from the entry point and the interrupt vectors,
+// and the leaders among them, in blockOf until formAnalyzedBlocks numbers
+// the blocks
+void findReachableCode(Analysis *analysis, const uint32_t *code)
+{
+  uint32_t *pending = (uint32_t *)malloc(ANALYZED_WORDS * sizeof(uint32_t));
+  uint32_t count = 0;
+
+  if (pending == NULL)
+  {
+    fprintf(stderr, "Failed to allocate memory for analysis.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  for (uint32_t index = 0; index < ANALYZED_WORDS; index++)
+    analysis->blockOf[index] = NO_ANALYZED_BLOCK;
+
+  for (uint32_t address = INIT_INTERRUPT_ADDR; address <= HARDWARE4_INTERRUPT_ADDR; address += 4)
+  {
+    analysis->blockOf[address / 4] = ANALYZED_LEADER;
+    pending[count++] = address / 4;
+  }
+
+  while (count > 0)
+  {
+    const uint32_t index = pending[--count];
+    uint32_t successors[2];
+    const uint32_t successorCount = findSuccessors(index * 4, code[index], successors);
+
+    for (uint32_t i = 0; i < successorCount; i++)
+    {
+      if (successors[i] > MEMORY_SIZE - 4)
+        continue;
+
+      uint32_t *next = &analysis->blockOf[successors[i] / 4];
+      const bool reached = *next != NO_ANALYZED_BLOCK;
+
+      // Jumps land on leaders, and so does the word after one that leaves its block
+      if (successors[i] != index * 4 + 4 || endsAnalyzedBlock(code[index]))
+        *next = ANALYZED_LEADER;
+      else if (!reached)
+        *next = ANALYZED_CODE;
+
+      if (!reached)
+        pending[count++] = successors[i] / 4;
+    }
+  }
+
+  free(pending);
+}
+
+// Numbers the blocks in address order and links each to its successors
+// and predecessors
+void formAnalyzedBlocks(Analysis *analysis, const uint32_t *code)
+{
+  analysis->blocks = (AnalyzedBlock *)malloc(ANALYZED_WORDS * sizeof(AnalyzedBlock));
+  analysis->blockCount = 0;
+
+  if (analysis->blocks == NULL)
+  {
+    fprintf(stderr, "Failed to allocate memory for analysis.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  for (uint32_t index = 0; index < ANALYZED_WORDS; index++)
+  {
+    if (analysis->blockOf[index] != ANALYZED_LEADER)
+      continue;
+
+    AnalyzedBlock *block = &analysis->blocks[analysis->blockCount];
+    uint32_t end = index;
+
+    do
+      analysis->blockOf[end++] = analysis->blockCount;
+    while (end < ANALYZED_WORDS && !endsAnalyzedBlock(code[end - 1]) && analysis->blockOf[end] == ANALYZED_CODE);
+
+    block->first = index;
+    block->end = end;
+    block->predecessorCount = 0;
+    block->loop = NO_ANALYZED_LOOP;
+    analysis->blockCount++;
+    index = end - 1;
+  }
+
+  // Successors of the last instruction, counting the predecessors of each block
+  uint32_t edgeCount = 0;
+
+  for (uint32_t b = 0; b < analysis->blockCount; b++)
+  {
+    AnalyzedBlock *block = &analysis->blocks[b];
+    uint32_t successors[2];
+    const uint32_t successorCount = findSuccessors((block->end - 1) * 4, code[block->end - 1], successors);
+
+    block->successors[0] = block->successors[1] = NO_ANALYZED_BLOCK;
+
+    for (uint32_t i = 0; i < successorCount; i++)
+    {
+      if (successors[i] > MEMORY_SIZE - 4 || (i == 1 && successors[1] == successors[0]))
+        continue;
+
+      block->successors[i] = analysis->blockOf[successors[i] / 4];
+      analysis->blocks[block->successors[i]].predecessorCount++;
+      edgeCount++;
+    }
+  }
+
+  analysis->predecessors = (uint32_t *)malloc((edgeCount > 0 ? edgeCount : 1) * sizeof(uint32_t));
+
+  if (analysis->predecessors == NULL)
+  {
+    fprintf(stderr, "Failed to allocate memory for analysis.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  for (uint32_t b = 0, first = 0; b < analysis->blockCount; b++)
+  {
+    analysis->blocks[b].firstPredecessor = first;
+    first += analysis->blocks[b].predecessorCount;
+    analysis->blocks[b].predecessorCount = 0;
+  }
+
+  for (uint32_t b = 0; b < analysis->blockCount; b++)
+  {
+    for (uint32_t i = 0; i < 2; i++)
+    {
+      const uint32_t successor = analysis->blocks[b].successors[i];
+
+      if (successor != NO_ANALYZED_BLOCK)
+      {
+        AnalyzedBlock *next = &analysis->blocks[successor];
+        analysis->predecessors[next->firstPredecessor + next->predecessorCount++] = b;
+      }
+    }
+  }
+}
+
+// Nearest common dominator of two blocks, by their reverse postorder numbers
+uint32_t intersectDominators(const uint32_t *dominators, const uint32_t *order, uint32_t a, uint32_t b)
+{
+  while (a != b)
+  {
+    while (order[a] > order[b])
+      a = dominators[a];
+
+    while (order[b] > order[a])
+      b = dominators[b];
+  }
+
+  return a;
+}
+
+void computeDominators(Analysis *analysis)
+{
+  const uint32_t root = analysis->blockCount; // Virtual block above the entry points
+  uint32_t *dominators = (uint32_t *)malloc((root + 1) * sizeof(uint32_t));
+  uint32_t *order = (uint32_t *)malloc((root + 1) * sizeof(uint32_t));     // Reverse postorder number of each block
+  uint32_t *postorder = (uint32_t *)malloc((root + 1) * sizeof(uint32_t)); // Blocks by postorder number
+  uint32_t *stack = (uint32_t *)malloc((root + 1) * sizeof(uint32_t));
+  uint8_t *visited = (uint8_t *)calloc(root + 1, sizeof(uint8_t)); // Successors already pushed, plus one
+  uint32_t count = 0;
+
+  if (dominators == NULL || order == NULL || postorder == NULL || stack == NULL || visited == NULL)
+  {
+    fprintf(stderr, "Failed to allocate memory for analysis.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  // Depth-first search from each entry point in turn
+  for (uint32_t address = INIT_INTERRUPT_ADDR; address <= HARDWARE4_INTERRUPT_ADDR; address += 4)
+  {
+    const uint32_t entry = analysis->blockOf[address / 4];
+    uint32_t depth = 0;
+
+    if (visited[entry])
+      continue;
+
+    visited[entry] = 1;
+    stack[depth++] = entry;
+
+    while (depth > 0)
+    {
+      const uint32_t block = stack[depth - 1];
+
+      if (visited[block] <= 2)
+      {
+        const uint32_t successor = analysis->blocks[block].successors[visited[block]++ - 1];
+
+        if (successor != NO_ANALYZED_BLOCK && !visited[successor])
+        {
+          visited[successor] = 1;
+          stack[depth++] = successor;
+        }
+      }
+      else
+      {
+        postorder[count++] = block;
+        depth--;
+      }
+    }
+  }
+
+  postorder[count] = root;
+  for (uint32_t i = 0; i <= count; i++)
+  {
+    order[postorder[i]] = count - i;
+    dominators[postorder[i]] = NO_ANALYZED_BLOCK;
+  }
+  dominators[root] = root;
+
+  bool changed = true;
+
+  while (changed)
+  {
+    changed = false;
+
+    for (uint32_t i = count; i-- > 0;)
+    {
+      const uint32_t b = postorder[i];
+      const AnalyzedBlock *block = &analysis->blocks[b];
+      uint32_t dominator = (block->first <= HARDWARE4_INTERRUPT_ADDR / 4) ? root : NO_ANALYZED_BLOCK;
+
+      for (uint32_t p = 0; p < block->predecessorCount; p++)
+      {
+        const uint32_t predecessor = analysis->predecessors[block->firstPredecessor + p];
+
+        if (dominators[predecessor] == NO_ANALYZED_BLOCK)
+          continue;
+
+        dominator = (dominator == NO_ANALYZED_BLOCK) ? predecessor : intersectDominators(dominators, order, predecessor, dominator);
+      }
+
+      if (dominators[b] != dominator)
+      {
+        dominators[b] = dominator;
+        changed = true;
+      }
+    }
+  }
+
+  for (uint32_t b = 0; b < analysis->blockCount; b++)
+    analysis->blocks[b].dominator = (dominators[b] == root) ? NO_ANALYZED_BLOCK : dominators[b];
+
+  free(dominators);
+  free(order);
+  free(postorder);
+  free(stack);
+  free(visited);
+}
+
+bool dominatesBlock(const Analysis *analysis, uint32_t dominator, uint32_t block)
+{
+  while (block != NO_ANALYZED_BLOCK && block != dominator)
+    block = analysis->blocks[block].dominator;
+
+  return block == dominator;
+}
+
+// Larger loops first, so that a loop comes before the loops it contains
+int compareAnalyzedLoops(const void *a, const void *b)
+{
+  const AnalyzedLoop *x = (const AnalyzedLoop *)a;
+  const AnalyzedLoop *y = (const AnalyzedLoop *)b;
+
+  if (x->blocks != y->blocks)
+    return x->blocks < y->blocks ? 1 : -1;
+
+  return x->header < y->header ? -1 : (x->header > y->header);
+}
+
+// Blocks of the loop at header: those reaching one of its back edges
+// without passing through it. Marks them with stamp, and makes it their
+// innermost loop unless loop is NO_ANALYZED_LOOP.
+uint32_t collectLoopBody(Analysis *analysis, uint32_t header, uint32_t loop, uint32_t *marks, uint32_t stamp, uint32_t *pending)
+{
+  uint32_t size = 0, count = 0;
+
+  marks[header] = stamp;
+  pending[count++] = header;
+
+  while (count > 0)
+  {
+    const uint32_t b = pending[--count];
+    const AnalyzedBlock *block = &analysis->blocks[b];
+
+    size++;
+    if (loop != NO_ANALYZED_LOOP)
+      analysis->blocks[b].loop = loop;
+
+    for (uint32_t p = 0; p < block->predecessorCount; p++)
+    {
+      const uint32_t predecessor = analysis->predecessors[block->firstPredecessor + p];
+
+      // Only back edges lead into the header; code that is not dominated
+      // by it enters an irreducible region and is left out
+      if (marks[predecessor] != stamp && dominatesBlock(analysis, header, predecessor))
+      {
+        marks[predecessor] = stamp;
+        pending[count++] = predecessor;
+      }
+    }
+  }
+
+  return size;
+}
+
+// One loop per header, merging the back edges that share it
+void findNaturalLoops(Analysis *analysis)
+{
+  uint32_t *marks = (uint32_t *)malloc((analysis->blockCount + 1) * sizeof(uint32_t));
+  uint32_t *pending = (uint32_t *)malloc((analysis->blockCount + 1) * sizeof(uint32_t));
+
+  analysis->loops = (AnalyzedLoop *)malloc((analysis->blockCount + 1) * sizeof(AnalyzedLoop));
+  analysis->loopCount = 0;
+
+  if (marks == NULL || pending == NULL || analysis->loops == NULL)
+  {
+    fprintf(stderr, "Failed to allocate memory for analysis.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  for (uint32_t b = 0; b < analysis->blockCount; b++)
+    marks[b] = NO_ANALYZED_BLOCK;
+
+  for (uint32_t h = 0; h < analysis->blockCount; h++)
+  {
+    const AnalyzedBlock *header = &analysis->blocks[h];
+    uint32_t backEdges = 0;
+
+    for (uint32_t p = 0; p < header->predecessorCount; p++)
+      backEdges += dominatesBlock(analysis, h, analysis->predecessors[header->firstPredecessor + p]);
+
+    if (backEdges == 0)
+      continue;
+
+    AnalyzedLoop *loop = &analysis->loops[analysis->loopCount++];
+
+    loop->header = h;
+    loop->backEdges = backEdges;
+    loop->blocks = collectLoopBody(analysis, h, NO_ANALYZED_LOOP, marks, h, pending);
+  }
+
+  qsort(analysis->loops, analysis->loopCount, sizeof(AnalyzedLoop), compareAnalyzedLoops);
+
+  // Each header is still in the innermost of the larger loops when its own loop is marked
+  for (uint32_t l = 0; l < analysis->loopCount; l++)
+  {
+    AnalyzedLoop *loop = &analysis->loops[l];
+
+    loop->parent = analysis->blocks[loop->header].loop;
+    loop->depth = (loop->parent == NO_ANALYZED_LOOP) ? 1 : analysis->loops[loop->parent].depth + 1;
+    collectLoopBody(analysis, loop->header, l, marks, analysis->blockCount + l, pending);
+  }
+
+  free(marks);
+  free(pending);
+}
+
+// Whether the block is in the loop or in one nested inside it
+bool isInAnalyzedLoop(const Analysis *analysis, uint32_t block, uint32_t loop)
+{
+  for (uint32_t l = analysis->blocks[block].loop; l != NO_ANALYZED_LOOP; l = analysis->loops[l].parent)
+  {
+    if (l == loop)
+      return true;
+  }
+
+  return false;
+}
@@ -0,0 +1,823 @@
+#include "poxim_internal.h"
+
+/******************************************************
+ * Assembler
+ *
+ * Assembles the .s dialect of the course programs: one statement per line,
+ * any number of "label:" prefixes, // comments, and the .text, .data,
+ * .align, .fill, .4byte and .asciz directives. .text and .data only mark the
+ * sections, which are laid out one after the other from address 0. A label
+ * stands for its byte address, except inside the brackets of a memory
+ * operand, where it is divided by the access size as l32 and s32 expect; a
+ * branch or call to a label becomes the word offset from the next
+ * instruction, while a number is taken as the offset itself.
+ *******************************************************/
+
+bool poxim_assemble(const char *text, size_t length, uint8_t *image, size_t *size, PoximSymbols **symbols)
+{
+  uint32_t end;
+
+  if (!assembleProgram(text, length, image, &end, symbols))
+    return false;
+
+  *size = end;
+
+  return true;
+}
+
+void poxim_symbols_destroy(PoximSymbols *symbols)
+{
+  freeSymbolTable(symbols);
+}
+
+bool poxim_write_symbols(const PoximSymbols *symbols, const char *path)
+{
+  FILE *output = fopen(path, "w");
+  if (output == NULL)
+    return false;
+
+  writeSymbolMap(symbols, output);
+
+  return fclose(output) == 0;
+}
+
+bool poxim_load_asm(PoximSystem *system, const char *text, size_t length)
+{
+  SymbolTable *symbols;
+  uint32_t size;
+
+  if (!assembleProgram(text, length, system->memory, &size, &symbols))
+    return false;
+
+  releaseSymbols(system);
+  system->symbols = symbols;
+  system->ownsSymbols = true;
+  analyzeLoadedProgram(system);
+
+  return true;
+}
+
+PoximImage *poxim_image_create_asm(const char *text, size_t length)
+{
+  uint8_t *memory = (uint8_t *)calloc(MEMORY_SIZE, sizeof(uint8_t));
+  if (memory == NULL)
+  {
+    fprintf(stderr, "Failed to allocate memory for image.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  SymbolTable *symbols;
+  uint32_t size;
+
+  if (!assembleProgram(text, length, memory, &size, &symbols))
+  {
+    free(memory);
+    return NULL;
+  }
+
+  ProgramImage *image = createImage(memory);
+  image->symbols = symbols;
+
+  return image;
+}
+
+// Two passes: the first places the labels so that the second can encode
+// forward references. Errors go to stderr with their line number.
+bool assembleProgram(const char *text, size_t length, uint8_t *memory, uint32_t *size, SymbolTable **symbols)
+{
+  Assembler assembler = {0};
+
+  runAssemblerPass(&assembler, text, length);
+
+  if (!assembler.failed)
+  {
+    assembler.memory = memory;
+    assembler.address = 0;
+    runAssemblerPass(&assembler, text, length);
+  }
+
+  // Whole words, as in the .hex format
+  while (!assembler.failed && assembler.address % 4 != 0)
+    emitByte(&assembler, 0);
+
+  *size = assembler.address;
+
+  SymbolTable *table = createSymbolTable(&assembler);
+
+  if (assembler.failed || symbols == NULL)
+    freeSymbolTable(table);
+  else
+    *symbols = table;
+
+  return !assembler.failed;
+}
+
+void runAssemblerPass(Assembler *assembler, const char *text, size_t length)
+{
+  size_t position = 0;
+
+  assembler->line = 0;
+
+  while (position < length && !assembler->failed)
+  {
+    char line[ASSEMBLER_LINE_SIZE];
+    size_t size = 0;
+    bool quoted = false;
+
+    assembler->line++;
+
+    while (position < length && text[position] != '\n')
+    {
+      if (size < sizeof(line) - 1)
+        line[size] = text[position];
+      size++;
+      position++;
+    }
+    position++; // newline
+
+    if (size >= sizeof(line))
+    {
+      reportAssemblerError(assembler, "Line too long", NULL);
+      return;
+    }
+
+    line[size] = '\0';
+
+    // Comments, outside of strings
+    for (size_t i = 0; i < size; i++)
+    {
+      if (line[i] == '"' && (i == 0 || line[i - 1] != '\\'))
+        quoted = !quoted;
+      else if (!quoted && line[i] == '/' && line[i + 1] == '/')
+      {
+        line[i] = '\0';
+        break;
+      }
+    }
+
+    char *statement = trimSpaces(line);
+
+    // Labels
+    while (isalpha((unsigned char)*statement) || *statement == '_' || *statement == '.' || *statement == '$')
+    {
+      char *end = statement;
+
+      while (isalnum((unsigned char)*end) || *end == '_' || *end == '.' || *end == '$')
+        end++;
+
+      if (*end != ':')
+        break;
+
+      *end = '\0';
+
+      // Placed in the first pass
+      if (assembler->memory == NULL)
+        defineLabel(assembler, statement);
+
+      statement = trimSpaces(end + 1);
+    }
+
+    if (*statement != '\0' && !assembler->failed)
+      assembleStatement(assembler, statement);
+  }
+}
+
+void assembleStatement(Assembler *assembler, char *statement)
+{
+  char *arguments = statement;
+
+  while (*arguments != '\0' && !isspace((unsigned char)*arguments))
+  {
+    *arguments = tolower((unsigned char)*arguments);
+    arguments++;
+  }
+
+  if (*arguments != '\0')
+    *arguments++ = '\0';
+
+  arguments = trimSpaces(arguments);
+
+  if (statement[0] == '.')
+    assembleDirective(assembler, statement, arguments);
+  else
+    assembleInstruction(assembler, statement, arguments);
+}
+
+void assembleDirective(Assembler *assembler, const char *directive, char *arguments)
+{
+  char *operands[ASSEMBLER_MAX_OPERANDS];
+  uint32_t values[3];
+  bool label;
+
+  if (strcmp(directive, ".text") == 0 || strcmp(directive, ".data") == 0)
+    return;
+
+  if (strcmp(directive, ".asciz") == 0)
+  {
+    parseString(assembler, arguments);
+    return;
+  }
+
+  const int count = splitOperands(arguments, operands);
+
+  if (strcmp(directive, ".align") == 0)
+  {
+    if (count != 1 || !parseValue(assembler, operands[0], &values[0], &label) || values[0] > 15)
+    {
+      reportAssemblerError(assembler, "Invalid alignment", arguments);
+      return;
+    }
+
+    // The operand is a power of two
+    while (assembler->address % (1u << values[0]) != 0 && !assembler->failed)
+      emitByte(assembler, 0);
+  }
+  else if (strcmp(directive, ".fill") == 0)
+  {
+    if (count != 3 || !parseValue(assembler, operands[0], &values[0], &label) || !parseValue(assembler, operands[1], &values[1], &label) ||
+        !parseValue(assembler, operands[2], &values[2], &label) || values[1] < 1 || values[1] > 4)
+    {
+      reportAssemblerError(assembler, "Expected .fill <count>, <size 1-4>, <value>", arguments);
+      return;
+    }
+
+    for (uint32_t i = 0; i < values[0] && !assembler->failed; i++)
+      for (uint32_t byte = values[1]; byte-- > 0;)
+        emitByte(assembler, values[2] >> (8 * byte));
+  }
+  else if (strcmp(directive, ".4byte") == 0)
+  {
+    if (count < 1)
+      reportAssemblerError(assembler, "Expected at least one value", directive);
+
+    for (int i = 0; i < count && !assembler->failed; i++)
+      if (parseValue(assembler, operands[i], &values[0], &label))
+        emitWord(assembler, values[0]);
+  }
+  else
+    reportAssemblerError(assembler, "Unknown directive", directive);
+}
+
+void assembleInstruction(Assembler *assembler, const char *mnemonic, char *arguments)
+{
+  const AssemblerInstruction *instruction = findAssemblerInstruction(mnemonic);
+  char *operands[ASSEMBLER_MAX_OPERANDS];
+  const int count = splitOperands(arguments, operands);
+
+  // Operands of each format, the stack accepting one to five
+  static const int8_t expected[] = {2, 3, 2, 2, 4, 4, 3, 2, 2, 2, 1, 1, 0, -1, 1, 1};
+
+  if (instruction == NULL)
+  {
+    reportAssemblerError(assembler, "Unknown instruction", mnemonic);
+    return;
+  }
+
+  if (expected[instruction->format] >= 0 ? count != expected[instruction->format] : (count < 1 || count > 5))
+  {
+    reportAssemblerError(assembler, "Wrong number of operands", mnemonic);
+    return;
+  }
+
+  uint8_t r[5] = {0};
+  uint32_t value = 0;
+  uint8_t base = 0;
+  bool label = false;
+  bool valid = true;
+  uint32_t word = (uint32_t)instruction->opcode << 26;
+
+  switch (instruction->format)
+  {
+  case OPERANDS_MOVE:
+    valid = parseRegister(operands[0], &r[0]) && parseValue(assembler, operands[1], &value, &label);
+    word |= (r[0] << 21) | (value & 0x1FFFFF);
+    break;
+  case OPERANDS_REGISTERS:
+    valid = parseRegister(operands[0], &r[0]) && parseRegister(operands[1], &r[1]) && parseRegister(operands[2], &r[2]);
+    word |= (r[0] << 21) | (r[1] << 16) | (r[2] << 11);
+    break;
+  case OPERANDS_COMPARE:
+    valid = parseRegister(operands[0], &r[0]) && parseRegister(operands[1], &r[1]);
+    word |= (r[0] << 16) | (r[1] << 11);
+    break;
+  case OPERANDS_NOT:
+    valid = parseRegister(operands[0], &r[0]) && parseRegister(operands[1], &r[1]);
+    word |= (r[0] << 21) | (r[1] << 16);
+    break;
+  case OPERANDS_EXTENDED:
+    valid = parseRegister(operands[0], &r[0]) && parseRegister(operands[1], &r[1]) && parseRegister(operands[2], &r[2]) &&
+            parseRegister(operands[3], &r[3]);
+    word |= (r[1] << 21) | (r[2] << 16) | (r[3] << 11) | (instruction->function << 8) | r[0];
+    break;
+  case OPERANDS_SHIFT:
+    valid = parseRegister(operands[0], &r[0]) && parseRegister(operands[1], &r[1]) && parseRegister(operands[2], &r[2]) &&
+            parseValue(assembler, operands[3], &value, &label);
+    word |= (r[0] << 21) | (r[1] << 16) | (r[2] << 11) | (instruction->function << 8) | (value & 0x1F);
+    break;
+  case OPERANDS_IMMEDIATE:
+    valid = parseRegister(operands[0], &r[0]) && parseRegister(operands[1], &r[1]) && parseValue(assembler, operands[2], &value, &label);
+    word |= (r[0] << 21) | (r[1] << 16) | (value & 0xFFFF);
+    break;
+  case OPERANDS_COMPARE_IMMEDIATE:
+    valid = parseRegister(operands[0], &r[0]) && parseValue(assembler, operands[1], &value, &label);
+    word |= (r[0] << 16) | (value & 0xFFFF);
+    break;
+  case OPERANDS_LOAD:
+    valid = parseRegister(operands[0], &r[0]) && parseMemoryOperand(assembler, operands[1], instruction->function, &base, &value);
+    word |= (r[0] << 21) | (base << 16) | (value & 0xFFFF);
+    break;
+  case OPERANDS_STORE:
+    valid = parseMemoryOperand(assembler, operands[0], instruction->function, &base, &value) && parseRegister(operands[1], &r[0]);
+    word |= (r[0] << 21) | (base << 16) | (value & 0xFFFF);
+    break;
+  case OPERANDS_CALL:
+    if (operands[0][0] == '[')
+    {
+      // Type F, through a register
+      valid = parseMemoryOperand(assembler, operands[0], 4, &base, &value);
+      word = (0b011110u << 26) | (base << 16) | (value & 0xFFFF);
+      break;
+    }
+    // fall through
+  case OPERANDS_BRANCH:
+    valid = parseValue(assembler, operands[0], &value, &label);
+    if (label)
+      value = (uint32_t)(((int32_t)value - (int32_t)assembler->address - 4) / 4);
+    word |= value & 0x3FFFFFF;
+    break;
+  case OPERANDS_NONE:
+    break;
+  case OPERANDS_STACK:
+    // Fields in operand order: v, w, x, y, z
+    for (int i = 0; i < count && valid; i++)
+      valid = parseRegister(operands[i], &r[i]);
+    word |= (r[4] << 21) | (r[2] << 16) | (r[3] << 11) | (r[0] << 6) | r[1];
+    break;
+  case OPERANDS_BIT:
+    valid = parseBitOperand(operands[0], &r[0], &r[1]);
+    word |= (r[0] << 21) | (r[1] << 16) | instruction->function;
+    break;
+  case OPERANDS_INTERRUPT:
+    valid = parseValue(assembler, operands[0], &value, &label);
+    word |= value & 0x3FFFFFF;
+    break;
+  }
+
+  if (!valid)
+    reportAssemblerError(assembler, "Invalid operand", arguments);
+  else
+    emitWord(assembler, word);
+}
+
+const AssemblerInstruction *findAssemblerInstruction(const char *mnemonic)
+{
+  static const AssemblerInstruction instructions[] = {
+      {"mov", 0b000000, 0, OPERANDS_MOVE},
+      {"movs", 0b000001, 0, OPERANDS_MOVE},
+      {"add", 0b000010, 0, OPERANDS_REGISTERS},
+      {"sub", 0b000011, 0, OPERANDS_REGISTERS},
+      {"mul", 0b000100, 0b000, OPERANDS_EXTENDED},
+      {"sll", 0b000100, 0b001, OPERANDS_SHIFT},
+      {"muls", 0b000100, 0b010, OPERANDS_EXTENDED},
+      {"sla", 0b000100, 0b011, OPERANDS_SHIFT},
+      {"div", 0b000100, 0b100, OPERANDS_EXTENDED},
+      {"srl", 0b000100, 0b101, OPERANDS_SHIFT},
+      {"divs", 0b000100, 0b110, OPERANDS_EXTENDED},
+      {"sra", 0b000100, 0b111, OPERANDS_SHIFT},
+      {"cmp", 0b000101, 0, OPERANDS_COMPARE},
+      {"and", 0b000110, 0, OPERANDS_REGISTERS},
+      {"or", 0b000111, 0, OPERANDS_REGISTERS},
+      {"not", 0b001000, 0, OPERANDS_NOT},
+      {"xor", 0b001001, 0, OPERANDS_REGISTERS},
+      {"push", 0b001010, 0, OPERANDS_STACK},
+      {"pop", 0b001011, 0, OPERANDS_STACK},
+      {"addi", 0b010010, 0, OPERANDS_IMMEDIATE},
+      {"subi", 0b010011, 0, OPERANDS_IMMEDIATE},
+      {"muli", 0b010100, 0, OPERANDS_IMMEDIATE},
+      {"divi", 0b010101, 0, OPERANDS_IMMEDIATE},
+      {"modi", 0b010110, 0, OPERANDS_IMMEDIATE},
+      {"cmpi", 0b010111, 0, OPERANDS_COMPARE_IMMEDIATE},
+      {"l8", 0b011000, 1, OPERANDS_LOAD},
+      {"l16", 0b011001, 2, OPERANDS_LOAD},
+      {"l32", 0b011010, 4, OPERANDS_LOAD},
+      {"s8", 0b011011, 1, OPERANDS_STORE},
+      {"s16", 0b011100, 2, OPERANDS_STORE},
+      {"s32", 0b011101, 4, OPERANDS_STORE},
+      {"call", 0b111001, 0, OPERANDS_CALL},
+      {"ret", 0b011111, 0, OPERANDS_NONE},
+      {"reti", 0b100000, 0, OPERANDS_NONE},
+      {"cbr", 0b100001, 0, OPERANDS_BIT},
+      {"sbr", 0b100001, 1, OPERANDS_BIT},
+      {"bae", 0b101010, 0, OPERANDS_BRANCH},
+      {"bat", 0b101011, 0, OPERANDS_BRANCH},
+      {"bbe", 0b101100, 0, OPERANDS_BRANCH},
+      {"bbt", 0b101101, 0, OPERANDS_BRANCH},
+      {"beq", 0b101110, 0, OPERANDS_BRANCH},
+      {"bge", 0b101111, 0, OPERANDS_BRANCH},
+      {"bgt", 0b110000, 0, OPERANDS_BRANCH},
+      {"biv", 0b110001, 0, OPERANDS_BRANCH},
+      {"ble", 0b110010, 0, OPERANDS_BRANCH},
+      {"blt", 0b110011, 0, OPERANDS_BRANCH},
+      {"bne", 0b110100, 0, OPERANDS_BRANCH},
+      {"bni", 0b110101, 0, OPERANDS_BRANCH},
+      {"bnz", 0b110110, 0, OPERANDS_BRANCH},
+      {"bun", 0b110111, 0, OPERANDS_BRANCH},
+      {"bzd", 0b111000, 0, OPERANDS_BRANCH},
+      {"int", 0b111111, 0, OPERANDS_INTERRUPT}};
+
+  for (size_t i = 0; i < sizeof(instructions) / sizeof(instructions[0]); i++)
+    if (strcmp(instructions[i].mnemonic, mnemonic) == 0)
+      return &instructions[i];
+
+  return NULL;
+}
+
+// Splits text in place at the commas outside strings, returning the number
+// of trimmed operands, or ASSEMBLER_MAX_OPERANDS + 1 when there are too many
+int splitOperands(char *text, char **operands)
+{
+  int count = 0;
+  bool quoted = false;
+
+  if (*text == '\0')
+    return 0;
+
+  operands[count++] = text;
+
+  for (char *c = text; *c != '\0'; c++)
+  {
+    if (*c == '"' && (c == text || c[-1] != '\\'))
+      quoted = !quoted;
+    else if (*c == ',' && !quoted)
+    {
+      if (count == ASSEMBLER_MAX_OPERANDS)
+        return ASSEMBLER_MAX_OPERANDS + 1;
+
+      *c = '\0';
+      operands[count++] = c + 1;
+    }
+  }
+
+  for (int i = 0; i < count; i++)
+    operands[i] = trimSpaces(operands[i]);
+
+  return count;
+}
+
+char *trimSpaces(char *text)
+{
+  while (isspace((unsigned char)*text))
+    text++;
+
+  size_t length = strlen(text);
+  while (length > 0 && isspace((unsigned char)text[length - 1]))
+    text[--length] = '\0';
+
+  return text;
+}
+
+// Only the first error is reported; it ends the pass
+void reportAssemblerError(Assembler *assembler, const char *message, const char *token)
+{
+  if (assembler->failed)
+    return;
+
+  if (token != NULL)
+    fprintf(stderr, "Line %u: %s: %s\n", assembler->line, message, token);
+  else
+    fprintf(stderr, "Line %u: %s\n", assembler->line, message);
+
+  assembler->failed = true;
+}
+
+void defineLabel(Assembler *assembler, const char *name)
+{
+  if (findLabel(assembler, name) != NULL)
+  {
+    reportAssemblerError(assembler, "Duplicate label", name);
+    return;
+  }
+
+  if (assembler->labelCount == assembler->labelCapacity)
+  {
+    assembler->labelCapacity = (assembler->labelCapacity == 0) ? 64 : 2 * assembler->labelCapacity;
+    assembler->labels = (Symbol *)realloc(assembler->labels, assembler->labelCapacity * sizeof(Symbol));
+
+    if (assembler->labels == NULL)
+    {
+      fprintf(stderr, "Failed to allocate memory for labels.\n");
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  char *copy = strdup(name);
+  if (copy == NULL)
+  {
+    fprintf(stderr, "Failed to allocate memory for labels.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  assembler->labels[assembler->labelCount].address = assembler->address;
+  assembler->labels[assembler->labelCount].name = copy;
+  assembler->labelCount++;
+}
+
+Symbol *findLabel(Assembler *assembler, const char *name)
+{
+  for (size_t i = 0; i < assembler->labelCount; i++)
+    if (strcmp(assembler->labels[i].name, name) == 0)
+      return &assembler->labels[i];
+
+  return NULL;
+}
+
+// Register names as the trace prints them (r0-r31, cr, ipc, ir, pc, sp, sr),
+// in either case
+bool parseRegister(const char *token, uint8_t *number)
+{
+  for (uint8_t i = 0; i < NUM_REGISTERS; i++)
+  {
+    if (strcasecmp(token, formatRegisterName(i, true)) == 0)
+    {
+      *number = i;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// A decimal, 0x hexadecimal or 0b binary number, optionally signed, or a
+// label. Labels not placed yet read as 0 in the first pass.
+bool parseValue(Assembler *assembler, const char *token, uint32_t *value, bool *label)
+{
+  *label = false;
+
+  if (isdigit((unsigned char)token[0]) || token[0] == '-' || token[0] == '+')
+  {
+    const bool negative = token[0] == '-';
+    const char *digits = (token[0] == '-' || token[0] == '+') ? token + 1 : token;
+    int base = 10;
+
+    if (digits[0] == '0' && (digits[1] == 'x' || digits[1] == 'X'))
+      base = 16;
+    else if (digits[0] == '0' && (digits[1] == 'b' || digits[1] == 'B'))
+      base = 2;
+
+    char *end;
+    const uint64_t number = strtoull(base == 10 ? digits : digits + 2, &end, base);
+
+    if (!isalnum((unsigned char)(base == 10 ? digits : digits + 2)[0]) || *end != '\0')
+      return false;
+
+    *value = negative ? (uint32_t)-number : (uint32_t)number;
+
+    return true;
+  }
+
+  Symbol *symbol = findLabel(assembler, token);
+  *label = true;
+
+  if (symbol != NULL)
+    *value = symbol->address;
+  else if (assembler->memory == NULL && (isalpha((unsigned char)token[0]) || token[0] == '_' || token[0] == '.' || token[0] == '$'))
+    *value = 0;
+  else
+  {
+    reportAssemblerError(assembler, "Undefined label", token);
+    return false;
+  }
+
+  return true;
+}
+
+// [base], [base+offset] or [base-offset], the base being a register or a
+// value. Labels are divided by the access size, as the handlers scale the
+// sum back up.
+bool parseMemoryOperand(Assembler *assembler, char *token, uint32_t scale, uint8_t *base, uint32_t *offset)
+{
+  const size_t length = strlen(token);
+
+  if (length < 3 || token[0] != '[' || token[length - 1] != ']')
+    return false;
+
+  token[length - 1] = '\0';
+
+  char *first = trimSpaces(token + 1);
+  char *second = NULL;
+  bool negative = false;
+
+  for (char *c = first + 1; *c != '\0'; c++)
+  {
+    if (*c == '+' || *c == '-')
+    {
+      negative = *c == '-';
+      *c = '\0';
+      second = trimSpaces(c + 1);
+      first = trimSpaces(first);
+      break;
+    }
+  }
+
+  uint32_t value = 0;
+  bool label;
+
+  if (parseRegister(first, base))
+  {
+    if (second != NULL)
+    {
+      if (!parseValue(assembler, second, &value, &label))
+        return false;
+
+      if (label)
+        value /= scale;
+    }
+
+    *offset = negative ? -value : value;
+
+    return true;
+  }
+
+  *base = 0;
+
+  if (!parseValue(assembler, first, offset, &label))
+    return false;
+
+  if (label)
+    *offset /= scale;
+
+  if (second != NULL)
+  {
+    if (!parseValue(assembler, second, &value, &label))
+      return false;
+
+    *offset += negative ? -value : value;
+  }
+
+  return true;
+}
+
+// register[bit], as in "sbr sr[1]"
+bool parseBitOperand(const char *token, uint8_t *number, uint8_t *bit)
+{
+  char name[8];
+  unsigned int index;
+  char end;
+
+  if (sscanf(token, "%7[^[ ] [ %u ] %c", name, &index, &end) != 2 || index > 31)
+    return false;
+
+  *bit = index;
+
+  return parseRegister(name, number);
+}
+
+// A quoted string with C escapes, emitted with its terminating NUL
+bool parseString(Assembler *assembler, const char *token)
+{
+  const size_t length = strlen(token);
+
+  if (length < 2 || token[0] != '"' || token[length - 1] != '"')
+  {
+    reportAssemblerError(assembler, "Expected a quoted string", token);
+    return false;
+  }
+
+  for (size_t i = 1; i < length - 1 && !assembler->failed; i++)
+  {
+    char character = token[i];
+
+    if (character == '\\' && i + 1 < length - 1)
+    {
+      switch (token[++i])
+      {
+      case 'n':
+        character = '\n';
+        break;
+      case 't':
+        character = '\t';
+        break;
+      case 'r':
+        character = '\r';
+        break;
+      case '0':
+        character = '\0';
+        break;
+      case 'x':
+      {
+        unsigned int code = 0;
+        int digits = 0;
+
+        while (digits < 2 && i + 1 < length - 1 && isxdigit((unsigned char)token[i + 1]))
+        {
+          const char digit = tolower((unsigned char)token[++i]);
+          code = code * 16 + (isdigit((unsigned char)digit) ? digit - '0' : digit - 'a' + 10);
+          digits++;
+        }
+
+        character = (char)code;
+        break;
+      }
+      default: // \\, \" and \'
+        character = token[i];
+      }
+    }
+
+    emitByte(assembler, character);
+  }
+
+  emitByte(assembler, 0);
+
+  return !assembler->failed;
+}
+
+void emitByte(Assembler *assembler, uint8_t value)
+{
+  if (assembler->address >= MEMORY_SIZE)
+  {
+    reportAssemblerError(assembler, "Program does not fit in memory", NULL);
+    return;
+  }
+
+  if (assembler->memory != NULL)
+    assembler->memory[assembler->address] = value;
+
+  assembler->address++;
+}
+
+// Big-endian, as the simulator reads instructions
+void emitWord(Assembler *assembler, uint32_t word)
+{
+  for (int shift = 24; shift >= 0 && !assembler->failed; shift -= 8)
+    emitByte(assembler, word >> shift);
+}
+
+/******************************************************
+ * Symbols
+ *******************************************************/
+
+// Takes over the labels of the assembler
+SymbolTable *createSymbolTable(Assembler *assembler)
+{
+  SymbolTable *symbols = (SymbolTable *)malloc(sizeof(SymbolTable));
+  if (symbols == NULL)
+  {
+    fprintf(stderr, "Failed to allocate memory for labels.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  // Insertion sort keeps labels of one address in definition order
+  for (size_t i = 1; i < assembler->labelCount; i++)
+  {
+    const Symbol label = assembler->labels[i];
+    size_t j = i;
+
+    for (; j > 0 && assembler->labels[j - 1].address > label.address; j--)
+      assembler->labels[j] = assembler->labels[j - 1];
+
+    assembler->labels[j] = label;
+  }
+
+  symbols->symbols = assembler->labels;
+  symbols->count = assembler->labelCount;
+
+  assembler->labels = NULL;
+  assembler->labelCount = 0;
+  assembler->labelCapacity = 0;
+
+  return symbols;
+}
+
+// The first label at address, or NULL
+const char *findSymbol(const SymbolTable *symbols, uint32_t address)
+{
+  if (symbols == NULL)
+    return NULL;
+
+  size_t low = 0;
+  size_t high = symbols->count;
+
+  while (low < high)
+  {
+    const size_t middle = low + (high - low) / 2;
+
+    if (symbols->symbols[middle].address < address)
+      low = middle + 1;
+    else
+      high = middle;
+  }
+
+  return (low < symbols->count && symbols->symbols[low].address == address) ? symbols->symbols[low].name : NULL;
+}
+
+void freeSymbolTable(SymbolTable *symbols)
+{
+  if (symbols == NULL)
+    return;
+
+  for (size_t i = 0; i < symbols->count; i++)
+    free(symbols->symbols[i].name);
+
+  free(symbols->symbols);
+  free(symbols);
+}
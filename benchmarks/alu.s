@@ -0,0 +1,40 @@
+// ALU-heavy loop: register arithmetic, logic and shifts
+.text
+	init:
+		bun main
+		.align 5
+	main:
+    mov r1, 0
+    mov r2, 3
+    mov r3, 7
+    mov r4, 0x1234
+
+    // OUTER LOOP COUNTER
+    mov r20, 0
+  outer:
+    // INNER LOOP COUNTER
+    mov r21, 0
+  inner:
+    add r5, r1, r2
+    sub r6, r5, r3
+    xor r7, r6, r4
+    and r8, r7, r5
+    or r9, r8, r6
+    not r10, r9
+    sll r0, r11, r5, 2
+    srl r0, r12, r11, 1
+    mul r0, r13, r12, r3
+    addi r1, r1, 1
+    muli r14, r2, 5
+    divi r15, r14, 3
+    cmp r13, r12
+
+    addi r21, r21, 1
+    cmpi r21, 0x7FFF
+    bne inner
+
+    addi r20, r20, 1
+    cmpi r20, 0x7FFF
+    bne outer
+
+		int 0
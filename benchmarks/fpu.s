@@ -0,0 +1,65 @@
+// FPU operations through the FPU_REGISTER_* ports, completed by interrupts
+.text
+	init:
+		bun main
+		bun invalidInstruction
+		bun divideByZero
+		bun softwareInterrupt
+		bun hardware1
+		bun fpuError
+		bun fpuDone
+		bun fpuDone
+		.align 5
+  invalidInstruction:
+  divideByZero:
+  softwareInterrupt:
+  hardware1:
+    reti
+  // ERROR: COUNT IT AND CLEAR THE STATUS
+  fpuError:
+    addi r22, r22, 1
+    s32 [r1+3], r0
+    mov r25, 1
+    reti
+  // OPERATION FINISHED
+  fpuDone:
+    mov r25, 1
+    reti
+	main:
+    // SP = 32KiB
+		mov sp, 0x7FFC
+
+    // R1 = FPU_REGISTER_X WORD ADDRESS
+    l32 r1, [fpuX]
+
+    mov r20, 0
+  outer:
+    // X = R20, Y = 3
+    s32 [r1], r20
+    mov r2, 3
+    s32 [r1+1], r2
+
+    // CYCLE THROUGH ADD, SUB, MUL, DIV, X=Z, Y=Z, CEIL, FLOOR, ROUND
+    mov r3, 1
+  operation:
+    mov r25, 0
+    s32 [r1+3], r3
+  wait:
+    cmpi r25, 0
+    beq wait
+
+    l32 r4, [r1+2]
+    add r23, r23, r4
+
+    addi r3, r3, 1
+    cmpi r3, 10
+    bne operation
+
+    addi r20, r20, 1
+    cmpi r20, 0x7FFF
+    bne outer
+
+		int 0
+.data
+  fpuX:
+    .4byte 0x20202220
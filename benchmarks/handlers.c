@@ -0,0 +1,183 @@
+/******************************************************
+ * Per-handler microbenchmark
+ *
+ * Build: gcc -O2 -pthread -o handlers benchmarks/handlers.c poxim.c reports.c lockstep.c assembler.c translator.c analysis.c -lm
+ * Usage: handlers [--iterations=<n>] [--seed=<n>] [<handler>...]
+ *
+ * Drives every instruction handler (or the ones named) in a tight loop over
+ * a pool of randomized register states and reports nanoseconds per
+ * instruction with the trace disabled and with the trace written to
+ * /dev/null twice, like the command line front end does. The cost of
+ * restoring the register state is measured on its own and subtracted.
+ *******************************************************/
+#include "../poxim_internal.h"
+
+#include <time.h>
+
+#define STATE_POOL_SIZE 1024 // Power of two
+#define DEFAULT_ITERATIONS 1000000
+
+typedef struct
+{
+  uint32_t registers[NUM_REGISTERS];
+} RegisterState;
+
+uint32_t nextRandom(uint32_t *seed)
+{
+  // xorshift32
+  uint32_t x = *seed;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *seed = x;
+  return x;
+}
+
+// General purpose register in R1..R25, so that PC, SP and SR stay sane
+uint32_t randomRegister(uint32_t *seed)
+{
+  return 1 + nextRandom(seed) % 25;
+}
+
+void randomizeStates(RegisterState *pool, const InstructionHandler *handler, uint32_t *seed)
+{
+  for (size_t n = 0; n < STATE_POOL_SIZE; n++)
+  {
+    uint32_t *registers = pool[n].registers;
+
+    for (uint8_t i = 0; i < NUM_REGISTERS; i++)
+      registers[i] = nextRandom(seed);
+
+    registers[0] = 0;
+    registers[PC] &= 0x7FFC;
+    registers[SP] = 0x1000 + (nextRandom(seed) & 0x3FFC); // Room for push/pop and ISR frames
+    registers[SR] &= 0x7F;
+
+    // Operand fields z, x, y, v, w name general purpose registers
+    const uint32_t operands = (randomRegister(seed) << 21) | (randomRegister(seed) << 16) | (randomRegister(seed) << 11) |
+                              (randomRegister(seed) << 6) | randomRegister(seed);
+    uint32_t ir = handler->encoding | (operands & ~handler->mask);
+
+    if (handler->memory)
+    {
+      // Zero displacement and an in-bounds base below the device window
+      ir &= 0xFFFF0000;
+      registers[(ir >> 16) & 0x1F] &= 0x1FFF;
+    }
+
+    registers[IR] = ir;
+  }
+}
+
+// Same work per line as the command line front end: screen and file
+void writeTraceLine(void *context, const char *line)
+{
+  fprintf((FILE *)context, "%s\n", line);
+  fprintf((FILE *)context, "%s\n", line);
+}
+
+double elapsedNanoseconds(struct timespec *start, struct timespec *end)
+{
+  return (end->tv_sec - start->tv_sec) * 1e9 + (end->tv_nsec - start->tv_nsec);
+}
+
+// Total time of the loop; handler NULL measures the state restore alone
+double runHandler(System *system, const RegisterState *pool, const InstructionHandler *handler, uint64_t iterations, Trace *output)
+{
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  for (uint64_t i = 0; i < iterations; i++)
+  {
+    memcpy(system->cpu.registers, pool[i & (STATE_POOL_SIZE - 1)].registers, sizeof(system->cpu.registers));
+    system->control.run = true;
+    system->control.pcAlreadyIncremented = false;
+
+    if (handler != NULL)
+      executeInstructionHandler(system, handler, output);
+
+    __asm__ volatile("" ::: "memory");
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  return elapsedNanoseconds(&start, &end);
+}
+
+int main(int argc, char *argv[])
+{
+  uint64_t iterations = DEFAULT_ITERATIONS;
+  uint32_t seed = 0x2545F491;
+  int first = 1;
+
+  for (; first < argc && strncmp(argv[first], "--", 2) == 0; first++)
+  {
+    if (strncmp(argv[first], "--iterations=", 13) == 0)
+      iterations = strtoull(argv[first] + 13, NULL, 10);
+    else if (strncmp(argv[first], "--seed=", 7) == 0)
+      seed = strtoul(argv[first] + 7, NULL, 0);
+    else
+    {
+      fprintf(stderr, "Usage: %s [--iterations=<n>] [--seed=<n>] [<handler>...]\n", argv[0]);
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  if (iterations == 0 || seed == 0)
+  {
+    fprintf(stderr, "Iterations and seed must be non-zero.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  // The command line front end writes every line to the screen and the file
+  FILE *sink = fopen("/dev/null", "w");
+  if (sink == NULL)
+  {
+    fprintf(stderr, "Failed to open /dev/null.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  Trace trace = {writeTraceLine, sink, 0};
+
+  System *system = poxim_create(0, NULL);
+
+  RegisterState *pool = (RegisterState *)malloc(STATE_POOL_SIZE * sizeof(RegisterState));
+  if (pool == NULL)
+  {
+    fprintf(stderr, "Failed to allocate memory for benchmark.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  printf("%-8s %14s %14s %8s\n", "handler", "ns (no trace)", "ns (trace)", "trace %");
+
+  for (size_t i = 0; i < instructionHandlerCount; i++)
+  {
+    const InstructionHandler *handler = &instructionHandlers[i];
+
+    if (first < argc)
+    {
+      bool selected = false;
+
+      for (int a = first; a < argc && !selected; a++)
+        selected = strcmp(argv[a], handler->name) == 0;
+
+      if (!selected)
+        continue;
+    }
+
+    randomizeStates(pool, handler, &seed);
+
+    const double baseline = runHandler(system, pool, NULL, iterations, NULL);
+    const double untraced = (runHandler(system, pool, handler, iterations, NULL) - baseline) / iterations;
+    const double traced = (runHandler(system, pool, handler, iterations, &trace) - baseline) / iterations;
+
+    printf("%-8s %14.2f %14.2f %7.1f%%\n", handler->name, untraced, traced,
+           traced > 0 ? 100.0 * (traced - untraced) / traced : 0.0);
+  }
+
+  fclose(sink);
+  free(pool);
+  poxim_destroy(system);
+
+  return 0;
+}
@@ -0,0 +1,57 @@
+// Watchdog and software interrupt storms
+.text
+	init:
+		bun main
+		bun invalidInstruction
+		bun divideByZero
+		bun softwareInterrupt
+		bun watchdog
+		bun hardware2
+		bun hardware3
+		bun hardware4
+		.align 5
+  invalidInstruction:
+  divideByZero:
+  hardware2:
+  hardware3:
+  hardware4:
+    reti
+  softwareInterrupt:
+    addi r21, r21, 1
+    reti
+  // COUNT THE EXPIRATION AND RE-ARM THE WATCHDOG
+  watchdog:
+    addi r22, r22, 1
+    s32 [r1], r2
+    reti
+	main:
+    // SP = 32KiB
+		mov sp, 0x7FFC
+
+    // R1 = WATCHDOG WORD ADDRESS, R2 = EN | 8 INSTRUCTIONS
+    l32 r1, [watchdogAddr]
+    l32 r2, [watchdogArm]
+
+    // IE = 1
+    mov sr, 2
+    s32 [r1], r2
+
+    mov r20, 0
+  outer:
+    mov r23, 0
+  inner:
+    int 1
+    addi r23, r23, 1
+    cmpi r23, 0x7FFF
+    bne inner
+
+    addi r20, r20, 1
+    cmpi r20, 0x7FFF
+    bne outer
+
+		int 0
+.data
+  watchdogAddr:
+    .4byte 0x20202020
+  watchdogArm:
+    .4byte 0x80000008
@@ -0,0 +1,41 @@
+// Load/store streaming: copy, scale and sum two 1024-word arrays
+.text
+	init:
+		bun main
+		.align 5
+	main:
+    mov r20, 0
+  outer:
+    // R1 = SOURCE WORD INDEX, R2 = DESTINATION WORD INDEX
+    mov r1, source
+    divi r1, r1, 4
+    mov r2, destination
+    divi r2, r2, 4
+
+    // R3 = REMAINING WORDS
+    mov r3, 1024
+    mov r10, 0
+  copy:
+    l32 r4, [r1]
+    addi r4, r4, 3
+    s32 [r2], r4
+    add r10, r10, r4
+    l8 r5, [r1+0]
+    s8 [r2+0], r5
+
+    addi r1, r1, 1
+    addi r2, r2, 1
+    subi r3, r3, 1
+    cmpi r3, 0
+    bne copy
+
+    addi r20, r20, 1
+    cmpi r20, 0x7FFF
+    bne outer
+
+		int 0
+.data
+  source:
+    .fill 1024, 4, 7
+  destination:
+    .fill 1024, 4, 0
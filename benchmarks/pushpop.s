@@ -0,0 +1,35 @@
+// Multi-register push/pop traffic
+.text
+	init:
+		bun main
+		.align 5
+	main:
+    // SP = 32KiB
+		mov sp, 0x7FFC
+
+    mov r1, 1
+    mov r2, 2
+    mov r3, 3
+    mov r4, 4
+    mov r5, 5
+
+    mov r20, 0
+  outer:
+    mov r21, 0
+  inner:
+    push r1, r2, r3, r4, r5
+    push r1, r2, r3
+    pop r8, r7, r6
+    pop r5, r4, r3, r2, r1
+    push r6
+    pop r6
+
+    addi r21, r21, 1
+    cmpi r21, 0x7FFF
+    bne inner
+
+    addi r20, r20, 1
+    cmpi r20, 0x7FFF
+    bne outer
+
+		int 0
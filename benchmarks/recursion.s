@@ -0,0 +1,51 @@
+// Deep recursion through call type S and call type F
+.text
+	init:
+		bun main
+		.align 5
+  // R1 = N, RETURNS R2 = N + (N - 1) + ... + 1
+  sumDirect:
+    cmpi r1, 0
+    bne 2
+    mov r2, 0
+    ret
+
+    push r1
+    subi r1, r1, 1
+    call sumDirect
+    pop r1
+    add r2, r2, r1
+    ret
+  // SAME AS sumDirect, RECURSING THROUGH THE POINTER IN R9
+  sumIndirect:
+    cmpi r1, 0
+    bne 2
+    mov r2, 0
+    ret
+
+    push r1
+    subi r1, r1, 1
+    call [r9]
+    pop r1
+    add r2, r2, r1
+    ret
+	main:
+    // SP = 32KiB
+		mov sp, 0x7FFC
+
+    // R9 = sumIndirect WORD ADDRESS
+    mov r9, sumIndirect
+    divi r9, r9, 4
+
+    mov r20, 0
+  outer:
+    mov r1, 1000
+    call sumDirect
+    mov r1, 1000
+    call [r9]
+
+    addi r20, r20, 1
+    cmpi r20, 0x7FFF
+    bne outer
+
+		int 0
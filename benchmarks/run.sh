@@ -0,0 +1,77 @@
+#!/bin/sh
+# Poxim benchmark harness
+#
+# Usage: benchmarks/run.sh <simulator> [--update-baseline]
+#
+# Runs every benchmark image with a fixed instruction budget, once with the
+# trace disabled and once with the trace written to /dev/null, and compares
+# MIPS and peak RSS against baseline.txt. Each run is repeated REPEAT times and
+# the fastest is kept, to filter scheduling noise. Exits with status 1 when any
+# run is slower (or larger) than the baseline by more than TOLERANCE percent.
+# Idle loops are not fast-forwarded, so every counted instruction is executed.
+# BASELINE names another baseline file.
+
+set -u
+
+SIMULATOR=${1:?usage: run.sh <simulator> [--update-baseline]}
+UPDATE=${2:-}
+DIRECTORY=$(cd "$(dirname "$0")" && pwd)
+BASELINE=${BASELINE:-"$DIRECTORY/baseline.txt"}
+BENCHMARKS="alu memory recursion pushpop fpu interrupts"
+BUDGET_NO_TRACE=${BUDGET_NO_TRACE:-20000000}
+BUDGET_TRACE=${BUDGET_TRACE:-2000000}
+TOLERANCE=${TOLERANCE:-15}
+REPEAT=${REPEAT:-3}
+
+RESULTS=$(mktemp)
+trap 'rm -f "$RESULTS"' EXIT
+
+# Runs one benchmark REPEAT times and appends "<name> <mode> <mips> <rss>" to
+# RESULTS, keeping the best MIPS and the largest peak RSS
+measure()
+{
+  name=$1
+  mode=$2
+  shift 2
+  run=0
+  while [ "$run" -lt "$REPEAT" ]
+  do
+    "$SIMULATOR" "$DIRECTORY/$name.hex" /dev/null --stats --idle-loops=off "$@" 2>&1 >/dev/null
+    run=$((run + 1))
+  done |
+    awk -v name="$name" -v mode="$mode" '
+      $1 == "MIPS:" && $2 > mips { mips = $2 }
+      $1 == "Peak" && $3 > rss { rss = $3 }
+      END { if (mips == "") exit 1; printf "%s %s %s %s\n", name, mode, mips, rss }
+    ' >> "$RESULTS" || { echo "$name ($mode): simulator failed" >&2; exit 2; }
+}
+
+for name in $BENCHMARKS
+do
+  measure "$name" no-trace --no-trace --max-instructions="$BUDGET_NO_TRACE"
+  measure "$name" trace --max-instructions="$BUDGET_TRACE"
+done
+
+if [ "$UPDATE" = "--update-baseline" ] || [ ! -f "$BASELINE" ]
+then
+  cp "$RESULTS" "$BASELINE"
+  echo "Baseline written to $BASELINE"
+  cat "$BASELINE"
+  exit 0
+fi
+
+awk -v tolerance="$TOLERANCE" '
+  NR == FNR { mips[$1 " " $2] = $3; rss[$1 " " $2] = $4; next }
+  {
+    key = $1 " " $2
+    status = "ok"
+    if (key in mips) {
+      if ($3 < mips[key] * (1 - tolerance / 100)) { status = "REGRESSION (MIPS)"; failed = 1 }
+      else if ($4 > rss[key] * (1 + tolerance / 100)) { status = "REGRESSION (RSS)"; failed = 1 }
+      printf "%-12s %-9s %10.3f MIPS (baseline %10.3f) %8d KiB (baseline %8d) %s\n", $1, $2, $3, mips[key], $4, rss[key], status
+    } else {
+      printf "%-12s %-9s %10.3f MIPS %8d KiB (no baseline)\n", $1, $2, $3, $4
+    }
+  }
+  END { exit failed }
+' "$BASELINE" "$RESULTS"
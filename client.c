@@ -0,0 +1,251 @@
+/******************************************************
+ * Poxim client
+ *
+ * Runs a program on a simulator started with --serve and writes the result
+ * like the command line front end does: the output file gets the trace and
+ * terminal, and the same text is echoed to stdout.
+ *
+ * Build: gcc -O2 -o poxim-client client.c
+ *******************************************************/
+
+/******************************************************
+ * Libraries
+ *******************************************************/
+
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <ctype.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/******************************************************
+ * Utility Constants
+ *******************************************************/
+
+// Keep in sync with the server's request and reply format in main.c
+#define DEFAULT_SOCKET "/tmp/poxim.sock"
+#define SOCKET_ENVIRONMENT "POXIM_SOCKET"
+#define STATUS_SIZE 256
+#define COPY_SIZE (64 * 1024)
+
+/******************************************************
+ * Functin Signature
+ *******************************************************/
+
+bool parseCount(const char *text, uint64_t *value);
+char *readFile(FILE *file, size_t *length);
+int connectServer(const char *path);
+int copyReply(FILE *stream, FILE *output);
+
+int main(int argc, char *argv[])
+{
+  const char *usage = "Usage: %s <input> <output> [--no-trace] [--max-instructions=<n>] [--socket=<path>]\n";
+
+  if (argc < 3)
+  {
+    fprintf(stderr, usage, argv[0]);
+    exit(EXIT_FAILURE);
+  }
+
+  const char *socketPath = getenv(SOCKET_ENVIRONMENT) != NULL ? getenv(SOCKET_ENVIRONMENT) : DEFAULT_SOCKET;
+  bool trace = true;
+  uint64_t maxInstructions = 0;
+  bool valid = true;
+
+  for (int i = 3; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--no-trace") == 0)
+      trace = false;
+    else if (strncmp(argv[i], "--max-instructions=", 19) == 0)
+      valid = parseCount(argv[i] + 19, &maxInstructions) && valid;
+    else if (strncmp(argv[i], "--socket=", 9) == 0)
+      socketPath = argv[i] + 9;
+    else
+      valid = false;
+  }
+
+  if (!valid)
+  {
+    fprintf(stderr, usage, argv[0]);
+    exit(EXIT_FAILURE);
+  }
+
+  FILE *input = fopen(argv[1], "r");
+  if (input == NULL)
+  {
+    fprintf(stderr, "Failed to open input file.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  size_t length;
+  char *program = readFile(input, &length);
+  fclose(input);
+
+  const int server = connectServer(socketPath);
+  if (server < 0)
+  {
+    fprintf(stderr, "Failed to connect to %s.\n", socketPath);
+    exit(EXIT_FAILURE);
+  }
+
+  FILE *stream = fdopen(server, "r+");
+  if (stream == NULL)
+  {
+    fprintf(stderr, "Failed to open server stream.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  // Inputs named *.s are assembled by the server, like the front end does
+  const size_t nameLength = strlen(argv[1]);
+  const bool assembly = nameLength > 2 && strcmp(argv[1] + nameLength - 2, ".s") == 0;
+
+  fprintf(stream, "RUN %zu %d %" PRIu64 " %s\n", length, trace ? 1 : 0, maxInstructions, assembly ? "asm" : "hex");
+  fwrite(program, 1, length, stream);
+  fflush(stream);
+  free(program);
+
+  char status[STATUS_SIZE];
+  if (fgets(status, sizeof(status), stream) == NULL)
+  {
+    fprintf(stderr, "Server closed the connection.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  if (strncmp(status, "ERROR ", 6) == 0)
+  {
+    fprintf(stderr, "%s", status + 6);
+    exit(EXIT_FAILURE);
+  }
+
+  FILE *output = fopen(argv[2], "w");
+  if (output == NULL)
+  {
+    fprintf(stderr, "Failed to open output file.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  const int exitStatus = copyReply(stream, output);
+
+  fclose(output);
+  fclose(stream);
+
+  if (exitStatus < 0)
+  {
+    fprintf(stderr, "Server closed the connection.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  return exitStatus;
+}
+
+/******************************************************
+ * Functions
+ *******************************************************/
+
+// Decimal digits only, like the simulator's --max-instructions
+bool parseCount(const char *text, uint64_t *value)
+{
+  char *end;
+
+  errno = 0;
+  *value = strtoull(text, &end, 10);
+
+  return isdigit((unsigned char)text[0]) && *end == '\0' && errno == 0;
+}
+
+// Reads the whole file into a buffer the caller frees
+char *readFile(FILE *file, size_t *length)
+{
+  size_t capacity = COPY_SIZE;
+  char *text = (char *)malloc(capacity);
+  *length = 0;
+
+  while (text != NULL)
+  {
+    *length += fread(text + *length, 1, capacity - *length, file);
+
+    if (*length < capacity)
+      return text;
+
+    capacity *= 2;
+    text = (char *)realloc(text, capacity);
+  }
+
+  fprintf(stderr, "Failed to allocate memory for input.\n");
+  exit(EXIT_FAILURE);
+}
+
+// Returns the connected socket, or -1
+int connectServer(const char *path)
+{
+  struct sockaddr_un address = {0};
+
+  address.sun_family = AF_UNIX;
+
+  if (strlen(path) >= sizeof(address.sun_path))
+    return -1;
+
+  strcpy(address.sun_path, path);
+
+  const int server = socket(AF_UNIX, SOCK_STREAM, 0);
+
+  if (server >= 0 && connect(server, (struct sockaddr *)&address, sizeof(address)) != 0)
+  {
+    close(server);
+    return -1;
+  }
+
+  return server;
+}
+
+// Copies the chunks of the reply to stdout and output and returns the exit
+// status from its trailer, or -1 when the reply ends early
+int copyReply(FILE *stream, FILE *output)
+{
+  char line[STATUS_SIZE];
+  char *buffer = (char *)malloc(COPY_SIZE);
+
+  if (buffer == NULL)
+  {
+    fprintf(stderr, "Failed to allocate memory for reply.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  int exitStatus = -1;
+
+  while (fgets(line, sizeof(line), stream) != NULL)
+  {
+    if (sscanf(line, "END %d", &exitStatus) == 1)
+      break;
+
+    char *end;
+    size_t length = strtoull(line, &end, 10);
+
+    if (end == line || *end != '\n')
+      break;
+
+    while (length > 0)
+    {
+      const size_t count = fread(buffer, 1, (length < COPY_SIZE) ? length : COPY_SIZE, stream);
+      if (count == 0)
+        break;
+
+      fwrite(buffer, 1, count, stdout);
+      fwrite(buffer, 1, count, output);
+      length -= count;
+    }
+
+    if (length > 0)
+      break;
+  }
+
+  free(buffer);
+
+  return exitStatus;
+}
@@ -0,0 +1,694 @@
+#include "poxim_internal.h"
+
+/******************************************************
+ * Lane vectors
+ *
+ * One 32-bit value per lane. Comparisons return a mask with every bit of a
+ * lane set when the condition holds for it, so masks combine with the
+ * bitwise operations and select lanes in laneSelect and laneStore.
+ *
+ * LaneVector is a generic vector and the helpers are macros or always
+ * inlined, so one stepLockstep body becomes AVX2 in stepLockstepAVX2 and
+ * SSE2 or plain code elsewhere. Macros rather than functions because GCC
+ * notes an ABI change for every 32-byte vector passed by value without AVX.
+ *******************************************************/
+
+#define LANE_INLINE static inline __attribute__((always_inline))
+
+typedef uint32_t LaneVector __attribute__((vector_size(4 * LOCKSTEP_LANES)));
+typedef int32_t SignedLaneVector __attribute__((vector_size(4 * LOCKSTEP_LANES)));
+
+// Only laneMask returns a vector from a function; it is always inlined
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+#define laneLoad(lanes) (*(const LaneVector *)(lanes))
+
+// Writes only the lanes selected by mask
+#define laneStore(lanes, value, mask) \
+  (*(LaneVector *)(lanes) = laneSelect(mask, value, laneLoad(lanes)))
+
+#define laneBroadcast(value) ((LaneVector){0} + (uint32_t)(value))
+#define laneAdd(a, b) ((a) + (b))
+#define laneSub(a, b) ((a) - (b))
+#define laneAnd(a, b) ((a) & (b))
+#define laneAndNot(a, b) (~(a) & (b)) // ~a & b
+#define laneOr(a, b) ((a) | (b))
+#define laneXor(a, b) ((a) ^ (b))
+
+// Mask of the lanes with bit 31 set
+#define laneNegative(a) ((LaneVector)((SignedLaneVector)(a) >> 31))
+
+// Comparisons as sign-bit arithmetic: without AVX, GCC splits that into
+// SSE2 halves but compares one lane at a time
+#define laneEqual(a, b) (~laneNegative(((a) ^ (b)) | -((a) ^ (b))))
+#define laneBelow(a, b) laneNegative((~(a) & (b)) | (~((a) ^ (b)) & ((a) - (b)))) // Unsigned a < b
+
+#define laneSelect(mask, a, b) (((a) & (mask)) | ((b) & ~(mask)))
+
+// Lane mask from bit n of bits for lane n
+LANE_INLINE LaneVector laneMask(uint32_t bits)
+{
+  LaneVector select;
+
+  for (uint32_t i = 0; i < LOCKSTEP_LANES; i++)
+    select[i] = 1u << i;
+
+  return laneEqual(laneBroadcast(bits) & select, select);
+}
+
+// Bit n set for lane n of mask
+#define laneBits(mask) laneMaskBits((const LaneVector[]){mask})
+
+LANE_INLINE uint32_t laneMaskBits(const LaneVector *mask)
+{
+  uint32_t bits = 0;
+
+  for (uint32_t i = 0; i < LOCKSTEP_LANES; i++)
+    bits |= ((*mask)[i] & 1) << i;
+
+  return bits;
+}
+
+// Unsigned minimum over the lanes with their bit set in bits
+LANE_INLINE uint32_t laneMinimum(const uint32_t *lanes, uint32_t bits)
+{
+  uint32_t minimum = 0xFFFFFFFF;
+
+  for (uint32_t i = 0; i < LOCKSTEP_LANES; i++)
+  {
+    if ((bits & (1u << i)) != 0 && lanes[i] < minimum)
+      minimum = lanes[i];
+  }
+
+  return minimum;
+}
+
+// Big-endian word in one lane's memory
+uint32_t loadLane32(const uint8_t *memory, uint32_t address)
+{
+  return ((uint32_t)memory[address] << 24) | ((uint32_t)memory[address + 1] << 16) | ((uint32_t)memory[address + 2] << 8) | memory[address + 3];
+}
+
+void storeLane32(uint8_t *memory, uint32_t address, uint32_t value)
+{
+  memory[address + 0] = (value >> 24) & 0xFF;
+  memory[address + 1] = (value >> 16) & 0xFF;
+  memory[address + 2] = (value >> 8) & 0xFF;
+  memory[address + 3] = value & 0xFF;
+}
+
+/******************************************************
+ * Lockstep engine
+ *
+ * Guests running the same code advance together: every step picks the
+ * lowest PC among the lanes, executes the instruction there once for all
+ * the lanes waiting at it and leaves the others masked off, so lanes that
+ * diverged at a branch re-converge as soon as their PCs meet again. ALU
+ * instructions and branches are vector operations; loads and stores go to
+ * each lane's own memory. Everything else runs through executeInstruction
+ * on that lane's system, and a lane that reaches a device or is left with
+ * a pending interrupt leaves the group for the scalar interpreter.
+ *******************************************************/
+
+uint64_t poxim_run_lockstep(PoximSystem *const systems[], size_t count, uint64_t limit)
+{
+  uint64_t executed = 0;
+  size_t next = 0;
+
+  while (next < count)
+  {
+    System *lanes[LOCKSTEP_LANES];
+    uint64_t before[LOCKSTEP_LANES];
+    uint32_t laneCount = 0;
+
+    // Fill a group; systems the engine cannot run go straight to poxim_run
+    for (; next < count && laneCount < LOCKSTEP_LANES; next++)
+    {
+      startLimits(systems[next]);
+      checkLimits(systems[next]);
+
+      if (isLockstepEligible(systems[next]))
+      {
+        before[laneCount] = systems[next]->timing.instructions;
+        lanes[laneCount++] = systems[next];
+      }
+      else
+        executed += poxim_run(systems[next], limit);
+    }
+
+    if (laneCount == 0)
+      continue;
+
+    LockstepGroup group;
+    void (*step)(LockstepGroup *) = stepLockstep;
+    initLockstepGroup(&group, lanes, laneCount, limit);
+
+#ifdef AVX2_KERNELS
+    if (lanes[0]->options.simd && hasAVX2())
+      step = stepLockstepAVX2;
+#endif
+
+    while (group.active != 0)
+      step(&group);
+
+    for (uint32_t lane = 0; lane < laneCount; lane++)
+    {
+      if (group.split & (1u << lane))
+        poxim_run(lanes[lane], limit != 0 ? group.remaining[lane] : 0);
+      else
+        flushTerminal(lanes[lane]);
+
+      executed += lanes[lane]->timing.instructions - before[lane];
+    }
+  }
+
+  return executed;
+}
+
+// Only the CPU is modelled in the group: no trace, no timing or statistics
+// models and no device activity
+bool isLockstepEligible(System *system)
+{
+  return system->control.run && system->trace.callback == NULL && !system->timing.enabled && !system->pipeline.enabled &&
+         !system->predictor.enabled && !system->profiler.enabled && isLockstepQuiet(system);
+}
+
+// Whether the watchdog, the FPU, the interval timer, pending interrupts and
+// terminal input would do nothing after an instruction
+bool isLockstepQuiet(System *system)
+{
+  return (system->watchdog.registers & 0x80000000) == 0 && system->interrupts.pending == 0 &&
+         (system->fpu.registers.control & 0x1F) == 0 && !system->fpu.timer.enabled && !system->terminal.input.interrupt &&
+         !(system->timer.control & TIMER_CONTROL_EN);
+}
+
+void initLockstepGroup(LockstepGroup *group, System *const systems[], uint32_t count, uint64_t limit)
+{
+  memset(group, 0, sizeof(LockstepGroup));
+
+  group->active = (1u << count) - 1;
+
+  for (uint32_t lane = 0; lane < count; lane++)
+  {
+    group->systems[lane] = systems[lane];
+    group->remaining[lane] = limitSlice(systems[lane], (limit != 0) ? limit : UINT64_MAX);
+
+    for (uint32_t i = 0; i < NUM_REGISTERS; i++)
+      group->registers[i][lane] = systems[lane]->cpu.registers[i];
+
+    flushLockstepLane(group, lane);
+  }
+}
+
+// Adds the instructions run by the vector path to the lane's system. A lane
+// with a time limit is flushed often enough for its clock checks.
+void flushLockstepLane(LockstepGroup *group, uint32_t lane)
+{
+  const uint64_t interval = (group->systems[lane]->limits.deadline != 0) ? LIMIT_CHECK_INTERVAL : LOCKSTEP_FLUSH_INTERVAL;
+
+  group->systems[lane]->timing.instructions += group->pending[lane];
+  group->remaining[lane] -= group->pending[lane];
+  group->pending[lane] = 0;
+
+  group->budget[lane] = (group->remaining[lane] < interval) ? group->remaining[lane] : interval;
+}
+
+// Hands the lane's state back to its system; split lanes keep running in
+// the scalar interpreter
+void retireLockstepLane(LockstepGroup *group, uint32_t lane, bool split)
+{
+  System *system = group->systems[lane];
+
+  for (uint32_t i = 0; i < NUM_REGISTERS; i++)
+    system->cpu.registers[i] = group->registers[i][lane];
+
+  flushLockstepLane(group, lane);
+
+  group->active &= ~(1u << lane);
+
+  if (split)
+    group->split |= 1u << lane;
+}
+
+// One instruction with the full interpreter on the lane's system
+void stepLockstepScalar(LockstepGroup *group, uint32_t lane)
+{
+  System *system = group->systems[lane];
+
+  flushLockstepLane(group, lane);
+
+  for (uint32_t i = 0; i < NUM_REGISTERS; i++)
+    system->cpu.registers[i] = group->registers[i][lane];
+
+  executeInstruction(system);
+
+  for (uint32_t i = 0; i < NUM_REGISTERS; i++)
+    group->registers[i][lane] = system->cpu.registers[i];
+
+  group->remaining[lane]--;
+  flushLockstepLane(group, lane);
+  checkLimits(system);
+
+  if (!system->control.run || group->remaining[lane] == 0)
+    retireLockstepLane(group, lane, false);
+  else if (!isLockstepQuiet(system))
+    retireLockstepLane(group, lane, true);
+}
+
+// Both variants below inline this; only their instruction sets differ
+LANE_INLINE void stepLockstepLanes(LockstepGroup *group)
+{
+  const LaneVector pcs = laneLoad(group->registers[PC]);
+  const uint32_t pc = laneMinimum(group->registers[PC], group->active);
+  uint32_t lanes = laneBits(laneEqual(pcs, laneBroadcast(pc))) & group->active;
+
+  if (pc > MEMORY_SIZE - 4)
+  {
+    for (; lanes != 0; lanes &= lanes - 1)
+      retireLockstepLane(group, __builtin_ctz(lanes), true);
+
+    return;
+  }
+
+  // Fetch once; a lane holding different code at this PC leaves the group
+  const uint8_t *leader = group->systems[__builtin_ctz(lanes)]->memory + pc;
+  const uint32_t ir = loadLane32(leader, 0);
+
+  for (uint32_t others = lanes & (lanes - 1); others != 0; others &= others - 1)
+  {
+    const uint32_t lane = __builtin_ctz(others);
+
+    if (memcmp(group->systems[lane]->memory + pc, leader, 4) != 0)
+    {
+      retireLockstepLane(group, lane, true);
+      lanes &= ~(1u << lane);
+    }
+  }
+
+  const uint8_t opcode = (ir >> 26) & 0x3F;
+  const uint8_t z = (ir >> 21) & 0x1F;
+  const uint8_t x = (ir >> 16) & 0x1F;
+  const uint8_t y = (ir >> 11) & 0x1F;
+
+  // A write to PC is followed by the usual PC += 4, which only the scalar
+  // path models
+  if (z == PC && opcode <= 0b011010)
+  {
+    for (; lanes != 0; lanes &= lanes - 1)
+      stepLockstepScalar(group, __builtin_ctz(lanes));
+
+    return;
+  }
+
+  LaneVector mask = laneMask(lanes);
+  laneStore(group->registers[IR], laneBroadcast(ir), mask);
+
+  const LaneVector valueX = laneLoad(group->registers[x]);
+  const LaneVector valueY = laneLoad(group->registers[y]);
+  const LaneVector sr = laneLoad(group->registers[SR]);
+  const LaneVector all = laneBroadcast(0xFFFFFFFF);
+  const LaneVector none = laneBroadcast(0);
+
+  // Results of the ALU cases; flags lists the SR bits they recompute
+  LaneVector result = none, zero = none, carry = none, overflow = none;
+  uint32_t flags = 0;
+  bool write = false;
+  bool advanced = false; // Set when a case already wrote each lane's PC
+  LaneVector nextPC = laneBroadcast(pc + 4);
+
+  switch (opcode)
+  {
+  case 0b000000: // mov
+    result = laneBroadcast(ir & 0x1FFFFF);
+    write = true;
+    break;
+  case 0b000001: // movs
+    result = laneBroadcast((uint32_t)extendSign32(ir & 0x1FFFFF, 21));
+    write = true;
+    break;
+  case 0b000010: // add
+    result = laneAdd(valueX, valueY);
+    carry = laneBelow(result, valueX);
+    overflow = laneAndNot(laneXor(valueX, valueY), laneXor(valueX, result));
+    flags = ZN_FLAG | SN_FLAG | OV_FLAG | CY_FLAG;
+    write = true;
+    break;
+  case 0b000011: // sub
+  case 0b000101: // cmp, which also writes rz
+    result = laneSub(valueX, valueY);
+    carry = laneBelow(valueX, valueY);
+    overflow = laneAnd(laneXor(valueX, valueY), laneXor(valueX, result));
+    flags = ZN_FLAG | SN_FLAG | OV_FLAG | CY_FLAG;
+    write = true;
+    break;
+  case 0b000110: // and
+    result = laneAnd(valueX, valueY);
+    flags = ZN_FLAG | SN_FLAG;
+    write = true;
+    break;
+  case 0b000111: // or
+    result = laneOr(valueX, valueY);
+    flags = ZN_FLAG | SN_FLAG;
+    write = true;
+    break;
+  case 0b001000: // not
+    result = laneXor(valueX, all);
+    flags = ZN_FLAG | SN_FLAG;
+    write = true;
+    break;
+  case 0b001001: // xor, which sets ZN on zero but never clears it
+    result = laneXor(valueX, valueY);
+    flags = SN_FLAG;
+    write = true;
+    break;
+  case 0b010010: // addi
+  case 0b010011: // subi
+  case 0b010111: // cmpi
+  {
+    // The immediate is sign-extended to 64 bits before the operation, so a
+    // negative one turns the carry of an addition into a borrow and back
+    const int32_t i = extendSign32(ir & 0xFFFF, 16);
+    const LaneVector immediate = laneBroadcast((uint32_t)i);
+
+    if (opcode == 0b010010)
+    {
+      result = laneAdd(valueX, immediate);
+      carry = (i >= 0) ? laneBelow(result, valueX) : laneBelow(valueX, result);
+      overflow = laneAndNot(laneXor(valueX, immediate), laneXor(valueX, result));
+    }
+    else
+    {
+      result = laneSub(valueX, immediate);
+      carry = (i >= 0) ? laneBelow(valueX, immediate) : laneBelow(result, valueX);
+      overflow = laneAnd(laneXor(valueX, immediate), laneXor(valueX, result));
+    }
+
+    flags = ZN_FLAG | SN_FLAG | OV_FLAG | CY_FLAG;
+    write = opcode != 0b010111;
+    break;
+  }
+
+  case 0b011000: // l8
+  case 0b011001: // l16
+  case 0b011010: // l32
+  case 0b011011: // s8
+  case 0b011100: // s16
+  case 0b011101: // s32
+  {
+    const uint16_t i = ir & 0xFFFF;
+    const bool load = opcode <= 0b011010;
+    const uint8_t scale = (opcode - 0b011000) % 3; // Address shift: bytes, halfwords, words
+
+    for (uint32_t pending = lanes; pending != 0; pending &= pending - 1)
+    {
+      const uint32_t lane = __builtin_ctz(pending);
+      System *system = group->systems[lane];
+      const uint32_t memoryAddress = (x != 0) ? ((group->registers[x][lane] + i) << scale) : (uint32_t)i << scale;
+      uint32_t *target = &group->registers[z][lane];
+
+      if (load && z == 0)
+        ; // Loads into r0 are dropped before the address is decoded
+      else if (memoryAddress >= MEMORY_SIZE)
+      {
+        // Terminal, FPU and counters live in the scalar interpreter; a lane
+        // that starts a device leaves the group there
+        stepLockstepScalar(group, lane);
+        lanes &= ~(1u << lane);
+        continue;
+      }
+      else if (opcode == 0b011000)
+        *target = system->memory[memoryAddress];
+      else if (opcode == 0b011001) // Upper halfword, as l16 does
+        *target = ((uint32_t)system->memory[memoryAddress] << 24) | ((uint32_t)system->memory[memoryAddress + 1] << 16);
+      else if (opcode == 0b011010)
+        *target = loadLane32(system->memory, memoryAddress);
+      else if (opcode == 0b011011)
+        system->memory[memoryAddress] = *target & 0xFF;
+      else if (opcode == 0b011100)
+      {
+        system->memory[memoryAddress] = (*target >> 24) & 0xFF;
+        system->memory[memoryAddress + 1] = (*target >> 16) & 0xFF;
+      }
+      else
+        storeLane32(system->memory, memoryAddress, *target);
+
+      if (load)
+        system->counters.loads++;
+      else
+        system->counters.stores++;
+    }
+
+    mask = laneMask(lanes);
+    break;
+  }
+
+  case 0b000100: // mul, sll, muls, sla, srl, sra; div and divs may interrupt
+  case 0b010100: // muli
+  case 0b100001: // cbr, sbr
+  {
+    const InstructionHandler *handler = decodeInstructionHandler(ir);
+
+    if (handler->cpuHandler == NULL)
+    {
+      for (; lanes != 0; lanes &= lanes - 1)
+        stepLockstepScalar(group, __builtin_ctz(lanes));
+
+      return;
+    }
+
+    // Register-only handlers run on a copy of the lane's registers
+    for (uint32_t pending = lanes; pending != 0; pending &= pending - 1)
+    {
+      const uint32_t lane = __builtin_ctz(pending);
+      CPU cpu;
+
+      for (uint32_t i = 0; i < NUM_REGISTERS; i++)
+        cpu.registers[i] = group->registers[i][lane];
+
+      handler->cpuHandler(&cpu, NULL);
+      cpu.registers[PC] += 4;
+
+      for (uint32_t i = 0; i < NUM_REGISTERS; i++)
+        group->registers[i][lane] = cpu.registers[i];
+    }
+
+    advanced = true;
+    break;
+  }
+
+  case 0b011110: // callf
+  case 0b111001: // calls
+  case 0b011111: // ret
+  case 0b001010: // push
+  case 0b001011: // pop
+  {
+    const uint32_t operands[] = {(ir >> 6) & 0x1F, ir & 0x1F, x, y, z};
+    uint32_t count = 0;
+
+    if (opcode == 0b001010 || opcode == 0b001011)
+    {
+      while (count < 5 && operands[count] != 0)
+        count++;
+
+      // Popping SP or PC changes the walk itself; leave those to the scalar path
+      for (uint32_t i = 0; i < count; i++)
+      {
+        if (operands[i] == SP || operands[i] == PC)
+        {
+          for (; lanes != 0; lanes &= lanes - 1)
+            stepLockstepScalar(group, __builtin_ctz(lanes));
+
+          return;
+        }
+      }
+    }
+
+    for (uint32_t pending = lanes; pending != 0; pending &= pending - 1)
+    {
+      const uint32_t lane = __builtin_ctz(pending);
+      System *system = group->systems[lane];
+      uint32_t sp = group->registers[SP][lane];
+
+      // Lowest and highest stack word touched must be in memory
+      int64_t low = sp, high = sp;
+
+      if (opcode == 0b001010)
+        low = (int64_t)sp - 4 * (int64_t)count + 4;
+      else if (opcode == 0b001011 || opcode == 0b011111)
+      {
+        low = (int64_t)sp + 4;
+        high = (int64_t)sp + 4 * (int64_t)(opcode == 0b001011 ? count : 1);
+      }
+
+      if (low < 0 || high > MEMORY_SIZE - 4)
+      {
+        retireLockstepLane(group, lane, true);
+        lanes &= ~(1u << lane);
+        continue;
+      }
+
+      switch (opcode)
+      {
+      case 0b011110: // callf
+      case 0b111001: // calls
+        storeLane32(system->memory, sp, pc + 4);
+        group->registers[PC][lane] = (opcode == 0b011110) ? (group->registers[x][lane] + extendSign32(ir & 0xFFFF, 16)) << 2
+                                                          : pc + 4 + ((uint32_t)extendSign32(ir & 0x03FFFFFF, 26) << 2);
+        group->registers[SP][lane] = sp - 4;
+        break;
+      case 0b011111: // ret
+        group->registers[SP][lane] = sp + 4;
+        group->registers[PC][lane] = loadLane32(system->memory, sp + 4);
+        break;
+      case 0b001010: // push
+        for (uint32_t i = 0; i < count; i++, sp -= 4)
+          storeLane32(system->memory, sp, group->registers[operands[i]][lane]);
+
+        group->registers[SP][lane] = sp;
+        group->registers[PC][lane] = pc + 4;
+        system->counters.stores++;
+        break;
+      case 0b001011: // pop
+        for (uint32_t i = 0; i < count; i++)
+        {
+          sp += 4;
+          group->registers[operands[i]][lane] = loadLane32(system->memory, sp);
+        }
+
+        group->registers[SP][lane] = sp;
+        group->registers[PC][lane] = pc + 4;
+        system->counters.loads++;
+        break;
+      }
+    }
+
+    mask = laneMask(lanes);
+    advanced = true;
+    break;
+  }
+
+  default:
+    if (opcode >= 0b101010 && opcode <= 0b111000) // Conditional branches and bun
+    {
+      const LaneVector zn = laneEqual(laneAnd(sr, laneBroadcast(ZN_FLAG)), laneBroadcast(ZN_FLAG));
+      const LaneVector zd = laneEqual(laneAnd(sr, laneBroadcast(ZD_FLAG)), laneBroadcast(ZD_FLAG));
+      const LaneVector cy = laneEqual(laneAnd(sr, laneBroadcast(CY_FLAG)), laneBroadcast(CY_FLAG));
+      const LaneVector iv = laneEqual(laneAnd(sr, laneBroadcast(IV_FLAG)), laneBroadcast(IV_FLAG));
+      const LaneVector less = laneXor(laneEqual(laneAnd(sr, laneBroadcast(SN_FLAG)), laneBroadcast(SN_FLAG)),
+                                      laneEqual(laneAnd(sr, laneBroadcast(OV_FLAG)), laneBroadcast(OV_FLAG)));
+      LaneVector taken = all;
+
+      switch (opcode)
+      {
+      case 0b101010: // bae
+        taken = laneXor(cy, all);
+        break;
+      case 0b101011: // bat
+        taken = laneAndNot(laneOr(zn, cy), all);
+        break;
+      case 0b101100: // bbe
+        taken = laneOr(zn, cy);
+        break;
+      case 0b101101: // bbt
+        taken = cy;
+        break;
+      case 0b101110: // beq
+        taken = zn;
+        break;
+      case 0b101111: // bge
+        taken = laneXor(less, all);
+        break;
+      case 0b110000: // bgt
+        taken = laneAndNot(laneOr(zn, less), all);
+        break;
+      case 0b110001: // biv
+        taken = iv;
+        break;
+      case 0b110010: // ble
+        taken = laneOr(zn, less);
+        break;
+      case 0b110011: // blt
+        taken = less;
+        break;
+      case 0b110100: // bne
+        taken = laneXor(zn, all);
+        break;
+      case 0b110101: // bni
+        taken = laneXor(iv, all);
+        break;
+      case 0b110110: // bnz
+        taken = laneXor(zd, all);
+        break;
+      case 0b111000: // bzd
+        taken = zd;
+        break;
+      }
+
+      const uint32_t target = pc + 4 + ((uint32_t)extendSign32(ir & 0x03FFFFFF, 26) << 2);
+      nextPC = laneSelect(taken, laneBroadcast(target), nextPC);
+
+      for (uint32_t branches = laneBits(taken) & lanes; branches != 0; branches &= branches - 1)
+        group->systems[__builtin_ctz(branches)]->counters.takenBranches++;
+
+      break;
+    }
+
+    // Calls, stack, multiply/divide, byte and halfword memory, interrupts
+    for (; lanes != 0; lanes &= lanes - 1)
+      stepLockstepScalar(group, __builtin_ctz(lanes));
+
+    return;
+  }
+
+  if (write && z != 0)
+    laneStore(group->registers[z], result, mask);
+
+  if (flags != 0)
+  {
+    LaneVector set = laneAnd(laneNegative(result), laneBroadcast(SN_FLAG));
+
+    if (opcode == 0b010010) // addi tests rz after the write, so r0 always reads zero
+      zero = laneEqual(laneLoad(group->registers[z]), none);
+    else
+      zero = laneAndNot(carry, laneEqual(result, none));
+
+    set = laneOr(set, laneAnd(zero, laneBroadcast(ZN_FLAG)));
+    set = laneOr(set, laneAnd(laneNegative(overflow), laneBroadcast(OV_FLAG)));
+    set = laneOr(set, laneAnd(carry, laneBroadcast(CY_FLAG)));
+
+    // Read SR again in case rz was SR
+    laneStore(group->registers[SR], laneOr(laneAnd(laneLoad(group->registers[SR]), laneBroadcast(~flags)), set), mask);
+  }
+
+  if (!advanced)
+    laneStore(group->registers[PC], nextPC, mask);
+
+  // Retire lanes that reached their budget
+  const LaneVector pending = laneSub(laneLoad(group->pending), mask);
+  laneStore(group->pending, pending, all);
+
+  for (uint32_t full = laneBits(laneEqual(pending, laneLoad(group->budget))) & lanes; full != 0; full &= full - 1)
+  {
+    const uint32_t lane = __builtin_ctz(full);
+
+    flushLockstepLane(group, lane);
+    checkLimits(group->systems[lane]);
+
+    if (group->remaining[lane] == 0 || !group->systems[lane]->control.run)
+      retireLockstepLane(group, lane, false);
+  }
+}
+
+void stepLockstep(LockstepGroup *group)
+{
+  stepLockstepLanes(group);
+}
+
+#ifdef AVX2_KERNELS
+
+__attribute__((target("avx2"))) void stepLockstepAVX2(LockstepGroup *group)
+{
+  stepLockstepLanes(group);
+}
+
+#endif
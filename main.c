@@ -2,64 +2,52 @@
  * Libraries
  *******************************************************/
 
+#define _GNU_SOURCE // fopencookie
+
 #include <stdint.h>
+#include <inttypes.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdbool.h>
 #include <ctype.h>
-#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <signal.h>
+#include <errno.h>
+
+#include "poxim.h"
 
 /******************************************************
  * Utility Constants
  *******************************************************/
 
-#define NUM_REGISTERS 32
-
-// Specific use register indexes
-#define CR 26  // Case interruption
-#define IPC 27 // Interrupt address
-#define IR 28  // Instruction Register
-#define PC 29  // Program Counter
-#define SP 30  // Stack Pointer
-#define SR 31  // Status Register
-
-// Flags in Status Register
-#define ZN_FLAG 0b01000000
-#define ZD_FLAG 0b00100000
-#define SN_FLAG 0b00010000
-#define OV_FLAG 0b00001000
-#define IV_FLAG 0b00000100
-#define IE_FLAG 0b00000010
-#define CY_FLAG 0b00000001
-
-// Interrupt addresses
-#define INIT_INTERRUPT_ADDR 0x00000000
-#define DIVIDE_BY_ZERO_ADDR 0x00000008
-#define INVALID_INSTRUCTION_ADDR 0x00000004
-#define SOFTWARE_INTERRUPT_ADDR 0x0000000C
-#define HARDWARE1_INTERRUPT_ADDR 0x00000010
-#define HARDWARE2_INTERRUPT_ADDR 0x00000014
-#define HARDWARE3_INTERRUPT_ADDR 0x00000018
-#define HARDWARE4_INTERRUPT_ADDR 0x0000001C
-#define WATCHDOG_ADDR 0x80808080
-
-// Interrupt codes
-#define HARDWARE1_INTERRUPT_CODE 0xE1AC04DA
-#define FPU_INTERRUPT_CODE 0x01EEE754
-
-// FPU
-#define FPU_REGISTER_X_ADDR 0x80808880
-#define FPU_REGISTER_Y_ADDR 0x80808884
-#define FPU_REGISTER_Z_ADDR 0x80808888
-#define FPU_REGISTER_CONTROL_ADDR 0x8080888C
-#define FPU_REGISTER_CONTROL_ADDR_OTHER 0x8080888F
-
-#define FPU_CONTROL_ST_MASK 0x00000020
-
-// Terminal
-#define TERMINAL_OUT_ADDRESS 0x8888888B
-#define TERMINAL_IN_ADDRESS 0x8888888A
+// Each resident system holds its guest memory and, when tracing, an open
+// output file, so this also bounds file descriptors per worker
+#define DEFAULT_RESIDENT_SYSTEMS 256
+
+// Upper bound on --jobs, one thread each
+#define MAX_WORKERS 1024
+
+// Exit status of a run stopped by --max-instructions, --max-trace-bytes or
+// --max-seconds; the server sends it to poxim-client in the reply trailer
+#define LIMIT_EXIT_STATUS 2
+
+// Exit status of a guest that fetched code or used its stack outside memory
+#define FAULT_EXIT_STATUS 3
+
+// Server mode; the request format is described at serveJob
+#define SERVER_HEADER_SIZE 128
+#define SERVER_BACKLOG 64
+#define SERVER_RUN_QUANTUM (1 << 20) // Instructions between checks for a client that went away
+#define SERVER_MAX_PROGRAM_SIZE (1 << 20) // Far more text than 32 KiB of memory takes
+#define SERVER_DEFAULT_MAX_SECONDS 60.0 // For jobs neither the request nor the server options limit
 
 /******************************************************
  * Types
@@ -67,3039 +55,1123 @@
 
 typedef struct
 {
-  float f;
-  uint32_t u;
-} FPUOperand;
-
-typedef struct
-{
-  uint32_t registers[NUM_REGISTERS];
-} CPU;
+  char *input;
+  char *output;
+  PoximImage *image; // Shared by every job with the same input, NULL if unreadable
+} BatchJob;
 
+// Jobs owned by one worker: the owner pops from the back, thieves take
+// from the front
 typedef struct
 {
-  bool hasInterrupt;
-  uint32_t code;
-} FPUInterrupt;
+  pthread_mutex_t lock;
+  size_t *jobs;
+  size_t front;
+  size_t back;
+} WorkQueue;
 
 typedef struct
 {
-  uint32_t counter;
-  bool enabled;
-  FPUInterrupt interrupt;
-} FPUTimer;
+  BatchJob *jobs;
+  size_t jobCount;
+  PoximImage **images; // One per distinct input
+  size_t imageCount;
+  WorkQueue *queues;
+  uint32_t workerCount;
 
-typedef struct
-{
-  FPUOperand x;
-  FPUOperand y;
-  FPUOperand z;
-  uint32_t control;
-} FPURegister;
-
-typedef struct
-{
-  FPURegister registers;
-  FPUTimer timer;
-  bool previousControlStatus;
-} FPU;
+  bool trace;
+  int optionCount;
+  const char **options;
 
-typedef struct
-{
-  int32_t registers;
-} Watchdog;
+  uint64_t quantum;  // Instructions per turn in interleaved mode, 0 for off
+  uint32_t resident; // Systems kept resident per worker in interleaved mode
+  bool lockstep;     // Run jobs POXIM_LOCKSTEP_LANES at a time in lockstep
+} Batch;
 
+// A job occupying one resident system of an interleaved worker
 typedef struct
 {
-  bool hasInterrupt;
-} Interrupt;
+  PoximSystem *system;
+  size_t job;
+  FILE *output; // NULL when the slot is free
+} ResidentJob;
 
+// Destination of --terminal-stream
 typedef struct
 {
-  bool run;
-  bool pcAlreadyIncremented;
-  Interrupt interrupt;
-  uint32_t oldPC;
-} Control;
+  FILE *file;
+  char last; // Last character written, 0 before the first
+} TerminalOutput;
 
 typedef struct
 {
-  char *data;
-  size_t size;
-  size_t capacity;
-} TerminalBuffer;
+  int socket; // Listening socket, accepted on by every worker
+  int optionCount;
+  const char **options;
+} Server;
 
 typedef struct
 {
-  uint32_t registers;
-  TerminalBuffer buffer;
-} Terminal;
-
-typedef struct TSystem
-{
-  CPU cpu;
-  FPU fpu;
-  Watchdog watchdog;
-  uint8_t *memory;
-  Terminal terminal;
-
-  Control control;
-} System;
+  Batch *batch;
+  uint32_t index;
+  pthread_t thread;
+  uint64_t instructions;
+  uint32_t failures;
+  uint32_t limited; // Jobs stopped by a limit
+  uint32_t faulted; // Jobs stopped by a memory fault
+} BatchWorker;
 
 /******************************************************
  * Functin Signature
  *******************************************************/
-void initializeSystem(System *system, FILE *input, FILE *output);
-void loadMemoryFromFile(System *system, FILE *input); // Load memory vector from a file
-void decodeInstructions(System *system, FILE *output);
-
-void initTerminalBuffer(TerminalBuffer *buffer, size_t initialCapacity);
-void addToBuffer(TerminalBuffer *buffer, char character);
-void freeBuffer(TerminalBuffer *buffer);
-void printTerminal(TerminalBuffer *buffer, FILE *output);
-
-void updateWatchdog(System *system, FILE *output);
-
-void executeFPU(System *system, FILE *output);
-void addFPU(FPU *fpu);
-void subtractFPU(FPU *fpu);
-void multiplyFPU(FPU *fpu);
-void divideFPU(FPU *fpu);
-void assignXFromZFPU(FPU *fpu);
-void assignYFromZFPU(FPU *fpu);
-void ceilingZFPU(FPU *fpu);
-void floorZFPU(FPU *fpu);
-void roundZFPU(FPU *fpu);
-bool getFPUControlSTField(FPU *fpu);
-void setFPUControlSTField(FPU *fpu, bool enable);
-void resetFPUControlOPCodeField(FPU *fpu);
-void handleFPUErrors(System *system, FILE *output);
-void setFPUTimerVariableCycle(System *system);
-void decrementFPUTimer(FPUTimer *timer);
-uint32_t convertToIEEE754(float *x);
-uint32_t calculateExponentDifference(uint32_t x, uint32_t y);
-
-void mov(CPU *cpu, FILE *output);
-void movs(CPU *cpu, FILE *output);
-void add(CPU *cpu, FILE *output);
-void sub(CPU *cpu, FILE *output);
-void mul(CPU *cpu, FILE *output);
-void sll(CPU *cpu, FILE *output);
-void muls(CPU *cpu, FILE *output);
-void sla(CPU *cpu, FILE *output);
-void divv(System *system, FILE *output);
-void srl(CPU *cpu, FILE *output);
-void divs(System *system, FILE *output);
-void sra(CPU *cpu, FILE *output);
-void cmp(CPU *cpu, FILE *output);
-void and (CPU * cpu, FILE *output);
-void or (CPU * cpu, FILE *output);
-void not(CPU * cpu, FILE *output);
-void xor (CPU * cpu, FILE *output);
-void addi(CPU *cpu, FILE *output);
-void subi(CPU *cpu, FILE *output);
-void muli(CPU *cpu, FILE *output);
-void divi(System *system, FILE *output);
-void modi(System *system, FILE *output);
-void cmpi(CPU *cpu, FILE *output);
-
-void bae(System *system, FILE *output);
-void bat(System *system, FILE *output);
-void bbe(System *system, FILE *output);
-void bbt(System *system, FILE *output);
-void beq(System *system, FILE *output);
-void bge(System *system, FILE *output);
-void bgt(System *system, FILE *output);
-void biv(System *system, FILE *output);
-void ble(System *system, FILE *output);
-void blt(System *system, FILE *output);
-void bne(System *system, FILE *output);
-void bni(System *system, FILE *output);
-void bnz(System *system, FILE *output);
-void bzd(System *system, FILE *output);
-void bun(System *system, FILE *output);
-
-void l8(System *system, FILE *output);
-void l16(System *system, FILE *output);
-void l32(System *system, FILE *output);
-void s8(System *system, FILE *output);
-void s16(System *system, FILE *output);
-void s32(System *system, FILE *output);
-
-void callf(System *system, FILE *output);
-void calls(System *system, FILE *output);
-void ret(System *system, FILE *output);
-void push(System *system, FILE *output);
-void pop(System *system, FILE *output);
-
-void reti(System *system, FILE *output);
-void cbr(CPU *cpu, FILE *output);
-void sbr(CPU *cpu, FILE *output);
-void interrupt(System *system, FILE *output);
-
-void unknownInstruction(System *system, FILE *output);
-
-void handleDivideByZero(System *system, FILE *output);
-void handleInvalidInstruction(System *system, FILE *output);
-void handleInterrupt(System *system, FILE *output);
-void handlePrepareForISR(System *system);
-
-int isZNSet(CPU *cpu);
-int isZDSet(CPU *cpu);
-int isSNSet(CPU *cpu);
-int isOVSet(CPU *cpu);
-int isIVSet(CPU *cpu);
-int isIESet(CPU *cpu);
-int isCYSet(CPU *cpu);
-
-int32_t extendSign32(uint32_t value, uint8_t significantBit);
-int64_t extendSign64(uint32_t value, uint8_t significantBit);
-
-char *formatRegisterName(uint8_t registerNumber, bool lower);
-
-void printInstruction(uint32_t pc, FILE *output, char *instruction, char *additionalInfo);
-void printInterruptMessage(uint32_t code, FILE *output);
-
-uint32_t readMemory32(System *system, uint32_t memoryAddress);
+bool parseCount(const char *text, uint64_t minimum, uint64_t maximum, uint64_t *value);
+char *readFile(FILE *input, size_t *length);
+bool isAssembly(const char *path);
+void writeTraceLine(void *context, const char *line);
+void writeFileTraceLine(void *context, const char *line);
+void writeTerminalStream(void *context, const char *data, size_t length);
+size_t readTerminalFile(void *context, char *data, size_t capacity);
+bool runProgram(PoximSystem *system, const char *inputPath, const char *outputPath, bool trace, bool screen, TerminalOutput *terminal,
+                int terminalInput);
+FILE *startProgram(PoximSystem *system, const char *inputPath, PoximImage *image, const char *outputPath, bool trace, bool screen);
+bool loadProgram(PoximSystem *system, const char *inputPath);
+void beginProgram(PoximSystem *system, FILE *output, bool trace, bool screen);
+PoximStatus finishProgram(PoximSystem *system, FILE *output, bool screen);
+int exitStatus(PoximStatus status);
+void printStats(uint64_t instructions, double seconds, FILE *output);
+
+bool readManifest(const char *path, Batch *batch);
+PoximImage *readImage(const char *path);
+int compareJobInputs(const void *a, const void *b);
+void createBatchImages(Batch *batch);
+bool takeJob(Batch *batch, uint32_t worker, size_t *job);
+void countJob(BatchWorker *worker, PoximStatus status);
+void *runBatchWorker(void *argument);
+bool startResidentJob(Batch *batch, BatchWorker *worker, ResidentJob *slot);
+void *runInterleavedWorker(void *argument);
+void *runLockstepWorker(void *argument);
+int runBatch(Batch *batch, bool stats);
+
+int runServer(const char *path, uint32_t workerCount, int optionCount, const char **options);
+void *runServerWorker(void *argument);
+void serveJob(PoximSystem *system, int client);
+bool clientHungUp(int client);
+ssize_t writeReplyChunk(void *cookie, const char *data, size_t size);
+bool writeAll(int file, const char *data, size_t size);
 
 int main(int argc, char *argv[])
 {
-  // Input file
-  FILE *input = fopen(argv[1], "r");
-  if (input == NULL)
-    exit(EXIT_FAILURE);
-
-  // Output file
-  FILE *output = fopen(argv[2], "w");
-  if (output == NULL)
+  const char *usage = "Usage: %s <input> <output> [--terminal-stream[=<file>]] [--terminal-input=<file>] [options]\n"
+                      "       %s --batch=<manifest> [--jobs=<n>] [--quantum=<n> [--resident=<n>] | --lockstep] [options]\n"
+                      "       %s --serve=<socket> [--jobs=<n>] [options]\n"
+                      "       %s --translate=<file.c> <input> [options]\n"
+                      "Options: [--profile=<file>] [--profile-folded=<file>] [--profile-callgrind=<file>] [--timing[=<class>=<cycles>,...]] [--timer-clock=cycles|instructions] [--pipeline[=<file>]] [--pipeline-forwarding=on|off] [--predictor=btfn|bimodal|gshare[:<bits>]] [--predictor-penalty=<cycles>] [--predictor-report=<file>] [--max-instructions=<n>] [--max-trace-bytes=<n>] [--max-seconds=<s>] [--idle-loops=off|skip|collapse] [--simd=on|off] [--disk=<file>] [--disk-read-only] [--symbol-map=<file>] [--no-trace] [--stats]\n";
+
+  const char *manifest = NULL;
+  const char *socketPath = NULL;
+  const int first = (argc >= 2 && (strncmp(argv[1], "--batch=", 8) == 0 || strncmp(argv[1], "--serve=", 8) == 0)) ? 2 : 3;
+
+  if (first == 2 && argv[1][2] == 'b')
+    manifest = argv[1] + 8;
+  else if (first == 2)
+    socketPath = argv[1] + 8;
+  else if (argc < 3)
+  {
+    fprintf(stderr, usage, argv[0], argv[0], argv[0], argv[0]);
     exit(EXIT_FAILURE);
+  }
 
-  System system;
-  initializeSystem(&system, input, output);
-
-  return 0;
-}
-
-/******************************************************
- * Utility Functions
- *******************************************************/
-
-void initializeSystem(System *system, FILE *input, FILE *output)
-{
-  // 32 registers initialized to zero
-  memset(system->cpu.registers, 0, sizeof(system->cpu.registers));
-
-  // watchdog
-  system->watchdog.registers = 0;
-
-  // Reset FPU registers
-  system->fpu.registers.control = 0;
-  system->fpu.registers.x.f = 0;
-  system->fpu.registers.x.u = 0;
-
-  system->fpu.registers.y.f = 0;
-  system->fpu.registers.y.u = 0;
-
-  system->fpu.registers.z.f = 0;
-  system->fpu.registers.z.u = 0;
-
-  // Reset FPU controller
-  system->fpu.previousControlStatus = false;
-
-  // Reset TERMINAL
-  system->terminal.registers = 0;
-  initTerminalBuffer(&system->terminal.buffer, 1024);
-
-  // Reset FPU timer
-  system->fpu.timer.counter = 0;
-  system->fpu.timer.enabled = false;
-  system->fpu.timer.interrupt.code = 0;
-  system->fpu.timer.interrupt.hasInterrupt = false;
-
-  // 32 KiB memory initialized to zero
-  system->memory = (uint8_t *)(calloc(32 * 1024, sizeof(uint8_t)));
-
-  loadMemoryFromFile(system, input);
-
-  // Initialized control variables
-  system->control.run = true;
-  system->control.pcAlreadyIncremented = false;
-  system->control.interrupt.hasInterrupt = false;
-
-  decodeInstructions(system, output);
-
-  // Terminal
-  printTerminal(&system->terminal.buffer, output);
-
-  fclose(input);
-  fclose(output);
-  free(system->memory);
-  freeBuffer(&system->terminal.buffer);
-}
-
-void loadMemoryFromFile(System *system, FILE *input)
-{
-  fseek(input, 0, SEEK_SET);
-
-  unsigned int count = 0;
-  char hexString[32];
-
-  while (fgets(hexString, sizeof(char) * 32, input) != NULL)
+  // Writes the program as C for the host compiler instead of running it
+  const char *translation = (first == 3 && strncmp(argv[1], "--translate=", 12) == 0) ? argv[1] + 12 : NULL;
+
+  // Front end options; everything else configures the simulator
+  bool trace = true;
+  bool stats = false;
+  const long processors = sysconf(_SC_NPROCESSORS_ONLN);
+  uint64_t jobs = processors > 0 ? processors : 1;
+  uint64_t quantum = 0;
+  uint64_t resident = DEFAULT_RESIDENT_SYSTEMS;
+  bool valid = true;
+  bool lockstep = false;
+  const char *terminalStream = NULL;
+  const char *terminalInput = NULL;
+
+  const char **options = (const char **)malloc(argc * sizeof(char *));
+  int optionCount = 0;
+
+  for (int i = first; i < argc; i++)
   {
-    const uint32_t hexCode = strtoul(hexString, NULL, 16);
-
-    system->memory[count] = (hexCode & 0xFF000000) >> 24;
-    system->memory[count + 1] = (hexCode & 0x00FF0000) >> 16;
-    system->memory[count + 2] = (hexCode & 0x0000FF00) >> 8;
-    system->memory[count + 3] = (hexCode & 0x000000FF);
-
-    count += 4;
+    if (strcmp(argv[i], "--no-trace") == 0)
+      trace = false;
+    else if (strcmp(argv[i], "--stats") == 0)
+      stats = true;
+    else if ((manifest != NULL || socketPath != NULL) && strncmp(argv[i], "--jobs=", 7) == 0)
+      valid = parseCount(argv[i] + 7, 1, MAX_WORKERS, &jobs) && valid;
+    else if (manifest != NULL && strncmp(argv[i], "--quantum=", 10) == 0)
+      valid = parseCount(argv[i] + 10, 1, UINT64_MAX, &quantum) && valid;
+    else if (manifest != NULL && strncmp(argv[i], "--resident=", 11) == 0)
+      valid = parseCount(argv[i] + 11, 1, UINT32_MAX, &resident) && valid;
+    else if (manifest != NULL && strcmp(argv[i], "--lockstep") == 0)
+      lockstep = true;
+    else if (first == 3 && strcmp(argv[i], "--terminal-stream") == 0)
+      terminalStream = "-";
+    else if (first == 3 && strncmp(argv[i], "--terminal-stream=", 18) == 0)
+      terminalStream = argv[i] + 18;
+    else if (first == 3 && strncmp(argv[i], "--terminal-input=", 17) == 0)
+      terminalInput = argv[i] + 17;
+    else
+      options[optionCount++] = argv[i];
   }
-}
-
-void decodeInstructions(System *system, FILE *output)
-{
-  // Output formatting to file
-  fprintf(output, "[START OF SIMULATION]\n");
 
-  printf("[START OF SIMULATION]\n");
-
-  while (system->control.run)
+  if (!valid)
   {
-
-    const uint32_t ir = readMemory32(system, system->cpu.registers[PC]);
-    system->control.oldPC = system->cpu.registers[PC];
-
-    system->cpu.registers[IR] = ir;
-
-    const uint8_t opcode = (ir >> 26) & 0x3F;
-    if (ir != 0) // If it is not idle instruction
-    {
-      switch (opcode)
-      {
-      case 0b000000: // mov
-        mov(&system->cpu, output);
-        break;
-      case 0b000001: // movs
-        movs(&system->cpu, output);
-        break;
-      case 0b000010: // add
-        add(&system->cpu, output);
-        break;
-      case 0b000011: // sub
-        sub(&system->cpu, output);
-        break;
-      case 0b000100: // mul, sll, muls, sla, div, srl, divs, sra
-        uint8_t subOpcode = (ir >> 8) & 0x7;
-
-        switch (subOpcode)
-        {
-        case 0b000: // mul
-          mul(&system->cpu, output);
-          break;
-        case 0b001: // sll
-          sll(&system->cpu, output);
-          break;
-        case 0b010: // muls
-          muls(&system->cpu, output);
-          break;
-        case 0b011: // sla
-          sla(&system->cpu, output);
-          break;
-        case 0b100: // div
-          divv(system, output);
-          break;
-        case 0b101: // srl
-          srl(&system->cpu, output);
-          break;
-        case 0b110: // divs
-          divs(system, output);
-          break;
-        case 0b111: // sra
-          sra(&system->cpu, output);
-          break;
-        }
-
-        break;
-      case 0b000101: // cmp
-        cmp(&system->cpu, output);
-        break;
-      case 0b000110: // and
-        and(&system->cpu, output);
-        break;
-      case 0b000111: // or
-        or (&system->cpu, output);
-        break;
-      case 0b001000: // not
-        not(&system->cpu, output);
-        break;
-      case 0b001001: // xor
-        xor(&system->cpu, output);
-        break;
-      case 0b010010: // addi
-        addi(&system->cpu, output);
-        break;
-      case 0b010011: // subi
-        subi(&system->cpu, output);
-        break;
-      case 0b010100: // muli
-        muli(&system->cpu, output);
-        break;
-      case 0b010101: // divi
-        divi(system, output);
-        break;
-      case 0b010110: // modi
-        modi(system, output);
-        break;
-      case 0b010111: // cmpi
-        cmpi(&system->cpu, output);
-        break;
-
-      case 0b011000: // l8
-        l8(system, output);
-        break;
-      case 0b011001: // l16
-        l16(system, output);
-        break;
-      case 0b011010: // l32
-        l32(system, output);
-        break;
-      case 0b011011: // s8
-        s8(system, output);
-        break;
-      case 0b011100: // s16
-        s16(system, output);
-        break;
-      case 0b011101: // s32
-        s32(system, output);
-        break;
-
-      case 0b101010: // bae
-        bae(system, output);
-        break;
-      case 0b101011: // bat
-        bat(system, output);
-        break;
-      case 0b101100: // bbe
-        bbe(system, output);
-        break;
-      case 0b101101: // bbt
-        bbt(system, output);
-        break;
-      case 0b101110: // beq
-        beq(system, output);
-        break;
-      case 0b101111: // bge
-        bge(system, output);
-        break;
-      case 0b110000: // bgt
-        bgt(system, output);
-        break;
-      case 0b110001: // biv
-        biv(system, output);
-        break;
-      case 0b110010: // ble
-        ble(system, output);
-        break;
-      case 0b110011: // blt
-        blt(system, output);
-        break;
-      case 0b110100: // bne
-        bne(system, output);
-        break;
-      case 0b110101: // bni
-        bni(system, output);
-        break;
-      case 0b110110: // bnz
-        bnz(system, output);
-        break;
-      case 0b110111: // bun
-        bun(system, output);
-        break;
-      case 0b111000: // bzd
-        bzd(system, output);
-        break;
-
-      case 0b011110: // call type F
-        callf(system, output);
-        break;
-      case 0b111001: // call type S
-        calls(system, output);
-        break;
-      case 0b011111: // ret
-        ret(system, output);
-        break;
-      case 0b001010: // push
-        push(system, output);
-        break;
-      case 0b001011: // pop
-        pop(system, output);
-        break;
-
-      case 0b100000: // reti
-        reti(system, output);
-        break;
-      case 0b100001: // cbr, sbr
-        subOpcode = ir & 0x1;
-
-        switch (subOpcode)
-        {
-        case 0b0: // cbr
-          cbr(&system->cpu, output);
-          break;
-        case 0b1: // sbr
-          sbr(&system->cpu, output);
-          break;
-        }
-        break;
-      case 0b111111: // int
-        interrupt(system, output);
-        break;
-
-      default: // Unknown instruction
-        unknownInstruction(system, output);
-      }
-    }
-
-    updateWatchdog(system, output); // Update the timer every instruction cycle
-
-    executeFPU(system, output); // FPU
-
-    if (!system->control.pcAlreadyIncremented)
-      system->cpu.registers[PC] += 4; // next instruction
-
-    system->control.pcAlreadyIncremented = false;
+    fprintf(stderr, usage, argv[0], argv[0], argv[0], argv[0]);
+    exit(EXIT_FAILURE);
   }
-}
-
-/******************************************************
- * Terminal
- *******************************************************/
-
-void initTerminalBuffer(TerminalBuffer *buffer, size_t initialCapacity)
-{
-  buffer->data = (char *)malloc(initialCapacity * sizeof(char));
-  buffer->size = 0;
-  buffer->capacity = (buffer->data != NULL) ? initialCapacity : 0;
-}
 
-void addToBuffer(TerminalBuffer *buffer, char character)
-{
-  if (buffer->size == buffer->capacity)
+  if (socketPath != NULL)
   {
-    size_t newCapacity = (buffer->capacity == 0) ? 1 : 2 * buffer->capacity;
-    buffer->data = (char *)realloc(buffer->data, newCapacity * sizeof(char));
-
-    if (buffer->data != NULL)
-      buffer->capacity = newCapacity;
-    else
+    // Reject bad options before listening
+    PoximSystem *system = poxim_create(optionCount, options);
+    if (system == NULL)
     {
-      fprintf(stderr, "Failed to allocate memory for buffer.\n");
+      fprintf(stderr, usage, argv[0], argv[0], argv[0], argv[0]);
       exit(EXIT_FAILURE);
     }
-  }
-
-  buffer->data[buffer->size++] = character;
-}
-
-void freeBuffer(TerminalBuffer *buffer)
-{
-  free(buffer->data);
-  buffer->data = NULL;
-  buffer->size = 0;
-  buffer->capacity = 0;
-}
-
-void printTerminal(TerminalBuffer *buffer, FILE *output)
-{
-  if (buffer->size > 0)
-  {
-    printf("[TERMINAL]\n");
-    printf("%s\n", buffer->data);
+    poxim_destroy(system);
 
-    fprintf(output, "[TERMINAL]\n");
-    fprintf(output, "%s\n", buffer->data);
+    return runServer(socketPath, jobs, optionCount, options);
   }
 
-  // Output formatting to file
-  fprintf(output, "[END OF SIMULATION]\n");
-  printf("[END OF SIMULATION]\n");
-}
-
-/******************************************************
- * Watchdog
- *******************************************************/
-
-void updateWatchdog(System *system, FILE *output)
-{
-  const int32_t en = system->watchdog.registers & 0x80000000;
-  int32_t counterValue = system->watchdog.registers & 0x7FFFFFFF;
-
-  if (en)
+  if (manifest != NULL)
   {
-    if (counterValue > 0)
-    {
-      counterValue--;
-      system->watchdog.registers = (system->watchdog.registers & 0x80000000) | counterValue;
-    }
-    else
+    Batch batch = {0};
+    batch.workerCount = jobs;
+    batch.trace = trace;
+    batch.optionCount = optionCount;
+    batch.options = options;
+    batch.quantum = quantum;
+    batch.resident = resident;
+    batch.lockstep = lockstep;
+
+    // Reject bad options once instead of in every worker
+    PoximSystem *system = poxim_create(optionCount, options);
+    if (system == NULL || !readManifest(manifest, &batch))
     {
-      system->watchdog.registers = 0x00000000; // EN = 0
-      system->control.interrupt.hasInterrupt = true;
+      fprintf(stderr, usage, argv[0], argv[0], argv[0], argv[0]);
+      exit(EXIT_FAILURE);
     }
-  }
-
-  if (system->control.interrupt.hasInterrupt && isIESet(&system->cpu))
-  {
-    handlePrepareForISR(system);
-
-    system->control.pcAlreadyIncremented = true;
-    system->control.interrupt.hasInterrupt = false;
-
-    system->cpu.registers[IPC] = system->cpu.registers[PC];
-    system->cpu.registers[PC] = HARDWARE1_INTERRUPT_ADDR;
-    system->cpu.registers[CR] = HARDWARE1_INTERRUPT_CODE;
-
-    printInterruptMessage(HARDWARE1_INTERRUPT_ADDR, output);
-  }
-}
-
-/******************************************************
- * FPU
- *******************************************************/
-
-void executeFPU(System *system, FILE *output)
-{
-  decrementFPUTimer(&system->fpu.timer);
+    poxim_destroy(system);
 
-  handleFPUErrors(system, output); // Dealing with interruptions
-  const uint8_t opcode = system->fpu.registers.control & 0x1F;
+    const int status = runBatch(&batch, stats);
+    free(options);
 
-  switch (opcode)
-  {
-  case 0b00000:
-    break;
-  case 0b00001: // Adition
-    addFPU(&system->fpu);
-
-    setFPUTimerVariableCycle(system);
-    break;
-  case 0b00010: // Subtraction
-    subtractFPU(&system->fpu);
-
-    setFPUTimerVariableCycle(system);
-    break;
-  case 0b00011: // Multiplication
-    multiplyFPU(&system->fpu);
-
-    setFPUTimerVariableCycle(system);
-    break;
-  case 0b00100: // Division
-    divideFPU(&system->fpu);
-
-    setFPUTimerVariableCycle(system);
-    break;
-  case 0b00101: // Assign x from z
-    assignXFromZFPU(&system->fpu);
-
-    system->fpu.timer.interrupt.code = HARDWARE4_INTERRUPT_ADDR;
-    system->fpu.timer.interrupt.hasInterrupt = true;
-    break;
-  case 0b00110: // Assign y from z
-    assignYFromZFPU(&system->fpu);
-
-    system->fpu.timer.interrupt.code = HARDWARE4_INTERRUPT_ADDR;
-    system->fpu.timer.interrupt.hasInterrupt = true;
-    break;
-  case 0b00111: // Ceiling
-    ceilingZFPU(&system->fpu);
-
-    system->fpu.timer.interrupt.code = HARDWARE4_INTERRUPT_ADDR;
-    system->fpu.timer.interrupt.hasInterrupt = true;
-    break;
-  case 0b01000: // Floor
-    floorZFPU(&system->fpu);
-
-    system->fpu.timer.interrupt.code = HARDWARE4_INTERRUPT_ADDR;
-    system->fpu.timer.interrupt.hasInterrupt = true;
-    break;
-  case 0b01001: // Round
-    roundZFPU(&system->fpu);
-
-    system->fpu.timer.interrupt.code = HARDWARE4_INTERRUPT_ADDR;
-    system->fpu.timer.interrupt.hasInterrupt = true;
-    break;
-  default:
-    setFPUControlSTField(&system->fpu, true);
-
-    system->fpu.timer.counter = 1;
-    system->fpu.timer.interrupt.code = HARDWARE2_INTERRUPT_ADDR;
-    system->fpu.timer.enabled = true;
-    system->fpu.timer.interrupt.hasInterrupt = false;
-    system->fpu.previousControlStatus = true;
+    return status;
   }
-}
-
-void addFPU(FPU *fpu)
-{
-  float z = fpu->registers.x.f + fpu->registers.y.f;
-  fpu->registers.z.f = z;
-  fpu->registers.z.u = convertToIEEE754(&z);
-}
 
-void subtractFPU(FPU *fpu)
-{
-  float z = fpu->registers.x.f - fpu->registers.y.f;
-  fpu->registers.z.f = z;
-  fpu->registers.z.u = convertToIEEE754(&z);
-}
-
-void multiplyFPU(FPU *fpu)
-{
-  float z = fpu->registers.x.f * fpu->registers.y.f;
-  fpu->registers.z.f = z;
-  fpu->registers.z.u = convertToIEEE754(&z);
-}
+  PoximSystem *system = poxim_create(optionCount, options);
+  free(options);
 
-void divideFPU(FPU *fpu)
-{
-  if (fpu->registers.y.f != 0)
-  {
-    float z = fpu->registers.x.f / fpu->registers.y.f;
-    fpu->registers.z.f = z;
-    fpu->registers.z.u = convertToIEEE754(&z);
-  }
-  else
+  if (system == NULL)
   {
-    fpu->previousControlStatus = true;
+    fprintf(stderr, usage, argv[0], argv[0], argv[0], argv[0]);
+    exit(EXIT_FAILURE);
   }
-}
-
-void assignXFromZFPU(FPU *fpu)
-{
-  fpu->registers.x.f = fpu->registers.z.f;
-  fpu->registers.x.u = fpu->registers.z.u;
-}
-
-void assignYFromZFPU(FPU *fpu)
-{
-  fpu->registers.y.f = fpu->registers.z.f;
-  fpu->registers.y.u = fpu->registers.z.u;
-}
-
-void ceilingZFPU(FPU *fpu)
-{
-  fpu->registers.z.u = ceilf(fpu->registers.z.f);
-}
-
-void floorZFPU(FPU *fpu)
-{
-  fpu->registers.z.u = floorf(fpu->registers.z.f);
-}
-
-void roundZFPU(FPU *fpu)
-{
-  fpu->registers.z.u = roundf(fpu->registers.z.f);
-}
-
-void setFPUControlSTField(FPU *fpu, bool enable)
-{
-  if (enable)
-    fpu->registers.control |= FPU_CONTROL_ST_MASK;
-  else
-    fpu->registers.control &= ~FPU_CONTROL_ST_MASK;
-}
-
-void resetFPUControlOPCodeField(FPU *fpu)
-{
-  fpu->registers.control &= FPU_CONTROL_ST_MASK;
-}
-
-bool getFPUControlSTField(FPU *fpu)
-{
-  const uint32_t st = fpu->registers.control & FPU_CONTROL_ST_MASK;
-
-  if (st > 0)
-    return true;
-  else
-    return false;
-}
-
-void handleFPUErrors(System *system, FILE *output)
-{
 
-  if (system->fpu.previousControlStatus && system->fpu.timer.interrupt.hasInterrupt) // Error in operation (ST = 1)
+  if (translation != NULL)
   {
-    handlePrepareForISR(system);
-    system->control.pcAlreadyIncremented = true;
-
-    system->cpu.registers[IPC] = system->control.oldPC;
-    system->cpu.registers[PC] = HARDWARE2_INTERRUPT_ADDR;
-    system->cpu.registers[CR] = FPU_INTERRUPT_CODE;
+    if (!loadProgram(system, argv[2]))
+      exit(EXIT_FAILURE);
 
-    printInterruptMessage(HARDWARE2_INTERRUPT_ADDR, output);
+    if (!poxim_translate(system, translation))
+    {
+      fprintf(stderr, "Failed to open %s.\n", translation);
+      exit(EXIT_FAILURE);
+    }
 
-    system->fpu.previousControlStatus = false;
-    system->fpu.timer.interrupt.hasInterrupt = false;
+    poxim_destroy(system);
 
-    resetFPUControlOPCodeField(&system->fpu);
-    setFPUControlSTField(&system->fpu, true);
+    return 0;
   }
 
-  else if (system->fpu.timer.interrupt.hasInterrupt)
-  {
-    handlePrepareForISR(system);
-    system->control.pcAlreadyIncremented = true;
-
-    system->cpu.registers[IPC] = system->control.oldPC;
-    system->cpu.registers[PC] = system->fpu.timer.interrupt.code;
-    system->cpu.registers[CR] = FPU_INTERRUPT_CODE;
+  // Guest output as it is produced instead of the [TERMINAL] block
+  TerminalOutput terminal = {NULL, 0};
 
-    printInterruptMessage(system->fpu.timer.interrupt.code, output);
-
-    system->fpu.timer.interrupt.hasInterrupt = false;
-    resetFPUControlOPCodeField(&system->fpu);
-  }
-}
-
-void setFPUTimerVariableCycle(System *system)
-{
-  if (!system->fpu.timer.enabled)
+  if (terminalStream != NULL)
   {
-    uint32_t x = convertToIEEE754(&system->fpu.registers.x.f);
-    uint32_t y = convertToIEEE754(&system->fpu.registers.y.f);
-
-    system->fpu.timer.counter = calculateExponentDifference(x, y);
-    system->fpu.timer.interrupt.code = HARDWARE3_INTERRUPT_ADDR;
-    system->fpu.timer.enabled = true;
-    system->fpu.timer.interrupt.hasInterrupt = false;
+    terminal.file = (strcmp(terminalStream, "-") == 0) ? stdout : fopen(terminalStream, "w");
+    if (terminal.file == NULL)
+    {
+      fprintf(stderr, "Failed to open %s.\n", terminalStream);
+      exit(EXIT_FAILURE);
+    }
   }
-}
 
-void decrementFPUTimer(FPUTimer *timer)
-{
-  if (timer->enabled && timer->counter > 0)
+  // Guest input read from the terminal input register, '-' being stdin
+  int input = -1;
+
+  if (terminalInput != NULL)
   {
-    timer->counter--;
-    if (timer->counter == 0)
+    input = (strcmp(terminalInput, "-") == 0) ? STDIN_FILENO : open(terminalInput, O_RDONLY);
+    if (input < 0)
     {
-      timer->enabled = false;
-      timer->interrupt.hasInterrupt = true;
+      fprintf(stderr, "Failed to open %s.\n", terminalInput);
+      exit(EXIT_FAILURE);
     }
   }
-}
-
-uint32_t convertToIEEE754(float *x)
-{
-  const uint32_t xi = *((uint32_t *)x);
 
-  return xi;
-}
-
-uint32_t calculateExponentDifference(uint32_t x, uint32_t y)
-{
-  const uint32_t exponentX = (x >> 23) & 0xFF;
-  const uint32_t exponentY = (y >> 23) & 0xFF;
-
-  return abs(exponentX - exponentY) + 1;
-}
-
-/******************************************************
- * Arithmetic and logical operations
- *******************************************************/
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
 
-void mov(CPU *cpu, FILE *output)
-{
-  // Fetch operands
-  const uint32_t ir = cpu->registers[IR];
-
-  const uint8_t z = ir >> 21;
-  const uint32_t xyl = ir & 0x1FFFFF;
-
-  // Execution of behavior
-  if (z != 0)
-    cpu->registers[z] = xyl;
-
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[30] = {0};
-
-  sprintf(instruction, "mov %s,%u", formatRegisterName(z, true), xyl);
-  sprintf(additionalInfo, "%s=0x%08X", formatRegisterName(z, false), cpu->registers[z]);
+  if (!runProgram(system, argv[1], argv[2], trace, true, terminalStream != NULL ? &terminal : NULL, input))
+    exit(EXIT_FAILURE);
 
-  // Output
-  printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
-}
+  if (input > STDIN_FILENO)
+    close(input);
 
-void movs(CPU *cpu, FILE *output)
-{
-  // Fetch operands
-  const uint32_t ir = cpu->registers[IR];
+  if (terminal.file != NULL && terminal.file != stdout)
+    fclose(terminal.file);
 
-  const uint8_t z = (ir & 0x03E00000) >> 21;
-  const int32_t xyl = extendSign32(ir & 0x1FFFFF, 21);
+  const int status = exitStatus(poxim_status(system));
 
-  // Execution of behavior
-  if (z != 0)
-    cpu->registers[z] = xyl;
-
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[30] = {0};
-
-  sprintf(instruction, "movs %s,%i", formatRegisterName(z, true), xyl);
-  sprintf(additionalInfo, "%s=0x%08X", formatRegisterName(z, false), cpu->registers[z]);
-
-  // Output
-  printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
-}
-
-void add(CPU *cpu, FILE *output)
-{
-  // Fetch operands
-  const uint32_t ir = cpu->registers[IR];
-
-  const uint8_t z = (ir >> 21) & 0x1F;
-  const uint8_t x = (ir >> 16) & 0x1F;
-  const uint8_t y = (ir >> 11) & 0x1F;
-
-  // Execution of behavior
-  const uint64_t valueX = (uint64_t)cpu->registers[x];
-  const uint64_t valueY = (uint64_t)cpu->registers[y];
-
-  const uint64_t result = valueX + valueY;
-
-  if (z != 0)
-    cpu->registers[z] = (uint32_t)result;
-
-  if (result == 0)
-    cpu->registers[SR] |= ZN_FLAG;
-  else
-    cpu->registers[SR] &= ~ZN_FLAG;
-
-  if ((result & 0x80000000))
-    cpu->registers[SR] |= SN_FLAG;
-  else
-    cpu->registers[SR] &= ~SN_FLAG;
-
-  if (
-      ((valueX & 0x80000000) == (valueY & 0x80000000)) &&
-      ((result & 0x80000000) != (valueX & 0x80000000)))
-    cpu->registers[SR] |= OV_FLAG;
-  else
-    cpu->registers[SR] &= ~OV_FLAG;
-
-  if (result > 0xFFFFFFFF)
-    cpu->registers[SR] |= CY_FLAG;
-  else
-    cpu->registers[SR] &= ~CY_FLAG;
-
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[100] = {0};
-
-  sprintf(instruction, "add %s,%s,%s",
-          formatRegisterName(z, true), formatRegisterName(x, true), formatRegisterName(y, true));
-  sprintf(additionalInfo, "%s=%s+%s=0x%08X,SR=0x%08X", formatRegisterName(z, false), formatRegisterName(x, false), formatRegisterName(y, false), cpu->registers[z], cpu->registers[SR]);
-
-  // Output
-  printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
-}
-
-void sub(CPU *cpu, FILE *output)
-{
-  // Fetch operands
-  const uint32_t ir = cpu->registers[IR];
-
-  const uint8_t z = (ir >> 21) & 0x1F;
-  const uint8_t x = (ir >> 16) & 0x1F;
-  const uint8_t y = (ir >> 11) & 0x1F;
-
-  // Execution of behavior
-  const uint64_t valueX = (uint64_t)cpu->registers[x];
-  const uint64_t valueY = (uint64_t)cpu->registers[y];
-
-  const uint64_t result = valueX - valueY;
-
-  if (z != 0)
-    cpu->registers[z] = (result & 0xFFFFFFFF);
-
-  if (result == 0)
-    cpu->registers[SR] |= ZN_FLAG;
-  else
-    cpu->registers[SR] &= ~ZN_FLAG;
-
-  if ((result & 0x80000000))
-    cpu->registers[SR] |= SN_FLAG;
-  else
-    cpu->registers[SR] &= ~SN_FLAG;
-
-  if (
-      ((valueX & 0x80000000) != (valueY & 0x80000000)) &&
-      ((result & 0x80000000) != (valueX & 0x80000000)))
-    cpu->registers[SR] |= OV_FLAG;
-  else
-    cpu->registers[SR] &= ~OV_FLAG;
-
-  if (result > 0xFFFFFFFF)
-    cpu->registers[SR] |= CY_FLAG;
-  else
-    cpu->registers[SR] &= ~CY_FLAG;
-
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[100] = {0};
-
-  sprintf(instruction, "sub %s,%s,%s",
-          formatRegisterName(z, true), formatRegisterName(x, true), formatRegisterName(y, true));
-  sprintf(additionalInfo, "%s=%s-%s=0x%08X,SR=0x%08X", formatRegisterName(z, false), formatRegisterName(x, false), formatRegisterName(y, false), cpu->registers[z], cpu->registers[SR]);
-
-  // Output
-  printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
-}
-
-void mul(CPU *cpu, FILE *output)
-{
-  // Fetch operands
-  const uint32_t ir = cpu->registers[IR];
-
-  const uint8_t z = (ir >> 21) & 0x1F;
-  const uint8_t x = (ir >> 16) & 0x1F;
-  const uint8_t y = (ir >> 11) & 0x1F;
-  const uint8_t l = ir & 0x1F;
-
-  // Execution of behavior
-  const uint64_t valueX = (uint64_t)cpu->registers[x];
-  const uint64_t valueY = (uint64_t)cpu->registers[y];
-
-  const uint64_t result = valueX * valueY;
-  if (z != 0)
-    cpu->registers[z] = (uint32_t)result;
-
-  if (l != 0)
-    cpu->registers[l] = (result >> 32) & 0xFFFFFFFF;
-
-  if (result == 0)
-    cpu->registers[SR] |= ZN_FLAG;
-  else
-    cpu->registers[SR] &= ~ZN_FLAG;
-
-  if (cpu->registers[l] != 0)
-    cpu->registers[SR] |= CY_FLAG;
-  else
-    cpu->registers[SR] &= ~CY_FLAG;
-
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[50] = {0};
-
-  sprintf(instruction, "mul %s,%s,%s,%s",
-          formatRegisterName(l, true), formatRegisterName(z, true), formatRegisterName(x, true), formatRegisterName(y, true));
-  sprintf(additionalInfo, "%s:%s=%s*%s=0x%08X%08X,SR=0x%08X", formatRegisterName(l, false), formatRegisterName(z, false), formatRegisterName(x, false), formatRegisterName(y, false), cpu->registers[l], cpu->registers[z], cpu->registers[SR]);
-
-  // Output
-  printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
-}
-
-void sll(CPU *cpu, FILE *output)
-{
-  // Fetch operands
-  const uint32_t ir = cpu->registers[IR];
-
-  const uint8_t z = (ir >> 21) & 0x1F;
-  const uint8_t x = (ir >> 16) & 0x1F;
-  const uint8_t y = (ir >> 11) & 0x1F;
-  const uint8_t l = ir & 0x1F;
-
-  // Execution of behavior
-  const uint64_t valueZ = (uint64_t)cpu->registers[z];
-  const uint64_t valueY = (uint64_t)cpu->registers[y];
-
-  const uint64_t result = z != 0 ? ((valueZ << 32) | valueY) << (l + 1) : valueY << (l + 1);
-
-  if (x != 0)
-    cpu->registers[x] = result & 0xFFFFFFFF;
-
-  if (z != 0)
-    cpu->registers[z] = (result >> 32) & 0xFFFFFFFF;
-
-  if (cpu->registers[z] != 0)
-    cpu->registers[SR] |= CY_FLAG;
-  else
-    cpu->registers[SR] &= ~CY_FLAG;
-
-  if (result == 0)
-    cpu->registers[SR] |= ZN_FLAG;
-  else
-    cpu->registers[SR] &= ~ZN_FLAG;
-
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[200] = {0};
-
-  sprintf(instruction, "sll %s,%s,%s,%u",
-          formatRegisterName(z, true), formatRegisterName(x, true), formatRegisterName(y, true), l);
-  sprintf(additionalInfo, "%s:%s=%s:%s<<%u=0x%08X%08X,SR=0x%08X", formatRegisterName(z, false), formatRegisterName(x, false), formatRegisterName(z, false), formatRegisterName(y, false), l + 1, cpu->registers[z], cpu->registers[x], cpu->registers[SR]);
-
-  // Output
-  printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
-}
-
-void muls(CPU *cpu, FILE *output)
-{
-  // Fetch operands
-  const uint32_t ir = cpu->registers[IR];
-
-  const uint8_t z = (ir >> 21) & 0x1F;
-  const uint8_t x = (ir >> 16) & 0x1F;
-  const uint8_t y = (ir >> 11) & 0x1F;
-  const uint8_t l = ir & 0x1F;
-
-  // Execution of behavior
-  const uint64_t valueX = extendSign64(cpu->registers[x], 32);
-  const uint64_t valueY = extendSign64(cpu->registers[y], 32);
-
-  const int64_t result = valueX * valueY;
-
-  if (z != 0)
-    cpu->registers[z] = (uint32_t)result;
-
-  if (l != 0)
-    cpu->registers[l] = (result >> 32) & 0xFFFFFFFF;
-
-  if (result == 0)
-    cpu->registers[SR] |= ZN_FLAG;
-  else
-    cpu->registers[SR] &= ~ZN_FLAG;
-
-  if (cpu->registers[l] != 0)
-    cpu->registers[SR] |= OV_FLAG;
-  else
-    cpu->registers[SR] &= ~OV_FLAG;
-
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[50] = {0};
-
-  sprintf(instruction, "muls %s,%s,%s,%s",
-          formatRegisterName(l, true), formatRegisterName(z, true), formatRegisterName(x, true), formatRegisterName(y, true));
-  sprintf(additionalInfo, "%s:%s=%s*%s=0x%08X%08X,SR=0x%08X", formatRegisterName(l, false), formatRegisterName(z, false), formatRegisterName(x, false), formatRegisterName(y, false), cpu->registers[l], cpu->registers[z], cpu->registers[SR]);
-
-  // Output
-  printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
-}
-
-void sla(CPU *cpu, FILE *output)
-{
-  // Fetch operands
-  const uint32_t ir = cpu->registers[IR];
-
-  const uint8_t z = (ir >> 21) & 0x1F;
-  const uint8_t x = (ir >> 16) & 0x1F;
-  const uint8_t y = (ir >> 11) & 0x1F;
-  const uint8_t l = ir & 0x1F;
-
-  // Execution of behavior
-  const uint64_t valueZ = (uint64_t)cpu->registers[z];
-  const uint64_t valueY = (uint64_t)cpu->registers[y];
-
-  const uint64_t result = ((valueZ << 32) | valueY) << (l + 1);
-
-  if (x != 0)
-    cpu->registers[x] = result & 0xFFFFFFFF;
-
-  if (z != 0)
-  {
-    cpu->registers[z] = (result >> 32) & 0xFFFFFFFF;
-
-    if (cpu->registers[z] != 0)
-      cpu->registers[SR] |= OV_FLAG;
-    else
-      cpu->registers[SR] &= ~OV_FLAG;
-  }
-
-  if (result == 0)
-    cpu->registers[SR] |= ZN_FLAG;
-  else
-    cpu->registers[SR] &= ~ZN_FLAG;
-
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[200] = {0};
-
-  sprintf(instruction, "sla %s,%s,%s,%u",
-          formatRegisterName(z, true), formatRegisterName(x, true), formatRegisterName(y, true), l);
-  sprintf(additionalInfo, "%s:%s=%s:%s<<%u=0x%08X%08X,SR=0x%08X", formatRegisterName(z, false), formatRegisterName(x, false), formatRegisterName(z, false), formatRegisterName(y, false), l + 1, cpu->registers[z], cpu->registers[x], cpu->registers[SR]);
-
-  // Output
-  printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
-}
-
-void divv(System *system, FILE *output)
-{
-  // Fetch operands
-  const uint32_t ir = system->cpu.registers[IR];
-
-  const uint8_t z = (ir >> 21) & 0x1F;
-  const uint8_t x = (ir >> 16) & 0x1F;
-  const uint8_t y = (ir >> 11) & 0x1F;
-  const uint8_t l = ir & 0x1F;
-
-  // Execution of behavior
-  const uint32_t valueX = system->cpu.registers[x];
-  const uint32_t valueY = system->cpu.registers[y];
-
-  if (valueY != 0)
-  {
-    if (z != 0)
-      system->cpu.registers[z] = valueX / valueY;
-
-    if (l != 0)
-      system->cpu.registers[l] = valueX % valueY;
-
-    if (system->cpu.registers[z] == 0)
-      system->cpu.registers[SR] |= ZN_FLAG;
-    else
-      system->cpu.registers[SR] &= ~ZN_FLAG;
-
-    if (system->cpu.registers[l] != 0)
-      system->cpu.registers[SR] |= CY_FLAG;
-    else
-      system->cpu.registers[SR] &= ~CY_FLAG;
-  }
-
-  if (valueY == 0)
-    system->cpu.registers[SR] |= ZD_FLAG;
-  else
-    system->cpu.registers[SR] &= ~ZD_FLAG;
-
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[100] = {0};
-
-  sprintf(instruction, "div %s,%s,%s,%s",
-          formatRegisterName(l, true), formatRegisterName(z, true), formatRegisterName(x, true), formatRegisterName(y, true));
-  sprintf(additionalInfo, "%s=%s%%%s=0x%08X,%s=%s/%s=0x%08X,SR=0x%08X", formatRegisterName(l, false), formatRegisterName(x, false), formatRegisterName(y, false), system->cpu.registers[l], formatRegisterName(z, false), formatRegisterName(x, false), formatRegisterName(y, false), system->cpu.registers[z], system->cpu.registers[SR]);
-
-  // Output
-  printInstruction(system->cpu.registers[PC], output, instruction, additionalInfo);
-
-  if (valueY == 0)
-    handleDivideByZero(system, output);
-}
-
-void srl(CPU *cpu, FILE *output)
-{
-  // Fetch operands
-  const uint32_t ir = cpu->registers[IR];
-
-  const uint8_t z = (ir >> 21) & 0x1F;
-  const uint8_t x = (ir >> 16) & 0x1F;
-  const uint8_t y = (ir >> 11) & 0x1F;
-  const uint8_t l = ir & 0x1F;
-
-  // Execution of behavior
-  const uint64_t valueZ = (uint64_t)cpu->registers[z];
-  const uint64_t valueY = (uint64_t)cpu->registers[y];
-
-  const uint64_t result = z != 0 ? ((valueZ << 32) | valueY) >> (l + 1) : valueY >> (l + 1);
-
-  if (x != 0)
-    cpu->registers[x] = result & 0xFFFFFFFF;
-
-  if (z != 0)
-  {
-    cpu->registers[z] = (result >> 32) & 0xFFFFFFFF;
-
-    if (cpu->registers[z] != 0)
-      cpu->registers[SR] |= OV_FLAG;
-    else
-      cpu->registers[SR] &= ~OV_FLAG;
-  }
-
-  if (result == 0)
-    cpu->registers[SR] |= ZN_FLAG;
-  else
-    cpu->registers[SR] &= ~ZN_FLAG;
-
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[200] = {0};
-
-  sprintf(instruction, "srl %s,%s,%s,%u",
-          formatRegisterName(z, true), formatRegisterName(x, true), formatRegisterName(y, true), l);
-  sprintf(additionalInfo, "%s:%s=%s:%s>>%u=0x%08X%08X,SR=0x%08X", formatRegisterName(z, false), formatRegisterName(x, false), formatRegisterName(z, false), formatRegisterName(y, false), l + 1, cpu->registers[z], cpu->registers[x], cpu->registers[SR]);
-
-  // Output
-  printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
-}
-
-void divs(System *system, FILE *output)
-{
-  // Fetch operands
-  const uint32_t ir = system->cpu.registers[IR];
-
-  const uint8_t z = (ir >> 21) & 0x1F;
-  const uint8_t x = (ir >> 16) & 0x1F;
-  const uint8_t y = (ir >> 11) & 0x1F;
-  const uint8_t l = ir & 0x1F;
-
-  // Execution of behavior
-  const int32_t valueX = system->cpu.registers[x];
-  const int32_t valueY = system->cpu.registers[y];
-
-  if (valueY != 0)
-  {
-    if (l != 0)
-      system->cpu.registers[l] = valueX % valueY;
-
-    if (z != 0)
-      system->cpu.registers[z] = valueX / valueY;
-
-    if (system->cpu.registers[z] == 0)
-      system->cpu.registers[SR] |= ZN_FLAG;
-    else
-      system->cpu.registers[SR] &= ~ZN_FLAG;
-
-    if (system->cpu.registers[l] != 0)
-      system->cpu.registers[SR] |= OV_FLAG;
-    else
-      system->cpu.registers[SR] &= ~OV_FLAG;
-  }
-
-  if (valueY == 0)
-    system->cpu.registers[SR] |= ZD_FLAG;
-  else
-    system->cpu.registers[SR] &= ~ZD_FLAG;
-
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[100] = {0};
-
-  sprintf(instruction, "divs %s,%s,%s,%s",
-          formatRegisterName(l, true), formatRegisterName(z, true), formatRegisterName(x, true), formatRegisterName(y, true));
-  sprintf(additionalInfo, "%s=%s%%%s=0x%08X,%s=%s/%s=0x%08X,SR=0x%08X", formatRegisterName(l, false), formatRegisterName(x, false), formatRegisterName(y, false), system->cpu.registers[l], formatRegisterName(z, false), formatRegisterName(x, false), formatRegisterName(y, false), system->cpu.registers[z], system->cpu.registers[SR]);
-
-  // Output
-  printInstruction(system->cpu.registers[PC], output, instruction, additionalInfo);
-
-  if (valueY == 0)
-    handleDivideByZero(system, output);
-}
-
-void sra(CPU *cpu, FILE *output)
-{
-  // Fetch operands
-  const uint32_t ir = cpu->registers[IR];
-
-  const uint8_t z = (ir >> 21) & 0x1F;
-  const uint8_t x = (ir >> 16) & 0x1F;
-  const uint8_t y = (ir >> 11) & 0x1F;
-  const uint8_t l = ir & 0x1F;
-
-  // Execution of behavior
-  const int64_t valueZ = cpu->registers[z];
-  const int64_t valueY = cpu->registers[y];
-
-  const int64_t result = ((valueZ << 32) | valueY) >> (l + 1);
-
-  if (x != 0)
-    cpu->registers[x] = result & 0xFFFFFFFF;
-
-  if (z != 0)
-    cpu->registers[z] = (result >> 32) & 0xFFFFFFFF;
-
-  if (cpu->registers[z] != 0)
-    cpu->registers[SR] |= OV_FLAG;
-  else
-    cpu->registers[SR] &= ~OV_FLAG;
-
-  if (result == 0)
-    cpu->registers[SR] |= ZN_FLAG;
-  else
-    cpu->registers[SR] &= ~ZN_FLAG;
-
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[200] = {0};
-
-  sprintf(instruction, "sra %s,%s,%s,%u",
-          formatRegisterName(z, true), formatRegisterName(x, true), formatRegisterName(y, true), l);
-  sprintf(additionalInfo, "%s:%s=%s:%s>>%u=0x%08X%08X,SR=0x%08X", formatRegisterName(z, false), formatRegisterName(x, false), formatRegisterName(z, false), formatRegisterName(y, false), l + 1, cpu->registers[z], cpu->registers[x], cpu->registers[SR]);
-
-  // Output
-  printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
-}
-
-void cmp(CPU *cpu, FILE *output)
-{
-  // Fetch operands
-  const uint32_t ir = cpu->registers[IR];
-
-  const uint8_t z = (ir >> 21) & 0x1F;
-  const uint8_t x = (ir >> 16) & 0x1F;
-  const uint8_t y = (ir >> 11) & 0x1F;
-
-  // Execution of behavior
-  const uint64_t valueX = (uint64_t)cpu->registers[x];
-  const uint64_t valueY = (uint64_t)cpu->registers[y];
-
-  const uint64_t result = valueX - valueY;
-
-  if (z != 0)
-    cpu->registers[z] = (result & 0xFFFFFFFF);
-
-  if (result == 0)
-    cpu->registers[SR] |= ZN_FLAG;
-  else
-    cpu->registers[SR] &= ~ZN_FLAG;
-
-  if ((result & 0x80000000))
-    cpu->registers[SR] |= SN_FLAG;
-  else
-    cpu->registers[SR] &= ~SN_FLAG;
-
-  if (
-      ((valueX & 0x80000000) != (valueY & 0x80000000)) &&
-      ((result & 0x80000000) != (valueX & 0x80000000)))
-    cpu->registers[SR] |= OV_FLAG;
-  else
-    cpu->registers[SR] &= ~OV_FLAG;
-
-  if (result > 0xFFFFFFFF)
-    cpu->registers[SR] |= CY_FLAG;
-  else
-    cpu->registers[SR] &= ~CY_FLAG;
-
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[30] = {0};
-
-  sprintf(instruction, "cmp %s,%s", formatRegisterName(x, true), formatRegisterName(y, true));
-  sprintf(additionalInfo, "SR=0x%08X", cpu->registers[SR]);
-
-  // Output
-  printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
-}
-
-void and (CPU * cpu, FILE *output)
-{
-  // Fetch operands
-  const uint32_t ir = cpu->registers[IR];
-
-  const uint8_t z = (ir >> 21) & 0x1F;
-  const uint8_t x = (ir >> 16) & 0x1F;
-  const uint8_t y = (ir >> 11) & 0x1F;
-
-  // Execution of behavior
-  const uint32_t valueX = (uint32_t)cpu->registers[x];
-  const uint32_t valueY = (uint32_t)cpu->registers[y];
-
-  const uint32_t result = valueX & valueY;
-
-  if (z != 0)
-    cpu->registers[z] = result;
-
-  if (result == 0)
-    cpu->registers[SR] |= ZN_FLAG;
-  else
-    cpu->registers[SR] &= ~ZN_FLAG;
-
-  if (result & 0x80000000)
-    cpu->registers[SR] |= SN_FLAG;
-  else
-    cpu->registers[SR] &= ~SN_FLAG;
-
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[100] = {0};
-
-  sprintf(instruction, "and %s,%s,%s", formatRegisterName(z, true), formatRegisterName(x, true), formatRegisterName(y, true));
-  sprintf(additionalInfo, "%s=%s&%s=0x%08X,SR=0x%08X", formatRegisterName(z, false), formatRegisterName(x, false), formatRegisterName(y, false), cpu->registers[z], cpu->registers[SR]);
-
-  // Output
-  printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
-}
-
-void or (CPU * cpu, FILE *output)
-{
-  // Fetch operands
-  const uint32_t ir = cpu->registers[IR];
-
-  const uint8_t z = (ir >> 21) & 0x1F;
-  const uint8_t x = (ir >> 16) & 0x1F;
-  const uint8_t y = (ir >> 11) & 0x1F;
-
-  // Execution of behavior
-  const uint32_t valueX = (uint32_t)cpu->registers[x];
-  const uint32_t valueY = (uint32_t)cpu->registers[y];
-
-  const uint32_t result = valueX | valueY;
-
-  if (z != 0)
-    cpu->registers[z] = result;
-
-  if (result == 0)
-    cpu->registers[SR] |= ZN_FLAG;
-  else
-    cpu->registers[SR] &= ~ZN_FLAG;
-
-  if (result & 0x80000000)
-    cpu->registers[SR] |= SN_FLAG;
-  else
-    cpu->registers[SR] &= ~SN_FLAG;
-
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[100] = {0};
-
-  sprintf(instruction, "or %s,%s,%s", formatRegisterName(z, true), formatRegisterName(x, true), formatRegisterName(y, true));
-  sprintf(additionalInfo, "%s=%s|%s=0x%08X,SR=0x%08X", formatRegisterName(z, false), formatRegisterName(x, false), formatRegisterName(y, false), cpu->registers[z], cpu->registers[SR]);
-
-  // Output
-  printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
-}
-
-void not(CPU * cpu, FILE *output)
-{
-  // Fetch operands
-  const uint32_t ir = cpu->registers[IR];
-
-  const uint8_t z = (ir >> 21) & 0x1F;
-  const uint8_t x = (ir >> 16) & 0x1F;
-
-  // Execution of behavior
-  const uint32_t valueX = (uint32_t)cpu->registers[x];
-
-  const uint32_t result = ~valueX;
-
-  if (z != 0)
-    cpu->registers[z] = result;
-
-  if (result == 0)
-    cpu->registers[SR] |= ZN_FLAG;
-  else
-    cpu->registers[SR] &= ~ZN_FLAG;
-
-  if (result & 0x80000000)
-    cpu->registers[SR] |= SN_FLAG;
-  else
-    cpu->registers[SR] &= ~SN_FLAG;
-
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[100] = {0};
-
-  sprintf(instruction, "not %s,%s", formatRegisterName(z, true), formatRegisterName(x, true));
-  sprintf(additionalInfo, "%s=~%s=0x%08X,SR=0x%08X", formatRegisterName(z, false), formatRegisterName(x, false), cpu->registers[z], cpu->registers[SR]);
-
-  // Output
-  printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
-}
-
-void xor (CPU * cpu, FILE *output) {
-  // Fetch operands
-  const uint32_t ir = cpu->registers[IR];
-
-  const uint8_t z = (ir >> 21) & 0x1F;
-  const uint8_t x = (ir >> 16) & 0x1F;
-  const uint8_t y = (ir >> 11) & 0x1F;
-
-  // Execution of behavior
-  const uint32_t valueX = (uint32_t)cpu->registers[x];
-  const uint32_t valueY = (uint32_t)cpu->registers[y];
-
-  const uint32_t result = valueX ^ valueY;
-
-  if (z != 0)
-    cpu->registers[z] = result;
-
-  if (result == 0)
-    cpu->registers[SR] |= ZN_FLAG;
-  else
-    cpu->registers[SR] &= ~SN_FLAG;
-
-  if (result & 0x80000000)
-    cpu->registers[SR] |= SN_FLAG;
-  else
-    cpu->registers[SR] &= ~SN_FLAG;
-
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[100] = {0};
-
-  sprintf(instruction, "xor %s,%s,%s", formatRegisterName(z, true), formatRegisterName(x, true), formatRegisterName(y, true));
-  sprintf(additionalInfo, "%s=%s^%s=0x%08X,SR=0x%08X", formatRegisterName(z, false), formatRegisterName(x, false), formatRegisterName(y, false), cpu->registers[z], cpu->registers[SR]);
-
-  // Output
-  printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
-}
-
-    void addi(CPU *cpu, FILE *output)
-{
-  // Fetch operands
-  const uint32_t ir = cpu->registers[IR];
-
-  const uint8_t z = (ir >> 21) & 0x1F;
-  const uint8_t x = (ir >> 16) & 0x1F;
-  const int32_t i = extendSign32(ir & 0xFFFF, 16);
-
-  // Execution of behavior
-  const uint64_t valueX = (uint64_t)cpu->registers[x];
-
-  const uint64_t result = valueX + (uint64_t)i;
-
-  if (z != 0)
-    cpu->registers[z] = (uint32_t)result;
-
-  if (cpu->registers[z] == 0)
-    cpu->registers[SR] |= ZN_FLAG;
-  else
-    cpu->registers[SR] &= ~ZN_FLAG;
-
-  if ((result & 0x80000000))
-    cpu->registers[SR] |= SN_FLAG;
-  else
-    cpu->registers[SR] &= ~SN_FLAG;
-
-  if (
-      ((valueX & 0x80000000) == (i & 0x80000000)) &&
-      ((result & 0x80000000) != (valueX & 0x80000000)))
-    cpu->registers[SR] |= OV_FLAG;
-  else
-    cpu->registers[SR] &= ~OV_FLAG;
-
-  if (result > 0xFFFFFFFF)
-    cpu->registers[SR] |= CY_FLAG;
-  else
-    cpu->registers[SR] &= ~CY_FLAG;
-
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[60] = {0};
-
-  sprintf(instruction, "addi %s,%s,%i",
-          formatRegisterName(z, true), formatRegisterName(x, true), i);
-  sprintf(additionalInfo, "%s=%s+0x%08X=0x%08X,SR=0x%08X", formatRegisterName(z, false), formatRegisterName(x, false), i, cpu->registers[z], cpu->registers[SR]);
-
-  // Output
-  printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
-}
-
-void subi(CPU *cpu, FILE *output)
-{
-  // Fetch operands
-  const uint32_t ir = cpu->registers[IR];
-
-  const uint8_t z = (ir >> 21) & 0x1F;
-  const uint8_t x = (ir >> 16) & 0x1F;
-  const int32_t i = extendSign32(ir & 0xFFFF, 16);
-
-  // Execution of behavior
-  const uint64_t valueX = (uint64_t)cpu->registers[x];
-
-  const uint64_t result = valueX - i;
-
-  if (z != 0)
-    cpu->registers[z] = (result & 0xFFFFFFFF);
-
-  if (result == 0)
-    cpu->registers[SR] |= ZN_FLAG;
-  else
-    cpu->registers[SR] &= ~ZN_FLAG;
-
-  if ((result & 0x80000000))
-    cpu->registers[SR] |= SN_FLAG;
-  else
-    cpu->registers[SR] &= ~SN_FLAG;
-
-  if (
-      ((valueX & 0x80000000) != (i & 0x80000000)) &&
-      ((result & 0x80000000) != (valueX & 0x80000000)))
-    cpu->registers[SR] |= OV_FLAG;
-  else
-    cpu->registers[SR] &= ~OV_FLAG;
-
-  if (result > 0xFFFFFFFF)
-    cpu->registers[SR] |= CY_FLAG;
-  else
-    cpu->registers[SR] &= ~CY_FLAG;
-
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[200] = {0};
-
-  sprintf(instruction, "subi %s,%s,%i",
-          formatRegisterName(z, true), formatRegisterName(x, true), i);
-  sprintf(additionalInfo, "%s=%s-0x%08X=0x%08X,SR=0x%08X", formatRegisterName(z, false), formatRegisterName(x, false), i, cpu->registers[z], cpu->registers[SR]);
-
-  // Output
-  printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
-}
-
-void muli(CPU *cpu, FILE *output)
-{
-  // Fetch operands
-  const uint32_t ir = cpu->registers[IR];
-
-  const uint8_t z = (ir >> 21) & 0x1F;
-  const uint8_t x = (ir >> 16) & 0x1F;
-  const int32_t i = extendSign32(ir & 0xFFFF, 16);
-
-  // Execution of behavior
-  const int64_t valueX = extendSign64(cpu->registers[x], 32);
-  const int64_t result = valueX * i;
-
-  if (z != 0)
-    cpu->registers[z] = (uint32_t)result;
-
-  if (result == 0)
-    cpu->registers[SR] |= ZN_FLAG;
-  else
-    cpu->registers[SR] &= ~ZN_FLAG;
-
-  if ((result & 0xFFFFFFFF00000000) != 0)
-    cpu->registers[SR] |= OV_FLAG;
-  else
-    cpu->registers[SR] &= ~OV_FLAG;
-
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[200] = {0};
-
-  sprintf(instruction, "muli %s,%s,%i",
-          formatRegisterName(z, true), formatRegisterName(x, true), i);
-  sprintf(additionalInfo, "%s=%s*0x%08X=0x%08X,SR=0x%08X", formatRegisterName(z, false), formatRegisterName(x, false), i, cpu->registers[z], cpu->registers[SR]);
-
-  // Output
-  printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
-}
-
-void divi(System *system, FILE *output)
-{
-  // Fetch operands
-  const uint32_t ir = system->cpu.registers[IR];
-
-  const uint8_t z = (ir >> 21) & 0x1F;
-  const uint8_t x = (ir >> 16) & 0x1F;
-  const int32_t i = extendSign32(ir & 0xFFFF, 16);
-
-  // Execution of behavior
-  const int32_t valueX = system->cpu.registers[x];
-
-  if (i != 0)
-  {
-    if (z != 0)
-      system->cpu.registers[z] = valueX / i;
-
-    if (system->cpu.registers[z] == 0)
-      system->cpu.registers[SR] |= ZN_FLAG;
-    else
-      system->cpu.registers[SR] &= ~ZN_FLAG;
-  }
-
-  if (i == 0)
-    system->cpu.registers[SR] |= ZD_FLAG;
-  else
-    system->cpu.registers[SR] &= ~ZD_FLAG;
-
-  system->cpu.registers[SR] &= ~OV_FLAG; // OV
-
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[200] = {0};
-
-  sprintf(instruction, "divi %s,%s,%i",
-          formatRegisterName(z, true), formatRegisterName(x, true), i);
-  sprintf(additionalInfo, "%s=%s/0x%08X=0x%08X,SR=0x%08X",
-          formatRegisterName(z, false), formatRegisterName(x, false), i, system->cpu.registers[z], system->cpu.registers[SR]);
-
-  // Output
-  printInstruction(system->cpu.registers[PC], output, instruction, additionalInfo);
-
-  if (i == 0)
-    handleDivideByZero(system, output);
-}
-
-void modi(System *system, FILE *output)
-{
-  // Fetch operands
-  const uint32_t ir = system->cpu.registers[IR];
-
-  const uint8_t z = (ir >> 21) & 0x1F;
-  const uint8_t x = (ir >> 16) & 0x1F;
-  const int32_t i = extendSign32(ir & 0xFFFF, 16);
-
-  // Execution of behavior
-  const int32_t valueX = system->cpu.registers[x];
-
-  if (z != 0)
-    system->cpu.registers[z] = valueX % i;
-
-  if (system->cpu.registers[z] == 0)
-    system->cpu.registers[SR] |= ZN_FLAG;
-  else
-    system->cpu.registers[SR] &= ~ZN_FLAG;
-
-  if (i == 0)
-    system->cpu.registers[SR] |= ZD_FLAG;
-  else
-    system->cpu.registers[SR] &= ~ZD_FLAG;
-
-  system->cpu.registers[SR] &= ~OV_FLAG;
-
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[200] = {0};
-
-  sprintf(instruction, "modi %s,%s,%i",
-          formatRegisterName(z, true), formatRegisterName(x, true), i);
-  sprintf(additionalInfo, "%s=%s%%0x%08X=0x%08X,SR=0x%08X", formatRegisterName(z, false), formatRegisterName(x, false), i, system->cpu.registers[z], system->cpu.registers[SR]);
-
-  // Output
-  printInstruction(system->cpu.registers[PC], output, instruction, additionalInfo);
-
-  if (i == 0)
-    handleDivideByZero(system, output);
-}
-
-void cmpi(CPU *cpu, FILE *output)
-{
-  // Fetch operands
-  const uint32_t ir = cpu->registers[IR];
-
-  const uint8_t x = (ir >> 16) & 0x1F;
-  const int64_t i = extendSign64(ir & 0xFFFF, 16);
-
-  // Execution of behavior
-  const uint64_t valueX = (uint64_t)cpu->registers[x];
-  const uint64_t result = valueX - (uint64_t)i;
-
-  if (result == 0)
-    cpu->registers[SR] |= ZN_FLAG;
-  else
-    cpu->registers[SR] &= ~ZN_FLAG;
-
-  if ((result & 0x80000000))
-    cpu->registers[SR] |= SN_FLAG;
-  else
-    cpu->registers[SR] &= ~SN_FLAG;
-
-  if ((valueX & 0x80000000) != (i & 0x80000000) &&
-      ((result & 0x80000000) != (valueX & 0x80000000)))
-    cpu->registers[SR] |= OV_FLAG;
-  else
-    cpu->registers[SR] &= ~OV_FLAG;
-
-  if (result > 0xFFFFFFFF)
-    cpu->registers[SR] |= CY_FLAG;
-  else
-    cpu->registers[SR] &= ~CY_FLAG;
-
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[50] = {0};
-
-  sprintf(instruction, "cmpi %s,%ld", formatRegisterName(x, true), i);
-  sprintf(additionalInfo, "SR=0x%08X", cpu->registers[SR]);
-
-  // Output
-  printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
-}
-
-/******************************************************
- * Flow Control Operations
- *******************************************************/
-
-void bae(System *system, FILE *output)
-{
-  // Fetch operands
-  const int32_t i = extendSign32(system->cpu.registers[IR] & 0x03FFFFFF, 26);
-
-  // Execution of behavior
-  const uint32_t oldPC = system->cpu.registers[PC];
-  if (!isCYSet(&system->cpu))
-  {
-    system->control.pcAlreadyIncremented = true;
-    system->cpu.registers[PC] = system->cpu.registers[PC] + 4 + (i << 2);
-  }
-
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[30] = {0};
-
-  sprintf(instruction, "bae %i", i);
-  sprintf(additionalInfo, "PC=0x%08X", isCYSet(&system->cpu) ? system->cpu.registers[PC] + 4 : system->cpu.registers[PC]);
-
-  // Output
-  printInstruction(oldPC, output, instruction, additionalInfo);
-}
-
-void bat(System *system, FILE *output)
-{
-  // Fetch operands
-  const int32_t i = extendSign32(system->cpu.registers[IR] & 0x03FFFFFF, 26);
-
-  // Execution of behavior
-  const uint32_t oldPC = system->cpu.registers[PC];
-  if (!isZNSet(&system->cpu) && !isCYSet(&system->cpu))
-  {
-    system->control.pcAlreadyIncremented = true;
-    system->cpu.registers[PC] = system->cpu.registers[PC] + 4 + (i << 2);
-  }
-
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[30] = {0};
-
-  sprintf(instruction, "bat %i", i);
-  sprintf(additionalInfo, "PC=0x%08X", isZNSet(&system->cpu) || isCYSet(&system->cpu) ? system->cpu.registers[PC] + 4 : system->cpu.registers[PC]);
-
-  // Output
-  printInstruction(oldPC, output, instruction, additionalInfo);
-}
-
-void bbe(System *system, FILE *output)
-{
-  // Fetch operands
-  const int32_t i = extendSign32(system->cpu.registers[IR] & 0x03FFFFFF, 26);
-
-  // Execution of behavior
-  const uint32_t oldPC = system->cpu.registers[PC];
-  if (isZNSet(&system->cpu) || isCYSet(&system->cpu))
-  {
-    system->control.pcAlreadyIncremented = true;
-    system->cpu.registers[PC] = system->cpu.registers[PC] + 4 + (i << 2);
-  }
-
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[30] = {0};
-
-  sprintf(instruction, "bbe %i", i);
-  sprintf(additionalInfo, "PC=0x%08X", !isZNSet(&system->cpu) && !isCYSet(&system->cpu) ? system->cpu.registers[PC] + 4 : system->cpu.registers[PC]);
-
-  // Output
-  printInstruction(oldPC, output, instruction, additionalInfo);
-}
-
-void bbt(System *system, FILE *output)
-{
-  // Fetch operands
-  const int32_t i = extendSign32(system->cpu.registers[IR] & 0x03FFFFFF, 26);
-
-  // Execution of behavior
-  const uint32_t oldPC = system->cpu.registers[PC];
-  if (isCYSet(&system->cpu))
-  {
-    system->control.pcAlreadyIncremented = true;
-    system->cpu.registers[PC] = system->cpu.registers[PC] + 4 + (i << 2);
-  }
-
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[30] = {0};
-
-  sprintf(instruction, "bbt %i", i);
-  sprintf(additionalInfo, "PC=0x%08X", !isCYSet(&system->cpu) ? system->cpu.registers[PC] + 4 : system->cpu.registers[PC]);
-
-  // Output
-  printInstruction(oldPC, output, instruction, additionalInfo);
-}
-
-void beq(System *system, FILE *output)
-{
-  // Fetch operands
-  const int32_t i = extendSign32(system->cpu.registers[IR] & 0x03FFFFFF, 26);
-
-  // Execution of behavior
-  const uint32_t oldPC = system->cpu.registers[PC];
-  if (isZNSet(&system->cpu))
-  {
-    system->control.pcAlreadyIncremented = true;
-    system->cpu.registers[PC] = system->cpu.registers[PC] + 4 + (i << 2);
-  }
-
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[30] = {0};
-
-  sprintf(instruction, "beq %i", i);
-  sprintf(additionalInfo, "PC=0x%08X", !isZNSet(&system->cpu) ? system->cpu.registers[PC] + 4 : system->cpu.registers[PC]);
-
-  // Output
-  printInstruction(oldPC, output, instruction, additionalInfo);
-}
-
-void bge(System *system, FILE *output)
-{
-  // Fetch operands
-  const int32_t i = extendSign32(system->cpu.registers[IR] & 0x03FFFFFF, 26);
-
-  // Execution of behavior
-  const uint32_t oldPC = system->cpu.registers[PC];
-  if (isSNSet(&system->cpu) == isOVSet(&system->cpu))
-  {
-    system->control.pcAlreadyIncremented = true;
-    system->cpu.registers[PC] = system->cpu.registers[PC] + 4 + (i << 2);
-  }
-
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[30] = {0};
-
-  sprintf(instruction, "bge %i", i);
-  sprintf(additionalInfo, "PC=0x%08X",
-          isSNSet(&system->cpu) != isOVSet(&system->cpu) ? system->cpu.registers[PC] + 4 : system->cpu.registers[PC]);
-
-  // Output
-  printInstruction(oldPC, output, instruction, additionalInfo);
-}
-
-void bgt(System *system, FILE *output)
-{
-  // Fetch operands
-  const int32_t i = extendSign32(system->cpu.registers[IR] & 0x03FFFFFF, 26);
+  clock_gettime(CLOCK_MONOTONIC, &end);
 
-  // Execution of behavior
-  const uint32_t oldPC = system->cpu.registers[PC];
-  if (!isZNSet(&system->cpu) && (isSNSet(&system->cpu) == isOVSet(&system->cpu)))
-  {
-    system->control.pcAlreadyIncremented = true;
-    system->cpu.registers[PC] = system->cpu.registers[PC] + 4 + (i << 2);
-  }
+  if (stats)
+    printStats(poxim_instructions(system), (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9, stderr);
 
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[30] = {0};
+  poxim_write_reports(system);
 
-  sprintf(instruction, "bgt %i", i);
-  sprintf(additionalInfo, "PC=0x%08X", isZNSet(&system->cpu) || (isSNSet(&system->cpu) != isOVSet(&system->cpu)) ? system->cpu.registers[PC] + 4 : system->cpu.registers[PC]);
+  poxim_destroy(system);
 
-  // Output
-  printInstruction(oldPC, output, instruction, additionalInfo);
+  return status;
 }
 
-void biv(System *system, FILE *output)
+/******************************************************
+ * Utility Functions
+ *******************************************************/
+
+// Decimal digits only, from minimum to maximum; the simulator's options
+// follow the same rule
+bool parseCount(const char *text, uint64_t minimum, uint64_t maximum, uint64_t *value)
 {
-  // Fetch operands
-  const int32_t i = extendSign32(system->cpu.registers[IR] & 0x03FFFFFF, 26);
+  char *end;
 
-  // Execution of behavior
-  const uint32_t oldPC = system->cpu.registers[PC];
-  if (isIVSet(&system->cpu))
-  {
-    system->control.pcAlreadyIncremented = true;
-    system->cpu.registers[PC] = system->cpu.registers[PC] + 4 + (i << 2);
-  }
+  errno = 0;
+  const uint64_t parsed = strtoull(text, &end, 10);
 
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[30] = {0};
+  if (!isdigit((unsigned char)text[0]) || *end != '\0' || errno != 0 || parsed < minimum || parsed > maximum)
+    return false;
 
-  sprintf(instruction, "biv %i", i);
-  sprintf(additionalInfo, "PC=0x%08X", !isIVSet(&system->cpu) ? system->cpu.registers[PC] + 4 : system->cpu.registers[PC]);
+  *value = parsed;
 
-  // Output
-  printInstruction(oldPC, output, instruction, additionalInfo);
+  return true;
 }
 
-void ble(System *system, FILE *output)
+char *readFile(FILE *input, size_t *length)
 {
-  // Fetch operands
-  const int32_t i = extendSign32(system->cpu.registers[IR] & 0x03FFFFFF, 26);
+  size_t capacity = 4096;
+  char *data = (char *)malloc(capacity);
+  *length = 0;
 
-  // Execution of behavior
-  const uint32_t oldPC = system->cpu.registers[PC];
-  if (isZNSet(&system->cpu) || (isSNSet(&system->cpu) != isOVSet(&system->cpu)))
+  while (data != NULL)
   {
-    system->control.pcAlreadyIncremented = true;
-    system->cpu.registers[PC] = system->cpu.registers[PC] + 4 + (i << 2);
-  }
+    *length += fread(data + *length, 1, capacity - *length, input);
 
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[30] = {0};
+    if (*length < capacity)
+      return data;
 
-  sprintf(instruction, "ble %i", i);
-  sprintf(additionalInfo, "PC=0x%08X", !isZNSet(&system->cpu) && (isSNSet(&system->cpu) == isOVSet(&system->cpu)) ? system->cpu.registers[PC] + 4 : system->cpu.registers[PC]);
+    capacity *= 2;
+    data = (char *)realloc(data, capacity);
+  }
 
-  // Output
-  printInstruction(oldPC, output, instruction, additionalInfo);
+  fprintf(stderr, "Failed to allocate memory for input.\n");
+  exit(EXIT_FAILURE);
 }
 
-void blt(System *system, FILE *output)
+// Inputs named *.s are assembled in process instead of parsed as .hex text
+bool isAssembly(const char *path)
 {
-  // Fetch operands
-  const int32_t i = extendSign32(system->cpu.registers[IR] & 0x03FFFFFF, 26);
+  const size_t length = strlen(path);
 
-  // Execution of behavior
-  const uint32_t oldPC = system->cpu.registers[PC];
-  if (isSNSet(&system->cpu) != isOVSet(&system->cpu))
-  {
-    system->control.pcAlreadyIncremented = true;
-    system->cpu.registers[PC] = system->cpu.registers[PC] + 4 + (i << 2);
-  }
+  return length > 2 && strcmp(path + length - 2, ".s") == 0;
+}
 
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[30] = {0};
+void writeTraceLine(void *context, const char *line)
+{
+  // Screen output formatting
+  printf("%s\n", line);
 
-  sprintf(instruction, "blt %i", i);
-  sprintf(additionalInfo, "PC=0x%08X", isSNSet(&system->cpu) == isOVSet(&system->cpu) ? system->cpu.registers[PC] + 4 : system->cpu.registers[PC]);
+  // Output formatting to file
+  fprintf((FILE *)context, "%s\n", line);
+}
 
-  // Output
-  printInstruction(oldPC, output, instruction, additionalInfo);
+// Screen output is left to the single program mode
+void writeFileTraceLine(void *context, const char *line)
+{
+  fprintf((FILE *)context, "%s\n", line);
 }
 
-void bne(System *system, FILE *output)
+void writeTerminalStream(void *context, const char *data, size_t length)
 {
-  // Fetch operands
-  const int32_t i = extendSign32(system->cpu.registers[IR] & 0x03FFFFFF, 26);
+  TerminalOutput *output = (TerminalOutput *)context;
 
-  // Execution of behavior
-  const uint32_t oldPC = system->cpu.registers[PC];
-  if (!isZNSet(&system->cpu))
-  {
-    system->control.pcAlreadyIncremented = true;
-    system->cpu.registers[PC] = system->cpu.registers[PC] + 4 + (i << 2);
-  }
+  fwrite(data, sizeof(char), length, output->file);
+  fflush(output->file);
 
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[30] = {0};
+  output->last = data[length - 1];
+}
 
-  sprintf(instruction, "bne %i", i);
-  sprintf(additionalInfo, "PC=0x%08X", isZNSet(&system->cpu) ? system->cpu.registers[PC] + 4 : system->cpu.registers[PC]);
+// Returns what one read gives, so interactive input reaches the guest a line
+// at a time while files fill the whole buffer
+size_t readTerminalFile(void *context, char *data, size_t capacity)
+{
+  const ssize_t count = read(*(int *)context, data, capacity);
 
-  // Output
-  printInstruction(oldPC, output, instruction, additionalInfo);
+  return (count > 0) ? (size_t)count : 0;
 }
 
-void bni(System *system, FILE *output)
+// Loads and runs one program, writing its trace and terminal to outputPath
+// (and to the screen when screen is set); terminal output goes to terminal
+// instead when there is one, and terminal input comes from the terminalInput
+// descriptor unless it is -1
+bool runProgram(PoximSystem *system, const char *inputPath, const char *outputPath, bool trace, bool screen, TerminalOutput *terminal,
+                int terminalInput)
 {
-  // Fetch operands
-  const int32_t i = extendSign32(system->cpu.registers[IR] & 0x03FFFFFF, 26);
+  FILE *output = startProgram(system, inputPath, NULL, outputPath, trace, screen);
+  if (output == NULL)
+    return false;
 
-  // Execution of behavior
-  const uint32_t oldPC = system->cpu.registers[PC];
-  if (!isIVSet(&system->cpu))
-  {
-    system->control.pcAlreadyIncremented = true;
-    system->cpu.registers[PC] = system->cpu.registers[PC] + 4 + (i << 2);
-  }
+  if (terminal != NULL)
+    poxim_set_terminal(system, writeTerminalStream, terminal);
+
+  if (terminalInput >= 0)
+    poxim_set_input(system, readTerminalFile, &terminalInput);
 
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[30] = {0};
+  poxim_run(system, 0);
 
-  sprintf(instruction, "bni %i", i);
-  sprintf(additionalInfo, "PC=0x%08X", isIVSet(&system->cpu) ? system->cpu.registers[PC] + 4 : system->cpu.registers[PC]);
+  // Keep the end marker on a line of its own
+  if (terminal != NULL && terminal->file == stdout && terminal->last != 0 && terminal->last != '\n')
+    putchar('\n');
 
-  // Output
-  printInstruction(oldPC, output, instruction, additionalInfo);
+  finishProgram(system, output, screen);
+
+  return true;
 }
 
-void bnz(System *system, FILE *output)
+// Loads a program, from its shared image when there is one, and opens its
+// output; returns NULL when either fails
+FILE *startProgram(PoximSystem *system, const char *inputPath, PoximImage *image, const char *outputPath, bool trace, bool screen)
 {
-  // Fetch operands
-  const int32_t i = extendSign32(system->cpu.registers[IR] & 0x03FFFFFF, 26);
-
-  // Execution of behavior
-  const uint32_t oldPC = system->cpu.registers[PC];
-  if (!isZDSet(&system->cpu))
-  {
-    system->control.pcAlreadyIncremented = true;
-    system->cpu.registers[PC] = system->cpu.registers[PC] + 4 + (i << 2);
-  }
+  if (image != NULL)
+    poxim_load_image(system, image);
+  else if (!loadProgram(system, inputPath))
+    return NULL;
 
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[30] = {0};
+  // Output file
+  FILE *output = fopen(outputPath, "w");
+  if (output == NULL)
+    return NULL;
 
-  sprintf(instruction, "bnz %i", i);
-  sprintf(additionalInfo, "PC=0x%08X", isZDSet(&system->cpu) ? system->cpu.registers[PC] + 4 : system->cpu.registers[PC]);
+  beginProgram(system, output, trace, screen);
 
-  // Output
-  printInstruction(oldPC, output, instruction, additionalInfo);
+  return output;
 }
 
-void bzd(System *system, FILE *output)
+// Loads a .hex or .s file into memory; returns false when it cannot be read
+// or does not assemble or fit
+bool loadProgram(PoximSystem *system, const char *inputPath)
 {
-  // Fetch operands
-  const int32_t i = extendSign32(system->cpu.registers[IR] & 0x03FFFFFF, 26);
+  // Input file
+  FILE *input = fopen(inputPath, "r");
+  if (input == NULL)
+    return false;
 
-  // Execution of behavior
-  const uint32_t oldPC = system->cpu.registers[PC];
-  if (isZDSet(&system->cpu))
-  {
-    system->control.pcAlreadyIncremented = true;
-    system->cpu.registers[PC] = system->cpu.registers[PC] + 4 + (i << 2);
-  }
+  size_t length;
+  char *program = readFile(input, &length);
+  fclose(input);
 
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[30] = {0};
+  const bool assembly = isAssembly(inputPath);
+  const bool loaded = assembly ? poxim_load_asm(system, program, length) : poxim_load_hex(system, program, length);
+  free(program);
 
-  sprintf(instruction, "bzd %i", i);
-  sprintf(additionalInfo, "PC=0x%08X", !isZDSet(&system->cpu) ? system->cpu.registers[PC] + 4 : system->cpu.registers[PC]);
+  if (!loaded)
+    fprintf(stderr, assembly ? "Failed to assemble %s\n" : "Program does not fit in memory: %s\n", inputPath);
 
-  // Output
-  printInstruction(oldPC, output, instruction, additionalInfo);
+  return loaded;
 }
 
-void bun(System *system, FILE *output)
+// Installs the trace on output and writes the start marker
+void beginProgram(PoximSystem *system, FILE *output, bool trace, bool screen)
 {
-  // Fetch operands
-  const int32_t i = extendSign32(system->cpu.registers[IR] & 0x03FFFFFF, 26);
+  PoximTraceCallback writeLine = screen ? writeTraceLine : writeFileTraceLine;
 
-  // Execution of behavior
-  system->control.pcAlreadyIncremented = true;
-  const uint32_t oldPC = system->cpu.registers[PC];
-  system->cpu.registers[PC] = system->cpu.registers[PC] + 4 + (i << 2);
+  if (trace)
+    poxim_set_trace(system, writeLine, output);
 
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[30] = {0};
-
-  sprintf(instruction, "bun %i", i);
-  sprintf(additionalInfo, "PC=0x%08X", system->cpu.registers[PC]);
-
-  // Output
-  printInstruction(oldPC, output, instruction, additionalInfo);
+  writeLine(output, "[START OF SIMULATION]");
 }
 
-/******************************************************
- * Memory read/write operations
- *******************************************************/
-
-void l8(System *system, FILE *output)
+// Writes the terminal contents, the limit or fault that stopped the program
+// if any and the end marker, and closes the output; returns how the program
+// stopped
+PoximStatus finishProgram(PoximSystem *system, FILE *output, bool screen)
 {
-  // Fetch operands
-  const uint32_t ir = system->cpu.registers[IR];
-
-  const uint8_t z = (ir >> 21) & 0x1F;
-  const uint8_t x = (ir >> 16) & 0x1F;
-  const uint16_t i = ir & 0xFFFF;
+  PoximTraceCallback writeLine = screen ? writeTraceLine : writeFileTraceLine;
 
-  // Execution of behavior
-  const uint32_t memoryAddress = (x != 0) ? system->cpu.registers[x] + i : i;
+  // Terminal
+  size_t terminalLength;
+  const char *terminal = poxim_terminal(system, &terminalLength);
 
-  if (z != 0)
+  if (terminalLength > 0)
   {
-    switch (memoryAddress)
+    if (screen)
     {
-    case TERMINAL_IN_ADDRESS:
-      system->cpu.registers[z] = (system->terminal.registers >> 8) & 0x000000FF;
-      break;
-    case FPU_REGISTER_X_ADDR:
-      system->cpu.registers[z] = system->fpu.registers.x.u;
-      break;
-    case FPU_REGISTER_Y_ADDR:
-      system->cpu.registers[z] = system->fpu.registers.y.u;
-      break;
-    case FPU_REGISTER_Z_ADDR:
-      system->cpu.registers[z] = system->fpu.registers.z.u;
-      break;
-    case FPU_REGISTER_CONTROL_ADDR:
-      system->cpu.registers[z] = system->fpu.registers.control;
-      break;
-    default:
-      if (memoryAddress == FPU_REGISTER_CONTROL_ADDR_OTHER)
-        system->cpu.registers[z] = system->fpu.registers.control;
-      else if (memoryAddress < (NUM_REGISTERS * 1024))
-        system->cpu.registers[z] = system->memory[memoryAddress];
+      printf("[TERMINAL]\n");
+      printf("%.*s\n", (int)terminalLength, terminal);
     }
-  }
-
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[100] = {0};
 
-  sprintf(instruction, "l8 %s,[%s%s%i]", formatRegisterName(z, true), formatRegisterName(x, true), (i >= 0) ? ("+") : (""), i);
-  sprintf(additionalInfo, "%s=MEM[0x%08X]=0x%02X", formatRegisterName(z, false), memoryAddress, system->cpu.registers[z]);
-
-  // Output
-  printInstruction(system->cpu.registers[PC], output, instruction, additionalInfo);
-}
+    fprintf(output, "[TERMINAL]\n");
+    fprintf(output, "%.*s\n", (int)terminalLength, terminal);
+  }
 
-void l16(System *system, FILE *output)
-{
-  // Fetch operands
-  const uint32_t ir = system->cpu.registers[IR];
+  const PoximStatus status = poxim_status(system);
 
-  const uint8_t z = (ir >> 21) & 0x1F;
-  const uint8_t x = (ir >> 16) & 0x1F;
-  const uint16_t i = ir & 0xFFFF;
+  if (status == POXIM_INSTRUCTION_LIMIT)
+    writeLine(output, "[INSTRUCTION LIMIT REACHED]");
+  else if (status == POXIM_TRACE_LIMIT)
+    writeLine(output, "[TRACE LIMIT REACHED]");
+  else if (status == POXIM_TIME_LIMIT)
+    writeLine(output, "[TIME LIMIT REACHED]");
+  else if (status == POXIM_MEMORY_FAULT)
+    writeLine(output, "[MEMORY FAULT]");
 
-  // Execution of behavior
-  const uint32_t memoryAddress = (x != 0) ? ((system->cpu.registers[x] + i) << 1) : i << 1;
+  writeLine(output, "[END OF SIMULATION]");
 
-  if (z != 0 && memoryAddress < (NUM_REGISTERS * 1024))
-    system->cpu.registers[z] = ((system->memory[memoryAddress] << 24) |
-                                (system->memory[memoryAddress + 1] << 16));
+  fclose(output);
 
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[100] = {0};
+  return status;
+}
 
-  sprintf(instruction, "l16 %s,[%s%s%i]", formatRegisterName(z, true), formatRegisterName(x, true), (i >= 0) ? ("+") : (""), i);
-  sprintf(additionalInfo, "%s=MEM[0x%08X]=0x%04X", formatRegisterName(z, false), memoryAddress, system->cpu.registers[z] >> 16);
+int exitStatus(PoximStatus status)
+{
+  if (status == POXIM_HALTED || status == POXIM_RUNNING)
+    return 0;
 
-  // Output
-  printInstruction(system->cpu.registers[PC], output, instruction, additionalInfo);
+  return (status == POXIM_MEMORY_FAULT) ? FAULT_EXIT_STATUS : LIMIT_EXIT_STATUS;
 }
 
-void l32(System *system, FILE *output)
+void printStats(uint64_t instructions, double seconds, FILE *output)
 {
-  // Fetch operands
-  const uint32_t ir = system->cpu.registers[IR];
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
 
-  const uint8_t z = (ir >> 21) & 0x1F;
-  const uint8_t x = (ir >> 16) & 0x1F;
-  const uint16_t i = ir & 0xFFFF;
+  fprintf(output, "[STATS]\n");
+  fprintf(output, "Instructions: %" PRIu64 "\n", instructions);
+  fprintf(output, "Seconds: %.6f\n", seconds);
+  fprintf(output, "MIPS: %.3f\n", seconds > 0 ? instructions / seconds / 1e6 : 0.0);
+  fprintf(output, "Peak RSS: %ld KiB\n", usage.ru_maxrss);
+}
 
-  // Execution of behavior
-  const uint32_t memoryAddress = (x != 0) ? ((system->cpu.registers[x] + i) << 2) : i << 2;
+/******************************************************
+ * Batch mode
+ *******************************************************/
 
-  if (z != 0)
+// One "<input> <output>" pair per line; blank lines and # comments are skipped
+bool readManifest(const char *path, Batch *batch)
+{
+  FILE *manifest = fopen(path, "r");
+  if (manifest == NULL)
   {
-    switch (memoryAddress)
-    {
-    case FPU_REGISTER_X_ADDR:
-      system->cpu.registers[z] = system->fpu.registers.x.u;
-      break;
-    case FPU_REGISTER_Y_ADDR:
-      system->cpu.registers[z] = system->fpu.registers.y.u;
-      break;
-    case FPU_REGISTER_Z_ADDR:
-      system->cpu.registers[z] = system->fpu.registers.z.u;
-      break;
-    case FPU_REGISTER_CONTROL_ADDR:
-      system->cpu.registers[z] = system->fpu.registers.control;
-      break;
-    default:
-      if (memoryAddress == FPU_REGISTER_CONTROL_ADDR_OTHER)
-        system->cpu.registers[z] = system->fpu.registers.control;
-      else if (memoryAddress < (NUM_REGISTERS * 1024))
-        system->cpu.registers[z] = readMemory32(system, memoryAddress);
-    }
+    fprintf(stderr, "Failed to open %s.\n", path);
+    return false;
   }
 
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[100] = {0};
-
-  sprintf(instruction, "l32 %s,[%s%s%i]", formatRegisterName(z, true), formatRegisterName(x, true), (i >= 0) ? ("+") : (""), i);
-  sprintf(additionalInfo, "%s=MEM[0x%08X]=0x%08X", formatRegisterName(z, false), memoryAddress, system->cpu.registers[z]);
-
-  // Output
-  printInstruction(system->cpu.registers[PC], output, instruction, additionalInfo);
-}
-
-void s8(System *system, FILE *output)
-{
-  // Fetch operands
-  const uint32_t ir = system->cpu.registers[IR];
+  size_t capacity = 0;
+  char *line = NULL;
+  size_t lineCapacity = 0;
 
-  const uint8_t z = (ir >> 21) & 0x1F;
-  const uint8_t x = (ir >> 16) & 0x1F;
-  const uint16_t i = ir & 0xFFFF;
+  while (getline(&line, &lineCapacity, manifest) != -1)
+  {
+    char *input = strtok(line, " \t\r\n");
+    if (input == NULL || input[0] == '#')
+      continue;
 
-  // Execution of behavior
-  const uint32_t memoryAddress = (x != 0) ? system->cpu.registers[x] + i : i;
-  const bool fpuControlST = getFPUControlSTField(&system->fpu);
-  const uint8_t valueRegisterZ = system->cpu.registers[z];
+    char *output = strtok(NULL, " \t\r\n");
+    if (output == NULL)
+    {
+      fprintf(stderr, "Missing output for %s in %s.\n", input, path);
+      free(line);
+      fclose(manifest);
+      return false;
+    }
 
-  switch (memoryAddress)
-  {
-  case TERMINAL_OUT_ADDRESS:
-    system->terminal.registers &= 0xFFFFFF00; // CLEAN OUT
-    system->terminal.registers |= valueRegisterZ;
-
-    addToBuffer(&system->terminal.buffer, valueRegisterZ);
-    break;
-  case FPU_REGISTER_X_ADDR:
-    system->fpu.registers.x.f = (float)valueRegisterZ;
-    system->fpu.registers.x.u = valueRegisterZ;
-    break;
-  case FPU_REGISTER_Y_ADDR:
-    system->fpu.registers.y.f = (float)valueRegisterZ;
-    system->fpu.registers.y.u = valueRegisterZ;
-    break;
-  case FPU_REGISTER_Z_ADDR:
-    system->fpu.registers.z.f = (float)valueRegisterZ;
-    system->fpu.registers.z.u = valueRegisterZ;
-    break;
-  case FPU_REGISTER_CONTROL_ADDR:
-    system->fpu.registers.control = valueRegisterZ;
-    setFPUControlSTField(&system->fpu, fpuControlST);
-    break;
-  default:
-    if (memoryAddress == FPU_REGISTER_CONTROL_ADDR_OTHER)
+    if (batch->jobCount == capacity)
     {
-      system->fpu.registers.control = valueRegisterZ;
-      setFPUControlSTField(&system->fpu, fpuControlST);
+      capacity = (capacity == 0) ? 64 : 2 * capacity;
+      batch->jobs = (BatchJob *)realloc(batch->jobs, capacity * sizeof(BatchJob));
+
+      if (batch->jobs == NULL)
+      {
+        fprintf(stderr, "Failed to allocate memory for batch.\n");
+        exit(EXIT_FAILURE);
+      }
     }
-    else if (memoryAddress < (NUM_REGISTERS * 1024))
-      system->memory[memoryAddress] = valueRegisterZ;
-  }
 
-  // Instruction formatting
-  char instruction[50] = {0};
-  char additionalInfo[200] = {0};
+    batch->jobs[batch->jobCount].input = strdup(input);
+    batch->jobs[batch->jobCount].output = strdup(output);
+    batch->jobs[batch->jobCount].image = NULL;
+    batch->jobCount++;
+  }
 
-  sprintf(instruction, "s8 [%s%s%i],%s", formatRegisterName(x, true), (i >= 0) ? ("+") : (""), i, formatRegisterName(z, true));
-  sprintf(additionalInfo, "MEM[0x%08X]=%s=0x%02X", memoryAddress, formatRegisterName(z, false), valueRegisterZ);
+  free(line);
+  fclose(manifest);
 
-  // Output
-  printInstruction(system->cpu.registers[PC], output, instruction, additionalInfo);
+  return true;
 }
 
-void s16(System *system, FILE *output)
+PoximImage *readImage(const char *path)
 {
-  // Fetch operands
-  const uint32_t ir = system->cpu.registers[IR];
-
-  const uint8_t z = (ir >> 21) & 0x1F;
-  const uint8_t x = (ir >> 16) & 0x1F;
-  const uint16_t i = ir & 0xFFFF;
+  FILE *input = fopen(path, "r");
+  if (input == NULL)
+    return NULL;
 
-  // Execution of behavior
-  const uint32_t memoryAddress = (x != 0) ? ((system->cpu.registers[x] + i) << 1) : i << 1;
-  if (memoryAddress < (NUM_REGISTERS * 1024))
-  {
-    system->memory[memoryAddress] = (system->cpu.registers[z] >> 24) & 0xFF;
-    system->memory[memoryAddress + 1] = (system->cpu.registers[z] >> 16) & 0xFF;
-  }
+  size_t length;
+  char *program = readFile(input, &length);
+  fclose(input);
 
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[100] = {0};
+  PoximImage *image = isAssembly(path) ? poxim_image_create_asm(program, length) : poxim_image_create_hex(program, length);
+  free(program);
 
-  sprintf(instruction, "s16 [%s%s%i],%s", formatRegisterName(x, true), (i >= 0) ? ("+") : (""), i, formatRegisterName(z, true));
-  sprintf(additionalInfo, "MEM[0x%08X]=%s=0x%04X", memoryAddress, formatRegisterName(z, false), system->cpu.registers[z] >> 16);
+  return image;
+}
 
-  // Output
-  printInstruction(system->cpu.registers[PC], output, instruction, additionalInfo);
+int compareJobInputs(const void *a, const void *b)
+{
+  return strcmp((*(BatchJob *const *)a)->input, (*(BatchJob *const *)b)->input);
 }
 
-void s32(System *system, FILE *output)
+// Parses every distinct input once; jobs running the same program then map
+// one image copy-on-write instead of reading and parsing the file again
+void createBatchImages(Batch *batch)
 {
-  // Fetch operands
-  const uint32_t ir = system->cpu.registers[IR];
+  BatchJob **sorted = (BatchJob **)malloc((batch->jobCount + 1) * sizeof(BatchJob *));
+  batch->images = (PoximImage **)malloc((batch->jobCount + 1) * sizeof(PoximImage *));
+  batch->imageCount = 0;
+
+  if (sorted == NULL || batch->images == NULL)
+  {
+    fprintf(stderr, "Failed to allocate memory for batch.\n");
+    exit(EXIT_FAILURE);
+  }
 
-  const uint8_t z = (ir >> 21) & 0x1F;
-  const uint8_t x = (ir >> 16) & 0x1F;
-  const uint16_t i = ir & 0xFFFF;
+  for (size_t i = 0; i < batch->jobCount; i++)
+    sorted[i] = &batch->jobs[i];
 
-  // Execution of behavior
-  const uint32_t memoryAddress = (x != 0) ? ((system->cpu.registers[x] + i) << 2) : i << 2;
+  qsort(sorted, batch->jobCount, sizeof(BatchJob *), compareJobInputs);
 
-  switch (memoryAddress)
+  for (size_t i = 0; i < batch->jobCount; i++)
   {
-  case WATCHDOG_ADDR:
-    system->watchdog.registers = system->cpu.registers[z];
-    break;
-  case FPU_REGISTER_X_ADDR:
-    system->fpu.registers.x.f = (float)system->cpu.registers[z];
-    system->fpu.registers.x.u = system->cpu.registers[z];
-    break;
-  case FPU_REGISTER_Y_ADDR:
-    system->fpu.registers.y.f = (float)system->cpu.registers[z];
-    system->fpu.registers.y.u = system->cpu.registers[z];
-    break;
-  case FPU_REGISTER_Z_ADDR:
-    system->fpu.registers.z.f = (float)system->cpu.registers[z];
-    system->fpu.registers.z.u = system->cpu.registers[z];
-    break;
-  case FPU_REGISTER_CONTROL_ADDR:
-    system->fpu.registers.control = system->cpu.registers[z];
-    break;
-  default:
-    if (memoryAddress == FPU_REGISTER_CONTROL_ADDR_OTHER)
-      system->fpu.registers.control = system->cpu.registers[z];
-    else if (memoryAddress < (NUM_REGISTERS * 1024))
+    if (i > 0 && strcmp(sorted[i]->input, sorted[i - 1]->input) == 0)
+      sorted[i]->image = sorted[i - 1]->image;
+    else
     {
-      system->memory[memoryAddress + 0] = (system->cpu.registers[z] >> 24) & 0xFF;
-      system->memory[memoryAddress + 1] = (system->cpu.registers[z] >> 16) & 0xFF;
-      system->memory[memoryAddress + 2] = (system->cpu.registers[z] >> 8) & 0xFF;
-      system->memory[memoryAddress + 3] = (system->cpu.registers[z]) & 0xFF;
+      sorted[i]->image = readImage(sorted[i]->input);
+
+      if (sorted[i]->image != NULL)
+        batch->images[batch->imageCount++] = sorted[i]->image;
     }
   }
 
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[100] = {0};
-
-  sprintf(instruction, "s32 [%s%s%i],%s", formatRegisterName(x, true), (i >= 0) ? ("+") : (""), i, formatRegisterName(z, true));
-  sprintf(additionalInfo, "MEM[0x%08X]=%s=0x%08X", memoryAddress, formatRegisterName(z, false), system->cpu.registers[z]);
-
-  // Output
-  printInstruction(system->cpu.registers[PC], output, instruction, additionalInfo);
+  free(sorted);
 }
 
-/******************************************************
- * Subroutine call operation
- *******************************************************/
-
-void callf(System *system, FILE *output)
+// Next job for a worker: its own queue first, then the front of the others
+bool takeJob(Batch *batch, uint32_t worker, size_t *job)
 {
-  // Fetch operands
-  const uint32_t ir = system->cpu.registers[IR];
-
-  const uint8_t x = (ir >> 16) & 0x1F;
-  const int32_t i = extendSign32(ir & 0xFFFF, 16);
+  for (uint32_t i = 0; i < batch->workerCount; i++)
+  {
+    WorkQueue *queue = &batch->queues[(worker + i) % batch->workerCount];
+    bool found = false;
 
-  // Execution of behavior
-  system->control.pcAlreadyIncremented = true; // Prevent it from being incremented
-  const uint32_t oldPC = system->cpu.registers[PC];
-  const uint32_t oldSP = system->cpu.registers[SP];
+    pthread_mutex_lock(&queue->lock);
 
-  system->memory[system->cpu.registers[SP]] = ((system->cpu.registers[PC] + 4) >> 24) & 0xFF;
-  system->memory[system->cpu.registers[SP] + 1] = ((system->cpu.registers[PC] + 4) >> 16) & 0xFF;
-  system->memory[system->cpu.registers[SP] + 2] = ((system->cpu.registers[PC] + 4) >> 8) & 0xFF;
-  system->memory[system->cpu.registers[SP] + 3] = ((system->cpu.registers[PC] + 4) >> 0) & 0xFF;
+    if (queue->front < queue->back)
+    {
+      *job = (i == 0) ? queue->jobs[--queue->back] : queue->jobs[queue->front++];
+      found = true;
+    }
 
-  system->cpu.registers[PC] = (system->cpu.registers[x] + i) << 2;
-  system->cpu.registers[SP] -= 4;
+    pthread_mutex_unlock(&queue->lock);
 
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[42] = {0};
+    if (found)
+      return true;
+  }
 
-  sprintf(instruction, "call [%s%s%i]",
-          formatRegisterName(x, true), (i >= 0) ? ("+") : (""), i);
-  sprintf(additionalInfo, "PC=0x%08X,MEM[0x%08X]=0x%08X", system->cpu.registers[PC], oldSP, oldPC + 4);
+  // Nothing is ever queued after the start, so every queue stays empty
+  return false;
+}
 
-  // Output
-  printInstruction(oldPC, output, instruction, additionalInfo);
+void countJob(BatchWorker *worker, PoximStatus status)
+{
+  if (status == POXIM_MEMORY_FAULT)
+    worker->faulted++;
+  else if (status != POXIM_HALTED && status != POXIM_RUNNING)
+    worker->limited++;
 }
 
-void calls(System *system, FILE *output)
+void *runBatchWorker(void *argument)
 {
-  // Fetch operands
-  const int32_t i = extendSign32(system->cpu.registers[IR] & 0x03FFFFFF, 26);
+  BatchWorker *worker = (BatchWorker *)argument;
+  Batch *batch = worker->batch;
 
-  // Execution of behavior
-  system->control.pcAlreadyIncremented = true; // Prevent it from being incremented twice
+  // One system per worker, reset between jobs
+  PoximSystem *system = poxim_create(batch->optionCount, batch->options);
+  size_t job;
 
-  const uint32_t oldPC = system->cpu.registers[PC];
-  const uint32_t oldSP = system->cpu.registers[SP];
+  while (takeJob(batch, worker->index, &job))
+  {
+    poxim_reset(system);
 
-  system->memory[system->cpu.registers[SP]] = ((system->cpu.registers[PC] + 4) >> 24) & 0xFF;
-  system->memory[system->cpu.registers[SP] + 1] = ((system->cpu.registers[PC] + 4) >> 16) & 0xFF;
-  system->memory[system->cpu.registers[SP] + 2] = ((system->cpu.registers[PC] + 4) >> 8) & 0xFF;
-  system->memory[system->cpu.registers[SP] + 3] = ((system->cpu.registers[PC] + 4) >> 0) & 0xFF;
+    FILE *output = startProgram(system, batch->jobs[job].input, batch->jobs[job].image, batch->jobs[job].output, batch->trace, false);
 
-  system->cpu.registers[PC] = system->cpu.registers[PC] + 4 + (i << 2);
-  system->cpu.registers[SP] -= 4;
+    if (output != NULL)
+    {
+      poxim_run(system, 0);
+      worker->instructions += poxim_instructions(system);
 
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[100] = {0};
+      countJob(worker, finishProgram(system, output, false));
+    }
+    else
+    {
+      fprintf(stderr, "Failed to run %s.\n", batch->jobs[job].input);
+      worker->failures++;
+    }
+  }
 
-  sprintf(instruction, "call %i", i);
-  sprintf(additionalInfo, "PC=0x%08X,MEM[0x%08X]=0x%08X", system->cpu.registers[PC], oldSP, oldPC + 4);
+  poxim_destroy(system);
 
-  // Output
-  printInstruction(oldPC, output, instruction, additionalInfo);
+  return NULL;
 }
 
-void ret(System *system, FILE *output)
+// Loads the next job into a free slot; false when no job is left
+bool startResidentJob(Batch *batch, BatchWorker *worker, ResidentJob *slot)
 {
-  // Execution of behavior
-  system->control.pcAlreadyIncremented = true; // Prevent it from being incremented twice
+  while (takeJob(batch, worker->index, &slot->job))
+  {
+    poxim_reset(slot->system);
 
-  const uint32_t oldPC = system->cpu.registers[PC];
-  system->cpu.registers[SP] += 4;
-  system->cpu.registers[PC] = readMemory32(system, system->cpu.registers[SP]);
+    slot->output = startProgram(slot->system, batch->jobs[slot->job].input, batch->jobs[slot->job].image, batch->jobs[slot->job].output, batch->trace, false);
+    if (slot->output != NULL)
+      return true;
 
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[42] = {0};
+    fprintf(stderr, "Failed to run %s.\n", batch->jobs[slot->job].input);
+    worker->failures++;
+  }
 
-  sprintf(instruction, "ret");
-  sprintf(additionalInfo, "PC=MEM[0x%08X]=0x%08X", system->cpu.registers[SP], system->cpu.registers[PC]);
+  slot->output = NULL;
 
-  // Output
-  printInstruction(oldPC, output, instruction, additionalInfo);
+  return false;
 }
 
-void push(System *system, FILE *output)
+// Keeps up to batch->resident guests loaded and runs them round-robin, one
+// quantum each; a guest resumes exactly at the instruction where it stopped
+void *runInterleavedWorker(void *argument)
 {
-  // Fetch operands
-  const uint32_t ir = system->cpu.registers[IR];
+  BatchWorker *worker = (BatchWorker *)argument;
+  Batch *batch = worker->batch;
 
-  const uint32_t v = (ir >> 6) & 0x1F;
-  const uint32_t w = ir & 0x1F;
-  const uint32_t x = (ir >> 16) & 0x1F;
-  const uint32_t y = (ir >> 11) & 0x1F;
-  const uint32_t z = (ir >> 21) & 0x1F;
+  PoximPool *pool = poxim_pool_create(batch->resident, batch->optionCount, batch->options);
+  ResidentJob *slots = (ResidentJob *)calloc(batch->resident, sizeof(ResidentJob));
 
-  const uint32_t operands[] = {v, w, x, y, z};
+  if (slots == NULL)
+  {
+    fprintf(stderr, "Failed to allocate memory for batch.\n");
+    exit(EXIT_FAILURE);
+  }
 
-  // Execution of behavior
-  const uint32_t oldSP = system->cpu.registers[SP];
+  uint32_t active = 0;
 
-  for (uint8_t i = 0; i < 5; i++)
+  for (uint32_t i = 0; i < batch->resident; i++)
   {
-    const uint32_t operand = operands[i];
-    if (operand == 0)
-      break;
-
-    system->memory[system->cpu.registers[SP] + 0] = (system->cpu.registers[operand] >> 24) & 0xFF;
-    system->memory[system->cpu.registers[SP] + 1] = (system->cpu.registers[operand] >> 16) & 0xFF;
-    system->memory[system->cpu.registers[SP] + 2] = (system->cpu.registers[operand] >> 8) & 0xFF;
-    system->memory[system->cpu.registers[SP] + 3] = (system->cpu.registers[operand]) & 0xFF;
+    slots[i].system = poxim_pool_system(pool, i);
 
-    system->cpu.registers[SP] -= 4;
+    if (startResidentJob(batch, worker, &slots[i]))
+      active++;
   }
 
-  // Instruction formatting
-  char instruction[50] = {0};
-  char additionalInfo[300] = {0};
+  while (active > 0)
+  {
+    for (uint32_t i = 0; i < batch->resident; i++)
+    {
+      ResidentJob *slot = &slots[i];
 
-  char registerValues[100] = {0};
-  char registerLabels[100] = {0};
+      if (slot->output == NULL)
+        continue;
 
-  int tempInstruction = sprintf(instruction, "push %s", (operands[0] == 0) ? ("-") : (""));
-  int tempValues = sprintf(registerValues, "%s", "");
-  int tempLabels = sprintf(registerLabels, "%s", "");
+      poxim_run(slot->system, batch->quantum);
 
-  for (uint8_t i = 0; i < 5; i++)
-  {
-    const uint32_t operand = operands[i];
-    if (operand == 0)
-      break;
+      if (poxim_running(slot->system))
+        continue;
 
-    // Instruction
-    tempInstruction += sprintf(instruction + tempInstruction, "%s%s",
-                               (i > 0) ? (",") : (""), formatRegisterName(operand, true));
+      worker->instructions += poxim_instructions(slot->system);
 
-    // Register Values
-    tempValues += sprintf(registerValues + tempValues, "%s0x%08X",
-                          (i > 0) ? (",") : (""), system->cpu.registers[operand]);
+      countJob(worker, finishProgram(slot->system, slot->output, false));
 
-    // Register Labels
-    tempLabels += sprintf(registerLabels + tempLabels, "%s%s",
-                          (i > 0) ? (",") : (""), formatRegisterName(operand, false));
+      if (!startResidentJob(batch, worker, slot))
+        active--;
+    }
   }
 
-  sprintf(additionalInfo, "MEM[0x%08X]{%s}={%s}", oldSP, registerValues, registerLabels);
+  free(slots);
+  poxim_pool_destroy(pool);
 
-  // Output
-  printInstruction(system->cpu.registers[PC], output, instruction, additionalInfo);
+  return NULL;
 }
 
-void pop(System *system, FILE *output)
+// Runs jobs in groups of POXIM_LOCKSTEP_LANES; consecutive jobs of a sweep
+// over one program share its code, so their guests advance together. Only
+// untraced guests are vectorized, the rest run scalar inside the group.
+void *runLockstepWorker(void *argument)
 {
-  // Fetch operands
-  const uint32_t ir = system->cpu.registers[IR];
-
-  const uint32_t v = (ir >> 6) & 0x1F;
-  const uint32_t w = ir & 0x1F;
-  const uint32_t x = (ir >> 16) & 0x1F;
-  const uint32_t y = (ir >> 11) & 0x1F;
-  const uint32_t z = (ir >> 21) & 0x1F;
+  BatchWorker *worker = (BatchWorker *)argument;
+  Batch *batch = worker->batch;
 
-  const uint32_t operands[] = {v, w, x, y, z};
+  PoximPool *pool = poxim_pool_create(POXIM_LOCKSTEP_LANES, batch->optionCount, batch->options);
+  ResidentJob slots[POXIM_LOCKSTEP_LANES];
+  PoximSystem *systems[POXIM_LOCKSTEP_LANES];
+  uint32_t count;
 
-  // Execution of behavior
-  const uint32_t oldSP = system->cpu.registers[SP];
-  for (uint8_t i = 0; i < 5; i++)
+  do
   {
-    const uint32_t operand = operands[i];
-    if (operand == 0)
-      break;
-
-    system->cpu.registers[SP] += 4;
-    system->cpu.registers[operand] = readMemory32(system, system->cpu.registers[SP]);
-  }
-
-  // Instruction formatting
-  char instruction[50] = {0};
-  char additionalInfo[300] = {0};
-
-  char registerValues[100] = {0};
-  char registerLabels[100] = {0};
+    for (count = 0; count < POXIM_LOCKSTEP_LANES; count++)
+    {
+      slots[count].system = poxim_pool_system(pool, count);
 
-  int tempInstruction = sprintf(instruction, "pop %s", (operands[0] == 0) ? ("-") : (""));
-  int tempValues = sprintf(registerValues, "%s", "");
-  int tempLabels = sprintf(registerLabels, "%s", "");
+      if (!startResidentJob(batch, worker, &slots[count]))
+        break;
 
-  for (uint8_t i = 0; i < 5; i++)
-  {
-    const uint32_t operand = operands[i];
-    if (operand == 0)
-      break;
+      systems[count] = slots[count].system;
+    }
 
-    // Instruction
-    tempInstruction += sprintf(instruction + tempInstruction, "%s%s",
-                               (i > 0) ? (",") : (""), formatRegisterName(operand, true));
+    poxim_run_lockstep(systems, count, 0);
 
-    // Register Values
-    tempValues += sprintf(registerValues + tempValues, "%s0x%08X",
-                          (i > 0) ? (",") : (""), system->cpu.registers[operand]);
+    for (uint32_t i = 0; i < count; i++)
+    {
+      worker->instructions += poxim_instructions(slots[i].system);
 
-    // Register Labels
-    tempLabels += sprintf(registerLabels + tempLabels, "%s%s",
-                          (i > 0) ? (",") : (""), formatRegisterName(operand, false));
-  }
+      countJob(worker, finishProgram(slots[i].system, slots[i].output, false));
+    }
+  } while (count == POXIM_LOCKSTEP_LANES);
 
-  sprintf(additionalInfo, "{%s}=MEM[0x%08X]{%s}", registerLabels, oldSP, registerValues);
+  poxim_pool_destroy(pool);
 
-  // Output
-  printInstruction(system->cpu.registers[PC], output, instruction, additionalInfo);
+  return NULL;
 }
 
-/******************************************************
- * Iterruption
- *******************************************************/
-
-void reti(System *system, FILE *output)
+int runBatch(Batch *batch, bool stats)
 {
-  // Execution of behavior
-  system->control.pcAlreadyIncremented = true; // Prevent it from being incremented twice
-  const uint32_t oldPC = system->cpu.registers[PC];
+  if (batch->workerCount > batch->jobCount)
+    batch->workerCount = batch->jobCount > 0 ? batch->jobCount : 1;
 
-  system->cpu.registers[SP] += 4;
-  system->cpu.registers[IPC] = readMemory32(system, system->cpu.registers[SP]);
+  if (batch->resident > batch->jobCount)
+    batch->resident = batch->jobCount > 0 ? batch->jobCount : 1;
 
-  system->cpu.registers[SP] += 4;
-  system->cpu.registers[CR] = readMemory32(system, system->cpu.registers[SP]);
+  batch->queues = (WorkQueue *)calloc(batch->workerCount, sizeof(WorkQueue));
+  BatchWorker *workers = (BatchWorker *)calloc(batch->workerCount, sizeof(BatchWorker));
+  size_t *jobs = (size_t *)malloc((batch->jobCount + 1) * sizeof(size_t));
 
-  system->cpu.registers[SP] += 4;
-  system->cpu.registers[PC] = readMemory32(system, system->cpu.registers[SP]);
-
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[300] = {0};
-
-  sprintf(instruction, "reti");
-  sprintf(additionalInfo, "IPC=MEM[0x%08X]=0x%08X,CR=MEM[0x%08X]=0x%08X,PC=MEM[0x%08X]=0x%08X", system->cpu.registers[SP] - 8, system->cpu.registers[IPC], system->cpu.registers[SP] - 4, system->cpu.registers[CR], system->cpu.registers[SP], system->cpu.registers[PC]);
+  if (batch->queues == NULL || workers == NULL || jobs == NULL)
+  {
+    fprintf(stderr, "Failed to allocate memory for batch.\n");
+    exit(EXIT_FAILURE);
+  }
 
-  // Output
-  printInstruction(oldPC, output, instruction, additionalInfo);
-}
+  createBatchImages(batch);
 
-void cbr(CPU *cpu, FILE *output)
-{
-  // Fetch operands
-  const uint32_t ir = cpu->registers[IR];
+  // Contiguous slices, so that each worker starts on its own share
+  for (uint32_t i = 0; i < batch->workerCount; i++)
+  {
+    WorkQueue *queue = &batch->queues[i];
 
-  const uint8_t z = (ir >> 21) & 0x1F;
-  const uint8_t x = (ir >> 16) & 0x1F;
+    pthread_mutex_init(&queue->lock, NULL);
+    queue->jobs = jobs;
+    queue->front = batch->jobCount * i / batch->workerCount;
+    queue->back = batch->jobCount * (i + 1) / batch->workerCount;
 
-  // Execution of behavior
-  const uint32_t oldPC = cpu->registers[PC];
-  if (z != 0)
-    cpu->registers[z] &= ~(0x00000001 << x);
+    // The owner pops from the back, so store the slice reversed to run in order
+    for (size_t j = queue->front; j < queue->back; j++)
+      jobs[j] = queue->front + queue->back - 1 - j;
+  }
 
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[300] = {0};
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
 
-  sprintf(instruction, "cbr %s[%i]",
-          formatRegisterName(z, true), x);
-  sprintf(additionalInfo, "%s=0x%08X", formatRegisterName(z, false), cpu->registers[z]);
+  for (uint32_t i = 0; i < batch->workerCount; i++)
+  {
+    workers[i].batch = batch;
+    workers[i].index = i;
 
-  // Output
-  printInstruction(oldPC, output, instruction, additionalInfo);
-}
+    void *(*run)(void *) = batch->lockstep ? runLockstepWorker : batch->quantum > 0 ? runInterleavedWorker : runBatchWorker;
 
-void sbr(CPU *cpu, FILE *output)
-{
-  // Fetch operands
-  const uint32_t ir = cpu->registers[IR];
+    if (pthread_create(&workers[i].thread, NULL, run, &workers[i]) != 0)
+    {
+      fprintf(stderr, "Failed to start batch worker.\n");
+      exit(EXIT_FAILURE);
+    }
+  }
 
-  const uint8_t z = (ir >> 21) & 0x1F;
-  const uint8_t x = (ir >> 16) & 0x1F;
+  uint64_t instructions = 0;
+  uint32_t failures = 0;
+  uint32_t limited = 0;
+  uint32_t faulted = 0;
 
-  // Execution of behavior
-  const uint32_t oldPC = cpu->registers[PC];
-  if (z != 0)
-    cpu->registers[z] |= (0x00000001 << x);
+  for (uint32_t i = 0; i < batch->workerCount; i++)
+  {
+    pthread_join(workers[i].thread, NULL);
+    instructions += workers[i].instructions;
+    failures += workers[i].failures;
+    limited += workers[i].limited;
+    faulted += workers[i].faulted;
+  }
 
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[300] = {0};
+  clock_gettime(CLOCK_MONOTONIC, &end);
 
-  sprintf(instruction, "sbr %s[%i]",
-          formatRegisterName(z, true), x);
-  sprintf(additionalInfo, "%s=0x%08X", formatRegisterName(z, false), cpu->registers[z]);
+  if (stats)
+  {
+    printStats(instructions, (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9, stderr);
+    fprintf(stderr, "Jobs: %zu (%u failed, %u stopped by a limit, %u faulted) on %u workers\n", batch->jobCount, failures, limited, faulted, batch->workerCount);
+  }
 
-  // Output
-  printInstruction(oldPC, output, instruction, additionalInfo);
-}
+  for (uint32_t i = 0; i < batch->workerCount; i++)
+    pthread_mutex_destroy(&batch->queues[i].lock);
 
-void interrupt(System *system, FILE *output)
-{
-  // Fetch operands
-  const uint32_t i = system->cpu.registers[IR] & 0x3FFFFF;
+  for (size_t i = 0; i < batch->imageCount; i++)
+    poxim_image_destroy(batch->images[i]);
 
-  // Execution of behavior
-  const uint32_t oldPC = system->cpu.registers[PC];
-  if (i == 0)
+  for (size_t i = 0; i < batch->jobCount; i++)
   {
-    system->control.run = false;
-    memset(system->cpu.registers, 0, sizeof(uint32_t) * NUM_REGISTERS);
+    free(batch->jobs[i].input);
+    free(batch->jobs[i].output);
   }
-  else
-    handleInterrupt(system, output);
 
-  // Instruction formatting
-  char instruction[30] = {0};
-  char additionalInfo[300] = {0};
+  free(jobs);
+  free(workers);
+  free(batch->queues);
+  free(batch->jobs);
+  free(batch->images);
 
-  sprintf(instruction, "int %i", i);
-  sprintf(additionalInfo, "CR=0x%08X,PC=0x%08X", system->cpu.registers[CR], system->cpu.registers[PC]);
+  if (failures > 0)
+    return EXIT_FAILURE;
 
-  // Output
-  printInstruction(oldPC, output, instruction, additionalInfo);
+  if (faulted > 0)
+    return FAULT_EXIT_STATUS;
 
-  if (i != 0)
-    printInterruptMessage(INIT_INTERRUPT_ADDR, output);
+  return limited > 0 ? LIMIT_EXIT_STATUS : 0;
 }
 
-void unknownInstruction(System *system, FILE *output)
-{
-  // Execution of behavior
-  const uint32_t oldPC = system->cpu.registers[PC];
+/******************************************************
+ * Server mode
+ *******************************************************/
 
-  system->cpu.registers[SR] |= IV_FLAG;
+// Serves jobs on a Unix domain socket until killed; each worker keeps one
+// system warm and resets it between jobs
+int runServer(const char *path, uint32_t workerCount, int optionCount, const char **options)
+{
+  Server server = {-1, optionCount, options};
+  struct sockaddr_un address = {0};
 
-  // Instruction formatting
-  char instruction[100] = {0};
-  sprintf(instruction, "[INVALID INSTRUCTION @ 0x%08X]\n", oldPC);
+  address.sun_family = AF_UNIX;
 
-  // Output formatting to file
-  printf("%s", instruction);
-  fprintf(output, "%s", instruction);
+  if (strlen(path) >= sizeof(address.sun_path))
+  {
+    fprintf(stderr, "Socket path too long: %s\n", path);
+    return EXIT_FAILURE;
+  }
 
-  handleInvalidInstruction(system, output);
-}
+  strcpy(address.sun_path, path);
 
-/******************************************************
- * Routines interrupt handling
- *******************************************************/
+  // A client that hangs up mid-trace must not take the server down
+  signal(SIGPIPE, SIG_IGN);
 
-void handlePrepareForISR(System *system)
-{
-  const uint32_t pc = system->control.pcAlreadyIncremented ? system->cpu.registers[PC] : system->cpu.registers[PC] + 4;
-
-  system->memory[system->cpu.registers[SP] + 0] = (pc >> 24) & 0xFF;
-  system->memory[system->cpu.registers[SP] + 1] = (pc >> 16) & 0xFF;
-  system->memory[system->cpu.registers[SP] + 2] = (pc >> 8) & 0xFF;
-  system->memory[system->cpu.registers[SP] + 3] = pc & 0xFF;
-  system->cpu.registers[SP] -= 4;
-
-  system->memory[system->cpu.registers[SP] + 0] = (system->cpu.registers[CR] >> 24) & 0xFF;
-  system->memory[system->cpu.registers[SP] + 1] = (system->cpu.registers[CR] >> 16) & 0xFF;
-  system->memory[system->cpu.registers[SP] + 2] = (system->cpu.registers[CR] >> 8) & 0xFF;
-  system->memory[system->cpu.registers[SP] + 3] = (system->cpu.registers[CR]) & 0xFF;
-  system->cpu.registers[SP] -= 4;
-
-  system->memory[system->cpu.registers[SP] + 0] = (system->cpu.registers[IPC] >> 24) & 0xFF;
-  system->memory[system->cpu.registers[SP] + 1] = (system->cpu.registers[IPC] >> 16) & 0xFF;
-  system->memory[system->cpu.registers[SP] + 2] = (system->cpu.registers[IPC] >> 8) & 0xFF;
-  system->memory[system->cpu.registers[SP] + 3] = (system->cpu.registers[IPC]) & 0xFF;
-  system->cpu.registers[SP] -= 4;
-}
+  server.socket = socket(AF_UNIX, SOCK_STREAM, 0);
+  unlink(path); // Left behind by a previous server
 
-void handleDivideByZero(System *system, FILE *output)
-{
+  if (server.socket < 0 || bind(server.socket, (struct sockaddr *)&address, sizeof(address)) != 0 ||
+      listen(server.socket, SERVER_BACKLOG) != 0)
+  {
+    fprintf(stderr, "Failed to listen on %s.\n", path);
+    return EXIT_FAILURE;
+  }
 
-  if (isIESet(&system->cpu))
+  pthread_t *threads = (pthread_t *)malloc(workerCount * sizeof(pthread_t));
+  if (threads == NULL)
   {
-    handlePrepareForISR(system);
-    system->control.pcAlreadyIncremented = true;
-    system->cpu.registers[CR] = 0;
-    system->cpu.registers[IPC] = system->cpu.registers[PC];
-    system->cpu.registers[PC] = DIVIDE_BY_ZERO_ADDR;
+    fprintf(stderr, "Failed to allocate memory for server.\n");
+    exit(EXIT_FAILURE);
+  }
 
-    printInterruptMessage(DIVIDE_BY_ZERO_ADDR, output);
+  for (uint32_t i = 0; i < workerCount; i++)
+  {
+    if (pthread_create(&threads[i], NULL, runServerWorker, &server) != 0)
+    {
+      fprintf(stderr, "Failed to start server worker.\n");
+      exit(EXIT_FAILURE);
+    }
   }
-}
 
-void handleInvalidInstruction(System *system, FILE *output)
-{
-  handlePrepareForISR(system);
-  system->control.pcAlreadyIncremented = true;
+  // Workers only return if accept fails for good
+  for (uint32_t i = 0; i < workerCount; i++)
+    pthread_join(threads[i], NULL);
 
-  system->cpu.registers[CR] = (system->cpu.registers[IR] >> 26) & 0x3F;
-  system->cpu.registers[IPC] = system->cpu.registers[PC];
-  system->cpu.registers[PC] = INVALID_INSTRUCTION_ADDR;
+  free(threads);
+  close(server.socket);
+  unlink(path);
 
-  printInterruptMessage(INVALID_INSTRUCTION_ADDR, output);
+  return EXIT_FAILURE;
 }
 
-void handleInterrupt(System *system, FILE *output)
+void *runServerWorker(void *argument)
 {
-  handlePrepareForISR(system);
+  Server *server = (Server *)argument;
+  PoximSystem *system = poxim_create(server->optionCount, server->options);
 
-  system->cpu.registers[CR] = system->cpu.registers[IR] & 0x3FFFFF;
-  system->cpu.registers[IPC] = system->cpu.registers[PC];
-  system->cpu.registers[PC] = SOFTWARE_INTERRUPT_ADDR;
+  while (true)
+  {
+    const int client = accept(server->socket, NULL, NULL);
 
-  system->control.pcAlreadyIncremented = true;
-}
+    if (client >= 0)
+      serveJob(system, client);
+    else if (errno != EINTR && errno != ECONNABORTED)
+      break;
+  }
 
-/******************************************************
- * Fetch from the status register(SR)
- *******************************************************/
+  poxim_destroy(system);
 
-int isCYSet(CPU *cpu)
-{
-  return (cpu->registers[SR] & CY_FLAG) != 0;
+  return NULL;
 }
 
-int isIESet(CPU *cpu)
+// Request: "RUN <length> <trace> <max-instructions> [hex|asm]\n" and then
+// <length> bytes of program text, .hex unless the format says asm (the .s
+// dialect); trace is 0 or 1, and the limit can only lower the server's
+// --max-instructions (0 keeps it). A job that neither limits stops after
+// SERVER_DEFAULT_MAX_SECONDS, so that a guest that never halts cannot hold
+// its worker for good.
+//
+// Reply: "ERROR <reason>\n", or "OK\n" followed by what the command line
+// front end writes to its output file, in chunks of "<length>\n" and
+// <length> bytes, and then "END <exit status>\n". The guest's output is
+// always inside a chunk, so it cannot pass for the trailer.
+void serveJob(PoximSystem *system, int client)
 {
-  return (cpu->registers[SR] & IE_FLAG) != 0;
-}
+  FILE *request = fdopen(client, "r");
 
-int isIVSet(CPU *cpu)
-{
-  return ((cpu->registers[SR] & IV_FLAG) >> 2) != 0;
-}
+  if (request == NULL)
+  {
+    fprintf(stderr, "Failed to open client stream.\n");
+    close(client);
+    return;
+  }
 
-int isOVSet(CPU *cpu)
-{
-  return ((cpu->registers[SR] & OV_FLAG) >> 3) != 0;
-}
+  char header[SERVER_HEADER_SIZE];
+  size_t length = 0;
+  int trace = 0;
+  uint64_t instructionLimit = 0;
+  char format[8] = "hex";
+  char *program = NULL;
+
+  if (fgets(header, sizeof(header), request) == NULL || sscanf(header, "RUN %zu %d %" SCNu64 " %7s", &length, &trace, &instructionLimit, format) < 3 ||
+      (strcmp(format, "hex") != 0 && strcmp(format, "asm") != 0))
+    dprintf(client, "ERROR Malformed request\n");
+  else if (length > SERVER_MAX_PROGRAM_SIZE)
+    dprintf(client, "ERROR Program too large\n");
+  else if ((program = (char *)malloc(length + 1)) == NULL)
+    dprintf(client, "ERROR Failed to allocate memory for input\n");
+  else if (fread(program, 1, length, request) != length)
+    dprintf(client, "ERROR Truncated program\n");
+  else
+  {
+    poxim_reset(system);
 
-int isSNSet(CPU *cpu)
-{
-  return ((cpu->registers[SR] & SN_FLAG) >> 4) != 0;
-}
+    const bool assembly = strcmp(format, "asm") == 0;
+    const cookie_io_functions_t chunks = {NULL, writeReplyChunk, NULL, NULL};
+    FILE *output;
 
-int isZDSet(CPU *cpu)
-{
-  return ((cpu->registers[SR] & ZD_FLAG) >> 5) != 0;
-}
+    if (!(assembly ? poxim_load_asm(system, program, length) : poxim_load_hex(system, program, length)))
+      dprintf(client, assembly ? "ERROR Failed to assemble program\n" : "ERROR Program does not fit in memory\n");
+    else if ((output = fopencookie(&client, "w", chunks)) == NULL)
+      dprintf(client, "ERROR Failed to open client stream\n");
+    else
+    {
+      PoximLimits limits;
+      poxim_get_limits(system, &limits);
 
-int isZNSet(CPU *cpu)
-{
-  return ((cpu->registers[SR] & ZN_FLAG) >> 6) != 0;
-}
+      if (instructionLimit != 0 && (limits.instructions == 0 || instructionLimit < limits.instructions))
+      {
+        limits.instructions = instructionLimit;
+        poxim_set_limits(system, &limits);
+      }
 
-/******************************************************
- * Utility Functions
- *******************************************************/
+      if (limits.instructions == 0 && limits.seconds == 0)
+      {
+        limits.seconds = SERVER_DEFAULT_MAX_SECONDS;
+        poxim_set_limits(system, &limits);
+      }
 
-int32_t extendSign32(uint32_t value, uint8_t significantBit)
-{
-  const uint32_t bitSignalDefined = value & (1 << (significantBit - 1));
-  return (bitSignalDefined ? (value | (0xFFFFFFFF << (significantBit))) : value);
-}
+      dprintf(client, "OK\n");
+      beginProgram(system, output, trace != 0, false);
 
-int64_t extendSign64(uint32_t value, uint8_t significantBit)
-{
-  const uint32_t bitSignalDefined = value & (1 << (significantBit - 1));
-  return (bitSignalDefined ? (value | (0xFFFFFFFFFFFFFFFF << (significantBit))) : value);
+      // In slices, so that a job whose client is gone stops early. A failed
+      // chunk write only shows up when the trace fills a chunk, so an
+      // untraced job also polls the socket for the hang-up
+      while (poxim_running(system) && !ferror(output) && !clientHungUp(client))
+        poxim_run(system, SERVER_RUN_QUANTUM);
+
+      const PoximStatus status = finishProgram(system, output, false);
+
+      dprintf(client, "END %d\n", exitStatus(status));
+    }
+  }
+
+  free(program);
+  fclose(request);
 }
 
-void printInstruction(uint32_t pc, FILE *output, char *instruction, char *additionalInfo)
+// Whether the client closed its end of the connection; it sends nothing
+// after the program, so any hang-up means nobody is reading the reply
+bool clientHungUp(int client)
 {
-  // Screen output formatting
-  printf("0x%08X:\t%-25s\t%s\n", pc, instruction, additionalInfo);
+  struct pollfd connection = {client, POLLRDHUP, 0};
 
-  // Output formatting to file
-  fprintf(output, "0x%08X:\t%-25s\t%s\n", pc, instruction, additionalInfo);
+  return poll(&connection, 1, 0) > 0 && (connection.revents & (POLLRDHUP | POLLHUP | POLLERR)) != 0;
 }
 
-void printInterruptMessage(uint32_t code, FILE *output)
+// Writes one reply chunk; a failed write marks the stream as failed, which
+// ends the job
+ssize_t writeReplyChunk(void *cookie, const char *data, size_t size)
 {
-  char message[300] = {0};
+  const int client = *(int *)cookie;
 
-  switch (code)
-  {
-  case INIT_INTERRUPT_ADDR:
-  case SOFTWARE_INTERRUPT_ADDR:
-    sprintf(message, "[SOFTWARE INTERRUPTION]");
-    break;
-  case INVALID_INSTRUCTION_ADDR:
-    sprintf(message, "[SOFTWARE INTERRUPTION]");
-    break;
-  case DIVIDE_BY_ZERO_ADDR:
-    sprintf(message, "[SOFTWARE INTERRUPTION]");
-    break;
-  case HARDWARE1_INTERRUPT_ADDR:
-    sprintf(message, "[HARDWARE INTERRUPTION 1]");
-    break;
-  case HARDWARE2_INTERRUPT_ADDR:
-    sprintf(message, "[HARDWARE INTERRUPTION 2]");
-    break;
-  case HARDWARE3_INTERRUPT_ADDR:
-    sprintf(message, "[HARDWARE INTERRUPTION 3]");
-    break;
-  case HARDWARE4_INTERRUPT_ADDR:
-    sprintf(message, "[HARDWARE INTERRUPTION 4]");
-    break;
-  default:
-    break;
-  }
+  char header[24];
+  const int length = sprintf(header, "%zu\n", size);
 
-  printf("%s\n", message);
-  fprintf(output, "%s\n", message);
+  return (writeAll(client, header, length) && writeAll(client, data, size)) ? (ssize_t)size : -1;
 }
 
-char *formatRegisterName(uint8_t registerNumber, bool lower)
+bool writeAll(int file, const char *data, size_t size)
 {
-  char *result;
-
-  if ((registerNumber >= 26))
+  while (size > 0)
   {
-    char instruction[4] = {0};
+    const ssize_t count = write(file, data, size);
 
-    switch (registerNumber)
-    {
-    case IR:
-      sprintf(instruction, "IR");
-      break;
-    case CR:
-      sprintf(instruction, "CR");
-      break;
-    case IPC:
-      sprintf(instruction, "IPC");
-      break;
-    case PC:
-      sprintf(instruction, "PC");
-      break;
-    case SP:
-      sprintf(instruction, "SP");
-      break;
-    case SR:
-      sprintf(instruction, "SR");
-      break;
-    }
+    if (count < 0 && errno == EINTR)
+      continue;
 
-    result = malloc(strlen(instruction) + 1);
-    strcpy(result, instruction);
-  }
-  else
-  {
-    size_t len = snprintf(NULL, 0, "R%u", registerNumber) + 1;
-    result = malloc(len);
-    snprintf(result, len, "R%u", registerNumber);
-  }
+    if (count <= 0)
+      return false;
 
-  if (lower)
-  {
-    for (size_t i = 0; result[i]; i++)
-    {
-      result[i] = tolower((unsigned char)result[i]);
-    }
+    data += count;
+    size -= count;
   }
 
-  return result;
-}
-
-uint32_t readMemory32(System *system, uint32_t memoryAddress)
-{
-  return ((system->memory[memoryAddress] << 24) |
-          (system->memory[memoryAddress + 1] << 16) |
-          (system->memory[memoryAddress + 2] << 8) |
-          (system->memory[memoryAddress + 3] << 0));
+  return true;
 }
@@ -0,0 +1,5779 @@
+#define _GNU_SOURCE // memfd_create
+
+#include "poxim_internal.h"
+
+#ifdef AVX2_KERNELS
+#include <immintrin.h>
+#endif
+
+/******************************************************
+ * Library interface
+ *******************************************************/
+
+PoximSystem *poxim_create(int optionCount, const char *const options[])
+{
+  System *system = (System *)calloc(1, sizeof(System));
+  if (system == NULL)
+  {
+    fprintf(stderr, "Failed to allocate memory for system.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  if (!parseArguments(optionCount, options, &system->arguments, &system->options))
+  {
+    free(system);
+    return NULL;
+  }
+
+  system->argumentCount = optionCount;
+
+  // 32 KiB memory initialized to zero
+  initSystem(system, allocateMemory(MEMORY_SIZE));
+
+  if (system->options.diskFile != NULL && system->disk.data == NULL)
+  {
+    poxim_destroy(system);
+    return NULL;
+  }
+
+  return system;
+}
+
+void poxim_destroy(PoximSystem *system)
+{
+  if (system == NULL)
+    return;
+
+  freeSystem(system);
+  releaseMemory(system->memory, MEMORY_SIZE);
+  freeArguments(system->arguments, system->argumentCount);
+  free(system);
+}
+
+PoximPool *poxim_pool_create(size_t count, int optionCount, const char *const options[])
+{
+  SystemPool *pool = (SystemPool *)calloc(1, sizeof(SystemPool));
+  if (pool == NULL)
+  {
+    fprintf(stderr, "Failed to allocate memory for pool.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  if (!parseArguments(optionCount, options, &pool->arguments, &pool->options))
+  {
+    free(pool);
+    return NULL;
+  }
+
+  pool->argumentCount = optionCount;
+  pool->count = count;
+  pool->systems = (System *)calloc(count > 0 ? count : 1, sizeof(System));
+  pool->memory = allocateGuardedMemory(count > 0 ? count : 1, &pool->stride);
+
+  if (pool->systems == NULL)
+  {
+    fprintf(stderr, "Failed to allocate memory for pool.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  // Option strings are shared through the pool
+  for (size_t i = 0; i < count; i++)
+  {
+    pool->systems[i].options = pool->options;
+    initSystem(&pool->systems[i], pool->memory + i * pool->stride);
+  }
+
+  if (count > 0 && pool->options.diskFile != NULL && pool->systems[0].disk.data == NULL)
+  {
+    poxim_pool_destroy(pool);
+    return NULL;
+  }
+
+  return pool;
+}
+
+PoximSystem *poxim_pool_system(PoximPool *pool, size_t index)
+{
+  return (index < pool->count) ? &pool->systems[index] : NULL;
+}
+
+void poxim_pool_destroy(PoximPool *pool)
+{
+  if (pool == NULL)
+    return;
+
+  for (size_t i = 0; i < pool->count; i++)
+    freeSystem(&pool->systems[i]);
+
+  free(pool->systems);
+  releaseMemory(pool->memory, (pool->count > 0 ? pool->count : 1) * pool->stride);
+  freeArguments(pool->arguments, pool->argumentCount);
+  free(pool);
+}
+
+bool poxim_load(PoximSystem *system, const uint8_t *image, size_t size)
+{
+  releaseSymbols(system);
+
+  if (size > MEMORY_SIZE)
+    return false;
+
+  memcpy(system->memory, image, size);
+  analyzeLoadedProgram(system);
+
+  return true;
+}
+
+bool poxim_load_hex(PoximSystem *system, const char *text, size_t length)
+{
+  releaseSymbols(system);
+
+  if (!parseHex(text, length, system->memory))
+    return false;
+
+  analyzeLoadedProgram(system);
+
+  return true;
+}
+
+PoximImage *poxim_image_create(const uint8_t *image, size_t size)
+{
+  if (size > MEMORY_SIZE)
+    return NULL;
+
+  uint8_t *memory = (uint8_t *)calloc(MEMORY_SIZE, sizeof(uint8_t));
+  if (memory == NULL)
+  {
+    fprintf(stderr, "Failed to allocate memory for image.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  memcpy(memory, image, size);
+
+  return createImage(memory);
+}
+
+PoximImage *poxim_image_create_hex(const char *text, size_t length)
+{
+  uint8_t *memory = (uint8_t *)calloc(MEMORY_SIZE, sizeof(uint8_t));
+  if (memory == NULL)
+  {
+    fprintf(stderr, "Failed to allocate memory for image.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  if (!parseHex(text, length, memory))
+  {
+    free(memory);
+    return NULL;
+  }
+
+  return createImage(memory);
+}
+
+void poxim_image_destroy(PoximImage *image)
+{
+  if (image == NULL)
+    return;
+
+  if (image->file >= 0)
+    close(image->file);
+
+  freeSymbolTable(image->symbols);
+  free(image->memory);
+  free(image);
+}
+
+bool poxim_load_image(PoximSystem *system, PoximImage *image)
+{
+  releaseSymbols(system);
+  system->symbols = image->symbols;
+
+  // Private mapping of the shared file: pages are copied on first write
+  if (image->file < 0 || mmap(system->memory, MEMORY_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, image->file, 0) == MAP_FAILED)
+    memcpy(system->memory, image->memory, MEMORY_SIZE);
+
+  analyzeLoadedProgram(system);
+
+  return true;
+}
+
+void poxim_set_trace(PoximSystem *system, PoximTraceCallback callback, void *context)
+{
+  system->trace.callback = callback;
+  system->trace.context = context;
+}
+
+void poxim_set_terminal(PoximSystem *system, PoximTerminalCallback callback, void *context)
+{
+  flushTerminal(system);
+
+  system->terminal.stream.callback = callback;
+  system->terminal.stream.context = context;
+}
+
+bool poxim_set_disk(PoximSystem *system, const char *path, bool writable)
+{
+  detachDisk(&system->disk);
+
+  return path == NULL || attachDisk(&system->disk, path, writable);
+}
+
+void poxim_set_input(PoximSystem *system, PoximInputCallback callback, void *context)
+{
+  TerminalInput *input = &system->terminal.input;
+
+  if (callback != NULL && input->data == NULL)
+  {
+    input->data = (char *)malloc(TERMINAL_INPUT_SIZE);
+
+    if (input->data == NULL)
+    {
+      fprintf(stderr, "Failed to allocate memory for terminal input.\n");
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  input->callback = callback;
+  input->context = context;
+  input->size = 0;
+  input->position = 0;
+  input->end = false;
+
+  updateTerminalInterrupt(system);
+}
+
+void poxim_set_limits(PoximSystem *system, const PoximLimits *limits)
+{
+  system->limits.limits = *limits;
+  system->limits.deadline = 0;
+}
+
+void poxim_get_limits(PoximSystem *system, PoximLimits *limits)
+{
+  *limits = system->limits.limits;
+}
+
+uint64_t poxim_run(PoximSystem *system, uint64_t count)
+{
+  uint64_t executed = 0;
+
+  startLimits(system);
+
+  while (system->control.run && (count == 0 || executed < count))
+  {
+    // Limits are checked between slices; a traced run checks after every
+    // instruction so that it stops on the line that crossed the trace limit
+    uint64_t slice = (system->trace.callback != NULL) ? 1 : LIMIT_CHECK_INTERVAL;
+
+    if (count != 0 && count - executed < slice)
+      slice = count - executed;
+
+    slice = limitSlice(system, slice);
+
+    if (slice > 0 && isTranslationEligible(system))
+      executed += system->translation(system, slice);
+    else
+      for (uint64_t i = 0; i < slice && system->control.run; i++)
+      {
+        executeInstruction(system);
+        executed++;
+
+        if (system->idle.enabled && system->cpu.registers[PC] <= system->control.oldPC)
+        {
+          const uint64_t skipped = watchIdleLoop(system, (count != 0) ? count - executed : UINT64_MAX);
+
+          executed += skipped;
+          i += skipped;
+        }
+      }
+
+    checkLimits(system);
+
+    if (system->terminal.stream.size > 0 && system->timing.instructions - system->terminal.stream.since >= TERMINAL_FLUSH_INTERVAL)
+      flushTerminal(system);
+  }
+
+  flushTerminal(system);
+
+  return executed;
+}
+
+bool poxim_step(PoximSystem *system)
+{
+  startLimits(system);
+
+  if (system->control.run && limitSlice(system, 1) > 0)
+    executeInstruction(system);
+
+  checkLimits(system);
+  flushTerminal(system);
+
+  return system->control.run;
+}
+
+bool poxim_running(PoximSystem *system)
+{
+  return system->control.run;
+}
+
+PoximStatus poxim_status(PoximSystem *system)
+{
+  return system->control.run ? POXIM_RUNNING : system->limits.reason;
+}
+
+uint64_t poxim_instructions(PoximSystem *system)
+{
+  return system->timing.instructions;
+}
+
+uint32_t poxim_get_register(PoximSystem *system, uint8_t index)
+{
+  return system->cpu.registers[index & 0x1F];
+}
+
+void poxim_set_register(PoximSystem *system, uint8_t index, uint32_t value)
+{
+  system->cpu.registers[index & 0x1F] = value;
+}
+
+bool poxim_read_memory(PoximSystem *system, uint32_t address, void *buffer, size_t size)
+{
+  if (address > MEMORY_SIZE || size > MEMORY_SIZE - address)
+    return false;
+
+  memcpy(buffer, system->memory + address, size);
+
+  return true;
+}
+
+bool poxim_write_memory(PoximSystem *system, uint32_t address, const void *buffer, size_t size)
+{
+  if (address > MEMORY_SIZE || size > MEMORY_SIZE - address)
+    return false;
+
+  memcpy(system->memory + address, buffer, size);
+
+  return true;
+}
+
+void poxim_reset(PoximSystem *system)
+{
+  resetSystem(system);
+}
+
+const char *poxim_terminal(PoximSystem *system, size_t *length)
+{
+  *length = system->terminal.buffer.size;
+
+  return system->terminal.buffer.data;
+}
+
+/******************************************************
+ * Utility Functions
+ *******************************************************/
+
+void initOptions(Options *options)
+{
+  memset(options, 0, sizeof(Options));
+  options->forwarding = true;
+  options->predictorPenalty = DEFAULT_MISPREDICT_PENALTY;
+  options->idleLoops = IDLE_LOOPS_SKIP;
+  options->simd = true;
+}
+
+// Decimal digits only, at most maximum
+bool parseUnsigned(const char *text, uint64_t maximum, uint64_t *value)
+{
+  char *end;
+
+  errno = 0;
+  *value = strtoull(text, &end, 10);
+
+  return isdigit((unsigned char)text[0]) && *end == '\0' && errno == 0 && *value <= maximum;
+}
+
+// A finite, non-negative number of seconds
+bool parseSeconds(const char *text, double *value)
+{
+  char *end;
+
+  *value = strtod(text, &end);
+
+  return end != text && *end == '\0' && isfinite(*value) && *value >= 0;
+}
+
+bool parseOption(char *argument, Options *options)
+{
+  if (strncmp(argument, "--profile=", 10) == 0)
+    options->profileFile = argument + 10;
+  else if (strncmp(argument, "--profile-folded=", 17) == 0)
+    options->foldedFile = argument + 17;
+  else if (strncmp(argument, "--profile-callgrind=", 20) == 0)
+    options->callgrindFile = argument + 20;
+  else if (strncmp(argument, "--symbol-map=", 13) == 0)
+    options->symbolFile = argument + 13;
+  else if (strcmp(argument, "--timing") == 0)
+    options->timing = true;
+  else if (strncmp(argument, "--timing=", 9) == 0)
+  {
+    TimingCosts costs;
+    if (!parseTimingCosts(argument + 9, &costs))
+    {
+      fprintf(stderr, "Invalid timing specification: %s\n", argument + 9);
+      return false;
+    }
+
+    options->timing = true;
+    options->timingCosts = argument + 9;
+  }
+  else if (strcmp(argument, "--timer-clock=cycles") == 0)
+  {
+    options->timing = true;
+    options->timersUseCycles = true;
+  }
+  else if (strcmp(argument, "--timer-clock=instructions") == 0)
+    options->timersUseCycles = false;
+  else if (strcmp(argument, "--pipeline") == 0)
+    options->pipeline = true;
+  else if (strncmp(argument, "--pipeline=", 11) == 0)
+  {
+    options->pipeline = true;
+    options->pipelineFile = argument + 11;
+  }
+  else if (strcmp(argument, "--pipeline-forwarding=on") == 0)
+    options->forwarding = true;
+  else if (strcmp(argument, "--pipeline-forwarding=off") == 0)
+    options->forwarding = false;
+  else if (strncmp(argument, "--predictor=", 12) == 0)
+  {
+    char model[16];
+    uint32_t bits;
+    if (!parsePredictorSpecification(argument + 12, model, &bits))
+      return false;
+
+    options->predictor = argument + 12;
+  }
+  else if (strncmp(argument, "--predictor-penalty=", 20) == 0)
+  {
+    uint64_t penalty;
+    if (!parseUnsigned(argument + 20, UINT32_MAX, &penalty))
+    {
+      fprintf(stderr, "Invalid misprediction penalty: %s\n", argument + 20);
+      return false;
+    }
+
+    options->predictorPenalty = penalty;
+  }
+  else if (strncmp(argument, "--predictor-report=", 19) == 0)
+    options->predictorFile = argument + 19;
+  else if (strncmp(argument, "--max-instructions=", 19) == 0)
+  {
+    if (!parseUnsigned(argument + 19, UINT64_MAX, &options->limits.instructions))
+    {
+      fprintf(stderr, "Invalid instruction limit: %s\n", argument + 19);
+      return false;
+    }
+  }
+  else if (strncmp(argument, "--max-trace-bytes=", 18) == 0)
+  {
+    if (!parseUnsigned(argument + 18, UINT64_MAX, &options->limits.traceBytes))
+    {
+      fprintf(stderr, "Invalid trace limit: %s\n", argument + 18);
+      return false;
+    }
+  }
+  else if (strncmp(argument, "--max-seconds=", 14) == 0)
+  {
+    if (!parseSeconds(argument + 14, &options->limits.seconds))
+    {
+      fprintf(stderr, "Invalid time limit: %s\n", argument + 14);
+      return false;
+    }
+  }
+  else if (strcmp(argument, "--idle-loops=off") == 0)
+    options->idleLoops = IDLE_LOOPS_OFF;
+  else if (strcmp(argument, "--idle-loops=skip") == 0)
+    options->idleLoops = IDLE_LOOPS_SKIP;
+  else if (strcmp(argument, "--idle-loops=collapse") == 0)
+    options->idleLoops = IDLE_LOOPS_COLLAPSE;
+  else if (strcmp(argument, "--simd=on") == 0)
+    options->simd = true;
+  else if (strcmp(argument, "--simd=off") == 0)
+    options->simd = false;
+  else if (strncmp(argument, "--disk=", 7) == 0)
+    options->diskFile = argument + 7;
+  else if (strcmp(argument, "--disk-read-only") == 0)
+    options->diskReadOnly = true;
+  else
+  {
+    fprintf(stderr, "Unknown option: %s\n", argument);
+    return false;
+  }
+
+  return true;
+}
+
+// Copies the option strings and parses them; parsed points into the copies
+bool parseArguments(int optionCount, const char *const options[], char ***arguments, Options *parsed)
+{
+  *arguments = (char **)calloc(optionCount > 0 ? optionCount : 1, sizeof(char *));
+  if (*arguments == NULL)
+  {
+    fprintf(stderr, "Failed to allocate memory for options.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  initOptions(parsed);
+
+  for (int i = 0; i < optionCount; i++)
+  {
+    (*arguments)[i] = strdup(options[i]);
+
+    if ((*arguments)[i] == NULL || !parseOption((*arguments)[i], parsed))
+    {
+      freeArguments(*arguments, i + 1);
+      *arguments = NULL;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// The .hex text format: one 32-bit word per line, read as the original fgets
+// loop did
+bool parseHex(const char *text, size_t length, uint8_t *memory)
+{
+  unsigned int count = 0;
+  size_t position = 0;
+
+  while (position < length)
+  {
+    char hexString[32] = {0};
+    size_t size = 0;
+
+    while (position < length && text[position] != '\n')
+    {
+      if (size < sizeof(hexString) - 1)
+        hexString[size++] = text[position];
+      position++;
+    }
+    position++; // newline
+
+    if (count + 4 > MEMORY_SIZE)
+      return false;
+
+    const uint32_t hexCode = strtoul(hexString, NULL, 16);
+
+    memory[count] = (hexCode & 0xFF000000) >> 24;
+    memory[count + 1] = (hexCode & 0x00FF0000) >> 16;
+    memory[count + 2] = (hexCode & 0x0000FF00) >> 8;
+    memory[count + 3] = (hexCode & 0x000000FF);
+
+    count += 4;
+  }
+
+  return true;
+}
+
+void freeArguments(char **arguments, int argumentCount)
+{
+  if (arguments == NULL)
+    return;
+
+  for (int i = 0; i < argumentCount; i++)
+    free(arguments[i]);
+
+  free(arguments);
+}
+
+// Page-aligned and zeroed, so that program images can be mapped over it
+uint8_t *allocateMemory(size_t size)
+{
+  void *memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (memory == MAP_FAILED)
+  {
+    fprintf(stderr, "Failed to allocate memory for system.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  return (uint8_t *)memory;
+}
+
+// count guest memories, each followed by an inaccessible guard page so that
+// a stray access past one guest faults instead of reaching the next; stride
+// is set to the distance between them
+uint8_t *allocateGuardedMemory(size_t count, size_t *stride)
+{
+  const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+  const size_t size = (MEMORY_SIZE + page - 1) / page * page;
+
+  *stride = size + page;
+  uint8_t *memory = allocateMemory(count * *stride);
+
+  for (size_t i = 0; i < count; i++)
+    if (mprotect(memory + i * *stride + size, page, PROT_NONE) != 0)
+    {
+      fprintf(stderr, "Failed to allocate memory for pool.\n");
+      exit(EXIT_FAILURE);
+    }
+
+  return memory;
+}
+
+void releaseMemory(uint8_t *memory, size_t size)
+{
+  munmap(memory, size);
+}
+
+// Drops every page the guest wrote (or mapped from an image) in favour of
+// fresh zero pages, instead of writing 32 KiB of zeros
+void clearMemory(uint8_t *memory)
+{
+  if (mmap(memory, MEMORY_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) == MAP_FAILED)
+    memset(memory, 0, MEMORY_SIZE);
+}
+
+// Takes ownership of a MEMORY_SIZE copy of the program and, where memfd is
+// available, backs it with a file that instances map copy-on-write
+ProgramImage *createImage(uint8_t *memory)
+{
+  ProgramImage *image = (ProgramImage *)malloc(sizeof(ProgramImage));
+  if (image == NULL)
+  {
+    fprintf(stderr, "Failed to allocate memory for image.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  image->memory = memory;
+  image->file = -1;
+  image->symbols = NULL;
+
+#ifdef __linux__
+  const int file = memfd_create("poxim-image", MFD_CLOEXEC);
+
+  if (file >= 0 && ftruncate(file, MEMORY_SIZE) == 0 && pwrite(file, memory, MEMORY_SIZE, 0) == MEMORY_SIZE)
+    image->file = file;
+  else if (file >= 0)
+    close(file);
+#endif
+
+  return image;
+}
+
+// Forgets the labels of the previous program
+void releaseSymbols(System *system)
+{
+  if (system->ownsSymbols)
+    freeSymbolTable(system->symbols);
+
+  system->symbols = NULL;
+  system->ownsSymbols = false;
+}
+
+// Sets up a system over a MEMORY_SIZE block owned by the caller
+void initSystem(System *system, uint8_t *memory)
+{
+  Options *options = &system->options;
+
+  initTerminalBuffer(&system->terminal.buffer, 1024);
+  system->terminal.input.data = NULL;
+
+  system->memory = memory;
+  system->symbols = NULL;
+  system->ownsSymbols = false;
+  system->translation = NULL;
+  system->analysis = NULL;
+
+  system->disk.data = NULL;
+  if (options->diskFile != NULL)
+    attachDisk(&system->disk, options->diskFile, !options->diskReadOnly);
+
+  // Timing model
+  initTiming(&system->timing, options);
+
+  // Pipeline model
+  initPipeline(&system->pipeline, options);
+
+  // Branch predictor
+  initBranchPredictor(&system->predictor, options);
+
+  // Profiler
+  initProfiler(&system->profiler, options->profileFile != NULL || options->foldedFile != NULL || options->callgrindFile != NULL, system->timing.enabled);
+
+  resetSystem(system);
+}
+
+// Power-on state, keeping every allocation so that a system can be reused
+void resetSystem(System *system)
+{
+  // 32 registers initialized to zero
+  memset(system->cpu.registers, 0, sizeof(system->cpu.registers));
+
+  // watchdog
+  system->watchdog.registers = 0;
+
+  // Reset FPU registers, controller and timer
+  memset(&system->fpu, 0, sizeof(FPU));
+
+  memset(&system->dma, 0, sizeof(DMA));
+
+  memset(&system->timer, 0, sizeof(IntervalTimer));
+  system->timer.deadline = UINT64_MAX;
+
+  // The disk itself stays attached
+  system->disk.sector = 0;
+  system->disk.address = 0;
+  system->disk.count = 0;
+  system->disk.control = 0;
+
+  // Reset TERMINAL
+  system->terminal.registers = 0;
+  system->terminal.buffer.size = 0;
+  system->terminal.stream.callback = NULL;
+  system->terminal.stream.context = NULL;
+  system->terminal.stream.size = 0;
+
+  // The prefetch buffer is kept for the next input
+  char *inputData = system->terminal.input.data;
+  memset(&system->terminal.input, 0, sizeof(TerminalInput));
+  system->terminal.input.data = inputData;
+
+  clearMemory(system->memory);
+  releaseSymbols(system);
+  system->translation = NULL;
+  freeAnalysis(system->analysis);
+  system->analysis = NULL;
+
+  // Initialized control variables
+  system->control.run = true;
+  system->control.pcAlreadyIncremented = false;
+  system->control.oldPC = 0;
+
+  resetInterrupts(&system->interrupts);
+
+  // No trace until the embedder installs a callback
+  system->trace.callback = NULL;
+  system->trace.context = NULL;
+  system->trace.bytes = 0;
+
+  system->limits.limits = system->options.limits;
+  system->limits.deadline = 0;
+  system->limits.nextClockCheck = 0;
+  system->limits.reason = POXIM_HALTED;
+
+  initTiming(&system->timing, &system->options);
+  memset(&system->counters, 0, sizeof(PerformanceCounters));
+  resetPipeline(&system->pipeline);
+  resetBranchPredictor(&system->predictor);
+  resetProfiler(&system->profiler);
+  resetIdleLoop(system);
+}
+
+void freeSystem(System *system)
+{
+  freeBuffer(&system->terminal.buffer);
+  free(system->terminal.input.data);
+  detachDisk(&system->disk);
+  releaseSymbols(system);
+  freeAnalysis(system->analysis);
+  freePipeline(&system->pipeline);
+  freeBranchPredictor(&system->predictor);
+  freeProfiler(&system->profiler);
+}
+
+void executeInstruction(System *system)
+{
+  // Handlers and devices skip all formatting when there is no trace sink
+  Trace *trace = (system->trace.callback != NULL) ? &system->trace : NULL;
+
+  if (system->cpu.registers[PC] > MEMORY_SIZE - 4)
+  {
+    raiseMemoryFault(system, system->cpu.registers[PC]);
+    return;
+  }
+
+  const uint32_t ir = readMemory32(system, system->cpu.registers[PC]);
+  system->control.oldPC = system->cpu.registers[PC];
+
+  system->cpu.registers[IR] = ir;
+
+  const uint8_t opcode = (ir >> 26) & 0x3F;
+  if (ir != 0) // If it is not idle instruction
+  {
+    switch (opcode)
+    {
+    case 0b000000: // mov
+      mov(&system->cpu, trace);
+      break;
+    case 0b000001: // movs
+      movs(&system->cpu, trace);
+      break;
+    case 0b000010: // add
+      add(&system->cpu, trace);
+      break;
+    case 0b000011: // sub
+      sub(&system->cpu, trace);
+      break;
+    case 0b000100: // mul, sll, muls, sla, div, srl, divs, sra
+      uint8_t subOpcode = (ir >> 8) & 0x7;
+
+      switch (subOpcode)
+      {
+      case 0b000: // mul
+        mul(&system->cpu, trace);
+        break;
+      case 0b001: // sll
+        sll(&system->cpu, trace);
+        break;
+      case 0b010: // muls
+        muls(&system->cpu, trace);
+        break;
+      case 0b011: // sla
+        sla(&system->cpu, trace);
+        break;
+      case 0b100: // div
+        divv(system, trace);
+        break;
+      case 0b101: // srl
+        srl(&system->cpu, trace);
+        break;
+      case 0b110: // divs
+        divs(system, trace);
+        break;
+      case 0b111: // sra
+        sra(&system->cpu, trace);
+        break;
+      }
+
+      break;
+    case 0b000101: // cmp
+      cmp(&system->cpu, trace);
+      break;
+    case 0b000110: // and
+      and(&system->cpu, trace);
+      break;
+    case 0b000111: // or
+      or (&system->cpu, trace);
+      break;
+    case 0b001000: // not
+      not(&system->cpu, trace);
+      break;
+    case 0b001001: // xor
+      xor(&system->cpu, trace);
+      break;
+    case 0b010010: // addi
+      addi(&system->cpu, trace);
+      break;
+    case 0b010011: // subi
+      subi(&system->cpu, trace);
+      break;
+    case 0b010100: // muli
+      muli(&system->cpu, trace);
+      break;
+    case 0b010101: // divi
+      divi(system, trace);
+      break;
+    case 0b010110: // modi
+      modi(system, trace);
+      break;
+    case 0b010111: // cmpi
+      cmpi(&system->cpu, trace);
+      break;
+
+    case 0b011000: // l8
+      l8(system, trace);
+      break;
+    case 0b011001: // l16
+      l16(system, trace);
+      break;
+    case 0b011010: // l32
+      l32(system, trace);
+      break;
+    case 0b011011: // s8
+      s8(system, trace);
+      break;
+    case 0b011100: // s16
+      s16(system, trace);
+      break;
+    case 0b011101: // s32
+      s32(system, trace);
+      break;
+
+    case 0b101010: // bae
+      bae(system, trace);
+      break;
+    case 0b101011: // bat
+      bat(system, trace);
+      break;
+    case 0b101100: // bbe
+      bbe(system, trace);
+      break;
+    case 0b101101: // bbt
+      bbt(system, trace);
+      break;
+    case 0b101110: // beq
+      beq(system, trace);
+      break;
+    case 0b101111: // bge
+      bge(system, trace);
+      break;
+    case 0b110000: // bgt
+      bgt(system, trace);
+      break;
+    case 0b110001: // biv
+      biv(system, trace);
+      break;
+    case 0b110010: // ble
+      ble(system, trace);
+      break;
+    case 0b110011: // blt
+      blt(system, trace);
+      break;
+    case 0b110100: // bne
+      bne(system, trace);
+      break;
+    case 0b110101: // bni
+      bni(system, trace);
+      break;
+    case 0b110110: // bnz
+      bnz(system, trace);
+      break;
+    case 0b110111: // bun
+      bun(system, trace);
+      break;
+    case 0b111000: // bzd
+      bzd(system, trace);
+      break;
+
+    case 0b011110: // call type F
+      callf(system, trace);
+      break;
+    case 0b111001: // call type S
+      calls(system, trace);
+      break;
+    case 0b011111: // ret
+      ret(system, trace);
+      break;
+    case 0b001010: // push
+      push(system, trace);
+      break;
+    case 0b001011: // pop
+      pop(system, trace);
+      break;
+
+    case 0b100000: // reti
+      reti(system, trace);
+      break;
+    case 0b100001: // cbr, sbr
+      subOpcode = ir & 0x1;
+
+      switch (subOpcode)
+      {
+      case 0b0: // cbr
+        cbr(&system->cpu, trace);
+        break;
+      case 0b1: // sbr
+        sbr(&system->cpu, trace);
+        break;
+      }
+      break;
+    case 0b111111: // int
+      interrupt(system, trace);
+      break;
+
+    default: // Unknown instruction
+      unknownInstruction(system, trace);
+    }
+  }
+
+  // A faulting instruction leaves the registers as they were
+  if (system->limits.reason == POXIM_MEMORY_FAULT)
+    return;
+
+  system->timing.instructions++;
+  countEvents(system, opcode);
+
+  if (system->timing.enabled)
+    accountCycles(system, opcode);
+
+  const uint32_t ticks = system->timing.timersUseCycles ? elapsedTicks(&system->timing) : 1;
+
+  updateWatchdog(system, ticks); // Update the timer every instruction cycle
+
+  executeFPU(system, ticks); // FPU
+
+  if (deviceClock(system) >= system->timer.deadline)
+    updateIntervalTimer(system);
+
+  if (system->interrupts.pending & system->interrupts.enabled)
+    dispatchInterrupt(system, trace);
+
+  if (system->pipeline.enabled)
+    simulatePipeline(system, opcode);
+
+  if (system->profiler.enabled)
+    profileInstruction(system, opcode);
+
+  if (!system->control.pcAlreadyIncremented)
+    system->cpu.registers[PC] += 4; // next instruction
+
+  system->control.pcAlreadyIncremented = false;
+}
+
+/******************************************************
+ * Run limits
+ *******************************************************/
+
+uint64_t monotonicNanoseconds(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+// The wall clock starts with the first run
+void startLimits(System *system)
+{
+  RunLimits *limits = &system->limits;
+
+  if (limits->limits.seconds > 0 && limits->deadline == 0)
+  {
+    limits->deadline = monotonicNanoseconds() + (uint64_t)(limits->limits.seconds * 1e9);
+    limits->nextClockCheck = system->timing.instructions + LIMIT_CHECK_INTERVAL;
+  }
+}
+
+// Stops a running system that reached one of its limits
+void checkLimits(System *system)
+{
+  RunLimits *limits = &system->limits;
+  const uint64_t instructions = system->timing.instructions;
+
+  if (!system->control.run)
+    return;
+
+  if (limits->limits.instructions != 0 && instructions >= limits->limits.instructions)
+    limits->reason = POXIM_INSTRUCTION_LIMIT;
+  else if (limits->limits.traceBytes != 0 && system->trace.bytes >= limits->limits.traceBytes)
+    limits->reason = POXIM_TRACE_LIMIT;
+  else if (limits->deadline != 0 && instructions >= limits->nextClockCheck)
+  {
+    limits->nextClockCheck = instructions + LIMIT_CHECK_INTERVAL;
+
+    if (monotonicNanoseconds() < limits->deadline)
+      return;
+
+    limits->reason = POXIM_TIME_LIMIT;
+  }
+  else
+    return;
+
+  system->control.run = false;
+}
+
+// Stops the program instead of touching memory past its end
+void raiseMemoryFault(System *system, uint32_t address)
+{
+  system->control.run = false;
+  system->limits.reason = POXIM_MEMORY_FAULT;
+
+  if (system->trace.callback != NULL)
+  {
+    char message[40] = {0};
+    sprintf(message, "[MEMORY FAULT @ 0x%08X]", address);
+
+    emitTraceLine(&system->trace, message);
+  }
+}
+
+// Shortens slice to the instructions left before the instruction limit
+uint64_t limitSlice(System *system, uint64_t slice)
+{
+  const uint64_t limit = system->limits.limits.instructions;
+  const uint64_t instructions = system->timing.instructions;
+
+  if (limit == 0)
+    return slice;
+
+  if (instructions >= limit)
+    return 0;
+
+  return (limit - instructions < slice) ? limit - instructions : slice;
+}
+
+/******************************************************
+ * Idle loops
+ *******************************************************/
+
+void resetIdleLoop(System *system)
+{
+  memset(&system->idle, 0, sizeof(IdleLoop));
+
+  system->idle.enabled = system->options.idleLoops != IDLE_LOOPS_OFF && !system->timing.enabled && !system->pipeline.enabled &&
+                         !system->predictor.enabled && !system->profiler.enabled;
+  system->idle.head = NO_IDLE_LOOP;
+}
+
+// Called after a backward control transfer; when it closes an idle loop,
+// skips whole iterations up to just before the next device event (or bound
+// instructions) and returns the instructions skipped
+uint64_t watchIdleLoop(System *system, uint64_t bound)
+{
+  IdleLoop *loop = &system->idle;
+  const uint32_t head = system->cpu.registers[PC];
+  const uint32_t branch = system->control.oldPC;
+  uint64_t skipped = 0;
+
+  if (system->trace.callback != NULL && system->options.idleLoops != IDLE_LOOPS_COLLAPSE)
+    return 0;
+
+  // Loops only wait for a timer; without one running there is nothing to skip to
+  const uint64_t event = nextDeviceEvent(system);
+
+  if (event == UINT64_MAX)
+  {
+    loop->head = NO_IDLE_LOOP;
+    return 0;
+  }
+
+  const uint64_t window = limitSlice(system, (event < bound) ? event : bound);
+  const uint64_t length = system->timing.instructions - loop->instructions;
+
+  if (head != loop->head || branch != loop->branch)
+  {
+    loop->head = head;
+    loop->branch = branch;
+    loop->compared = false;
+  }
+  else if (length > IDLE_LOOP_MAX_LENGTH)
+    loop->compared = false;
+  else if (loop->compared && system->counters.stores == loop->stores && system->counters.reads == loop->counterReads &&
+           memcmp(loop->registers, system->cpu.registers, sizeof(loop->registers)) == 0)
+  {
+    // Stay short of the event, which then happens in a normal iteration
+    if (window > length)
+      skipped = skipIdleLoop(system, (window - 1) / length) * length;
+  }
+  else
+  {
+    memcpy(loop->registers, system->cpu.registers, sizeof(loop->registers));
+    loop->compared = true;
+  }
+
+  loop->instructions = system->timing.instructions;
+  loop->loads = system->counters.loads;
+  loop->stores = system->counters.stores;
+  loop->takenBranches = system->counters.takenBranches;
+  loop->counterReads = system->counters.reads;
+
+  return skipped;
+}
+
+// Instructions until a device changes the machine state: the watchdog
+// expiring, the FPU finishing, an interval timer match or a pending
+// interrupt being taken, UINT64_MAX when none will
+uint64_t nextDeviceEvent(System *system)
+{
+  uint64_t event = UINT64_MAX;
+
+  // Work already due on the next instruction
+  if (takeableInterrupts(system) != 0 || ((system->fpu.registers.control & 0x1F) != 0 && !system->fpu.timer.enabled))
+    return 1;
+
+  if (system->watchdog.registers & 0x80000000)
+    event = (uint64_t)(system->watchdog.registers & 0x7FFFFFFF) + 1;
+
+  if (system->fpu.timer.enabled && system->fpu.timer.counter < event)
+    event = system->fpu.timer.counter;
+
+  if (system->timer.deadline != UINT64_MAX)
+  {
+    const uint64_t clock = deviceClock(system);
+    const uint64_t match = (system->timer.deadline > clock) ? system->timer.deadline - clock : 1;
+
+    if (match < event)
+      event = match;
+  }
+
+  return event;
+}
+
+// Advances the counters and device timers as if the loop ran the given
+// number of iterations; returns them
+uint64_t skipIdleLoop(System *system, uint64_t iterations)
+{
+  IdleLoop *loop = &system->idle;
+  const uint64_t length = system->timing.instructions - loop->instructions;
+  const uint64_t skipped = iterations * length;
+
+  if (iterations == 0)
+    return 0;
+
+  system->counters.loads += iterations * (system->counters.loads - loop->loads);
+  system->counters.takenBranches += iterations * (system->counters.takenBranches - loop->takenBranches);
+  advanceDeviceTimers(system, skipped);
+
+  if (system->trace.callback != NULL)
+  {
+    char line[TRACE_LINE_SIZE];
+    snprintf(line, sizeof(line), "[IDLE LOOP 0x%08X-0x%08X: %" PRIu64 " ITERATIONS SKIPPED]", loop->head, loop->branch, iterations);
+
+    emitTraceLine(&system->trace, line);
+  }
+
+  return iterations;
+}
+
+// Counts instructions run without executeInstruction, moving the watchdog,
+// the FPU timer and the interval timer's clock along with them; callers stay
+// short of nextDeviceEvent, so none of them fires here
+void advanceDeviceTimers(System *system, uint64_t instructions)
+{
+  system->timing.instructions += instructions;
+
+  if (system->watchdog.registers & 0x80000000)
+    system->watchdog.registers = 0x80000000 | ((system->watchdog.registers & 0x7FFFFFFF) - instructions);
+
+  if (system->fpu.timer.enabled)
+    system->fpu.timer.counter -= instructions;
+}
+
+
+/******************************************************
+ * Instruction handlers
+ *******************************************************/
+
+// Every handler dispatched by executeInstruction, for tools that drive the
+// handlers directly. Keep in sync with the switch above.
+const InstructionHandler instructionHandlers[] = {
+  {"mov", 0x00000000, 0xFC000000, false, mov, NULL},
+  {"movs", 0x04000000, 0xFC000000, false, movs, NULL},
+  {"add", 0x08000000, 0xFC000000, false, add, NULL},
+  {"sub", 0x0C000000, 0xFC000000, false, sub, NULL},
+  {"mul", 0x10000000, 0xFC000700, false, mul, NULL},
+  {"sll", 0x10000100, 0xFC000700, false, sll, NULL},
+  {"muls", 0x10000200, 0xFC000700, false, muls, NULL},
+  {"sla", 0x10000300, 0xFC000700, false, sla, NULL},
+  {"div", 0x10000400, 0xFC000700, false, NULL, divv},
+  {"srl", 0x10000500, 0xFC000700, false, srl, NULL},
+  {"divs", 0x10000600, 0xFC000700, false, NULL, divs},
+  {"sra", 0x10000700, 0xFC000700, false, sra, NULL},
+  {"cmp", 0x14000000, 0xFC000000, false, cmp, NULL},
+  {"and", 0x18000000, 0xFC000000, false, and, NULL},
+  {"or", 0x1C000000, 0xFC000000, false, or, NULL},
+  {"not", 0x20000000, 0xFC000000, false, not, NULL},
+  {"xor", 0x24000000, 0xFC000000, false, xor, NULL},
+  {"addi", 0x48000000, 0xFC000000, false, addi, NULL},
+  {"subi", 0x4C000000, 0xFC000000, false, subi, NULL},
+  {"muli", 0x50000000, 0xFC000000, false, muli, NULL},
+  {"divi", 0x54000000, 0xFC000000, false, NULL, divi},
+  {"modi", 0x58000000, 0xFC000000, false, NULL, modi},
+  {"cmpi", 0x5C000000, 0xFC000000, false, cmpi, NULL},
+  {"l8", 0x60000000, 0xFC000000, true, NULL, l8},
+  {"l16", 0x64000000, 0xFC000000, true, NULL, l16},
+  {"l32", 0x68000000, 0xFC000000, true, NULL, l32},
+  {"s8", 0x6C000000, 0xFC000000, true, NULL, s8},
+  {"s16", 0x70000000, 0xFC000000, true, NULL, s16},
+  {"s32", 0x74000000, 0xFC000000, true, NULL, s32},
+  {"bae", 0xA8000000, 0xFC000000, false, NULL, bae},
+  {"bat", 0xAC000000, 0xFC000000, false, NULL, bat},
+  {"bbe", 0xB0000000, 0xFC000000, false, NULL, bbe},
+  {"bbt", 0xB4000000, 0xFC000000, false, NULL, bbt},
+  {"beq", 0xB8000000, 0xFC000000, false, NULL, beq},
+  {"bge", 0xBC000000, 0xFC000000, false, NULL, bge},
+  {"bgt", 0xC0000000, 0xFC000000, false, NULL, bgt},
+  {"biv", 0xC4000000, 0xFC000000, false, NULL, biv},
+  {"ble", 0xC8000000, 0xFC000000, false, NULL, ble},
+  {"blt", 0xCC000000, 0xFC000000, false, NULL, blt},
+  {"bne", 0xD0000000, 0xFC000000, false, NULL, bne},
+  {"bni", 0xD4000000, 0xFC000000, false, NULL, bni},
+  {"bnz", 0xD8000000, 0xFC000000, false, NULL, bnz},
+  {"bun", 0xDC000000, 0xFC000000, false, NULL, bun},
+  {"bzd", 0xE0000000, 0xFC000000, false, NULL, bzd},
+  {"callf", 0x78000000, 0xFC000000, false, NULL, callf},
+  {"calls", 0xE4000000, 0xFC000000, false, NULL, calls},
+  {"ret", 0x7C000000, 0xFC000000, false, NULL, ret},
+  {"push", 0x28000000, 0xFC000000, false, NULL, push},
+  {"pop", 0x2C000000, 0xFC000000, false, NULL, pop},
+  {"reti", 0x80000000, 0xFC000000, false, NULL, reti},
+  {"cbr", 0x84000000, 0xFC000001, false, cbr, NULL},
+  {"sbr", 0x84000001, 0xFC000001, false, sbr, NULL},
+  {"int", 0xFC000000, 0xFC000000, false, NULL, interrupt},
+};
+
+const size_t instructionHandlerCount = sizeof(instructionHandlers) / sizeof(instructionHandlers[0]);
+
+const InstructionHandler *findInstructionHandler(const char *name)
+{
+  for (size_t i = 0; i < instructionHandlerCount; i++)
+  {
+    if (strcmp(instructionHandlers[i].name, name) == 0)
+      return &instructionHandlers[i];
+  }
+
+  return NULL;
+}
+
+const InstructionHandler *decodeInstructionHandler(uint32_t ir)
+{
+  for (size_t i = 0; i < instructionHandlerCount; i++)
+  {
+    if ((ir & instructionHandlers[i].mask) == instructionHandlers[i].encoding)
+      return &instructionHandlers[i];
+  }
+
+  return NULL;
+}
+
+// Runs a single handler on the instruction already in IR
+void executeInstructionHandler(System *system, const InstructionHandler *handler, Trace *output)
+{
+  if (handler->cpuHandler != NULL)
+    handler->cpuHandler(&system->cpu, output);
+  else
+    handler->systemHandler(system, output);
+}
+
+/******************************************************
+ * Terminal
+ *******************************************************/
+
+void initTerminalBuffer(TerminalBuffer *buffer, size_t initialCapacity)
+{
+  buffer->data = (char *)malloc(initialCapacity * sizeof(char));
+  buffer->size = 0;
+  buffer->capacity = (buffer->data != NULL) ? initialCapacity : 0;
+}
+
+void addToBuffer(TerminalBuffer *buffer, char character)
+{
+  if (buffer->size == buffer->capacity)
+  {
+    size_t newCapacity = (buffer->capacity == 0) ? 1 : 2 * buffer->capacity;
+    buffer->data = (char *)realloc(buffer->data, newCapacity * sizeof(char));
+
+    if (buffer->data != NULL)
+      buffer->capacity = newCapacity;
+    else
+    {
+      fprintf(stderr, "Failed to allocate memory for buffer.\n");
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  buffer->data[buffer->size++] = character;
+}
+
+void freeBuffer(TerminalBuffer *buffer)
+{
+  free(buffer->data);
+  buffer->data = NULL;
+  buffer->size = 0;
+  buffer->capacity = 0;
+}
+
+// Keeps the character for poxim_terminal, or queues it for the stream
+void writeTerminal(System *system, char character)
+{
+  TerminalStream *stream = &system->terminal.stream;
+
+  if (stream->callback == NULL)
+  {
+    addToBuffer(&system->terminal.buffer, character);
+    return;
+  }
+
+  if (stream->size == 0)
+    stream->since = system->timing.instructions;
+
+  stream->data[stream->size++] = character;
+
+  if (stream->size == TERMINAL_STREAM_SIZE)
+    flushTerminal(system);
+}
+
+void flushTerminal(System *system)
+{
+  TerminalStream *stream = &system->terminal.stream;
+
+  if (stream->size > 0 && stream->callback != NULL)
+    stream->callback(stream->context, stream->data, stream->size);
+
+  stream->size = 0;
+}
+
+// Whether a byte is waiting, refilling the prefetch buffer when it is drained
+bool terminalInputReady(System *system)
+{
+  TerminalInput *input = &system->terminal.input;
+
+  if (input->position < input->size)
+    return true;
+
+  if (input->callback == NULL || input->end)
+    return false;
+
+  input->size = input->callback(input->context, input->data, TERMINAL_INPUT_SIZE);
+  input->position = 0;
+  input->end = (input->size == 0);
+
+  return !input->end;
+}
+
+// Takes the next byte, or 0 when there is none
+uint8_t readTerminalInput(System *system)
+{
+  TerminalInput *input = &system->terminal.input;
+  const uint8_t value = terminalInputReady(system) ? (uint8_t)input->data[input->position++] : 0;
+
+  system->terminal.registers &= 0xFFFF00FF;
+  system->terminal.registers |= (uint32_t)value << 8;
+
+  // Successive reads differ, so a loop reading them is never idle
+  system->counters.reads++;
+
+  if (input->interrupt)
+    updateTerminalInterrupt(system);
+
+  return value;
+}
+
+uint8_t readTerminalStatus(System *system)
+{
+  const TerminalInput *input = &system->terminal.input;
+  uint8_t status = input->interrupt ? TERMINAL_STATUS_INTERRUPT : 0;
+
+  if (terminalInputReady(system))
+    status |= TERMINAL_STATUS_READY;
+  else if (input->end)
+    status |= TERMINAL_STATUS_END;
+
+  return status;
+}
+
+void writeTerminalStatus(System *system, uint8_t value)
+{
+  system->terminal.input.interrupt = (value & TERMINAL_STATUS_INTERRUPT) != 0;
+
+  updateTerminalInterrupt(system);
+}
+
+// Pending while a byte is waiting, except between taking the interrupt and reti
+void updateTerminalInterrupt(System *system)
+{
+  TerminalInput *input = &system->terminal.input;
+
+  if (input->interrupt && !input->inService && terminalInputReady(system))
+    raiseInterrupt(system, INTERRUPT_TERMINAL);
+  else
+    clearInterrupt(system, INTERRUPT_TERMINAL);
+}
+
+void enterTerminalInterrupt(System *system, Trace *output)
+{
+  if (!handlePrepareForISR(system))
+    return;
+
+  system->control.pcAlreadyIncremented = true;
+  system->terminal.input.inService = true;
+
+  system->cpu.registers[IPC] = system->cpu.registers[PC];
+  system->cpu.registers[PC] = HARDWARE1_INTERRUPT_ADDR;
+  system->cpu.registers[CR] = TERMINAL_INTERRUPT_CODE;
+
+  printInterruptMessage(HARDWARE1_INTERRUPT_ADDR, output);
+}
+
+/******************************************************
+ * DMA
+ *******************************************************/
+
+uint32_t readDMARegister(System *system, uint32_t address)
+{
+  switch (address)
+  {
+  case DMA_SOURCE_ADDR:
+    return system->dma.source;
+  case DMA_DESTINATION_ADDR:
+    return system->dma.destination;
+  case DMA_LENGTH_ADDR:
+    return system->dma.length;
+  default:
+    return system->dma.control;
+  }
+}
+
+void writeDMARegister(System *system, uint32_t address, uint32_t value)
+{
+  switch (address)
+  {
+  case DMA_SOURCE_ADDR:
+    system->dma.source = value;
+    break;
+  case DMA_DESTINATION_ADDR:
+    system->dma.destination = value;
+    break;
+  case DMA_LENGTH_ADDR:
+    system->dma.length = value;
+    break;
+  default:
+    system->dma.control = value;
+
+    if (value & (DMA_CONTROL_COPY | DMA_CONTROL_FILL))
+      startDMATransfer(system);
+  }
+}
+
+// Transfers complete within the store that starts them; the control register
+// keeps only the interrupt enable and the ST flag afterwards
+void startDMATransfer(System *system)
+{
+  DMA *dma = &system->dma;
+  const bool copy = dma->control & DMA_CONTROL_COPY;
+  const bool fill = dma->control & DMA_CONTROL_FILL;
+  const uint64_t length = dma->length;
+
+  const bool fits = (uint64_t)dma->destination + length <= MEMORY_SIZE &&
+                    (fill || (uint64_t)dma->source + length <= MEMORY_SIZE);
+
+  dma->control &= DMA_CONTROL_INTERRUPT;
+
+  if (copy == fill || !fits)
+    dma->control |= DMA_CONTROL_ST;
+  else if (copy)
+    memmove(system->memory + dma->destination, system->memory + dma->source, length); // Overlap allowed
+  else
+    memset(system->memory + dma->destination, dma->source & 0xFF, length);
+
+  if (dma->control & DMA_CONTROL_INTERRUPT)
+    raiseInterrupt(system, INTERRUPT_DMA);
+}
+
+// Entered like the FPU completion interrupts, regardless of IE
+void handleDMAInterrupt(System *system, Trace *output)
+{
+  if (!handlePrepareForISR(system))
+    return;
+
+  system->control.pcAlreadyIncremented = true;
+
+  system->cpu.registers[IPC] = system->control.oldPC;
+  system->cpu.registers[PC] = HARDWARE1_INTERRUPT_ADDR;
+  system->cpu.registers[CR] = DMA_INTERRUPT_CODE;
+
+  printInterruptMessage(HARDWARE1_INTERRUPT_ADDR, output);
+}
+
+/******************************************************
+ * Interrupt controller
+ *******************************************************/
+
+void resetInterrupts(InterruptController *interrupts)
+{
+  interrupts->pending = 0;
+  interrupts->enabled = (1u << INTERRUPT_SOURCES) - 1;
+  interrupts->priorities = INTERRUPT_DEFAULT_PRIORITIES;
+}
+
+void raiseInterrupt(System *system, InterruptSource source)
+{
+  system->interrupts.pending |= 1u << source;
+}
+
+void clearInterrupt(System *system, InterruptSource source)
+{
+  system->interrupts.pending &= ~(1u << source);
+}
+
+// Pending, unmasked sources that IE in SR lets through
+uint32_t takeableInterrupts(System *system)
+{
+  const uint32_t allowed = isIESet(&system->cpu) ? ~0u : INTERRUPT_NON_MASKABLE;
+
+  return system->interrupts.pending & system->interrupts.enabled & allowed;
+}
+
+// Enters the handler of the highest priority takeable source
+void dispatchInterrupt(System *system, Trace *output)
+{
+  uint32_t takeable = takeableInterrupts(system);
+
+  if (takeable == 0)
+    return;
+
+  InterruptSource source = __builtin_ctz(takeable);
+
+  for (takeable &= takeable - 1; takeable != 0; takeable &= takeable - 1)
+  {
+    const InterruptSource other = __builtin_ctz(takeable);
+
+    if (((system->interrupts.priorities >> (4 * other)) & 0xF) > ((system->interrupts.priorities >> (4 * source)) & 0xF))
+      source = other;
+  }
+
+  clearInterrupt(system, source);
+
+  switch (source)
+  {
+  case INTERRUPT_WATCHDOG:
+    enterWatchdogInterrupt(system, output);
+    break;
+  case INTERRUPT_FPU:
+    handleFPUErrors(system, output);
+    break;
+  case INTERRUPT_DMA:
+    handleDMAInterrupt(system, output);
+    break;
+  case INTERRUPT_TERMINAL:
+    enterTerminalInterrupt(system, output);
+    break;
+  case INTERRUPT_TIMER:
+    enterTimerInterrupt(system, output);
+    break;
+  default:
+    enterDiskInterrupt(system, output);
+  }
+}
+
+uint32_t readInterruptRegister(System *system, uint32_t address)
+{
+  switch (address)
+  {
+  case INTERRUPT_PENDING_ADDR:
+    return system->interrupts.pending;
+  case INTERRUPT_ENABLE_ADDR:
+    return system->interrupts.enabled;
+  default:
+    return system->interrupts.priorities;
+  }
+}
+
+void writeInterruptRegister(System *system, uint32_t address, uint32_t value)
+{
+  const uint32_t sources = (1u << INTERRUPT_SOURCES) - 1;
+
+  // The FPU waits for its interrupt to reset the opcode, so masking it
+  // would stop the FPU for good
+  if (address == INTERRUPT_ENABLE_ADDR)
+    system->interrupts.enabled = (value & sources) | INTERRUPT_NON_MASKABLE;
+  else if (address == INTERRUPT_PRIORITY_ADDR)
+    system->interrupts.priorities = value & ((1u << (4 * INTERRUPT_SOURCES)) - 1);
+}
+
+/******************************************************
+ * Interval timer
+ *
+ * Scheduled by deadline: instructions only compare the clock with the next
+ * compare match, and the count is worked out from the clock when read.
+ *******************************************************/
+
+// Ticks the device timers run on: cycles with --timer-clock=cycles,
+// instructions otherwise
+uint64_t deviceClock(System *system)
+{
+  return system->timing.timersUseCycles ? system->timing.cycles : system->timing.instructions;
+}
+
+uint32_t readIntervalTimerRegister(System *system, uint32_t address)
+{
+  const IntervalTimer *timer = &system->timer;
+
+  switch (address)
+  {
+  case TIMER_CONTROL_ADDR:
+    return timer->control;
+  case TIMER_RELOAD_ADDR:
+    return timer->reload;
+  case TIMER_PRESCALER_ADDR:
+    return timer->prescaler;
+  case TIMER_COMPARE_ADDR:
+    return timer->compare;
+  default:
+  {
+    if (!(timer->control & TIMER_CONTROL_EN))
+      return 0;
+
+    system->counters.reads++; // The count changes between reads, so polling it is never idle
+
+    const uint64_t period = (timer->reload != 0) ? timer->reload : (1ull << 32);
+
+    return ((deviceClock(system) - timer->start) / ((uint64_t)timer->prescaler + 1)) % period;
+  }
+  }
+}
+
+void writeIntervalTimerRegister(System *system, uint32_t address, uint32_t value)
+{
+  IntervalTimer *timer = &system->timer;
+
+  switch (address)
+  {
+  case TIMER_CONTROL_ADDR:
+    timer->control = value & (TIMER_CONTROL_EN | TIMER_CONTROL_INTERRUPT | TIMER_CONTROL_ONE_SHOT);
+    break;
+  case TIMER_RELOAD_ADDR:
+    timer->reload = value;
+    break;
+  case TIMER_PRESCALER_ADDR:
+    timer->prescaler = value;
+    break;
+  case TIMER_COMPARE_ADDR:
+    timer->compare = value;
+    break;
+  default:
+    return; // The count is read only
+  }
+
+  scheduleIntervalTimer(system);
+}
+
+// Restarts the count from 0 and sets the deadline of the first match
+void scheduleIntervalTimer(System *system)
+{
+  IntervalTimer *timer = &system->timer;
+  const uint64_t period = (timer->reload != 0) ? timer->reload : (1ull << 32);
+
+  timer->start = deviceClock(system);
+  timer->deadline = UINT64_MAX;
+
+  // The count starts at compare 0 without matching it; the wrap does
+  if ((timer->control & TIMER_CONTROL_EN) && timer->compare < period)
+    timer->deadline = timer->start + ((uint64_t)timer->prescaler + 1) * ((timer->compare != 0) ? timer->compare : period);
+}
+
+// Called once the clock reaches the deadline
+void updateIntervalTimer(System *system)
+{
+  IntervalTimer *timer = &system->timer;
+  const uint64_t period = (timer->reload != 0) ? timer->reload : (1ull << 32);
+
+  if (timer->control & TIMER_CONTROL_INTERRUPT)
+    raiseInterrupt(system, INTERRUPT_TIMER);
+
+  if (timer->control & TIMER_CONTROL_ONE_SHOT)
+  {
+    timer->control &= ~TIMER_CONTROL_EN;
+    timer->deadline = UINT64_MAX;
+  }
+  else
+    timer->deadline += ((uint64_t)timer->prescaler + 1) * period;
+}
+
+void enterTimerInterrupt(System *system, Trace *output)
+{
+  if (!handlePrepareForISR(system))
+    return;
+
+  system->control.pcAlreadyIncremented = true;
+
+  system->cpu.registers[IPC] = system->cpu.registers[PC];
+  system->cpu.registers[PC] = HARDWARE1_INTERRUPT_ADDR;
+  system->cpu.registers[CR] = TIMER_INTERRUPT_CODE;
+
+  printInterruptMessage(HARDWARE1_INTERRUPT_ADDR, output);
+}
+
+/******************************************************
+ * Block device
+ *******************************************************/
+
+// Maps the whole file; pages are read in as the guest touches them
+bool attachDisk(Disk *disk, const char *path, bool writable)
+{
+  const int file = open(path, writable ? O_RDWR : O_RDONLY);
+  struct stat status;
+
+  disk->data = NULL;
+  disk->size = 0;
+  disk->writable = writable;
+
+  if (file < 0 || fstat(file, &status) != 0 || status.st_size < DISK_SECTOR_SIZE)
+  {
+    fprintf(stderr, "Failed to open disk %s.\n", path);
+
+    if (file >= 0)
+      close(file);
+
+    return false;
+  }
+
+  const uint64_t size = (uint64_t)status.st_size / DISK_SECTOR_SIZE * DISK_SECTOR_SIZE;
+  void *data = mmap(NULL, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, writable ? MAP_SHARED : MAP_PRIVATE, file, 0);
+  close(file);
+
+  if (data == MAP_FAILED)
+  {
+    fprintf(stderr, "Failed to map disk %s.\n", path);
+    return false;
+  }
+
+  disk->data = (uint8_t *)data;
+  disk->size = size;
+
+  return true;
+}
+
+void detachDisk(Disk *disk)
+{
+  if (disk->data != NULL)
+    munmap(disk->data, disk->size);
+
+  disk->data = NULL;
+  disk->size = 0;
+}
+
+uint32_t readDiskRegister(System *system, uint32_t address)
+{
+  switch (address)
+  {
+  case DISK_SECTOR_ADDR:
+    return system->disk.sector;
+  case DISK_MEMORY_ADDR:
+    return system->disk.address;
+  case DISK_COUNT_ADDR:
+    return system->disk.count;
+  case DISK_CONTROL_ADDR:
+    return system->disk.control;
+  default:
+    return system->disk.size / DISK_SECTOR_SIZE;
+  }
+}
+
+void writeDiskRegister(System *system, uint32_t address, uint32_t value)
+{
+  switch (address)
+  {
+  case DISK_SECTOR_ADDR:
+    system->disk.sector = value;
+    break;
+  case DISK_MEMORY_ADDR:
+    system->disk.address = value;
+    break;
+  case DISK_COUNT_ADDR:
+    system->disk.count = value;
+    break;
+  case DISK_CONTROL_ADDR:
+    system->disk.control = value;
+
+    if (value & (DISK_CONTROL_READ | DISK_CONTROL_WRITE))
+      startDiskTransfer(system);
+  }
+}
+
+// Like DMA transfers, completes within the store that starts it
+void startDiskTransfer(System *system)
+{
+  Disk *disk = &system->disk;
+  const bool read = disk->control & DISK_CONTROL_READ;
+  const bool write = disk->control & DISK_CONTROL_WRITE;
+  const uint64_t offset = (uint64_t)disk->sector * DISK_SECTOR_SIZE;
+  const uint64_t length = (uint64_t)disk->count * DISK_SECTOR_SIZE;
+
+  const bool fits = offset + length <= disk->size && (uint64_t)disk->address + length <= MEMORY_SIZE;
+
+  disk->control &= DISK_CONTROL_INTERRUPT;
+
+  if (disk->data == NULL || read == write || !fits || (write && !disk->writable))
+    disk->control |= DISK_CONTROL_ST;
+  else if (read)
+    memcpy(system->memory + disk->address, disk->data + offset, length);
+  else
+    memcpy(disk->data + offset, system->memory + disk->address, length);
+
+  if (disk->control & DISK_CONTROL_INTERRUPT)
+    raiseInterrupt(system, INTERRUPT_DISK);
+}
+
+void enterDiskInterrupt(System *system, Trace *output)
+{
+  if (!handlePrepareForISR(system))
+    return;
+
+  system->control.pcAlreadyIncremented = true;
+
+  system->cpu.registers[IPC] = system->cpu.registers[PC];
+  system->cpu.registers[PC] = HARDWARE1_INTERRUPT_ADDR;
+  system->cpu.registers[CR] = DISK_INTERRUPT_CODE;
+
+  printInterruptMessage(HARDWARE1_INTERRUPT_ADDR, output);
+}
+
+/******************************************************
+ * Watchdog
+ *******************************************************/
+
+void updateWatchdog(System *system, uint32_t ticks)
+{
+  const int32_t en = system->watchdog.registers & 0x80000000;
+  int32_t counterValue = system->watchdog.registers & 0x7FFFFFFF;
+
+  if (en)
+  {
+    if (counterValue >= (int32_t)ticks)
+    {
+      counterValue -= ticks;
+      system->watchdog.registers = (system->watchdog.registers & 0x80000000) | counterValue;
+    }
+    else
+    {
+      system->watchdog.registers = 0x00000000; // EN = 0
+      raiseInterrupt(system, INTERRUPT_WATCHDOG);
+    }
+  }
+}
+
+void enterWatchdogInterrupt(System *system, Trace *output)
+{
+  if (!handlePrepareForISR(system))
+    return;
+
+  system->control.pcAlreadyIncremented = true;
+
+  system->cpu.registers[IPC] = system->cpu.registers[PC];
+  system->cpu.registers[PC] = HARDWARE1_INTERRUPT_ADDR;
+  system->cpu.registers[CR] = HARDWARE1_INTERRUPT_CODE;
+
+  printInterruptMessage(HARDWARE1_INTERRUPT_ADDR, output);
+}
+
+/******************************************************
+ * Timing model
+ *******************************************************/
+
+void initTiming(Timing *timing, Options *options)
+{
+  memset(timing, 0, sizeof(Timing));
+
+  timing->enabled = options->timing;
+  timing->timersUseCycles = options->timersUseCycles;
+
+  // Default costs of a simple in-order core
+  timing->costs.alu = 1;
+  timing->costs.mulDiv = 4;
+  timing->costs.memory = 2;
+  timing->costs.branchTaken = 3;
+  timing->costs.branchNotTaken = 1;
+  timing->costs.call = 3;
+  timing->costs.interrupt = 6;
+
+  if (options->timingCosts != NULL && !parseTimingCosts(options->timingCosts, &timing->costs))
+  {
+    fprintf(stderr, "Invalid timing specification: %s\n", options->timingCosts);
+    exit(EXIT_FAILURE);
+  }
+
+  for (uint8_t opcode = 0; opcode < 64; opcode++)
+    timing->opcodeCycles[opcode] = timing->costs.alu;
+
+  timing->opcodeCycles[0b010100] = timing->costs.mulDiv; // muli
+  timing->opcodeCycles[0b010101] = timing->costs.mulDiv; // divi
+  timing->opcodeCycles[0b010110] = timing->costs.mulDiv; // modi
+
+  for (uint8_t opcode = 0b011000; opcode <= 0b011101; opcode++) // l8 ... s32
+    timing->opcodeCycles[opcode] = timing->costs.memory;
+
+  timing->opcodeCycles[0b011110] = timing->costs.call; // call type F
+  timing->opcodeCycles[0b111001] = timing->costs.call; // call type S
+  timing->opcodeCycles[0b011111] = timing->costs.call; // ret
+  timing->opcodeCycles[0b100000] = timing->costs.call; // reti
+}
+
+bool parseTimingCosts(char *specification, TimingCosts *costs)
+{
+  const char *names[] = {"alu", "muldiv", "mem", "taken", "nottaken", "call", "interrupt"};
+  uint32_t *fields[] = {&costs->alu, &costs->mulDiv, &costs->memory, &costs->branchTaken,
+                        &costs->branchNotTaken, &costs->call, &costs->interrupt};
+
+  char *copy = strdup(specification);
+  bool valid = true;
+
+  for (char *entry = strtok(copy, ","); entry != NULL && valid; entry = strtok(NULL, ","))
+  {
+    char *value = strchr(entry, '=');
+    valid = false;
+
+    if (value == NULL)
+      break;
+
+    *value++ = '\0';
+
+    for (uint8_t i = 0; i < 7; i++)
+    {
+      if (strcmp(entry, names[i]) == 0)
+      {
+        // Every instruction takes at least a cycle; with --timer-clock=cycles
+        // a free one would leave the watchdog and timers standing still
+        uint64_t cycles;
+        valid = parseUnsigned(value, UINT32_MAX, &cycles) && cycles > 0;
+        *fields[i] = cycles;
+      }
+    }
+  }
+
+  free(copy);
+  return valid;
+}
+
+void accountCycles(System *system, uint8_t opcode)
+{
+  Timing *timing = &system->timing;
+  const uint32_t ir = system->cpu.registers[IR];
+
+  if (ir == 0) // Idle instruction
+    timing->cycles += timing->costs.alu;
+  else if (opcode >= 0b101010 && opcode <= 0b111000 && system->predictor.enabled) // Mispredictions are charged by predictBranch
+    timing->cycles += timing->costs.branchNotTaken;
+  else if (opcode >= 0b101010 && opcode <= 0b111000) // Branches, taken ones have moved PC
+    timing->cycles += system->control.pcAlreadyIncremented ? timing->costs.branchTaken : timing->costs.branchNotTaken;
+  else if (opcode == 0b001010 || opcode == 0b001011) // push, pop
+  {
+    const uint32_t operands[] = {(ir >> 6) & 0x1F, ir & 0x1F, (ir >> 16) & 0x1F, (ir >> 11) & 0x1F, (ir >> 21) & 0x1F};
+
+    uint32_t count = 0;
+    while (count < 5 && operands[count] != 0)
+      count++;
+
+    timing->cycles += (count > 0 ? count : 1) * timing->costs.memory;
+  }
+  else if (opcode == 0b000100) // Odd sub-opcodes are the shifts
+    timing->cycles += ((ir >> 8) & 0x1) ? timing->costs.alu : timing->costs.mulDiv;
+  else
+    timing->cycles += timing->opcodeCycles[opcode];
+}
+
+uint32_t elapsedTicks(Timing *timing)
+{
+  const uint32_t ticks = timing->cycles - timing->lastTick;
+  timing->lastTick = timing->cycles;
+
+  return ticks;
+}
+
+/******************************************************
+ * Performance counters
+ *******************************************************/
+
+void countEvents(System *system, uint8_t opcode)
+{
+  switch (opcode)
+  {
+  case 0b011000: // l8
+  case 0b011001: // l16
+  case 0b011010: // l32
+  case 0b001011: // pop
+    system->counters.loads++;
+    break;
+  case 0b011011: // s8
+  case 0b011100: // s16
+  case 0b011101: // s32
+  case 0b001010: // push
+    system->counters.stores++;
+    break;
+  default:
+    if (opcode >= 0b101010 && opcode <= 0b111000 && system->control.pcAlreadyIncremented)
+      system->counters.takenBranches++;
+  }
+}
+
+uint64_t readPerformanceCounter(System *system, uint8_t index)
+{
+  uint64_t value = 0;
+
+  switch (index)
+  {
+  case PERF_COUNTER_INSTRUCTIONS:
+    value = system->timing.instructions;
+    break;
+  case PERF_COUNTER_CYCLES:
+    // One cycle per instruction when the timing model is off
+    value = system->timing.enabled ? system->timing.cycles : system->timing.instructions;
+    break;
+  case PERF_COUNTER_LOADS:
+    value = system->counters.loads;
+    break;
+  case PERF_COUNTER_STORES:
+    value = system->counters.stores;
+    break;
+  case PERF_COUNTER_TAKEN_BRANCHES:
+    value = system->counters.takenBranches;
+    break;
+  case PERF_COUNTER_INTERRUPTS:
+    value = system->timing.interrupts;
+    break;
+  }
+
+  return value - system->counters.base[index];
+}
+
+bool isPerformanceCounterAddress(uint32_t memoryAddress)
+{
+  return memoryAddress >= PERF_COUNTER_BASE_ADDR && memoryAddress <= PERF_COUNTER_CONTROL_ADDR;
+}
+
+uint32_t readPerformanceCounterRegister(System *system, uint32_t memoryAddress)
+{
+  system->counters.reads++;
+
+  if (memoryAddress == PERF_COUNTER_CONTROL_ADDR)
+    return 0;
+
+  const uint8_t index = (memoryAddress - PERF_COUNTER_BASE_ADDR) / 8;
+
+  // Reading the low word latches the high word, so a LO/HI pair is consistent
+  if ((memoryAddress & 0x4) == 0)
+  {
+    const uint64_t value = readPerformanceCounter(system, index);
+
+    system->counters.latch = value >> 32;
+    return value & 0xFFFFFFFF;
+  }
+
+  return system->counters.latch;
+}
+
+void writePerformanceCounterRegister(System *system, uint32_t memoryAddress, uint32_t value)
+{
+  // Any write to a counter resets it, the control register resets by mask
+  const uint32_t mask = (memoryAddress == PERF_COUNTER_CONTROL_ADDR) ? value : (1u << ((memoryAddress - PERF_COUNTER_BASE_ADDR) / 8));
+
+  for (uint8_t index = 0; index < PERF_COUNTER_COUNT; index++)
+  {
+    if (mask & (1u << index))
+      system->counters.base[index] += readPerformanceCounter(system, index);
+  }
+}
+
+/******************************************************
+ * Pipeline model
+ *******************************************************/
+
+void initPipeline(Pipeline *pipeline, Options *options)
+{
+  memset(pipeline, 0, sizeof(Pipeline));
+
+  pipeline->enabled = options->pipeline;
+  pipeline->forwarding = options->forwarding;
+
+  if (!pipeline->enabled)
+    return;
+
+  // One entry per word of guest memory
+  pipeline->stallsByPC = (PipelineStalls *)calloc(MEMORY_SIZE / 4, sizeof(PipelineStalls));
+  if (pipeline->stallsByPC == NULL)
+  {
+    fprintf(stderr, "Failed to allocate memory for pipeline.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  // Cycles to fill IF/ID/EX/MEM before the first instruction retires
+  pipeline->cycles = PIPELINE_DEPTH - 1;
+}
+
+void resetPipeline(Pipeline *pipeline)
+{
+  if (!pipeline->enabled)
+    return;
+
+  PipelineStalls *stallsByPC = pipeline->stallsByPC;
+  const bool forwarding = pipeline->forwarding;
+
+  memset(pipeline, 0, sizeof(Pipeline));
+  memset(stallsByPC, 0, (MEMORY_SIZE / 4) * sizeof(PipelineStalls));
+
+  pipeline->enabled = true;
+  pipeline->forwarding = forwarding;
+  pipeline->stallsByPC = stallsByPC;
+  pipeline->cycles = PIPELINE_DEPTH - 1;
+}
+
+void freePipeline(Pipeline *pipeline)
+{
+  free(pipeline->stallsByPC);
+  pipeline->stallsByPC = NULL;
+}
+
+uint32_t registerBit(uint8_t index)
+{
+  // R0 is hardwired to zero and PC/IR are handled by the fetch stage
+  return (index != 0 && index != PC && index != IR) ? (1u << index) : 0;
+}
+
+void decodeRegisterUsage(uint32_t ir, uint32_t *reads, uint32_t *writes, bool *load)
+{
+  const uint8_t opcode = (ir >> 26) & 0x3F;
+  const uint8_t z = (ir >> 21) & 0x1F;
+  const uint8_t x = (ir >> 16) & 0x1F;
+  const uint8_t y = (ir >> 11) & 0x1F;
+  const uint8_t l = ir & 0x1F;
+
+  *reads = 0;
+  *writes = 0;
+  *load = false;
+
+  if (ir == 0) // Idle instruction
+    return;
+
+  switch (opcode)
+  {
+  case 0b000000: // mov
+  case 0b000001: // movs
+    *writes = registerBit(z);
+    break;
+  case 0b000010: // add
+  case 0b000011: // sub
+  case 0b000101: // cmp
+  case 0b000110: // and
+  case 0b000111: // or
+  case 0b001001: // xor
+    *reads = registerBit(x) | registerBit(y);
+    *writes = registerBit(z) | registerBit(SR);
+    break;
+  case 0b001000: // not
+    *reads = registerBit(x);
+    *writes = registerBit(z) | registerBit(SR);
+    break;
+  case 0b000100: // mul, sll, muls, sla, div, srl, divs, sra
+    if ((ir >> 8) & 0x1) // Shifts read and write the z:x pair
+    {
+      *reads = registerBit(z) | registerBit(y);
+      *writes = registerBit(z) | registerBit(x) | registerBit(SR);
+    }
+    else
+    {
+      *reads = registerBit(x) | registerBit(y);
+      *writes = registerBit(z) | registerBit(l) | registerBit(SR);
+    }
+    break;
+  case 0b010010: // addi
+  case 0b010011: // subi
+  case 0b010100: // muli
+  case 0b010101: // divi
+  case 0b010110: // modi
+    *reads = registerBit(x);
+    *writes = registerBit(z) | registerBit(SR);
+    break;
+  case 0b010111: // cmpi
+    *reads = registerBit(x);
+    *writes = registerBit(SR);
+    break;
+  case 0b011000: // l8
+  case 0b011001: // l16
+  case 0b011010: // l32
+    *reads = registerBit(x);
+    *writes = registerBit(z);
+    *load = true;
+    break;
+  case 0b011011: // s8
+  case 0b011100: // s16
+  case 0b011101: // s32
+    *reads = registerBit(x) | registerBit(z);
+    break;
+  case 0b011110: // call type F
+    *reads = registerBit(x) | registerBit(SP);
+    *writes = registerBit(SP);
+    break;
+  case 0b111001: // call type S
+    *reads = registerBit(SP);
+    *writes = registerBit(SP);
+    break;
+  case 0b011111: // ret
+    *reads = registerBit(SP);
+    *writes = registerBit(SP);
+    *load = true;
+    break;
+  case 0b001010: // push
+  case 0b001011: // pop
+  {
+    const uint8_t operands[] = {(ir >> 6) & 0x1F, l, x, y, z};
+    uint32_t list = 0;
+
+    for (uint8_t i = 0; i < 5 && operands[i] != 0; i++)
+      list |= registerBit(operands[i]);
+
+    *reads = registerBit(SP) | (opcode == 0b001010 ? list : 0);
+    *writes = registerBit(SP) | (opcode == 0b001011 ? list : 0);
+    *load = (opcode == 0b001011);
+    break;
+  }
+  case 0b100000: // reti
+    *reads = registerBit(SP);
+    *writes = registerBit(SP) | registerBit(IPC) | registerBit(CR);
+    *load = true;
+    break;
+  case 0b100001: // cbr, sbr
+    *reads = registerBit(z);
+    *writes = registerBit(z);
+    break;
+  case 0b110111: // bun
+  case 0b111111: // int
+    break;
+  default:
+    if (opcode >= 0b101010 && opcode <= 0b111000) // Conditional branches
+      *reads = registerBit(SR);
+  }
+}
+
+void simulatePipeline(System *system, uint8_t opcode)
+{
+  Pipeline *pipeline = &system->pipeline;
+
+  uint32_t reads, writes;
+  bool load;
+  decodeRegisterUsage(system->cpu.registers[IR], &reads, &writes, &load);
+
+  const uint32_t pc = system->control.oldPC;
+  PipelineStalls empty = {0};
+  PipelineStalls *stalls = (pc / 4 < MEMORY_SIZE / 4) ? &pipeline->stallsByPC[pc / 4] : &empty;
+
+  // RAW hazards against the two instructions ahead in EX and MEM
+  uint32_t bubbles = 0;
+  if (pipeline->forwarding)
+  {
+    if (pipeline->previousLoad && (reads & pipeline->writes[0]))
+    {
+      bubbles = 1;
+      stalls->loadUse++;
+      pipeline->total.loadUse++;
+    }
+  }
+  else
+  {
+    if (reads & pipeline->writes[0])
+      bubbles = 2;
+    else if (reads & pipeline->writes[1])
+      bubbles = 1;
+
+    if (bubbles > 0)
+    {
+      if (pipeline->previousLoad && (reads & pipeline->writes[0]))
+      {
+        stalls->loadUse += bubbles;
+        pipeline->total.loadUse += bubbles;
+      }
+      else
+      {
+        stalls->data += bubbles;
+        pipeline->total.data += bubbles;
+      }
+    }
+  }
+
+  // A stall lets the older producer reach write back
+  pipeline->writes[1] = (bubbles > 0) ? 0 : pipeline->writes[0];
+  pipeline->writes[0] = writes;
+  pipeline->previousLoad = load;
+
+  pipeline->instructions++;
+  pipeline->cycles += 1 + bubbles;
+
+  // Control transfers are resolved in EX, interrupts squash everything behind
+  const bool interrupted = (system->timing.interrupts != pipeline->lastInterrupts);
+  pipeline->lastInterrupts = system->timing.interrupts;
+
+  if (interrupted)
+  {
+    stalls->interrupt += PIPELINE_INTERRUPT_FLUSH;
+    pipeline->total.interrupt += PIPELINE_INTERRUPT_FLUSH;
+    pipeline->interruptFlushes++;
+    pipeline->cycles += PIPELINE_INTERRUPT_FLUSH;
+  }
+  else if (system->predictor.enabled ? system->predictor.mispredicted : (system->control.pcAlreadyIncremented && opcode != 0b111111))
+  {
+    stalls->branch += PIPELINE_BRANCH_FLUSH;
+    pipeline->total.branch += PIPELINE_BRANCH_FLUSH;
+    pipeline->branchFlushes++;
+    pipeline->cycles += PIPELINE_BRANCH_FLUSH;
+  }
+
+  if (interrupted || system->control.pcAlreadyIncremented)
+  {
+    pipeline->writes[0] = pipeline->writes[1] = 0;
+    pipeline->previousLoad = false;
+  }
+
+  system->predictor.mispredicted = false;
+}
+
+/******************************************************
+ * Branch prediction
+ *******************************************************/
+
+// <btfn|bimodal|gshare>[:<index bits>]
+bool parsePredictorSpecification(const char *specification, char *model, uint32_t *bits)
+{
+  // <model> or <model>:<bits>
+  const char *colon = strchr(specification, ':');
+  const size_t length = (colon != NULL) ? (size_t)(colon - specification) : strlen(specification);
+  uint64_t value = 12;
+
+  memset(model, 0, 16);
+
+  if (length == 0 || length > 15 || (colon != NULL && (!parseUnsigned(colon + 1, 24, &value) || value == 0)))
+  {
+    fprintf(stderr, "Invalid predictor specification: %s\n", specification);
+    return false;
+  }
+
+  memcpy(model, specification, length);
+  *bits = value;
+
+  if (strcmp(model, "btfn") != 0 && strcmp(model, "bimodal") != 0 && strcmp(model, "gshare") != 0)
+  {
+    fprintf(stderr, "Unknown branch predictor: %s\n", model);
+    return false;
+  }
+
+  return true;
+}
+
+void initBranchPredictor(BranchPredictor *predictor, Options *options)
+{
+  memset(predictor, 0, sizeof(BranchPredictor));
+
+  if (options->predictor == NULL)
+    return;
+
+  char model[16];
+  uint32_t bits;
+  if (!parsePredictorSpecification(options->predictor, model, &bits))
+    exit(EXIT_FAILURE);
+
+  if (strcmp(model, "btfn") == 0)
+  {
+    predictor->predict = predictBTFN;
+    predictor->update = NULL;
+  }
+  else if (strcmp(model, "bimodal") == 0)
+  {
+    predictor->predict = predictBimodal;
+    predictor->update = updateBimodal;
+  }
+  else
+  {
+    predictor->predict = predictGshare;
+    predictor->update = updateGshare;
+  }
+
+  predictor->enabled = true;
+  strcpy(predictor->name, model);
+  predictor->indexBits = bits;
+  predictor->penalty = options->predictorPenalty;
+  predictor->returnCapacity = RETURN_STACK_SIZE;
+
+  // Counters start weakly not taken
+  predictor->counters = (uint8_t *)malloc(1u << bits);
+  predictor->returnStack = (uint32_t *)calloc(predictor->returnCapacity, sizeof(uint32_t));
+  predictor->targetsByPC = (uint32_t *)calloc(MEMORY_SIZE / 4, sizeof(uint32_t));
+  predictor->statsByPC = (BranchStats *)calloc(MEMORY_SIZE / 4, sizeof(BranchStats));
+
+  if (predictor->counters == NULL || predictor->returnStack == NULL || predictor->targetsByPC == NULL || predictor->statsByPC == NULL)
+  {
+    fprintf(stderr, "Failed to allocate memory for branch predictor.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  memset(predictor->counters, 1, 1u << bits);
+}
+
+void resetBranchPredictor(BranchPredictor *predictor)
+{
+  if (!predictor->enabled)
+    return;
+
+  memset(predictor->counters, 1, 1u << predictor->indexBits);
+  memset(predictor->returnStack, 0, predictor->returnCapacity * sizeof(uint32_t));
+  memset(predictor->targetsByPC, 0, (MEMORY_SIZE / 4) * sizeof(uint32_t));
+  memset(predictor->statsByPC, 0, (MEMORY_SIZE / 4) * sizeof(BranchStats));
+  memset(predictor->stats, 0, sizeof(predictor->stats));
+
+  predictor->history = 0;
+  predictor->returnDepth = 0;
+  predictor->returnTop = 0;
+  predictor->mispredicted = false;
+}
+
+void freeBranchPredictor(BranchPredictor *predictor)
+{
+  free(predictor->counters);
+  free(predictor->returnStack);
+  free(predictor->targetsByPC);
+  free(predictor->statsByPC);
+  memset(predictor, 0, sizeof(BranchPredictor));
+}
+
+bool predictBTFN(BranchPredictor *predictor, uint32_t pc, uint32_t target)
+{
+  (void)predictor;
+
+  return target <= pc; // Backward taken, forward not taken
+}
+
+bool predictBimodal(BranchPredictor *predictor, uint32_t pc, uint32_t target)
+{
+  (void)target;
+
+  return predictor->counters[(pc >> 2) & ((1u << predictor->indexBits) - 1)] >= 2;
+}
+
+void updateBimodal(BranchPredictor *predictor, uint32_t pc, bool taken)
+{
+  uint8_t *counter = &predictor->counters[(pc >> 2) & ((1u << predictor->indexBits) - 1)];
+
+  if (taken && *counter < 3)
+    (*counter)++;
+  else if (!taken && *counter > 0)
+    (*counter)--;
+}
+
+bool predictGshare(BranchPredictor *predictor, uint32_t pc, uint32_t target)
+{
+  (void)target;
+
+  return predictor->counters[((pc >> 2) ^ predictor->history) & ((1u << predictor->indexBits) - 1)] >= 2;
+}
+
+void updateGshare(BranchPredictor *predictor, uint32_t pc, bool taken)
+{
+  const uint32_t mask = (1u << predictor->indexBits) - 1;
+  uint8_t *counter = &predictor->counters[((pc >> 2) ^ predictor->history) & mask];
+
+  if (taken && *counter < 3)
+    (*counter)++;
+  else if (!taken && *counter > 0)
+    (*counter)--;
+
+  predictor->history = ((predictor->history << 1) | taken) & mask;
+}
+
+void predictBranch(System *system, BranchKind kind, uint32_t pc, uint32_t target, bool taken)
+{
+  BranchPredictor *predictor = &system->predictor;
+  bool correct = true;
+
+  switch (kind)
+  {
+  case BRANCH_CONDITIONAL:
+    correct = (predictor->predict(predictor, pc, target) == taken);
+
+    if (predictor->update != NULL)
+      predictor->update(predictor, pc, taken);
+    break;
+  case BRANCH_DIRECT:
+    // Target is encoded in the instruction and known at decode
+    break;
+  case BRANCH_CALL:
+  case BRANCH_INDIRECT_CALL:
+    if (kind == BRANCH_INDIRECT_CALL && pc / 4 < MEMORY_SIZE / 4)
+    {
+      correct = (predictor->targetsByPC[pc / 4] == target);
+      predictor->targetsByPC[pc / 4] = target;
+    }
+
+    predictor->returnTop = (predictor->returnTop + 1) % predictor->returnCapacity;
+    predictor->returnStack[predictor->returnTop] = pc + 4;
+
+    if (predictor->returnDepth < predictor->returnCapacity)
+      predictor->returnDepth++;
+    break;
+  case BRANCH_RETURN:
+    correct = (predictor->returnDepth > 0 && predictor->returnStack[predictor->returnTop] == target);
+
+    if (predictor->returnDepth > 0)
+    {
+      predictor->returnTop = (predictor->returnTop + predictor->returnCapacity - 1) % predictor->returnCapacity;
+      predictor->returnDepth--;
+    }
+    break;
+  }
+
+  BranchStats *stats = &predictor->stats[kind];
+  stats->branches++;
+  stats->mispredictions += !correct;
+
+  if (pc / 4 < MEMORY_SIZE / 4)
+  {
+    predictor->statsByPC[pc / 4].branches++;
+    predictor->statsByPC[pc / 4].mispredictions += !correct;
+  }
+
+  predictor->mispredicted = !correct;
+
+  if (!correct && system->timing.enabled)
+    system->timing.cycles += predictor->penalty;
+}
+
+/******************************************************
+ * FPU
+ *******************************************************/
+
+void executeFPU(System *system, uint32_t ticks)
+{
+  if (decrementFPUTimer(&system->fpu.timer, ticks))
+    raiseInterrupt(system, INTERRUPT_FPU);
+
+  // A finished operation waits for its interrupt to reset the opcode
+  if (system->interrupts.pending & (1u << INTERRUPT_FPU))
+    return;
+
+  const uint8_t opcode = system->fpu.registers.control & 0x1F;
+
+  if (opcode != 0 && (system->fpu.registers.control & FPU_CONTROL_VECTOR_MASK))
+  {
+    executeVectorFPU(system, opcode);
+    return;
+  }
+
+  switch (opcode)
+  {
+  case 0b00000:
+    break;
+  case 0b00001: // Adition
+    addFPU(&system->fpu);
+
+    setFPUTimerVariableCycle(system);
+    break;
+  case 0b00010: // Subtraction
+    subtractFPU(&system->fpu);
+
+    setFPUTimerVariableCycle(system);
+    break;
+  case 0b00011: // Multiplication
+    multiplyFPU(&system->fpu);
+
+    setFPUTimerVariableCycle(system);
+    break;
+  case 0b00100: // Division
+    divideFPU(&system->fpu);
+
+    setFPUTimerVariableCycle(system);
+    break;
+  case 0b00101: // Assign x from z
+    assignXFromZFPU(&system->fpu);
+
+    completeFPUOperation(&system->fpu);
+    break;
+  case 0b00110: // Assign y from z
+    assignYFromZFPU(&system->fpu);
+
+    completeFPUOperation(&system->fpu);
+    break;
+  case 0b00111: // Ceiling
+    ceilingZFPU(&system->fpu);
+
+    completeFPUOperation(&system->fpu);
+    break;
+  case 0b01000: // Floor
+    floorZFPU(&system->fpu);
+
+    completeFPUOperation(&system->fpu);
+    break;
+  case 0b01001: // Round
+    roundZFPU(&system->fpu);
+
+    completeFPUOperation(&system->fpu);
+    break;
+  default:
+    rejectFPUOperation(&system->fpu);
+  }
+}
+
+// Single-cycle operation: the completion interrupt follows on the next tick
+void completeFPUOperation(FPU *fpu)
+{
+  fpu->timer.counter = 1;
+  fpu->timer.interrupt.code = HARDWARE4_INTERRUPT_ADDR;
+  fpu->timer.enabled = true;
+}
+
+// Invalid operation: ST is set and the error interrupt follows
+void rejectFPUOperation(FPU *fpu)
+{
+  setFPUControlSTField(fpu, true);
+
+  fpu->timer.counter = 1;
+  fpu->timer.interrupt.code = HARDWARE2_INTERRUPT_ADDR;
+  fpu->timer.enabled = true;
+  fpu->previousControlStatus = true;
+}
+
+// Computes the whole arrays when the operation starts; the completion
+// interrupt comes after one tick per FPU_VECTOR_WIDTH elements
+void executeVectorFPU(System *system, uint8_t opcode)
+{
+  FPU *fpu = &system->fpu;
+  const FPUVector *vector = &fpu->vector;
+  const uint64_t bytes = (uint64_t)vector->length * 4;
+
+  if (fpu->timer.enabled)
+    return;
+
+  // The kernels read ahead of their stores in groups of different sizes, so
+  // z may only start where x or y does or stay clear of them
+  if (opcode > 0b00100 || vector->x + bytes > MEMORY_SIZE || vector->y + bytes > MEMORY_SIZE || vector->z + bytes > MEMORY_SIZE ||
+      overlapsPartially(vector->z, vector->x, bytes) || overlapsPartially(vector->z, vector->y, bytes))
+  {
+    rejectFPUOperation(fpu);
+    return;
+  }
+
+  bool divideByZero = false;
+
+  for (uint32_t i = 0; opcode == 0b00100 && i < vector->length && !divideByZero; i++)
+    divideByZero = (readMemory32(system, vector->y + 4 * i) & 0x7FFFFFFF) == 0;
+
+  // As in divideFPU, a zero divisor leaves the result alone and ends in the error interrupt
+  if (divideByZero)
+    fpu->previousControlStatus = true;
+  else
+    runVectorFPUKernel(system->memory, vector, opcode, system->options.simd);
+
+  fpu->timer.counter = 1 + (vector->length + FPU_VECTOR_WIDTH - 1) / FPU_VECTOR_WIDTH;
+  fpu->timer.interrupt.code = HARDWARE3_INTERRUPT_ADDR;
+  fpu->timer.enabled = true;
+}
+
+bool overlapsPartially(uint32_t first, uint32_t second, uint64_t bytes)
+{
+  return first != second && first < second + bytes && second < first + bytes;
+}
+
+// z[i] = x[i] op y[i] over big-endian words; z is x, y or clear of both. The AVX2
+// kernel takes whole groups of eight and the loop below the rest
+void runVectorFPUKernel(uint8_t *memory, const FPUVector *vector, uint8_t opcode, bool simd)
+{
+  uint32_t i = 0;
+
+#ifdef AVX2_KERNELS
+  if (simd && hasAVX2())
+    i = runVectorFPUKernelAVX2(memory, vector, opcode);
+#endif
+
+  for (; i < vector->length; i++)
+  {
+    uint32_t word;
+    float x, y, z;
+
+    word = loadLane32(memory, vector->x + 4 * i);
+    memcpy(&x, &word, sizeof(float));
+    word = loadLane32(memory, vector->y + 4 * i);
+    memcpy(&y, &word, sizeof(float));
+
+    switch (opcode)
+    {
+    case 0b00001:
+      z = x + y;
+      break;
+    case 0b00010:
+      z = x - y;
+      break;
+    case 0b00011:
+      z = x * y;
+      break;
+    default:
+      z = x / y;
+    }
+
+    memcpy(&word, &z, sizeof(float));
+    storeLane32(memory, vector->z + 4 * i, word);
+  }
+}
+
+#ifdef AVX2_KERNELS
+
+// Returns how many elements it computed, a multiple of eight
+__attribute__((target("avx2"))) uint32_t runVectorFPUKernelAVX2(uint8_t *memory, const FPUVector *vector, uint8_t opcode)
+{
+  // Reverses the bytes of each word
+  const __m256i swap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  uint32_t i = 0;
+
+  for (; i + 8 <= vector->length; i += 8)
+  {
+    const __m256 x = _mm256_castsi256_ps(_mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *)(memory + vector->x + 4 * i)), swap));
+    const __m256 y = _mm256_castsi256_ps(_mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *)(memory + vector->y + 4 * i)), swap));
+    __m256 z;
+
+    switch (opcode)
+    {
+    case 0b00001:
+      z = _mm256_add_ps(x, y);
+      break;
+    case 0b00010:
+      z = _mm256_sub_ps(x, y);
+      break;
+    case 0b00011:
+      z = _mm256_mul_ps(x, y);
+      break;
+    default:
+      z = _mm256_div_ps(x, y);
+    }
+
+    _mm256_storeu_si256((__m256i *)(memory + vector->z + 4 * i), _mm256_shuffle_epi8(_mm256_castps_si256(z), swap));
+  }
+
+  return i;
+}
+
+bool hasAVX2(void)
+{
+  return __builtin_cpu_supports("avx2");
+}
+
+#endif
+
+void addFPU(FPU *fpu)
+{
+  float z = fpu->registers.x.f + fpu->registers.y.f;
+  fpu->registers.z.f = z;
+  fpu->registers.z.u = convertToIEEE754(&z);
+}
+
+void subtractFPU(FPU *fpu)
+{
+  float z = fpu->registers.x.f - fpu->registers.y.f;
+  fpu->registers.z.f = z;
+  fpu->registers.z.u = convertToIEEE754(&z);
+}
+
+void multiplyFPU(FPU *fpu)
+{
+  float z = fpu->registers.x.f * fpu->registers.y.f;
+  fpu->registers.z.f = z;
+  fpu->registers.z.u = convertToIEEE754(&z);
+}
+
+void divideFPU(FPU *fpu)
+{
+  if (fpu->registers.y.f != 0)
+  {
+    float z = fpu->registers.x.f / fpu->registers.y.f;
+    fpu->registers.z.f = z;
+    fpu->registers.z.u = convertToIEEE754(&z);
+  }
+  else
+  {
+    fpu->previousControlStatus = true;
+  }
+}
+
+void assignXFromZFPU(FPU *fpu)
+{
+  fpu->registers.x.f = fpu->registers.z.f;
+  fpu->registers.x.u = fpu->registers.z.u;
+}
+
+void assignYFromZFPU(FPU *fpu)
+{
+  fpu->registers.y.f = fpu->registers.z.f;
+  fpu->registers.y.u = fpu->registers.z.u;
+}
+
+void ceilingZFPU(FPU *fpu)
+{
+  fpu->registers.z.u = ceilf(fpu->registers.z.f);
+}
+
+void floorZFPU(FPU *fpu)
+{
+  fpu->registers.z.u = floorf(fpu->registers.z.f);
+}
+
+void roundZFPU(FPU *fpu)
+{
+  fpu->registers.z.u = roundf(fpu->registers.z.f);
+}
+
+void setFPUControlSTField(FPU *fpu, bool enable)
+{
+  if (enable)
+    fpu->registers.control |= FPU_CONTROL_ST_MASK;
+  else
+    fpu->registers.control &= ~FPU_CONTROL_ST_MASK;
+}
+
+void resetFPUControlOPCodeField(FPU *fpu)
+{
+  fpu->registers.control &= FPU_CONTROL_ST_MASK;
+}
+
+bool getFPUControlSTField(FPU *fpu)
+{
+  const uint32_t st = fpu->registers.control & FPU_CONTROL_ST_MASK;
+
+  if (st > 0)
+    return true;
+  else
+    return false;
+}
+
+void handleFPUErrors(System *system, Trace *output)
+{
+  if (system->fpu.previousControlStatus) // Error in operation (ST = 1)
+  {
+    if (!handlePrepareForISR(system))
+      return;
+
+    system->control.pcAlreadyIncremented = true;
+
+    system->cpu.registers[IPC] = system->control.oldPC;
+    system->cpu.registers[PC] = HARDWARE2_INTERRUPT_ADDR;
+    system->cpu.registers[CR] = FPU_INTERRUPT_CODE;
+
+    printInterruptMessage(HARDWARE2_INTERRUPT_ADDR, output);
+
+    system->fpu.previousControlStatus = false;
+
+    resetFPUControlOPCodeField(&system->fpu);
+    setFPUControlSTField(&system->fpu, true);
+  }
+
+  else
+  {
+    if (!handlePrepareForISR(system))
+      return;
+
+    system->control.pcAlreadyIncremented = true;
+
+    system->cpu.registers[IPC] = system->control.oldPC;
+    system->cpu.registers[PC] = system->fpu.timer.interrupt.code;
+    system->cpu.registers[CR] = FPU_INTERRUPT_CODE;
+
+    printInterruptMessage(system->fpu.timer.interrupt.code, output);
+
+    resetFPUControlOPCodeField(&system->fpu);
+  }
+}
+
+void setFPUTimerVariableCycle(System *system)
+{
+  if (!system->fpu.timer.enabled)
+  {
+    uint32_t x = convertToIEEE754(&system->fpu.registers.x.f);
+    uint32_t y = convertToIEEE754(&system->fpu.registers.y.f);
+
+    system->fpu.timer.counter = calculateExponentDifference(x, y);
+    system->fpu.timer.interrupt.code = HARDWARE3_INTERRUPT_ADDR;
+    system->fpu.timer.enabled = true;
+  }
+}
+
+// Returns whether the timer expired
+bool decrementFPUTimer(FPUTimer *timer, uint32_t ticks)
+{
+  if (timer->enabled && timer->counter > 0)
+  {
+    timer->counter = (timer->counter > ticks) ? timer->counter - ticks : 0;
+    if (timer->counter == 0)
+    {
+      timer->enabled = false;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+uint32_t convertToIEEE754(float *x)
+{
+  const uint32_t xi = *((uint32_t *)x);
+
+  return xi;
+}
+
+uint32_t calculateExponentDifference(uint32_t x, uint32_t y)
+{
+  const uint32_t exponentX = (x >> 23) & 0xFF;
+  const uint32_t exponentY = (y >> 23) & 0xFF;
+
+  return abs(exponentX - exponentY) + 1;
+}
+
+/******************************************************
+ * Profiler
+ *******************************************************/
+
+void initProfiler(Profiler *profiler, bool enabled, bool countCycles)
+{
+  memset(profiler, 0, sizeof(Profiler));
+  profiler->enabled = enabled;
+  profiler->countCycles = countCycles;
+
+  if (!enabled)
+    return;
+
+  profiler->capacity = 64;
+  profiler->nodes = (ProfilerNode *)calloc(profiler->capacity, sizeof(ProfilerNode));
+
+  profiler->stackCapacity = 64;
+  profiler->stack = (ProfilerFrame *)calloc(profiler->stackCapacity, sizeof(ProfilerFrame));
+
+  if (profiler->nodes == NULL || profiler->stack == NULL)
+  {
+    fprintf(stderr, "Failed to allocate memory for profiler.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  // Root context: the program entry point
+  profiler->size = 1;
+  profiler->nodes[0].function = INIT_INTERRUPT_ADDR;
+  profiler->nodes[0].calls = 1;
+
+  profiler->depth = 1;
+  profiler->stack[0].node = 0;
+}
+
+void resetProfiler(Profiler *profiler)
+{
+  if (!profiler->enabled)
+    return;
+
+  memset(profiler->nodes, 0, profiler->capacity * sizeof(ProfilerNode));
+
+  // Root context: the program entry point
+  profiler->size = 1;
+  profiler->nodes[0].function = INIT_INTERRUPT_ADDR;
+  profiler->nodes[0].calls = 1;
+
+  profiler->depth = 1;
+  profiler->stack[0].node = 0;
+  profiler->stack[0].returnAddress = 0;
+
+  profiler->lastCycles = 0;
+  profiler->interruptEntered = false;
+  profiler->interruptReturn = 0;
+
+  attachProfilerLoops(profiler, NULL);
+}
+
+void freeProfiler(Profiler *profiler)
+{
+  free(profiler->nodes);
+  free(profiler->stack);
+  free(profiler->loops);
+  memset(profiler, 0, sizeof(Profiler));
+}
+
+uint32_t findProfilerNode(Profiler *profiler, uint32_t parent, uint32_t function, uint32_t callSite)
+{
+  for (uint32_t child = profiler->nodes[parent].firstChild; child != 0; child = profiler->nodes[child].nextSibling)
+  {
+    if (profiler->nodes[child].function == function)
+      return child;
+  }
+
+  if (profiler->size == profiler->capacity)
+  {
+    profiler->capacity *= 2;
+    profiler->nodes = (ProfilerNode *)realloc(profiler->nodes, profiler->capacity * sizeof(ProfilerNode));
+
+    if (profiler->nodes == NULL)
+    {
+      fprintf(stderr, "Failed to allocate memory for profiler.\n");
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  const uint32_t node = profiler->size++;
+
+  profiler->nodes[node].function = function;
+  profiler->nodes[node].callSite = callSite;
+  profiler->nodes[node].parent = parent;
+  profiler->nodes[node].firstChild = 0;
+  profiler->nodes[node].nextSibling = profiler->nodes[parent].firstChild;
+  profiler->nodes[node].calls = 0;
+  profiler->nodes[node].self.instructions = 0;
+  profiler->nodes[node].self.cycles = 0;
+
+  profiler->nodes[parent].firstChild = node;
+
+  return node;
+}
+
+void profilerEnter(Profiler *profiler, uint32_t function, uint32_t callSite, uint32_t returnAddress)
+{
+  const uint32_t parent = profiler->stack[profiler->depth - 1].node;
+  const uint32_t node = findProfilerNode(profiler, parent, function, callSite);
+
+  profiler->nodes[node].calls++;
+
+  if (profiler->depth == profiler->stackCapacity)
+  {
+    profiler->stackCapacity *= 2;
+    profiler->stack = (ProfilerFrame *)realloc(profiler->stack, profiler->stackCapacity * sizeof(ProfilerFrame));
+
+    if (profiler->stack == NULL)
+    {
+      fprintf(stderr, "Failed to allocate memory for profiler.\n");
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  profiler->stack[profiler->depth].node = node;
+  profiler->stack[profiler->depth].returnAddress = returnAddress;
+  profiler->depth++;
+}
+
+void profilerReturn(Profiler *profiler, uint32_t returnAddress)
+{
+  // Unwind to the frame that expected this return address, so frames
+  // skipped by guest code that manipulates SP do not stay on the stack
+  for (size_t i = profiler->depth - 1; i > 0; i--)
+  {
+    if (profiler->stack[i].returnAddress == returnAddress)
+    {
+      profiler->depth = i;
+      return;
+    }
+  }
+
+  if (profiler->depth > 1)
+    profiler->depth--;
+}
+
+void profileInstruction(System *system, uint8_t opcode)
+{
+  Profiler *profiler = &system->profiler;
+
+  // Address of the next instruction, before any interrupt redirected PC
+  const uint32_t pc = profiler->interruptEntered ? profiler->interruptReturn : system->cpu.registers[PC];
+
+  ProfilerCost *self = &profiler->nodes[profiler->stack[profiler->depth - 1].node].self;
+  const uint64_t cycles = system->timing.cycles - profiler->lastCycles;
+
+  self->instructions++;
+  self->cycles += cycles;
+  profiler->lastCycles = system->timing.cycles;
+
+  if (profiler->analysis != NULL)
+    profileLoops(profiler, system->control.oldPC, cycles);
+
+  switch (opcode)
+  {
+  case 0b011110: // call type F
+  case 0b111001: // call type S
+    profilerEnter(profiler, pc, system->control.oldPC, system->control.oldPC + 4);
+    break;
+  case 0b011111: // ret
+  case 0b100000: // reti
+    profilerReturn(profiler, pc);
+    break;
+  }
+
+  if (profiler->interruptEntered)
+  {
+    profilerEnter(profiler, system->cpu.registers[PC], system->control.oldPC, profiler->interruptReturn);
+    profiler->interruptEntered = false;
+  }
+}
+
+// Counts the loops of a newly loaded program from zero; NULL stops counting
+void attachProfilerLoops(Profiler *profiler, const Analysis *analysis)
+{
+  free(profiler->loops);
+  profiler->loops = NULL;
+  profiler->analysis = analysis;
+  profiler->block = NO_ANALYZED_BLOCK;
+
+  if (analysis == NULL)
+    return;
+
+  profiler->loops = (ProfilerLoop *)calloc(analysis->loopCount + 1, sizeof(ProfilerLoop));
+
+  if (profiler->loops == NULL)
+  {
+    fprintf(stderr, "Failed to allocate memory for profiler.\n");
+    exit(EXIT_FAILURE);
+  }
+}
+
+// Charges the instruction at address to the innermost loop around it. The
+// first instruction of a header counts an iteration when the previous one
+// ran in the same loop, and an entry otherwise.
+void profileLoops(Profiler *profiler, uint32_t address, uint64_t cycles)
+{
+  const Analysis *analysis = profiler->analysis;
+  const uint32_t block = (address <= MEMORY_SIZE - 4) ? analysis->blockOf[address / 4] : NO_ANALYZED_BLOCK;
+  const uint32_t loop = (block != NO_ANALYZED_BLOCK) ? analysis->blocks[block].loop : NO_ANALYZED_LOOP;
+
+  if (loop != NO_ANALYZED_LOOP)
+  {
+    ProfilerLoop *counts = &profiler->loops[loop];
+
+    counts->self.instructions++;
+    counts->self.cycles += cycles;
+
+    if (analysis->loops[loop].header == block && address == analysis->blocks[block].first * 4)
+    {
+      if (profiler->block != NO_ANALYZED_BLOCK && isInAnalyzedLoop(analysis, profiler->block, loop))
+        counts->iterations++;
+      else
+        counts->entries++;
+    }
+  }
+
+  profiler->block = block;
+}
+
+/******************************************************
+ * Arithmetic and logical operations
+ *******************************************************/
+
+void mov(CPU *cpu, Trace *output)
+{
+  // Fetch operands
+  const uint32_t ir = cpu->registers[IR];
+
+  const uint8_t z = ir >> 21;
+  const uint32_t xyl = ir & 0x1FFFFF;
+
+  // Execution of behavior
+  if (z != 0)
+    cpu->registers[z] = xyl;
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[30] = {0};
+
+    sprintf(instruction, "mov %s,%u", formatRegisterName(z, true), xyl);
+    sprintf(additionalInfo, "%s=0x%08X", formatRegisterName(z, false), cpu->registers[z]);
+
+    // Output
+    printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
+  }
+}
+
+void movs(CPU *cpu, Trace *output)
+{
+  // Fetch operands
+  const uint32_t ir = cpu->registers[IR];
+
+  const uint8_t z = (ir & 0x03E00000) >> 21;
+  const int32_t xyl = extendSign32(ir & 0x1FFFFF, 21);
+
+  // Execution of behavior
+  if (z != 0)
+    cpu->registers[z] = xyl;
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[30] = {0};
+
+    sprintf(instruction, "movs %s,%i", formatRegisterName(z, true), xyl);
+    sprintf(additionalInfo, "%s=0x%08X", formatRegisterName(z, false), cpu->registers[z]);
+
+    // Output
+    printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
+  }
+}
+
+void add(CPU *cpu, Trace *output)
+{
+  // Fetch operands
+  const uint32_t ir = cpu->registers[IR];
+
+  const uint8_t z = (ir >> 21) & 0x1F;
+  const uint8_t x = (ir >> 16) & 0x1F;
+  const uint8_t y = (ir >> 11) & 0x1F;
+
+  // Execution of behavior
+  const uint64_t valueX = (uint64_t)cpu->registers[x];
+  const uint64_t valueY = (uint64_t)cpu->registers[y];
+
+  const uint64_t result = valueX + valueY;
+
+  if (z != 0)
+    cpu->registers[z] = (uint32_t)result;
+
+  if (result == 0)
+    cpu->registers[SR] |= ZN_FLAG;
+  else
+    cpu->registers[SR] &= ~ZN_FLAG;
+
+  if ((result & 0x80000000))
+    cpu->registers[SR] |= SN_FLAG;
+  else
+    cpu->registers[SR] &= ~SN_FLAG;
+
+  if (
+      ((valueX & 0x80000000) == (valueY & 0x80000000)) &&
+      ((result & 0x80000000) != (valueX & 0x80000000)))
+    cpu->registers[SR] |= OV_FLAG;
+  else
+    cpu->registers[SR] &= ~OV_FLAG;
+
+  if (result > 0xFFFFFFFF)
+    cpu->registers[SR] |= CY_FLAG;
+  else
+    cpu->registers[SR] &= ~CY_FLAG;
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[100] = {0};
+
+    sprintf(instruction, "add %s,%s,%s",
+            formatRegisterName(z, true), formatRegisterName(x, true), formatRegisterName(y, true));
+    sprintf(additionalInfo, "%s=%s+%s=0x%08X,SR=0x%08X", formatRegisterName(z, false), formatRegisterName(x, false), formatRegisterName(y, false), cpu->registers[z], cpu->registers[SR]);
+
+    // Output
+    printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
+  }
+}
+
+void sub(CPU *cpu, Trace *output)
+{
+  // Fetch operands
+  const uint32_t ir = cpu->registers[IR];
+
+  const uint8_t z = (ir >> 21) & 0x1F;
+  const uint8_t x = (ir >> 16) & 0x1F;
+  const uint8_t y = (ir >> 11) & 0x1F;
+
+  // Execution of behavior
+  const uint64_t valueX = (uint64_t)cpu->registers[x];
+  const uint64_t valueY = (uint64_t)cpu->registers[y];
+
+  const uint64_t result = valueX - valueY;
+
+  if (z != 0)
+    cpu->registers[z] = (result & 0xFFFFFFFF);
+
+  if (result == 0)
+    cpu->registers[SR] |= ZN_FLAG;
+  else
+    cpu->registers[SR] &= ~ZN_FLAG;
+
+  if ((result & 0x80000000))
+    cpu->registers[SR] |= SN_FLAG;
+  else
+    cpu->registers[SR] &= ~SN_FLAG;
+
+  if (
+      ((valueX & 0x80000000) != (valueY & 0x80000000)) &&
+      ((result & 0x80000000) != (valueX & 0x80000000)))
+    cpu->registers[SR] |= OV_FLAG;
+  else
+    cpu->registers[SR] &= ~OV_FLAG;
+
+  if (result > 0xFFFFFFFF)
+    cpu->registers[SR] |= CY_FLAG;
+  else
+    cpu->registers[SR] &= ~CY_FLAG;
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[100] = {0};
+
+    sprintf(instruction, "sub %s,%s,%s",
+            formatRegisterName(z, true), formatRegisterName(x, true), formatRegisterName(y, true));
+    sprintf(additionalInfo, "%s=%s-%s=0x%08X,SR=0x%08X", formatRegisterName(z, false), formatRegisterName(x, false), formatRegisterName(y, false), cpu->registers[z], cpu->registers[SR]);
+
+    // Output
+    printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
+  }
+}
+
+void mul(CPU *cpu, Trace *output)
+{
+  // Fetch operands
+  const uint32_t ir = cpu->registers[IR];
+
+  const uint8_t z = (ir >> 21) & 0x1F;
+  const uint8_t x = (ir >> 16) & 0x1F;
+  const uint8_t y = (ir >> 11) & 0x1F;
+  const uint8_t l = ir & 0x1F;
+
+  // Execution of behavior
+  const uint64_t valueX = (uint64_t)cpu->registers[x];
+  const uint64_t valueY = (uint64_t)cpu->registers[y];
+
+  const uint64_t result = valueX * valueY;
+  if (z != 0)
+    cpu->registers[z] = (uint32_t)result;
+
+  if (l != 0)
+    cpu->registers[l] = (result >> 32) & 0xFFFFFFFF;
+
+  if (result == 0)
+    cpu->registers[SR] |= ZN_FLAG;
+  else
+    cpu->registers[SR] &= ~ZN_FLAG;
+
+  if (cpu->registers[l] != 0)
+    cpu->registers[SR] |= CY_FLAG;
+  else
+    cpu->registers[SR] &= ~CY_FLAG;
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[50] = {0};
+
+    sprintf(instruction, "mul %s,%s,%s,%s",
+            formatRegisterName(l, true), formatRegisterName(z, true), formatRegisterName(x, true), formatRegisterName(y, true));
+    sprintf(additionalInfo, "%s:%s=%s*%s=0x%08X%08X,SR=0x%08X", formatRegisterName(l, false), formatRegisterName(z, false), formatRegisterName(x, false), formatRegisterName(y, false), cpu->registers[l], cpu->registers[z], cpu->registers[SR]);
+
+    // Output
+    printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
+  }
+}
+
+void sll(CPU *cpu, Trace *output)
+{
+  // Fetch operands
+  const uint32_t ir = cpu->registers[IR];
+
+  const uint8_t z = (ir >> 21) & 0x1F;
+  const uint8_t x = (ir >> 16) & 0x1F;
+  const uint8_t y = (ir >> 11) & 0x1F;
+  const uint8_t l = ir & 0x1F;
+
+  // Execution of behavior
+  const uint64_t valueZ = (uint64_t)cpu->registers[z];
+  const uint64_t valueY = (uint64_t)cpu->registers[y];
+
+  const uint64_t result = z != 0 ? ((valueZ << 32) | valueY) << (l + 1) : valueY << (l + 1);
+
+  if (x != 0)
+    cpu->registers[x] = result & 0xFFFFFFFF;
+
+  if (z != 0)
+    cpu->registers[z] = (result >> 32) & 0xFFFFFFFF;
+
+  if (cpu->registers[z] != 0)
+    cpu->registers[SR] |= CY_FLAG;
+  else
+    cpu->registers[SR] &= ~CY_FLAG;
+
+  if (result == 0)
+    cpu->registers[SR] |= ZN_FLAG;
+  else
+    cpu->registers[SR] &= ~ZN_FLAG;
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[200] = {0};
+
+    sprintf(instruction, "sll %s,%s,%s,%u",
+            formatRegisterName(z, true), formatRegisterName(x, true), formatRegisterName(y, true), l);
+    sprintf(additionalInfo, "%s:%s=%s:%s<<%u=0x%08X%08X,SR=0x%08X", formatRegisterName(z, false), formatRegisterName(x, false), formatRegisterName(z, false), formatRegisterName(y, false), l + 1, cpu->registers[z], cpu->registers[x], cpu->registers[SR]);
+
+    // Output
+    printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
+  }
+}
+
+void muls(CPU *cpu, Trace *output)
+{
+  // Fetch operands
+  const uint32_t ir = cpu->registers[IR];
+
+  const uint8_t z = (ir >> 21) & 0x1F;
+  const uint8_t x = (ir >> 16) & 0x1F;
+  const uint8_t y = (ir >> 11) & 0x1F;
+  const uint8_t l = ir & 0x1F;
+
+  // Execution of behavior
+  const uint64_t valueX = extendSign64(cpu->registers[x], 32);
+  const uint64_t valueY = extendSign64(cpu->registers[y], 32);
+
+  const int64_t result = valueX * valueY;
+
+  if (z != 0)
+    cpu->registers[z] = (uint32_t)result;
+
+  if (l != 0)
+    cpu->registers[l] = (result >> 32) & 0xFFFFFFFF;
+
+  if (result == 0)
+    cpu->registers[SR] |= ZN_FLAG;
+  else
+    cpu->registers[SR] &= ~ZN_FLAG;
+
+  if (cpu->registers[l] != 0)
+    cpu->registers[SR] |= OV_FLAG;
+  else
+    cpu->registers[SR] &= ~OV_FLAG;
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[50] = {0};
+
+    sprintf(instruction, "muls %s,%s,%s,%s",
+            formatRegisterName(l, true), formatRegisterName(z, true), formatRegisterName(x, true), formatRegisterName(y, true));
+    sprintf(additionalInfo, "%s:%s=%s*%s=0x%08X%08X,SR=0x%08X", formatRegisterName(l, false), formatRegisterName(z, false), formatRegisterName(x, false), formatRegisterName(y, false), cpu->registers[l], cpu->registers[z], cpu->registers[SR]);
+
+    // Output
+    printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
+  }
+}
+
+void sla(CPU *cpu, Trace *output)
+{
+  // Fetch operands
+  const uint32_t ir = cpu->registers[IR];
+
+  const uint8_t z = (ir >> 21) & 0x1F;
+  const uint8_t x = (ir >> 16) & 0x1F;
+  const uint8_t y = (ir >> 11) & 0x1F;
+  const uint8_t l = ir & 0x1F;
+
+  // Execution of behavior
+  const uint64_t valueZ = (uint64_t)cpu->registers[z];
+  const uint64_t valueY = (uint64_t)cpu->registers[y];
+
+  const uint64_t result = ((valueZ << 32) | valueY) << (l + 1);
+
+  if (x != 0)
+    cpu->registers[x] = result & 0xFFFFFFFF;
+
+  if (z != 0)
+  {
+    cpu->registers[z] = (result >> 32) & 0xFFFFFFFF;
+
+    if (cpu->registers[z] != 0)
+      cpu->registers[SR] |= OV_FLAG;
+    else
+      cpu->registers[SR] &= ~OV_FLAG;
+  }
+
+  if (result == 0)
+    cpu->registers[SR] |= ZN_FLAG;
+  else
+    cpu->registers[SR] &= ~ZN_FLAG;
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[200] = {0};
+
+    sprintf(instruction, "sla %s,%s,%s,%u",
+            formatRegisterName(z, true), formatRegisterName(x, true), formatRegisterName(y, true), l);
+    sprintf(additionalInfo, "%s:%s=%s:%s<<%u=0x%08X%08X,SR=0x%08X", formatRegisterName(z, false), formatRegisterName(x, false), formatRegisterName(z, false), formatRegisterName(y, false), l + 1, cpu->registers[z], cpu->registers[x], cpu->registers[SR]);
+
+    // Output
+    printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
+  }
+}
+
+void divv(System *system, Trace *output)
+{
+  // Fetch operands
+  const uint32_t ir = system->cpu.registers[IR];
+
+  const uint8_t z = (ir >> 21) & 0x1F;
+  const uint8_t x = (ir >> 16) & 0x1F;
+  const uint8_t y = (ir >> 11) & 0x1F;
+  const uint8_t l = ir & 0x1F;
+
+  // Execution of behavior
+  const uint32_t valueX = system->cpu.registers[x];
+  const uint32_t valueY = system->cpu.registers[y];
+
+  if (valueY != 0)
+  {
+    if (z != 0)
+      system->cpu.registers[z] = valueX / valueY;
+
+    if (l != 0)
+      system->cpu.registers[l] = valueX % valueY;
+
+    if (system->cpu.registers[z] == 0)
+      system->cpu.registers[SR] |= ZN_FLAG;
+    else
+      system->cpu.registers[SR] &= ~ZN_FLAG;
+
+    if (system->cpu.registers[l] != 0)
+      system->cpu.registers[SR] |= CY_FLAG;
+    else
+      system->cpu.registers[SR] &= ~CY_FLAG;
+  }
+
+  if (valueY == 0)
+    system->cpu.registers[SR] |= ZD_FLAG;
+  else
+    system->cpu.registers[SR] &= ~ZD_FLAG;
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[100] = {0};
+
+    sprintf(instruction, "div %s,%s,%s,%s",
+            formatRegisterName(l, true), formatRegisterName(z, true), formatRegisterName(x, true), formatRegisterName(y, true));
+    sprintf(additionalInfo, "%s=%s%%%s=0x%08X,%s=%s/%s=0x%08X,SR=0x%08X", formatRegisterName(l, false), formatRegisterName(x, false), formatRegisterName(y, false), system->cpu.registers[l], formatRegisterName(z, false), formatRegisterName(x, false), formatRegisterName(y, false), system->cpu.registers[z], system->cpu.registers[SR]);
+
+    // Output
+    printInstruction(system->cpu.registers[PC], output, instruction, additionalInfo);
+  }
+
+  if (valueY == 0)
+    handleDivideByZero(system, output);
+}
+
+void srl(CPU *cpu, Trace *output)
+{
+  // Fetch operands
+  const uint32_t ir = cpu->registers[IR];
+
+  const uint8_t z = (ir >> 21) & 0x1F;
+  const uint8_t x = (ir >> 16) & 0x1F;
+  const uint8_t y = (ir >> 11) & 0x1F;
+  const uint8_t l = ir & 0x1F;
+
+  // Execution of behavior
+  const uint64_t valueZ = (uint64_t)cpu->registers[z];
+  const uint64_t valueY = (uint64_t)cpu->registers[y];
+
+  const uint64_t result = z != 0 ? ((valueZ << 32) | valueY) >> (l + 1) : valueY >> (l + 1);
+
+  if (x != 0)
+    cpu->registers[x] = result & 0xFFFFFFFF;
+
+  if (z != 0)
+  {
+    cpu->registers[z] = (result >> 32) & 0xFFFFFFFF;
+
+    if (cpu->registers[z] != 0)
+      cpu->registers[SR] |= OV_FLAG;
+    else
+      cpu->registers[SR] &= ~OV_FLAG;
+  }
+
+  if (result == 0)
+    cpu->registers[SR] |= ZN_FLAG;
+  else
+    cpu->registers[SR] &= ~ZN_FLAG;
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[200] = {0};
+
+    sprintf(instruction, "srl %s,%s,%s,%u",
+            formatRegisterName(z, true), formatRegisterName(x, true), formatRegisterName(y, true), l);
+    sprintf(additionalInfo, "%s:%s=%s:%s>>%u=0x%08X%08X,SR=0x%08X", formatRegisterName(z, false), formatRegisterName(x, false), formatRegisterName(z, false), formatRegisterName(y, false), l + 1, cpu->registers[z], cpu->registers[x], cpu->registers[SR]);
+
+    // Output
+    printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
+  }
+}
+
+void divs(System *system, Trace *output)
+{
+  // Fetch operands
+  const uint32_t ir = system->cpu.registers[IR];
+
+  const uint8_t z = (ir >> 21) & 0x1F;
+  const uint8_t x = (ir >> 16) & 0x1F;
+  const uint8_t y = (ir >> 11) & 0x1F;
+  const uint8_t l = ir & 0x1F;
+
+  // Execution of behavior
+  const int32_t valueX = system->cpu.registers[x];
+  const int32_t valueY = system->cpu.registers[y];
+
+  if (valueY != 0)
+  {
+    if (l != 0)
+      system->cpu.registers[l] = valueX % valueY;
+
+    if (z != 0)
+      system->cpu.registers[z] = valueX / valueY;
+
+    if (system->cpu.registers[z] == 0)
+      system->cpu.registers[SR] |= ZN_FLAG;
+    else
+      system->cpu.registers[SR] &= ~ZN_FLAG;
+
+    if (system->cpu.registers[l] != 0)
+      system->cpu.registers[SR] |= OV_FLAG;
+    else
+      system->cpu.registers[SR] &= ~OV_FLAG;
+  }
+
+  if (valueY == 0)
+    system->cpu.registers[SR] |= ZD_FLAG;
+  else
+    system->cpu.registers[SR] &= ~ZD_FLAG;
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[100] = {0};
+
+    sprintf(instruction, "divs %s,%s,%s,%s",
+            formatRegisterName(l, true), formatRegisterName(z, true), formatRegisterName(x, true), formatRegisterName(y, true));
+    sprintf(additionalInfo, "%s=%s%%%s=0x%08X,%s=%s/%s=0x%08X,SR=0x%08X", formatRegisterName(l, false), formatRegisterName(x, false), formatRegisterName(y, false), system->cpu.registers[l], formatRegisterName(z, false), formatRegisterName(x, false), formatRegisterName(y, false), system->cpu.registers[z], system->cpu.registers[SR]);
+
+    // Output
+    printInstruction(system->cpu.registers[PC], output, instruction, additionalInfo);
+  }
+
+  if (valueY == 0)
+    handleDivideByZero(system, output);
+}
+
+void sra(CPU *cpu, Trace *output)
+{
+  // Fetch operands
+  const uint32_t ir = cpu->registers[IR];
+
+  const uint8_t z = (ir >> 21) & 0x1F;
+  const uint8_t x = (ir >> 16) & 0x1F;
+  const uint8_t y = (ir >> 11) & 0x1F;
+  const uint8_t l = ir & 0x1F;
+
+  // Execution of behavior
+  const int64_t valueZ = cpu->registers[z];
+  const int64_t valueY = cpu->registers[y];
+
+  const int64_t result = ((valueZ << 32) | valueY) >> (l + 1);
+
+  if (x != 0)
+    cpu->registers[x] = result & 0xFFFFFFFF;
+
+  if (z != 0)
+    cpu->registers[z] = (result >> 32) & 0xFFFFFFFF;
+
+  if (cpu->registers[z] != 0)
+    cpu->registers[SR] |= OV_FLAG;
+  else
+    cpu->registers[SR] &= ~OV_FLAG;
+
+  if (result == 0)
+    cpu->registers[SR] |= ZN_FLAG;
+  else
+    cpu->registers[SR] &= ~ZN_FLAG;
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[200] = {0};
+
+    sprintf(instruction, "sra %s,%s,%s,%u",
+            formatRegisterName(z, true), formatRegisterName(x, true), formatRegisterName(y, true), l);
+    sprintf(additionalInfo, "%s:%s=%s:%s>>%u=0x%08X%08X,SR=0x%08X", formatRegisterName(z, false), formatRegisterName(x, false), formatRegisterName(z, false), formatRegisterName(y, false), l + 1, cpu->registers[z], cpu->registers[x], cpu->registers[SR]);
+
+    // Output
+    printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
+  }
+}
+
+void cmp(CPU *cpu, Trace *output)
+{
+  // Fetch operands
+  const uint32_t ir = cpu->registers[IR];
+
+  const uint8_t z = (ir >> 21) & 0x1F;
+  const uint8_t x = (ir >> 16) & 0x1F;
+  const uint8_t y = (ir >> 11) & 0x1F;
+
+  // Execution of behavior
+  const uint64_t valueX = (uint64_t)cpu->registers[x];
+  const uint64_t valueY = (uint64_t)cpu->registers[y];
+
+  const uint64_t result = valueX - valueY;
+
+  if (z != 0)
+    cpu->registers[z] = (result & 0xFFFFFFFF);
+
+  if (result == 0)
+    cpu->registers[SR] |= ZN_FLAG;
+  else
+    cpu->registers[SR] &= ~ZN_FLAG;
+
+  if ((result & 0x80000000))
+    cpu->registers[SR] |= SN_FLAG;
+  else
+    cpu->registers[SR] &= ~SN_FLAG;
+
+  if (
+      ((valueX & 0x80000000) != (valueY & 0x80000000)) &&
+      ((result & 0x80000000) != (valueX & 0x80000000)))
+    cpu->registers[SR] |= OV_FLAG;
+  else
+    cpu->registers[SR] &= ~OV_FLAG;
+
+  if (result > 0xFFFFFFFF)
+    cpu->registers[SR] |= CY_FLAG;
+  else
+    cpu->registers[SR] &= ~CY_FLAG;
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[30] = {0};
+
+    sprintf(instruction, "cmp %s,%s", formatRegisterName(x, true), formatRegisterName(y, true));
+    sprintf(additionalInfo, "SR=0x%08X", cpu->registers[SR]);
+
+    // Output
+    printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
+  }
+}
+
+void and (CPU * cpu, Trace *output)
+{
+  // Fetch operands
+  const uint32_t ir = cpu->registers[IR];
+
+  const uint8_t z = (ir >> 21) & 0x1F;
+  const uint8_t x = (ir >> 16) & 0x1F;
+  const uint8_t y = (ir >> 11) & 0x1F;
+
+  // Execution of behavior
+  const uint32_t valueX = (uint32_t)cpu->registers[x];
+  const uint32_t valueY = (uint32_t)cpu->registers[y];
+
+  const uint32_t result = valueX & valueY;
+
+  if (z != 0)
+    cpu->registers[z] = result;
+
+  if (result == 0)
+    cpu->registers[SR] |= ZN_FLAG;
+  else
+    cpu->registers[SR] &= ~ZN_FLAG;
+
+  if (result & 0x80000000)
+    cpu->registers[SR] |= SN_FLAG;
+  else
+    cpu->registers[SR] &= ~SN_FLAG;
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[100] = {0};
+
+    sprintf(instruction, "and %s,%s,%s", formatRegisterName(z, true), formatRegisterName(x, true), formatRegisterName(y, true));
+    sprintf(additionalInfo, "%s=%s&%s=0x%08X,SR=0x%08X", formatRegisterName(z, false), formatRegisterName(x, false), formatRegisterName(y, false), cpu->registers[z], cpu->registers[SR]);
+
+    // Output
+    printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
+  }
+}
+
+void or (CPU * cpu, Trace *output)
+{
+  // Fetch operands
+  const uint32_t ir = cpu->registers[IR];
+
+  const uint8_t z = (ir >> 21) & 0x1F;
+  const uint8_t x = (ir >> 16) & 0x1F;
+  const uint8_t y = (ir >> 11) & 0x1F;
+
+  // Execution of behavior
+  const uint32_t valueX = (uint32_t)cpu->registers[x];
+  const uint32_t valueY = (uint32_t)cpu->registers[y];
+
+  const uint32_t result = valueX | valueY;
+
+  if (z != 0)
+    cpu->registers[z] = result;
+
+  if (result == 0)
+    cpu->registers[SR] |= ZN_FLAG;
+  else
+    cpu->registers[SR] &= ~ZN_FLAG;
+
+  if (result & 0x80000000)
+    cpu->registers[SR] |= SN_FLAG;
+  else
+    cpu->registers[SR] &= ~SN_FLAG;
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[100] = {0};
+
+    sprintf(instruction, "or %s,%s,%s", formatRegisterName(z, true), formatRegisterName(x, true), formatRegisterName(y, true));
+    sprintf(additionalInfo, "%s=%s|%s=0x%08X,SR=0x%08X", formatRegisterName(z, false), formatRegisterName(x, false), formatRegisterName(y, false), cpu->registers[z], cpu->registers[SR]);
+
+    // Output
+    printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
+  }
+}
+
+void not(CPU * cpu, Trace *output)
+{
+  // Fetch operands
+  const uint32_t ir = cpu->registers[IR];
+
+  const uint8_t z = (ir >> 21) & 0x1F;
+  const uint8_t x = (ir >> 16) & 0x1F;
+
+  // Execution of behavior
+  const uint32_t valueX = (uint32_t)cpu->registers[x];
+
+  const uint32_t result = ~valueX;
+
+  if (z != 0)
+    cpu->registers[z] = result;
+
+  if (result == 0)
+    cpu->registers[SR] |= ZN_FLAG;
+  else
+    cpu->registers[SR] &= ~ZN_FLAG;
+
+  if (result & 0x80000000)
+    cpu->registers[SR] |= SN_FLAG;
+  else
+    cpu->registers[SR] &= ~SN_FLAG;
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[100] = {0};
+
+    sprintf(instruction, "not %s,%s", formatRegisterName(z, true), formatRegisterName(x, true));
+    sprintf(additionalInfo, "%s=~%s=0x%08X,SR=0x%08X", formatRegisterName(z, false), formatRegisterName(x, false), cpu->registers[z], cpu->registers[SR]);
+
+    // Output
+    printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
+  }
+}
+
+void xor (CPU * cpu, Trace *output) {
+  // Fetch operands
+  const uint32_t ir = cpu->registers[IR];
+
+  const uint8_t z = (ir >> 21) & 0x1F;
+  const uint8_t x = (ir >> 16) & 0x1F;
+  const uint8_t y = (ir >> 11) & 0x1F;
+
+  // Execution of behavior
+  const uint32_t valueX = (uint32_t)cpu->registers[x];
+  const uint32_t valueY = (uint32_t)cpu->registers[y];
+
+  const uint32_t result = valueX ^ valueY;
+
+  if (z != 0)
+    cpu->registers[z] = result;
+
+  if (result == 0)
+    cpu->registers[SR] |= ZN_FLAG;
+  else
+    cpu->registers[SR] &= ~SN_FLAG;
+
+  if (result & 0x80000000)
+    cpu->registers[SR] |= SN_FLAG;
+  else
+    cpu->registers[SR] &= ~SN_FLAG;
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[100] = {0};
+
+    sprintf(instruction, "xor %s,%s,%s", formatRegisterName(z, true), formatRegisterName(x, true), formatRegisterName(y, true));
+    sprintf(additionalInfo, "%s=%s^%s=0x%08X,SR=0x%08X", formatRegisterName(z, false), formatRegisterName(x, false), formatRegisterName(y, false), cpu->registers[z], cpu->registers[SR]);
+
+    // Output
+    printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
+  }
+}
+
+    void addi(CPU *cpu, Trace *output)
+{
+  // Fetch operands
+  const uint32_t ir = cpu->registers[IR];
+
+  const uint8_t z = (ir >> 21) & 0x1F;
+  const uint8_t x = (ir >> 16) & 0x1F;
+  const int32_t i = extendSign32(ir & 0xFFFF, 16);
+
+  // Execution of behavior
+  const uint64_t valueX = (uint64_t)cpu->registers[x];
+
+  const uint64_t result = valueX + (uint64_t)i;
+
+  if (z != 0)
+    cpu->registers[z] = (uint32_t)result;
+
+  if (cpu->registers[z] == 0)
+    cpu->registers[SR] |= ZN_FLAG;
+  else
+    cpu->registers[SR] &= ~ZN_FLAG;
+
+  if ((result & 0x80000000))
+    cpu->registers[SR] |= SN_FLAG;
+  else
+    cpu->registers[SR] &= ~SN_FLAG;
+
+  if (
+      ((valueX & 0x80000000) == (i & 0x80000000)) &&
+      ((result & 0x80000000) != (valueX & 0x80000000)))
+    cpu->registers[SR] |= OV_FLAG;
+  else
+    cpu->registers[SR] &= ~OV_FLAG;
+
+  if (result > 0xFFFFFFFF)
+    cpu->registers[SR] |= CY_FLAG;
+  else
+    cpu->registers[SR] &= ~CY_FLAG;
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[60] = {0};
+
+    sprintf(instruction, "addi %s,%s,%i",
+            formatRegisterName(z, true), formatRegisterName(x, true), i);
+    sprintf(additionalInfo, "%s=%s+0x%08X=0x%08X,SR=0x%08X", formatRegisterName(z, false), formatRegisterName(x, false), i, cpu->registers[z], cpu->registers[SR]);
+
+    // Output
+    printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
+  }
+}
+
+void subi(CPU *cpu, Trace *output)
+{
+  // Fetch operands
+  const uint32_t ir = cpu->registers[IR];
+
+  const uint8_t z = (ir >> 21) & 0x1F;
+  const uint8_t x = (ir >> 16) & 0x1F;
+  const int32_t i = extendSign32(ir & 0xFFFF, 16);
+
+  // Execution of behavior
+  const uint64_t valueX = (uint64_t)cpu->registers[x];
+
+  const uint64_t result = valueX - i;
+
+  if (z != 0)
+    cpu->registers[z] = (result & 0xFFFFFFFF);
+
+  if (result == 0)
+    cpu->registers[SR] |= ZN_FLAG;
+  else
+    cpu->registers[SR] &= ~ZN_FLAG;
+
+  if ((result & 0x80000000))
+    cpu->registers[SR] |= SN_FLAG;
+  else
+    cpu->registers[SR] &= ~SN_FLAG;
+
+  if (
+      ((valueX & 0x80000000) != (i & 0x80000000)) &&
+      ((result & 0x80000000) != (valueX & 0x80000000)))
+    cpu->registers[SR] |= OV_FLAG;
+  else
+    cpu->registers[SR] &= ~OV_FLAG;
+
+  if (result > 0xFFFFFFFF)
+    cpu->registers[SR] |= CY_FLAG;
+  else
+    cpu->registers[SR] &= ~CY_FLAG;
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[200] = {0};
+
+    sprintf(instruction, "subi %s,%s,%i",
+            formatRegisterName(z, true), formatRegisterName(x, true), i);
+    sprintf(additionalInfo, "%s=%s-0x%08X=0x%08X,SR=0x%08X", formatRegisterName(z, false), formatRegisterName(x, false), i, cpu->registers[z], cpu->registers[SR]);
+
+    // Output
+    printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
+  }
+}
+
+void muli(CPU *cpu, Trace *output)
+{
+  // Fetch operands
+  const uint32_t ir = cpu->registers[IR];
+
+  const uint8_t z = (ir >> 21) & 0x1F;
+  const uint8_t x = (ir >> 16) & 0x1F;
+  const int32_t i = extendSign32(ir & 0xFFFF, 16);
+
+  // Execution of behavior
+  const int64_t valueX = extendSign64(cpu->registers[x], 32);
+  const int64_t result = valueX * i;
+
+  if (z != 0)
+    cpu->registers[z] = (uint32_t)result;
+
+  if (result == 0)
+    cpu->registers[SR] |= ZN_FLAG;
+  else
+    cpu->registers[SR] &= ~ZN_FLAG;
+
+  if ((result & 0xFFFFFFFF00000000) != 0)
+    cpu->registers[SR] |= OV_FLAG;
+  else
+    cpu->registers[SR] &= ~OV_FLAG;
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[200] = {0};
+
+    sprintf(instruction, "muli %s,%s,%i",
+            formatRegisterName(z, true), formatRegisterName(x, true), i);
+    sprintf(additionalInfo, "%s=%s*0x%08X=0x%08X,SR=0x%08X", formatRegisterName(z, false), formatRegisterName(x, false), i, cpu->registers[z], cpu->registers[SR]);
+
+    // Output
+    printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
+  }
+}
+
+void divi(System *system, Trace *output)
+{
+  // Fetch operands
+  const uint32_t ir = system->cpu.registers[IR];
+
+  const uint8_t z = (ir >> 21) & 0x1F;
+  const uint8_t x = (ir >> 16) & 0x1F;
+  const int32_t i = extendSign32(ir & 0xFFFF, 16);
+
+  // Execution of behavior
+  const int32_t valueX = system->cpu.registers[x];
+
+  if (i != 0)
+  {
+    if (z != 0)
+      system->cpu.registers[z] = valueX / i;
+
+    if (system->cpu.registers[z] == 0)
+      system->cpu.registers[SR] |= ZN_FLAG;
+    else
+      system->cpu.registers[SR] &= ~ZN_FLAG;
+  }
+
+  if (i == 0)
+    system->cpu.registers[SR] |= ZD_FLAG;
+  else
+    system->cpu.registers[SR] &= ~ZD_FLAG;
+
+  system->cpu.registers[SR] &= ~OV_FLAG; // OV
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[200] = {0};
+
+    sprintf(instruction, "divi %s,%s,%i",
+            formatRegisterName(z, true), formatRegisterName(x, true), i);
+    sprintf(additionalInfo, "%s=%s/0x%08X=0x%08X,SR=0x%08X",
+            formatRegisterName(z, false), formatRegisterName(x, false), i, system->cpu.registers[z], system->cpu.registers[SR]);
+
+    // Output
+    printInstruction(system->cpu.registers[PC], output, instruction, additionalInfo);
+  }
+
+  if (i == 0)
+    handleDivideByZero(system, output);
+}
+
+void modi(System *system, Trace *output)
+{
+  // Fetch operands
+  const uint32_t ir = system->cpu.registers[IR];
+
+  const uint8_t z = (ir >> 21) & 0x1F;
+  const uint8_t x = (ir >> 16) & 0x1F;
+  const int32_t i = extendSign32(ir & 0xFFFF, 16);
+
+  // Execution of behavior
+  const int32_t valueX = system->cpu.registers[x];
+
+  if (z != 0)
+    system->cpu.registers[z] = valueX % i;
+
+  if (system->cpu.registers[z] == 0)
+    system->cpu.registers[SR] |= ZN_FLAG;
+  else
+    system->cpu.registers[SR] &= ~ZN_FLAG;
+
+  if (i == 0)
+    system->cpu.registers[SR] |= ZD_FLAG;
+  else
+    system->cpu.registers[SR] &= ~ZD_FLAG;
+
+  system->cpu.registers[SR] &= ~OV_FLAG;
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[200] = {0};
+
+    sprintf(instruction, "modi %s,%s,%i",
+            formatRegisterName(z, true), formatRegisterName(x, true), i);
+    sprintf(additionalInfo, "%s=%s%%0x%08X=0x%08X,SR=0x%08X", formatRegisterName(z, false), formatRegisterName(x, false), i, system->cpu.registers[z], system->cpu.registers[SR]);
+
+    // Output
+    printInstruction(system->cpu.registers[PC], output, instruction, additionalInfo);
+  }
+
+  if (i == 0)
+    handleDivideByZero(system, output);
+}
+
+void cmpi(CPU *cpu, Trace *output)
+{
+  // Fetch operands
+  const uint32_t ir = cpu->registers[IR];
+
+  const uint8_t x = (ir >> 16) & 0x1F;
+  const int64_t i = extendSign64(ir & 0xFFFF, 16);
+
+  // Execution of behavior
+  const uint64_t valueX = (uint64_t)cpu->registers[x];
+  const uint64_t result = valueX - (uint64_t)i;
+
+  if (result == 0)
+    cpu->registers[SR] |= ZN_FLAG;
+  else
+    cpu->registers[SR] &= ~ZN_FLAG;
+
+  if ((result & 0x80000000))
+    cpu->registers[SR] |= SN_FLAG;
+  else
+    cpu->registers[SR] &= ~SN_FLAG;
+
+  if ((valueX & 0x80000000) != (i & 0x80000000) &&
+      ((result & 0x80000000) != (valueX & 0x80000000)))
+    cpu->registers[SR] |= OV_FLAG;
+  else
+    cpu->registers[SR] &= ~OV_FLAG;
+
+  if (result > 0xFFFFFFFF)
+    cpu->registers[SR] |= CY_FLAG;
+  else
+    cpu->registers[SR] &= ~CY_FLAG;
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[50] = {0};
+
+    sprintf(instruction, "cmpi %s,%" PRId64, formatRegisterName(x, true), i);
+    sprintf(additionalInfo, "SR=0x%08X", cpu->registers[SR]);
+
+    // Output
+    printInstruction(cpu->registers[PC], output, instruction, additionalInfo);
+  }
+}
+
+/******************************************************
+ * Flow Control Operations
+ *******************************************************/
+
+void bae(System *system, Trace *output)
+{
+  // Fetch operands
+  const int32_t i = extendSign32(system->cpu.registers[IR] & 0x03FFFFFF, 26);
+
+  // Execution of behavior
+  const uint32_t oldPC = system->cpu.registers[PC];
+  if (!isCYSet(&system->cpu))
+  {
+    system->control.pcAlreadyIncremented = true;
+    system->cpu.registers[PC] = system->cpu.registers[PC] + 4 + (i << 2);
+  }
+
+  if (system->predictor.enabled)
+    predictBranch(system, BRANCH_CONDITIONAL, oldPC, oldPC + 4 + (i << 2), system->control.pcAlreadyIncremented);
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[30] = {0};
+
+    sprintf(instruction, "bae %i", i);
+    sprintf(additionalInfo, "PC=0x%08X", isCYSet(&system->cpu) ? system->cpu.registers[PC] + 4 : system->cpu.registers[PC]);
+
+    // Output
+    printInstruction(oldPC, output, instruction, additionalInfo);
+  }
+}
+
+void bat(System *system, Trace *output)
+{
+  // Fetch operands
+  const int32_t i = extendSign32(system->cpu.registers[IR] & 0x03FFFFFF, 26);
+
+  // Execution of behavior
+  const uint32_t oldPC = system->cpu.registers[PC];
+  if (!isZNSet(&system->cpu) && !isCYSet(&system->cpu))
+  {
+    system->control.pcAlreadyIncremented = true;
+    system->cpu.registers[PC] = system->cpu.registers[PC] + 4 + (i << 2);
+  }
+
+  if (system->predictor.enabled)
+    predictBranch(system, BRANCH_CONDITIONAL, oldPC, oldPC + 4 + (i << 2), system->control.pcAlreadyIncremented);
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[30] = {0};
+
+    sprintf(instruction, "bat %i", i);
+    sprintf(additionalInfo, "PC=0x%08X", isZNSet(&system->cpu) || isCYSet(&system->cpu) ? system->cpu.registers[PC] + 4 : system->cpu.registers[PC]);
+
+    // Output
+    printInstruction(oldPC, output, instruction, additionalInfo);
+  }
+}
+
+void bbe(System *system, Trace *output)
+{
+  // Fetch operands
+  const int32_t i = extendSign32(system->cpu.registers[IR] & 0x03FFFFFF, 26);
+
+  // Execution of behavior
+  const uint32_t oldPC = system->cpu.registers[PC];
+  if (isZNSet(&system->cpu) || isCYSet(&system->cpu))
+  {
+    system->control.pcAlreadyIncremented = true;
+    system->cpu.registers[PC] = system->cpu.registers[PC] + 4 + (i << 2);
+  }
+
+  if (system->predictor.enabled)
+    predictBranch(system, BRANCH_CONDITIONAL, oldPC, oldPC + 4 + (i << 2), system->control.pcAlreadyIncremented);
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[30] = {0};
+
+    sprintf(instruction, "bbe %i", i);
+    sprintf(additionalInfo, "PC=0x%08X", !isZNSet(&system->cpu) && !isCYSet(&system->cpu) ? system->cpu.registers[PC] + 4 : system->cpu.registers[PC]);
+
+    // Output
+    printInstruction(oldPC, output, instruction, additionalInfo);
+  }
+}
+
+void bbt(System *system, Trace *output)
+{
+  // Fetch operands
+  const int32_t i = extendSign32(system->cpu.registers[IR] & 0x03FFFFFF, 26);
+
+  // Execution of behavior
+  const uint32_t oldPC = system->cpu.registers[PC];
+  if (isCYSet(&system->cpu))
+  {
+    system->control.pcAlreadyIncremented = true;
+    system->cpu.registers[PC] = system->cpu.registers[PC] + 4 + (i << 2);
+  }
+
+  if (system->predictor.enabled)
+    predictBranch(system, BRANCH_CONDITIONAL, oldPC, oldPC + 4 + (i << 2), system->control.pcAlreadyIncremented);
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[30] = {0};
+
+    sprintf(instruction, "bbt %i", i);
+    sprintf(additionalInfo, "PC=0x%08X", !isCYSet(&system->cpu) ? system->cpu.registers[PC] + 4 : system->cpu.registers[PC]);
+
+    // Output
+    printInstruction(oldPC, output, instruction, additionalInfo);
+  }
+}
+
+void beq(System *system, Trace *output)
+{
+  // Fetch operands
+  const int32_t i = extendSign32(system->cpu.registers[IR] & 0x03FFFFFF, 26);
+
+  // Execution of behavior
+  const uint32_t oldPC = system->cpu.registers[PC];
+  if (isZNSet(&system->cpu))
+  {
+    system->control.pcAlreadyIncremented = true;
+    system->cpu.registers[PC] = system->cpu.registers[PC] + 4 + (i << 2);
+  }
+
+  if (system->predictor.enabled)
+    predictBranch(system, BRANCH_CONDITIONAL, oldPC, oldPC + 4 + (i << 2), system->control.pcAlreadyIncremented);
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[30] = {0};
+
+    sprintf(instruction, "beq %i", i);
+    sprintf(additionalInfo, "PC=0x%08X", !isZNSet(&system->cpu) ? system->cpu.registers[PC] + 4 : system->cpu.registers[PC]);
+
+    // Output
+    printInstruction(oldPC, output, instruction, additionalInfo);
+  }
+}
+
+void bge(System *system, Trace *output)
+{
+  // Fetch operands
+  const int32_t i = extendSign32(system->cpu.registers[IR] & 0x03FFFFFF, 26);
+
+  // Execution of behavior
+  const uint32_t oldPC = system->cpu.registers[PC];
+  if (isSNSet(&system->cpu) == isOVSet(&system->cpu))
+  {
+    system->control.pcAlreadyIncremented = true;
+    system->cpu.registers[PC] = system->cpu.registers[PC] + 4 + (i << 2);
+  }
+
+  if (system->predictor.enabled)
+    predictBranch(system, BRANCH_CONDITIONAL, oldPC, oldPC + 4 + (i << 2), system->control.pcAlreadyIncremented);
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[30] = {0};
+
+    sprintf(instruction, "bge %i", i);
+    sprintf(additionalInfo, "PC=0x%08X",
+            isSNSet(&system->cpu) != isOVSet(&system->cpu) ? system->cpu.registers[PC] + 4 : system->cpu.registers[PC]);
+
+    // Output
+    printInstruction(oldPC, output, instruction, additionalInfo);
+  }
+}
+
+void bgt(System *system, Trace *output)
+{
+  // Fetch operands
+  const int32_t i = extendSign32(system->cpu.registers[IR] & 0x03FFFFFF, 26);
+
+  // Execution of behavior
+  const uint32_t oldPC = system->cpu.registers[PC];
+  if (!isZNSet(&system->cpu) && (isSNSet(&system->cpu) == isOVSet(&system->cpu)))
+  {
+    system->control.pcAlreadyIncremented = true;
+    system->cpu.registers[PC] = system->cpu.registers[PC] + 4 + (i << 2);
+  }
+
+  if (system->predictor.enabled)
+    predictBranch(system, BRANCH_CONDITIONAL, oldPC, oldPC + 4 + (i << 2), system->control.pcAlreadyIncremented);
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[30] = {0};
+
+    sprintf(instruction, "bgt %i", i);
+    sprintf(additionalInfo, "PC=0x%08X", isZNSet(&system->cpu) || (isSNSet(&system->cpu) != isOVSet(&system->cpu)) ? system->cpu.registers[PC] + 4 : system->cpu.registers[PC]);
+
+    // Output
+    printInstruction(oldPC, output, instruction, additionalInfo);
+  }
+}
+
+void biv(System *system, Trace *output)
+{
+  // Fetch operands
+  const int32_t i = extendSign32(system->cpu.registers[IR] & 0x03FFFFFF, 26);
+
+  // Execution of behavior
+  const uint32_t oldPC = system->cpu.registers[PC];
+  if (isIVSet(&system->cpu))
+  {
+    system->control.pcAlreadyIncremented = true;
+    system->cpu.registers[PC] = system->cpu.registers[PC] + 4 + (i << 2);
+  }
+
+  if (system->predictor.enabled)
+    predictBranch(system, BRANCH_CONDITIONAL, oldPC, oldPC + 4 + (i << 2), system->control.pcAlreadyIncremented);
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[30] = {0};
+
+    sprintf(instruction, "biv %i", i);
+    sprintf(additionalInfo, "PC=0x%08X", !isIVSet(&system->cpu) ? system->cpu.registers[PC] + 4 : system->cpu.registers[PC]);
+
+    // Output
+    printInstruction(oldPC, output, instruction, additionalInfo);
+  }
+}
+
+void ble(System *system, Trace *output)
+{
+  // Fetch operands
+  const int32_t i = extendSign32(system->cpu.registers[IR] & 0x03FFFFFF, 26);
+
+  // Execution of behavior
+  const uint32_t oldPC = system->cpu.registers[PC];
+  if (isZNSet(&system->cpu) || (isSNSet(&system->cpu) != isOVSet(&system->cpu)))
+  {
+    system->control.pcAlreadyIncremented = true;
+    system->cpu.registers[PC] = system->cpu.registers[PC] + 4 + (i << 2);
+  }
+
+  if (system->predictor.enabled)
+    predictBranch(system, BRANCH_CONDITIONAL, oldPC, oldPC + 4 + (i << 2), system->control.pcAlreadyIncremented);
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[30] = {0};
+
+    sprintf(instruction, "ble %i", i);
+    sprintf(additionalInfo, "PC=0x%08X", !isZNSet(&system->cpu) && (isSNSet(&system->cpu) == isOVSet(&system->cpu)) ? system->cpu.registers[PC] + 4 : system->cpu.registers[PC]);
+
+    // Output
+    printInstruction(oldPC, output, instruction, additionalInfo);
+  }
+}
+
+void blt(System *system, Trace *output)
+{
+  // Fetch operands
+  const int32_t i = extendSign32(system->cpu.registers[IR] & 0x03FFFFFF, 26);
+
+  // Execution of behavior
+  const uint32_t oldPC = system->cpu.registers[PC];
+  if (isSNSet(&system->cpu) != isOVSet(&system->cpu))
+  {
+    system->control.pcAlreadyIncremented = true;
+    system->cpu.registers[PC] = system->cpu.registers[PC] + 4 + (i << 2);
+  }
+
+  if (system->predictor.enabled)
+    predictBranch(system, BRANCH_CONDITIONAL, oldPC, oldPC + 4 + (i << 2), system->control.pcAlreadyIncremented);
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[30] = {0};
+
+    sprintf(instruction, "blt %i", i);
+    sprintf(additionalInfo, "PC=0x%08X", isSNSet(&system->cpu) == isOVSet(&system->cpu) ? system->cpu.registers[PC] + 4 : system->cpu.registers[PC]);
+
+    // Output
+    printInstruction(oldPC, output, instruction, additionalInfo);
+  }
+}
+
+void bne(System *system, Trace *output)
+{
+  // Fetch operands
+  const int32_t i = extendSign32(system->cpu.registers[IR] & 0x03FFFFFF, 26);
+
+  // Execution of behavior
+  const uint32_t oldPC = system->cpu.registers[PC];
+  if (!isZNSet(&system->cpu))
+  {
+    system->control.pcAlreadyIncremented = true;
+    system->cpu.registers[PC] = system->cpu.registers[PC] + 4 + (i << 2);
+  }
+
+  if (system->predictor.enabled)
+    predictBranch(system, BRANCH_CONDITIONAL, oldPC, oldPC + 4 + (i << 2), system->control.pcAlreadyIncremented);
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[30] = {0};
+
+    sprintf(instruction, "bne %i", i);
+    sprintf(additionalInfo, "PC=0x%08X", isZNSet(&system->cpu) ? system->cpu.registers[PC] + 4 : system->cpu.registers[PC]);
+
+    // Output
+    printInstruction(oldPC, output, instruction, additionalInfo);
+  }
+}
+
+void bni(System *system, Trace *output)
+{
+  // Fetch operands
+  const int32_t i = extendSign32(system->cpu.registers[IR] & 0x03FFFFFF, 26);
+
+  // Execution of behavior
+  const uint32_t oldPC = system->cpu.registers[PC];
+  if (!isIVSet(&system->cpu))
+  {
+    system->control.pcAlreadyIncremented = true;
+    system->cpu.registers[PC] = system->cpu.registers[PC] + 4 + (i << 2);
+  }
+
+  if (system->predictor.enabled)
+    predictBranch(system, BRANCH_CONDITIONAL, oldPC, oldPC + 4 + (i << 2), system->control.pcAlreadyIncremented);
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[30] = {0};
+
+    sprintf(instruction, "bni %i", i);
+    sprintf(additionalInfo, "PC=0x%08X", isIVSet(&system->cpu) ? system->cpu.registers[PC] + 4 : system->cpu.registers[PC]);
+
+    // Output
+    printInstruction(oldPC, output, instruction, additionalInfo);
+  }
+}
+
+void bnz(System *system, Trace *output)
+{
+  // Fetch operands
+  const int32_t i = extendSign32(system->cpu.registers[IR] & 0x03FFFFFF, 26);
+
+  // Execution of behavior
+  const uint32_t oldPC = system->cpu.registers[PC];
+  if (!isZDSet(&system->cpu))
+  {
+    system->control.pcAlreadyIncremented = true;
+    system->cpu.registers[PC] = system->cpu.registers[PC] + 4 + (i << 2);
+  }
+
+  if (system->predictor.enabled)
+    predictBranch(system, BRANCH_CONDITIONAL, oldPC, oldPC + 4 + (i << 2), system->control.pcAlreadyIncremented);
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[30] = {0};
+
+    sprintf(instruction, "bnz %i", i);
+    sprintf(additionalInfo, "PC=0x%08X", isZDSet(&system->cpu) ? system->cpu.registers[PC] + 4 : system->cpu.registers[PC]);
+
+    // Output
+    printInstruction(oldPC, output, instruction, additionalInfo);
+  }
+}
+
+void bzd(System *system, Trace *output)
+{
+  // Fetch operands
+  const int32_t i = extendSign32(system->cpu.registers[IR] & 0x03FFFFFF, 26);
+
+  // Execution of behavior
+  const uint32_t oldPC = system->cpu.registers[PC];
+  if (isZDSet(&system->cpu))
+  {
+    system->control.pcAlreadyIncremented = true;
+    system->cpu.registers[PC] = system->cpu.registers[PC] + 4 + (i << 2);
+  }
+
+  if (system->predictor.enabled)
+    predictBranch(system, BRANCH_CONDITIONAL, oldPC, oldPC + 4 + (i << 2), system->control.pcAlreadyIncremented);
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[30] = {0};
+
+    sprintf(instruction, "bzd %i", i);
+    sprintf(additionalInfo, "PC=0x%08X", !isZDSet(&system->cpu) ? system->cpu.registers[PC] + 4 : system->cpu.registers[PC]);
+
+    // Output
+    printInstruction(oldPC, output, instruction, additionalInfo);
+  }
+}
+
+void bun(System *system, Trace *output)
+{
+  // Fetch operands
+  const int32_t i = extendSign32(system->cpu.registers[IR] & 0x03FFFFFF, 26);
+
+  // Execution of behavior
+  system->control.pcAlreadyIncremented = true;
+  const uint32_t oldPC = system->cpu.registers[PC];
+  system->cpu.registers[PC] = system->cpu.registers[PC] + 4 + (i << 2);
+
+  if (system->predictor.enabled)
+    predictBranch(system, BRANCH_DIRECT, oldPC, system->cpu.registers[PC], true);
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[30] = {0};
+
+    sprintf(instruction, "bun %i", i);
+    sprintf(additionalInfo, "PC=0x%08X", system->cpu.registers[PC]);
+
+    // Output
+    printInstruction(oldPC, output, instruction, additionalInfo);
+  }
+}
+
+/******************************************************
+ * Memory read/write operations
+ *******************************************************/
+
+void l8(System *system, Trace *output)
+{
+  // Fetch operands
+  const uint32_t ir = system->cpu.registers[IR];
+
+  const uint8_t z = (ir >> 21) & 0x1F;
+  const uint8_t x = (ir >> 16) & 0x1F;
+  const uint16_t i = ir & 0xFFFF;
+
+  // Execution of behavior
+  const uint32_t memoryAddress = (x != 0) ? system->cpu.registers[x] + i : i;
+
+  if (z != 0)
+  {
+    switch (memoryAddress)
+    {
+    case TERMINAL_IN_ADDRESS:
+      system->cpu.registers[z] = readTerminalInput(system);
+      break;
+    case TERMINAL_STATUS_ADDRESS:
+      system->cpu.registers[z] = readTerminalStatus(system);
+      break;
+    case FPU_REGISTER_X_ADDR:
+      system->cpu.registers[z] = system->fpu.registers.x.u;
+      break;
+    case FPU_REGISTER_Y_ADDR:
+      system->cpu.registers[z] = system->fpu.registers.y.u;
+      break;
+    case FPU_REGISTER_Z_ADDR:
+      system->cpu.registers[z] = system->fpu.registers.z.u;
+      break;
+    case FPU_REGISTER_CONTROL_ADDR:
+      system->cpu.registers[z] = system->fpu.registers.control;
+      break;
+    default:
+      if (memoryAddress == FPU_REGISTER_CONTROL_ADDR_OTHER)
+        system->cpu.registers[z] = system->fpu.registers.control;
+      else if (memoryAddress < (NUM_REGISTERS * 1024))
+        system->cpu.registers[z] = system->memory[memoryAddress];
+    }
+  }
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[100] = {0};
+
+    sprintf(instruction, "l8 %s,[%s%s%i]", formatRegisterName(z, true), formatRegisterName(x, true), (i >= 0) ? ("+") : (""), i);
+    sprintf(additionalInfo, "%s=MEM[0x%08X]=0x%02X", formatRegisterName(z, false), memoryAddress, system->cpu.registers[z]);
+
+    // Output
+    printInstruction(system->cpu.registers[PC], output, instruction, additionalInfo);
+  }
+}
+
+void l16(System *system, Trace *output)
+{
+  // Fetch operands
+  const uint32_t ir = system->cpu.registers[IR];
+
+  const uint8_t z = (ir >> 21) & 0x1F;
+  const uint8_t x = (ir >> 16) & 0x1F;
+  const uint16_t i = ir & 0xFFFF;
+
+  // Execution of behavior
+  const uint32_t memoryAddress = (x != 0) ? ((system->cpu.registers[x] + i) << 1) : i << 1;
+
+  if (z != 0 && memoryAddress < (NUM_REGISTERS * 1024))
+    system->cpu.registers[z] = ((system->memory[memoryAddress] << 24) |
+                                (system->memory[memoryAddress + 1] << 16));
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[100] = {0};
+
+    sprintf(instruction, "l16 %s,[%s%s%i]", formatRegisterName(z, true), formatRegisterName(x, true), (i >= 0) ? ("+") : (""), i);
+    sprintf(additionalInfo, "%s=MEM[0x%08X]=0x%04X", formatRegisterName(z, false), memoryAddress, system->cpu.registers[z] >> 16);
+
+    // Output
+    printInstruction(system->cpu.registers[PC], output, instruction, additionalInfo);
+  }
+}
+
+void l32(System *system, Trace *output)
+{
+  // Fetch operands
+  const uint32_t ir = system->cpu.registers[IR];
+
+  const uint8_t z = (ir >> 21) & 0x1F;
+  const uint8_t x = (ir >> 16) & 0x1F;
+  const uint16_t i = ir & 0xFFFF;
+
+  // Execution of behavior
+  const uint32_t memoryAddress = (x != 0) ? ((system->cpu.registers[x] + i) << 2) : i << 2;
+
+  if (z != 0)
+  {
+    switch (memoryAddress)
+    {
+    case FPU_REGISTER_X_ADDR:
+      system->cpu.registers[z] = system->fpu.registers.x.u;
+      break;
+    case FPU_REGISTER_Y_ADDR:
+      system->cpu.registers[z] = system->fpu.registers.y.u;
+      break;
+    case FPU_REGISTER_Z_ADDR:
+      system->cpu.registers[z] = system->fpu.registers.z.u;
+      break;
+    case FPU_REGISTER_CONTROL_ADDR:
+      system->cpu.registers[z] = system->fpu.registers.control;
+      break;
+    case FPU_VECTOR_X_ADDR:
+      system->cpu.registers[z] = system->fpu.vector.x;
+      break;
+    case FPU_VECTOR_Y_ADDR:
+      system->cpu.registers[z] = system->fpu.vector.y;
+      break;
+    case FPU_VECTOR_Z_ADDR:
+      system->cpu.registers[z] = system->fpu.vector.z;
+      break;
+    case FPU_VECTOR_LENGTH_ADDR:
+      system->cpu.registers[z] = system->fpu.vector.length;
+      break;
+    case DMA_SOURCE_ADDR:
+    case DMA_DESTINATION_ADDR:
+    case DMA_LENGTH_ADDR:
+    case DMA_CONTROL_ADDR:
+      system->cpu.registers[z] = readDMARegister(system, memoryAddress);
+      break;
+    case INTERRUPT_PENDING_ADDR:
+    case INTERRUPT_ENABLE_ADDR:
+    case INTERRUPT_PRIORITY_ADDR:
+      system->cpu.registers[z] = readInterruptRegister(system, memoryAddress);
+      break;
+    case TIMER_CONTROL_ADDR:
+    case TIMER_RELOAD_ADDR:
+    case TIMER_PRESCALER_ADDR:
+    case TIMER_COMPARE_ADDR:
+    case TIMER_COUNT_ADDR:
+      system->cpu.registers[z] = readIntervalTimerRegister(system, memoryAddress);
+      break;
+    case DISK_SECTOR_ADDR:
+    case DISK_MEMORY_ADDR:
+    case DISK_COUNT_ADDR:
+    case DISK_CONTROL_ADDR:
+    case DISK_SECTORS_ADDR:
+      system->cpu.registers[z] = readDiskRegister(system, memoryAddress);
+      break;
+    default:
+      if (memoryAddress == FPU_REGISTER_CONTROL_ADDR_OTHER)
+        system->cpu.registers[z] = system->fpu.registers.control;
+      else if (isPerformanceCounterAddress(memoryAddress))
+        system->cpu.registers[z] = readPerformanceCounterRegister(system, memoryAddress);
+      else if (memoryAddress < (NUM_REGISTERS * 1024))
+        system->cpu.registers[z] = readMemory32(system, memoryAddress);
+    }
+  }
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[100] = {0};
+
+    sprintf(instruction, "l32 %s,[%s%s%i]", formatRegisterName(z, true), formatRegisterName(x, true), (i >= 0) ? ("+") : (""), i);
+    sprintf(additionalInfo, "%s=MEM[0x%08X]=0x%08X", formatRegisterName(z, false), memoryAddress, system->cpu.registers[z]);
+
+    // Output
+    printInstruction(system->cpu.registers[PC], output, instruction, additionalInfo);
+  }
+}
+
+void s8(System *system, Trace *output)
+{
+  // Fetch operands
+  const uint32_t ir = system->cpu.registers[IR];
+
+  const uint8_t z = (ir >> 21) & 0x1F;
+  const uint8_t x = (ir >> 16) & 0x1F;
+  const uint16_t i = ir & 0xFFFF;
+
+  // Execution of behavior
+  const uint32_t memoryAddress = (x != 0) ? system->cpu.registers[x] + i : i;
+  const bool fpuControlST = getFPUControlSTField(&system->fpu);
+  const uint8_t valueRegisterZ = system->cpu.registers[z];
+
+  switch (memoryAddress)
+  {
+  case TERMINAL_OUT_ADDRESS:
+    system->terminal.registers &= 0xFFFFFF00; // CLEAN OUT
+    system->terminal.registers |= valueRegisterZ;
+
+    writeTerminal(system, valueRegisterZ);
+    break;
+  case TERMINAL_STATUS_ADDRESS:
+    writeTerminalStatus(system, valueRegisterZ);
+    break;
+  case FPU_REGISTER_X_ADDR:
+    system->fpu.registers.x.f = (float)valueRegisterZ;
+    system->fpu.registers.x.u = valueRegisterZ;
+    break;
+  case FPU_REGISTER_Y_ADDR:
+    system->fpu.registers.y.f = (float)valueRegisterZ;
+    system->fpu.registers.y.u = valueRegisterZ;
+    break;
+  case FPU_REGISTER_Z_ADDR:
+    system->fpu.registers.z.f = (float)valueRegisterZ;
+    system->fpu.registers.z.u = valueRegisterZ;
+    break;
+  case FPU_REGISTER_CONTROL_ADDR:
+    system->fpu.registers.control = valueRegisterZ;
+    setFPUControlSTField(&system->fpu, fpuControlST);
+    break;
+  default:
+    if (memoryAddress == FPU_REGISTER_CONTROL_ADDR_OTHER)
+    {
+      system->fpu.registers.control = valueRegisterZ;
+      setFPUControlSTField(&system->fpu, fpuControlST);
+    }
+    else if (memoryAddress < (NUM_REGISTERS * 1024))
+      system->memory[memoryAddress] = valueRegisterZ;
+  }
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[50] = {0};
+    char additionalInfo[200] = {0};
+
+    sprintf(instruction, "s8 [%s%s%i],%s", formatRegisterName(x, true), (i >= 0) ? ("+") : (""), i, formatRegisterName(z, true));
+    sprintf(additionalInfo, "MEM[0x%08X]=%s=0x%02X", memoryAddress, formatRegisterName(z, false), valueRegisterZ);
+
+    // Output
+    printInstruction(system->cpu.registers[PC], output, instruction, additionalInfo);
+  }
+}
+
+void s16(System *system, Trace *output)
+{
+  // Fetch operands
+  const uint32_t ir = system->cpu.registers[IR];
+
+  const uint8_t z = (ir >> 21) & 0x1F;
+  const uint8_t x = (ir >> 16) & 0x1F;
+  const uint16_t i = ir & 0xFFFF;
+
+  // Execution of behavior
+  const uint32_t memoryAddress = (x != 0) ? ((system->cpu.registers[x] + i) << 1) : i << 1;
+  if (memoryAddress < (NUM_REGISTERS * 1024))
+  {
+    system->memory[memoryAddress] = (system->cpu.registers[z] >> 24) & 0xFF;
+    system->memory[memoryAddress + 1] = (system->cpu.registers[z] >> 16) & 0xFF;
+  }
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[100] = {0};
+
+    sprintf(instruction, "s16 [%s%s%i],%s", formatRegisterName(x, true), (i >= 0) ? ("+") : (""), i, formatRegisterName(z, true));
+    sprintf(additionalInfo, "MEM[0x%08X]=%s=0x%04X", memoryAddress, formatRegisterName(z, false), system->cpu.registers[z] >> 16);
+
+    // Output
+    printInstruction(system->cpu.registers[PC], output, instruction, additionalInfo);
+  }
+}
+
+void s32(System *system, Trace *output)
+{
+  // Fetch operands
+  const uint32_t ir = system->cpu.registers[IR];
+
+  const uint8_t z = (ir >> 21) & 0x1F;
+  const uint8_t x = (ir >> 16) & 0x1F;
+  const uint16_t i = ir & 0xFFFF;
+
+  // Execution of behavior
+  const uint32_t memoryAddress = (x != 0) ? ((system->cpu.registers[x] + i) << 2) : i << 2;
+
+  switch (memoryAddress)
+  {
+  case WATCHDOG_ADDR:
+    system->watchdog.registers = system->cpu.registers[z];
+    break;
+  case FPU_REGISTER_X_ADDR:
+    system->fpu.registers.x.f = (float)system->cpu.registers[z];
+    system->fpu.registers.x.u = system->cpu.registers[z];
+    break;
+  case FPU_REGISTER_Y_ADDR:
+    system->fpu.registers.y.f = (float)system->cpu.registers[z];
+    system->fpu.registers.y.u = system->cpu.registers[z];
+    break;
+  case FPU_REGISTER_Z_ADDR:
+    system->fpu.registers.z.f = (float)system->cpu.registers[z];
+    system->fpu.registers.z.u = system->cpu.registers[z];
+    break;
+  case FPU_REGISTER_CONTROL_ADDR:
+    system->fpu.registers.control = system->cpu.registers[z];
+    break;
+  case FPU_VECTOR_X_ADDR:
+    system->fpu.vector.x = system->cpu.registers[z];
+    break;
+  case FPU_VECTOR_Y_ADDR:
+    system->fpu.vector.y = system->cpu.registers[z];
+    break;
+  case FPU_VECTOR_Z_ADDR:
+    system->fpu.vector.z = system->cpu.registers[z];
+    break;
+  case FPU_VECTOR_LENGTH_ADDR:
+    system->fpu.vector.length = system->cpu.registers[z];
+    break;
+  case DMA_SOURCE_ADDR:
+  case DMA_DESTINATION_ADDR:
+  case DMA_LENGTH_ADDR:
+  case DMA_CONTROL_ADDR:
+    writeDMARegister(system, memoryAddress, system->cpu.registers[z]);
+    break;
+  case INTERRUPT_PENDING_ADDR:
+  case INTERRUPT_ENABLE_ADDR:
+  case INTERRUPT_PRIORITY_ADDR:
+    writeInterruptRegister(system, memoryAddress, system->cpu.registers[z]);
+    break;
+  case TIMER_CONTROL_ADDR:
+  case TIMER_RELOAD_ADDR:
+  case TIMER_PRESCALER_ADDR:
+  case TIMER_COMPARE_ADDR:
+  case TIMER_COUNT_ADDR:
+    writeIntervalTimerRegister(system, memoryAddress, system->cpu.registers[z]);
+    break;
+  case DISK_SECTOR_ADDR:
+  case DISK_MEMORY_ADDR:
+  case DISK_COUNT_ADDR:
+  case DISK_CONTROL_ADDR:
+  case DISK_SECTORS_ADDR:
+    writeDiskRegister(system, memoryAddress, system->cpu.registers[z]);
+    break;
+  default:
+    if (memoryAddress == FPU_REGISTER_CONTROL_ADDR_OTHER)
+      system->fpu.registers.control = system->cpu.registers[z];
+    else if (isPerformanceCounterAddress(memoryAddress))
+      writePerformanceCounterRegister(system, memoryAddress, system->cpu.registers[z]);
+    else if (memoryAddress < (NUM_REGISTERS * 1024))
+    {
+      system->memory[memoryAddress + 0] = (system->cpu.registers[z] >> 24) & 0xFF;
+      system->memory[memoryAddress + 1] = (system->cpu.registers[z] >> 16) & 0xFF;
+      system->memory[memoryAddress + 2] = (system->cpu.registers[z] >> 8) & 0xFF;
+      system->memory[memoryAddress + 3] = (system->cpu.registers[z]) & 0xFF;
+    }
+  }
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[100] = {0};
+
+    sprintf(instruction, "s32 [%s%s%i],%s", formatRegisterName(x, true), (i >= 0) ? ("+") : (""), i, formatRegisterName(z, true));
+    sprintf(additionalInfo, "MEM[0x%08X]=%s=0x%08X", memoryAddress, formatRegisterName(z, false), system->cpu.registers[z]);
+
+    // Output
+    printInstruction(system->cpu.registers[PC], output, instruction, additionalInfo);
+  }
+}
+
+/******************************************************
+ * Subroutine call operation
+ *******************************************************/
+
+void callf(System *system, Trace *output)
+{
+  // Fetch operands
+  const uint32_t ir = system->cpu.registers[IR];
+
+  const uint8_t x = (ir >> 16) & 0x1F;
+  const int32_t i = extendSign32(ir & 0xFFFF, 16);
+
+  if (system->cpu.registers[SP] > MEMORY_SIZE - 4)
+  {
+    raiseMemoryFault(system, system->cpu.registers[SP]);
+    return;
+  }
+
+  // Execution of behavior
+  system->control.pcAlreadyIncremented = true; // Prevent it from being incremented
+  const uint32_t oldPC = system->cpu.registers[PC];
+  const uint32_t oldSP = system->cpu.registers[SP];
+
+  system->memory[system->cpu.registers[SP]] = ((system->cpu.registers[PC] + 4) >> 24) & 0xFF;
+  system->memory[system->cpu.registers[SP] + 1] = ((system->cpu.registers[PC] + 4) >> 16) & 0xFF;
+  system->memory[system->cpu.registers[SP] + 2] = ((system->cpu.registers[PC] + 4) >> 8) & 0xFF;
+  system->memory[system->cpu.registers[SP] + 3] = ((system->cpu.registers[PC] + 4) >> 0) & 0xFF;
+
+  system->cpu.registers[PC] = (system->cpu.registers[x] + i) << 2;
+  system->cpu.registers[SP] -= 4;
+
+  if (system->predictor.enabled)
+    predictBranch(system, BRANCH_INDIRECT_CALL, oldPC, system->cpu.registers[PC], true);
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[42] = {0};
+
+    sprintf(instruction, "call [%s%s%i]",
+            formatRegisterName(x, true), (i >= 0) ? ("+") : (""), i);
+    sprintf(additionalInfo, "PC=0x%08X,MEM[0x%08X]=0x%08X", system->cpu.registers[PC], oldSP, oldPC + 4);
+
+    // Output
+    printInstruction(oldPC, output, instruction, additionalInfo);
+  }
+}
+
+void calls(System *system, Trace *output)
+{
+  // Fetch operands
+  const int32_t i = extendSign32(system->cpu.registers[IR] & 0x03FFFFFF, 26);
+
+  if (system->cpu.registers[SP] > MEMORY_SIZE - 4)
+  {
+    raiseMemoryFault(system, system->cpu.registers[SP]);
+    return;
+  }
+
+  // Execution of behavior
+  system->control.pcAlreadyIncremented = true; // Prevent it from being incremented twice
+
+  const uint32_t oldPC = system->cpu.registers[PC];
+  const uint32_t oldSP = system->cpu.registers[SP];
+
+  system->memory[system->cpu.registers[SP]] = ((system->cpu.registers[PC] + 4) >> 24) & 0xFF;
+  system->memory[system->cpu.registers[SP] + 1] = ((system->cpu.registers[PC] + 4) >> 16) & 0xFF;
+  system->memory[system->cpu.registers[SP] + 2] = ((system->cpu.registers[PC] + 4) >> 8) & 0xFF;
+  system->memory[system->cpu.registers[SP] + 3] = ((system->cpu.registers[PC] + 4) >> 0) & 0xFF;
+
+  system->cpu.registers[PC] = system->cpu.registers[PC] + 4 + (i << 2);
+  system->cpu.registers[SP] -= 4;
+
+  if (system->predictor.enabled)
+    predictBranch(system, BRANCH_CALL, oldPC, system->cpu.registers[PC], true);
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[100] = {0};
+
+    sprintf(instruction, "call %i", i);
+    sprintf(additionalInfo, "PC=0x%08X,MEM[0x%08X]=0x%08X", system->cpu.registers[PC], oldSP, oldPC + 4);
+
+    // Output
+    printInstruction(oldPC, output, instruction, additionalInfo);
+  }
+}
+
+void ret(System *system, Trace *output)
+{
+  if (system->cpu.registers[SP] > MEMORY_SIZE - 8)
+  {
+    raiseMemoryFault(system, system->cpu.registers[SP] + 4);
+    return;
+  }
+
+  // Execution of behavior
+  system->control.pcAlreadyIncremented = true; // Prevent it from being incremented twice
+
+  const uint32_t oldPC = system->cpu.registers[PC];
+  system->cpu.registers[SP] += 4;
+  system->cpu.registers[PC] = readMemory32(system, system->cpu.registers[SP]);
+
+  if (system->predictor.enabled)
+    predictBranch(system, BRANCH_RETURN, oldPC, system->cpu.registers[PC], true);
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[42] = {0};
+
+    sprintf(instruction, "ret");
+    sprintf(additionalInfo, "PC=MEM[0x%08X]=0x%08X", system->cpu.registers[SP], system->cpu.registers[PC]);
+
+    // Output
+    printInstruction(oldPC, output, instruction, additionalInfo);
+  }
+}
+
+void push(System *system, Trace *output)
+{
+  // Fetch operands
+  const uint32_t ir = system->cpu.registers[IR];
+
+  const uint32_t v = (ir >> 6) & 0x1F;
+  const uint32_t w = ir & 0x1F;
+  const uint32_t x = (ir >> 16) & 0x1F;
+  const uint32_t y = (ir >> 11) & 0x1F;
+  const uint32_t z = (ir >> 21) & 0x1F;
+
+  const uint32_t operands[] = {v, w, x, y, z};
+
+  uint8_t count = 0;
+  while (count < 5 && operands[count] != 0)
+    count++;
+
+  // The stack grows down from SP, one word per operand
+  const uint32_t sp = system->cpu.registers[SP];
+  if (count > 0 && (sp > MEMORY_SIZE - 4 || sp < 4 * (count - 1)))
+  {
+    raiseMemoryFault(system, sp);
+    return;
+  }
+
+  // Execution of behavior
+  const uint32_t oldSP = system->cpu.registers[SP];
+
+  for (uint8_t i = 0; i < 5; i++)
+  {
+    const uint32_t operand = operands[i];
+    if (operand == 0)
+      break;
+
+    system->memory[system->cpu.registers[SP] + 0] = (system->cpu.registers[operand] >> 24) & 0xFF;
+    system->memory[system->cpu.registers[SP] + 1] = (system->cpu.registers[operand] >> 16) & 0xFF;
+    system->memory[system->cpu.registers[SP] + 2] = (system->cpu.registers[operand] >> 8) & 0xFF;
+    system->memory[system->cpu.registers[SP] + 3] = (system->cpu.registers[operand]) & 0xFF;
+
+    system->cpu.registers[SP] -= 4;
+  }
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[50] = {0};
+    char additionalInfo[300] = {0};
+
+    char registerValues[100] = {0};
+    char registerLabels[100] = {0};
+
+    int tempInstruction = sprintf(instruction, "push %s", (operands[0] == 0) ? ("-") : (""));
+    int tempValues = sprintf(registerValues, "%s", "");
+    int tempLabels = sprintf(registerLabels, "%s", "");
+
+    for (uint8_t i = 0; i < 5; i++)
+    {
+      const uint32_t operand = operands[i];
+      if (operand == 0)
+        break;
+
+      // Instruction
+      tempInstruction += sprintf(instruction + tempInstruction, "%s%s",
+                                 (i > 0) ? (",") : (""), formatRegisterName(operand, true));
+
+      // Register Values
+      tempValues += sprintf(registerValues + tempValues, "%s0x%08X",
+                            (i > 0) ? (",") : (""), system->cpu.registers[operand]);
+
+      // Register Labels
+      tempLabels += sprintf(registerLabels + tempLabels, "%s%s",
+                            (i > 0) ? (",") : (""), formatRegisterName(operand, false));
+    }
+
+    sprintf(additionalInfo, "MEM[0x%08X]{%s}={%s}", oldSP, registerValues, registerLabels);
+
+    // Output
+    printInstruction(system->cpu.registers[PC], output, instruction, additionalInfo);
+  }
+}
+
+void pop(System *system, Trace *output)
+{
+  // Fetch operands
+  const uint32_t ir = system->cpu.registers[IR];
+
+  const uint32_t v = (ir >> 6) & 0x1F;
+  const uint32_t w = ir & 0x1F;
+  const uint32_t x = (ir >> 16) & 0x1F;
+  const uint32_t y = (ir >> 11) & 0x1F;
+  const uint32_t z = (ir >> 21) & 0x1F;
+
+  const uint32_t operands[] = {v, w, x, y, z};
+
+  uint8_t count = 0;
+  while (count < 5 && operands[count] != 0)
+    count++;
+
+  const uint64_t top = (uint64_t)system->cpu.registers[SP] + 4 * count;
+  if (count > 0 && top > MEMORY_SIZE - 4)
+  {
+    raiseMemoryFault(system, system->cpu.registers[SP] + 4);
+    return;
+  }
+
+  // Execution of behavior
+  const uint32_t oldSP = system->cpu.registers[SP];
+  for (uint8_t i = 0; i < 5; i++)
+  {
+    const uint32_t operand = operands[i];
+    if (operand == 0)
+      break;
+
+    system->cpu.registers[SP] += 4;
+    system->cpu.registers[operand] = readMemory32(system, system->cpu.registers[SP]);
+  }
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[50] = {0};
+    char additionalInfo[300] = {0};
+
+    char registerValues[100] = {0};
+    char registerLabels[100] = {0};
+
+    int tempInstruction = sprintf(instruction, "pop %s", (operands[0] == 0) ? ("-") : (""));
+    int tempValues = sprintf(registerValues, "%s", "");
+    int tempLabels = sprintf(registerLabels, "%s", "");
+
+    for (uint8_t i = 0; i < 5; i++)
+    {
+      const uint32_t operand = operands[i];
+      if (operand == 0)
+        break;
+
+      // Instruction
+      tempInstruction += sprintf(instruction + tempInstruction, "%s%s",
+                                 (i > 0) ? (",") : (""), formatRegisterName(operand, true));
+
+      // Register Values
+      tempValues += sprintf(registerValues + tempValues, "%s0x%08X",
+                            (i > 0) ? (",") : (""), system->cpu.registers[operand]);
+
+      // Register Labels
+      tempLabels += sprintf(registerLabels + tempLabels, "%s%s",
+                            (i > 0) ? (",") : (""), formatRegisterName(operand, false));
+    }
+
+    sprintf(additionalInfo, "{%s}=MEM[0x%08X]{%s}", registerLabels, oldSP, registerValues);
+
+    // Output
+    printInstruction(system->cpu.registers[PC], output, instruction, additionalInfo);
+  }
+}
+
+/******************************************************
+ * Iterruption
+ *******************************************************/
+
+void reti(System *system, Trace *output)
+{
+  if (system->cpu.registers[SP] > MEMORY_SIZE - 16)
+  {
+    raiseMemoryFault(system, system->cpu.registers[SP] + 4);
+    return;
+  }
+
+  // Execution of behavior
+  system->control.pcAlreadyIncremented = true; // Prevent it from being incremented twice
+  const uint32_t oldPC = system->cpu.registers[PC];
+
+  system->cpu.registers[SP] += 4;
+  system->cpu.registers[IPC] = readMemory32(system, system->cpu.registers[SP]);
+
+  system->cpu.registers[SP] += 4;
+  system->cpu.registers[CR] = readMemory32(system, system->cpu.registers[SP]);
+
+  system->cpu.registers[SP] += 4;
+  system->cpu.registers[PC] = readMemory32(system, system->cpu.registers[SP]);
+
+  if (system->terminal.input.inService)
+  {
+    system->terminal.input.inService = false; // Input may interrupt again
+    updateTerminalInterrupt(system);
+  }
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[300] = {0};
+
+    sprintf(instruction, "reti");
+    sprintf(additionalInfo, "IPC=MEM[0x%08X]=0x%08X,CR=MEM[0x%08X]=0x%08X,PC=MEM[0x%08X]=0x%08X", system->cpu.registers[SP] - 8, system->cpu.registers[IPC], system->cpu.registers[SP] - 4, system->cpu.registers[CR], system->cpu.registers[SP], system->cpu.registers[PC]);
+
+    // Output
+    printInstruction(oldPC, output, instruction, additionalInfo);
+  }
+}
+
+void cbr(CPU *cpu, Trace *output)
+{
+  // Fetch operands
+  const uint32_t ir = cpu->registers[IR];
+
+  const uint8_t z = (ir >> 21) & 0x1F;
+  const uint8_t x = (ir >> 16) & 0x1F;
+
+  // Execution of behavior
+  const uint32_t oldPC = cpu->registers[PC];
+  if (z != 0)
+    cpu->registers[z] &= ~(0x00000001 << x);
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[300] = {0};
+
+    sprintf(instruction, "cbr %s[%i]",
+            formatRegisterName(z, true), x);
+    sprintf(additionalInfo, "%s=0x%08X", formatRegisterName(z, false), cpu->registers[z]);
+
+    // Output
+    printInstruction(oldPC, output, instruction, additionalInfo);
+  }
+}
+
+void sbr(CPU *cpu, Trace *output)
+{
+  // Fetch operands
+  const uint32_t ir = cpu->registers[IR];
+
+  const uint8_t z = (ir >> 21) & 0x1F;
+  const uint8_t x = (ir >> 16) & 0x1F;
+
+  // Execution of behavior
+  const uint32_t oldPC = cpu->registers[PC];
+  if (z != 0)
+    cpu->registers[z] |= (0x00000001 << x);
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[300] = {0};
+
+    sprintf(instruction, "sbr %s[%i]",
+            formatRegisterName(z, true), x);
+    sprintf(additionalInfo, "%s=0x%08X", formatRegisterName(z, false), cpu->registers[z]);
+
+    // Output
+    printInstruction(oldPC, output, instruction, additionalInfo);
+  }
+}
+
+void interrupt(System *system, Trace *output)
+{
+  // Fetch operands
+  const uint32_t i = system->cpu.registers[IR] & 0x3FFFFF;
+
+  // Execution of behavior
+  const uint32_t oldPC = system->cpu.registers[PC];
+  if (i == 0)
+  {
+    system->control.run = false;
+    memset(system->cpu.registers, 0, sizeof(uint32_t) * NUM_REGISTERS);
+  }
+  else
+  {
+    handleInterrupt(system, output);
+
+    if (system->limits.reason == POXIM_MEMORY_FAULT)
+      return;
+  }
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[30] = {0};
+    char additionalInfo[300] = {0};
+
+    sprintf(instruction, "int %i", i);
+    sprintf(additionalInfo, "CR=0x%08X,PC=0x%08X", system->cpu.registers[CR], system->cpu.registers[PC]);
+
+    // Output
+    printInstruction(oldPC, output, instruction, additionalInfo);
+  }
+
+  if (i != 0)
+    printInterruptMessage(INIT_INTERRUPT_ADDR, output);
+}
+
+void unknownInstruction(System *system, Trace *output)
+{
+  // Execution of behavior
+  const uint32_t oldPC = system->cpu.registers[PC];
+
+  system->cpu.registers[SR] |= IV_FLAG;
+
+  // Instruction formatting
+  if (output != NULL)
+  {
+    char instruction[100] = {0};
+    sprintf(instruction, "[INVALID INSTRUCTION @ 0x%08X]", oldPC);
+
+    emitTraceLine(output, instruction);
+  }
+
+  handleInvalidInstruction(system, output);
+}
+
+/******************************************************
+ * Routines interrupt handling
+ *******************************************************/
+
+bool handlePrepareForISR(System *system)
+{
+  // Three words go below SP: the return address, CR and IPC
+  const uint32_t sp = system->cpu.registers[SP];
+  if (sp > MEMORY_SIZE - 4 || sp < 8)
+  {
+    raiseMemoryFault(system, sp);
+    return false;
+  }
+
+  const uint32_t pc = system->control.pcAlreadyIncremented ? system->cpu.registers[PC] : system->cpu.registers[PC] + 4;
+
+  system->memory[system->cpu.registers[SP] + 0] = (pc >> 24) & 0xFF;
+  system->memory[system->cpu.registers[SP] + 1] = (pc >> 16) & 0xFF;
+  system->memory[system->cpu.registers[SP] + 2] = (pc >> 8) & 0xFF;
+  system->memory[system->cpu.registers[SP] + 3] = pc & 0xFF;
+  system->cpu.registers[SP] -= 4;
+
+  system->memory[system->cpu.registers[SP] + 0] = (system->cpu.registers[CR] >> 24) & 0xFF;
+  system->memory[system->cpu.registers[SP] + 1] = (system->cpu.registers[CR] >> 16) & 0xFF;
+  system->memory[system->cpu.registers[SP] + 2] = (system->cpu.registers[CR] >> 8) & 0xFF;
+  system->memory[system->cpu.registers[SP] + 3] = (system->cpu.registers[CR]) & 0xFF;
+  system->cpu.registers[SP] -= 4;
+
+  system->memory[system->cpu.registers[SP] + 0] = (system->cpu.registers[IPC] >> 24) & 0xFF;
+  system->memory[system->cpu.registers[SP] + 1] = (system->cpu.registers[IPC] >> 16) & 0xFF;
+  system->memory[system->cpu.registers[SP] + 2] = (system->cpu.registers[IPC] >> 8) & 0xFF;
+  system->memory[system->cpu.registers[SP] + 3] = (system->cpu.registers[IPC]) & 0xFF;
+  system->cpu.registers[SP] -= 4;
+
+  system->timing.interrupts++;
+
+  if (system->timing.enabled)
+    system->timing.cycles += system->timing.costs.interrupt;
+
+  if (system->profiler.enabled)
+  {
+    system->profiler.interruptEntered = true;
+    system->profiler.interruptReturn = pc;
+  }
+
+  return true;
+}
+
+void handleDivideByZero(System *system, Trace *output)
+{
+
+  if (isIESet(&system->cpu))
+  {
+    if (!handlePrepareForISR(system))
+      return;
+
+    system->control.pcAlreadyIncremented = true;
+    system->cpu.registers[CR] = 0;
+    system->cpu.registers[IPC] = system->cpu.registers[PC];
+    system->cpu.registers[PC] = DIVIDE_BY_ZERO_ADDR;
+
+    printInterruptMessage(DIVIDE_BY_ZERO_ADDR, output);
+  }
+}
+
+void handleInvalidInstruction(System *system, Trace *output)
+{
+  if (!handlePrepareForISR(system))
+    return;
+
+  system->control.pcAlreadyIncremented = true;
+
+  system->cpu.registers[CR] = (system->cpu.registers[IR] >> 26) & 0x3F;
+  system->cpu.registers[IPC] = system->cpu.registers[PC];
+  system->cpu.registers[PC] = INVALID_INSTRUCTION_ADDR;
+
+  printInterruptMessage(INVALID_INSTRUCTION_ADDR, output);
+}
+
+void handleInterrupt(System *system, Trace *output)
+{
+  if (!handlePrepareForISR(system))
+    return;
+
+  system->cpu.registers[CR] = system->cpu.registers[IR] & 0x3FFFFF;
+  system->cpu.registers[IPC] = system->cpu.registers[PC];
+  system->cpu.registers[PC] = SOFTWARE_INTERRUPT_ADDR;
+
+  system->control.pcAlreadyIncremented = true;
+}
+
+/******************************************************
+ * Fetch from the status register(SR)
+ *******************************************************/
+
+int isCYSet(CPU *cpu)
+{
+  return (cpu->registers[SR] & CY_FLAG) != 0;
+}
+
+int isIESet(CPU *cpu)
+{
+  return (cpu->registers[SR] & IE_FLAG) != 0;
+}
+
+int isIVSet(CPU *cpu)
+{
+  return ((cpu->registers[SR] & IV_FLAG) >> 2) != 0;
+}
+
+int isOVSet(CPU *cpu)
+{
+  return ((cpu->registers[SR] & OV_FLAG) >> 3) != 0;
+}
+
+int isSNSet(CPU *cpu)
+{
+  return ((cpu->registers[SR] & SN_FLAG) >> 4) != 0;
+}
+
+int isZDSet(CPU *cpu)
+{
+  return ((cpu->registers[SR] & ZD_FLAG) >> 5) != 0;
+}
+
+int isZNSet(CPU *cpu)
+{
+  return ((cpu->registers[SR] & ZN_FLAG) >> 6) != 0;
+}
+
+/******************************************************
+ * Utility Functions
+ *******************************************************/
+
+int32_t extendSign32(uint32_t value, uint8_t significantBit)
+{
+  const uint32_t bitSignalDefined = value & (1 << (significantBit - 1));
+  return (bitSignalDefined ? (value | (0xFFFFFFFF << (significantBit))) : value);
+}
+
+int64_t extendSign64(uint32_t value, uint8_t significantBit)
+{
+  const uint32_t bitSignalDefined = value & (1 << (significantBit - 1));
+  return (bitSignalDefined ? (value | (0xFFFFFFFFFFFFFFFF << (significantBit))) : value);
+}
+
+// Hands one line to the trace callback and counts it against the trace limit
+void emitTraceLine(Trace *output, const char *line)
+{
+  output->callback(output->context, line);
+  output->bytes += strlen(line) + 1;
+}
+
+void printInstruction(uint32_t pc, Trace *output, char *instruction, char *additionalInfo)
+{
+  char line[TRACE_LINE_SIZE];
+  snprintf(line, sizeof(line), "0x%08X:\t%-25s\t%s", pc, instruction, additionalInfo);
+
+  emitTraceLine(output, line);
+}
+
+void printInterruptMessage(uint32_t code, Trace *output)
+{
+  if (output == NULL)
+    return;
+
+  char message[300] = {0};
+
+  switch (code)
+  {
+  case INIT_INTERRUPT_ADDR:
+  case SOFTWARE_INTERRUPT_ADDR:
+    sprintf(message, "[SOFTWARE INTERRUPTION]");
+    break;
+  case INVALID_INSTRUCTION_ADDR:
+    sprintf(message, "[SOFTWARE INTERRUPTION]");
+    break;
+  case DIVIDE_BY_ZERO_ADDR:
+    sprintf(message, "[SOFTWARE INTERRUPTION]");
+    break;
+  case HARDWARE1_INTERRUPT_ADDR:
+    sprintf(message, "[HARDWARE INTERRUPTION 1]");
+    break;
+  case HARDWARE2_INTERRUPT_ADDR:
+    sprintf(message, "[HARDWARE INTERRUPTION 2]");
+    break;
+  case HARDWARE3_INTERRUPT_ADDR:
+    sprintf(message, "[HARDWARE INTERRUPTION 3]");
+    break;
+  case HARDWARE4_INTERRUPT_ADDR:
+    sprintf(message, "[HARDWARE INTERRUPTION 4]");
+    break;
+  default:
+    break;
+  }
+
+  emitTraceLine(output, message);
+}
+
+const char *formatRegisterName(uint8_t registerNumber, bool lower)
+{
+  // Names are static so that formatting a trace line does not allocate
+  static const char *upperNames[32] = {
+      "R0", "R1", "R2", "R3", "R4", "R5", "R6", "R7",
+      "R8", "R9", "R10", "R11", "R12", "R13", "R14", "R15",
+      "R16", "R17", "R18", "R19", "R20", "R21", "R22", "R23",
+      "R24", "R25", "CR", "IPC", "IR", "PC", "SP", "SR"};
+  static const char *lowerNames[32] = {
+      "r0", "r1", "r2", "r3", "r4", "r5", "r6", "r7",
+      "r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15",
+      "r16", "r17", "r18", "r19", "r20", "r21", "r22", "r23",
+      "r24", "r25", "cr", "ipc", "ir", "pc", "sp", "sr"};
+
+  return lower ? lowerNames[registerNumber & 0x1F] : upperNames[registerNumber & 0x1F];
+}
+
+// Words that do not fit in memory read as zero
+uint32_t readMemory32(System *system, uint32_t memoryAddress)
+{
+  if (memoryAddress > MEMORY_SIZE - 4)
+    return 0;
+
+  return ((system->memory[memoryAddress] << 24) |
+          (system->memory[memoryAddress + 1] << 16) |
+          (system->memory[memoryAddress + 2] << 8) |
+          (system->memory[memoryAddress + 3] << 0));
+}
@@ -0,0 +1,200 @@
+#ifndef POXIM_H
+#define POXIM_H
+
+/******************************************************
+ * Poxim simulator library
+ *
+ * Build the library from poxim.c, reports.c, lockstep.c, assembler.c, analysis.c and translator.c.
+ * main.c is the command line front end on top of this interface.
+ *******************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define POXIM_MEMORY_SIZE (32 * 1024)
+#define POXIM_LOCKSTEP_LANES 8
+
+typedef struct TSystem PoximSystem;
+typedef struct TPoximPool PoximPool;
+typedef struct TPoximImage PoximImage;
+typedef struct TPoximSymbols PoximSymbols;
+
+// Receives one trace line at a time, without the trailing newline
+typedef void (*PoximTraceCallback)(void *context, const char *line);
+
+// Receives terminal output in chunks (not NUL-terminated)
+typedef void (*PoximTerminalCallback)(void *context, const char *data, size_t length);
+
+// Fills data with up to capacity bytes of terminal input and returns how many,
+// 0 at the end of the input. May block until input arrives.
+typedef size_t (*PoximInputCallback)(void *context, char *data, size_t capacity);
+
+// Native code for one program, as written by poxim_translate: runs the
+// system from its PC for up to count (> 0) instructions, stopping early when
+// the program does, and returns the number executed
+typedef uint64_t (*PoximTranslation)(PoximSystem *system, uint64_t count);
+
+// Bounds on one run, 0 meaning no bound. Instructions count from the last
+// reset, trace bytes are the lines given to the callback plus a newline each,
+// and wall time starts with the first run after a reset or poxim_set_limits.
+// Also set by --max-instructions=<n>, --max-trace-bytes=<n> and
+// --max-seconds=<s>.
+typedef struct
+{
+  uint64_t instructions;
+  uint64_t traceBytes;
+  double seconds;
+} PoximLimits;
+
+typedef enum
+{
+  POXIM_RUNNING,
+  POXIM_HALTED,            // The program stopped itself
+  POXIM_INSTRUCTION_LIMIT, // Stopped by one of the limits
+  POXIM_TRACE_LIMIT,
+  POXIM_TIME_LIMIT,
+  POXIM_MEMORY_FAULT       // Fetched code or moved the stack outside memory
+} PoximStatus;
+
+// Creates a system with zeroed registers and memory. Options use the command
+// line syntax (e.g. "--timing", "--predictor=gshare:10"); returns NULL when
+// one of them is invalid.
+PoximSystem *poxim_create(int optionCount, const char *const options[]);
+void poxim_destroy(PoximSystem *system);
+
+// Creates count systems with the same options in one contiguous allocation
+// (and one block of guest memory), for keeping many small guests resident.
+// Systems belong to the pool and must not be passed to poxim_destroy.
+PoximPool *poxim_pool_create(size_t count, int optionCount, const char *const options[]);
+PoximSystem *poxim_pool_system(PoximPool *pool, size_t index);
+void poxim_pool_destroy(PoximPool *pool);
+
+// Returns the system to its state right after poxim_create (zeroed registers,
+// memory and devices, no trace, terminal or input callback) without releasing its
+// allocations
+void poxim_reset(PoximSystem *system);
+
+// Copy a program into memory at address 0, either as a raw big-endian image
+// or as the text format of the .hex files (one 32-bit word per line).
+// Return false when the program does not fit in memory.
+bool poxim_load(PoximSystem *system, const uint8_t *image, size_t size);
+bool poxim_load_hex(PoximSystem *system, const char *text, size_t length);
+
+// A program parsed once and shared by every system it is loaded into. On
+// Linux each system maps it copy-on-write, so only the pages a guest writes
+// are duplicated; elsewhere loading copies it. Returns NULL when the program
+// does not fit in memory. An image must outlive the loads that use it.
+PoximImage *poxim_image_create(const uint8_t *image, size_t size);
+PoximImage *poxim_image_create_hex(const char *text, size_t length);
+void poxim_image_destroy(PoximImage *image);
+bool poxim_load_image(PoximSystem *system, PoximImage *image);
+
+// Assemble source in the .s dialect (labels, .text/.data, .align, .fill,
+// .4byte, .asciz, register names such as sp and sr) in two passes, without
+// going through the .hex text. Errors are printed to stderr with their line
+// number, and the functions then return false or NULL.
+//
+// poxim_assemble writes the raw big-endian image, the format of poxim_load,
+// into image (POXIM_MEMORY_SIZE bytes) and its length to size. When symbols
+// is not NULL it also receives the labels, to be released with
+// poxim_symbols_destroy; poxim_write_symbols writes them as one
+// "<address> <label>" line each.
+bool poxim_assemble(const char *text, size_t length, uint8_t *image, size_t *size, PoximSymbols **symbols);
+void poxim_symbols_destroy(PoximSymbols *symbols);
+bool poxim_write_symbols(const PoximSymbols *symbols, const char *path);
+
+// Assemble straight into guest memory, or into a shared image. The labels
+// stay with the system until the next load or reset: the profiler reports
+// then name functions by label, and --symbol-map=<file> writes the map
+// alongside the other reports.
+bool poxim_load_asm(PoximSystem *system, const char *text, size_t length);
+PoximImage *poxim_image_create_asm(const char *text, size_t length);
+
+// Translates the program in memory ahead of time into a C file for the host
+// compiler, to be built with the library sources. Code is found by
+// following branches and calls from address 0 and the interrupt vectors;
+// each basic block becomes a label, registers become locals and SR flags
+// are only computed where a later instruction can read them. Loads and
+// stores outside memory, division, interrupts and jumps to code that was
+// not found go through the interpreter and its devices. Programs that
+// modify their own code are not supported. The file's main runs the program
+// as "<binary> <output> [options]", writing what the front end writes
+// without a trace. Also reached as "poxim --translate=<file.c> <input>".
+bool poxim_translate(PoximSystem *system, const char *path);
+
+// Runs the loaded program through its translation in poxim_run, until the
+// next reset. Traced runs and runs with the timing, pipeline, predictor or
+// profiler models keep interpreting.
+void poxim_set_translation(PoximSystem *system, PoximTranslation translation);
+
+// Tracing is off until a callback is set; NULL turns it off again
+void poxim_set_trace(PoximSystem *system, PoximTraceCallback callback, void *context);
+
+// Streams terminal output instead of keeping it for poxim_terminal. Output
+// goes through a fixed-size buffer that is handed to the callback when it
+// fills, when its oldest character has waited a few tens of thousands of
+// instructions, and before poxim_run or poxim_step returns. NULL goes back
+// to keeping it.
+void poxim_set_terminal(PoximSystem *system, PoximTerminalCallback callback, void *context);
+
+// Feeds the terminal input register (0x8888888A) from the callback, which is
+// asked for large blocks so most guest reads are served from memory. Each
+// read takes the next byte, or 0 once the input is exhausted. The status byte
+// at 0x88888889 has bit 0 set while a byte is waiting and bit 1 at the end of
+// the input; a guest setting bit 2 gets a HARDWARE1 interrupt (CR 0x7E2A1A1A)
+// whenever a byte is waiting, again after each reti. NULL disconnects the input.
+void poxim_set_input(PoximSystem *system, PoximInputCallback callback, void *context);
+
+// Attaches a host file as the guest's block device (registers at
+// 0x80808AC0), mapped so that only the sectors the guest touches are read.
+// Writes reach the file when writable is set and are rejected (ST) otherwise.
+// Replaces the disk given by --disk=<file> (--disk-read-only); the disk stays
+// attached across resets. NULL detaches it. Returns false when the file
+// cannot be mapped, leaving no disk attached.
+bool poxim_set_disk(PoximSystem *system, const char *path, bool writable);
+
+// Limits start out as given by the options and return to them on reset. A
+// system that reaches one stops running with the matching status; the time
+// limit is checked every few tens of thousands of instructions.
+void poxim_set_limits(PoximSystem *system, const PoximLimits *limits);
+void poxim_get_limits(PoximSystem *system, PoximLimits *limits);
+
+// Executes up to count instructions (0 = until the program stops) and returns
+// the number executed
+uint64_t poxim_run(PoximSystem *system, uint64_t count);
+
+// Executes a single instruction; returns whether the program is still running
+bool poxim_step(PoximSystem *system);
+
+// Runs count systems, each until it stops or executes limit instructions
+// (0 = no limit), and returns the number executed. Systems running the same
+// code are stepped POXIM_LOCKSTEP_LANES at a time with one vector operation
+// per instruction, AVX2 when the CPU has it and --simd=off is not given; a
+// guest leaves its group for the scalar interpreter when it touches a device
+// or takes an interrupt. Traced systems and systems with the timing,
+// pipeline, predictor or profiler models run scalar throughout.
+uint64_t poxim_run_lockstep(PoximSystem *const systems[], size_t count, uint64_t limit);
+
+bool poxim_running(PoximSystem *system);
+PoximStatus poxim_status(PoximSystem *system);
+uint64_t poxim_instructions(PoximSystem *system);
+
+uint32_t poxim_get_register(PoximSystem *system, uint8_t index);
+void poxim_set_register(PoximSystem *system, uint8_t index, uint32_t value);
+
+// Plain memory access; device registers are not visible here
+bool poxim_read_memory(PoximSystem *system, uint32_t address, void *buffer, size_t size);
+bool poxim_write_memory(PoximSystem *system, uint32_t address, const void *buffer, size_t size);
+
+// Characters written to the terminal so far (not NUL-terminated), apart from
+// those streamed to a terminal callback
+const char *poxim_terminal(PoximSystem *system, size_t *length);
+
+// Writes the timing, pipeline, predictor and profiler reports selected by
+// the options to their files, or to stderr. With a profiler, each load
+// finds the natural loops of the program's control flow, and the flat
+// profile (--profile) ends with their entries, iterations and instructions.
+void poxim_write_reports(PoximSystem *system);
+
+#endif
@@ -0,0 +1,1118 @@
+#ifndef POXIM_INTERNAL_H
+#define POXIM_INTERNAL_H
+
+/******************************************************
+ * Libraries
+ *******************************************************/
+
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <ctype.h>
+#include <math.h>
+#include <time.h>
+#include <errno.h>
+
+#include "poxim.h"
+
+/******************************************************
+ * Utility Constants
+ *******************************************************/
+
+#define NUM_REGISTERS 32
+#define MEMORY_SIZE POXIM_MEMORY_SIZE
+#define TRACE_LINE_SIZE 512
+#define TERMINAL_STREAM_SIZE 1024        // Terminal output held before it is handed to the callback
+#define TERMINAL_FLUSH_INTERVAL (1 << 16) // Instructions output may wait in the stream buffer
+#define TERMINAL_INPUT_SIZE (64 * 1024)   // Terminal input prefetched from the host per refill
+
+// Specific use register indexes
+#define CR 26  // Case interruption
+#define IPC 27 // Interrupt address
+#define IR 28  // Instruction Register
+#define PC 29  // Program Counter
+#define SP 30  // Stack Pointer
+#define SR 31  // Status Register
+
+// Flags in Status Register
+#define ZN_FLAG 0b01000000
+#define ZD_FLAG 0b00100000
+#define SN_FLAG 0b00010000
+#define OV_FLAG 0b00001000
+#define IV_FLAG 0b00000100
+#define IE_FLAG 0b00000010
+#define CY_FLAG 0b00000001
+
+// Interrupt addresses
+#define INIT_INTERRUPT_ADDR 0x00000000
+#define DIVIDE_BY_ZERO_ADDR 0x00000008
+#define INVALID_INSTRUCTION_ADDR 0x00000004
+#define SOFTWARE_INTERRUPT_ADDR 0x0000000C
+#define HARDWARE1_INTERRUPT_ADDR 0x00000010
+#define HARDWARE2_INTERRUPT_ADDR 0x00000014
+#define HARDWARE3_INTERRUPT_ADDR 0x00000018
+#define HARDWARE4_INTERRUPT_ADDR 0x0000001C
+#define WATCHDOG_ADDR 0x80808080
+
+// Interrupt codes
+#define HARDWARE1_INTERRUPT_CODE 0xE1AC04DA
+#define FPU_INTERRUPT_CODE 0x01EEE754
+#define TERMINAL_INTERRUPT_CODE 0x7E2A1A1A // Terminal input ready, on the HARDWARE1 vector
+#define DMA_INTERRUPT_CODE 0x0D3A0D3A      // DMA transfer ended, on the HARDWARE1 vector
+#define TIMER_INTERRUPT_CODE 0x71E3E200    // Interval timer compare match, on the HARDWARE1 vector
+#define DISK_INTERRUPT_CODE 0xD15CB10C     // Block device transfer ended, on the HARDWARE1 vector
+
+// FPU
+#define FPU_REGISTER_X_ADDR 0x80808880
+#define FPU_REGISTER_Y_ADDR 0x80808884
+#define FPU_REGISTER_Z_ADDR 0x80808888
+#define FPU_REGISTER_CONTROL_ADDR 0x8080888C
+#define FPU_REGISTER_CONTROL_ADDR_OTHER 0x8080888F
+
+#define FPU_CONTROL_ST_MASK 0x00000020
+
+// Vector operations: with FPU_CONTROL_VECTOR_MASK set, opcodes 1-4 apply to
+// arrays of IEEE 754 singles in guest memory instead of the x/y/z registers.
+// An operation whose z array partly overlaps x or y is rejected
+#define FPU_VECTOR_X_ADDR 0x80808890 // Byte addresses of the arrays
+#define FPU_VECTOR_Y_ADDR 0x80808894
+#define FPU_VECTOR_Z_ADDR 0x80808898
+#define FPU_VECTOR_LENGTH_ADDR 0x8080889C // Elements
+
+#define FPU_CONTROL_VECTOR_MASK 0x00000040
+#define FPU_VECTOR_WIDTH 8 // Elements the modelled vector unit completes per tick
+
+// DMA controller; source and destination are byte addresses in guest memory
+#define DMA_SOURCE_ADDR 0x80808A00
+#define DMA_DESTINATION_ADDR 0x80808A04
+#define DMA_LENGTH_ADDR 0x80808A08
+#define DMA_CONTROL_ADDR 0x80808A0C
+
+#define DMA_CONTROL_COPY 0x01      // Copy length bytes from source to destination
+#define DMA_CONTROL_FILL 0x02      // Fill length bytes at destination with the low byte of source
+#define DMA_CONTROL_INTERRUPT 0x04 // Interrupt when a transfer ends
+#define DMA_CONTROL_ST 0x20        // Last transfer was rejected (out of memory, or both operations)
+
+// Interrupt controller
+#define INTERRUPT_PENDING_ADDR 0x80808A40  // Read only
+#define INTERRUPT_ENABLE_ADDR 0x80808A44   // One bit per InterruptSource, all set at reset; the non-maskable ones stay set
+#define INTERRUPT_PRIORITY_ADDR 0x80808A48 // Four bits per source, the highest taken first
+
+#define INTERRUPT_DEFAULT_PRIORITIES 0xABCDEF // Watchdog, FPU, DMA, terminal input, interval timer, then the disk
+
+// Interval timer: counts up every PRESCALER + 1 ticks and wraps after RELOAD
+// counts; writing any register while it runs restarts the period
+#define TIMER_CONTROL_ADDR 0x80808A80
+#define TIMER_RELOAD_ADDR 0x80808A84    // Counts per period, 0 meaning 2^32
+#define TIMER_PRESCALER_ADDR 0x80808A88 // Ticks per count, minus one
+#define TIMER_COMPARE_ADDR 0x80808A8C   // Count that matches once per period
+#define TIMER_COUNT_ADDR 0x80808A90     // Read only
+
+#define TIMER_CONTROL_EN 0x01
+#define TIMER_CONTROL_INTERRUPT 0x02 // Interrupt on compare match
+#define TIMER_CONTROL_ONE_SHOT 0x04  // Stop at the first match
+
+// Block device over a host file mapped with --disk=<file>
+#define DISK_SECTOR_SIZE 512
+#define DISK_SECTOR_ADDR 0x80808AC0  // First sector of the transfer
+#define DISK_MEMORY_ADDR 0x80808AC4  // Byte address in guest memory
+#define DISK_COUNT_ADDR 0x80808AC8   // Sectors
+#define DISK_CONTROL_ADDR 0x80808ACC
+#define DISK_SECTORS_ADDR 0x80808AD0 // Read only: size of the disk in sectors
+
+#define DISK_CONTROL_READ 0x01      // Disk to guest memory
+#define DISK_CONTROL_WRITE 0x02     // Guest memory to disk
+#define DISK_CONTROL_INTERRUPT 0x04 // Interrupt when a transfer ends
+#define DISK_CONTROL_ST 0x20        // Last transfer was rejected (no disk, out of range, read only)
+
+// Performance counters, 64 bits each with the low word first
+#define PERF_COUNTER_BASE_ADDR 0x80808900
+#define PERF_COUNTER_CONTROL_ADDR 0x80808930
+
+#define PERF_COUNTER_INSTRUCTIONS 0
+#define PERF_COUNTER_CYCLES 1
+#define PERF_COUNTER_LOADS 2
+#define PERF_COUNTER_STORES 3
+#define PERF_COUNTER_TAKEN_BRANCHES 4
+#define PERF_COUNTER_INTERRUPTS 5
+#define PERF_COUNTER_COUNT 6
+
+// Terminal
+#define TERMINAL_OUT_ADDRESS 0x8888888B
+#define TERMINAL_IN_ADDRESS 0x8888888A
+#define TERMINAL_STATUS_ADDRESS 0x88888889
+
+#define TERMINAL_STATUS_READY 0x01     // A byte is waiting at TERMINAL_IN_ADDRESS
+#define TERMINAL_STATUS_END 0x02       // The input is exhausted
+#define TERMINAL_STATUS_INTERRUPT 0x04 // Interrupt while a byte is waiting (the only writable bit)
+
+// Pipeline model
+#define PIPELINE_DEPTH 5
+#define PIPELINE_BRANCH_FLUSH 2    // Instructions fetched behind a control transfer resolved in EX
+#define PIPELINE_INTERRUPT_FLUSH 3 // Instructions squashed when entering an ISR
+
+// Branch prediction
+#define RETURN_STACK_SIZE 16
+#define DEFAULT_MISPREDICT_PENALTY 2
+
+// AVX2 kernels are built on x86 whatever the compiler flags and chosen at
+// run time, when the CPU has AVX2 and --simd is not off
+#if defined(__x86_64__) || defined(__i386__)
+#define AVX2_KERNELS
+#endif
+
+// Lockstep engine
+#define LOCKSTEP_LANES POXIM_LOCKSTEP_LANES
+#define LOCKSTEP_FLUSH_INTERVAL 0x40000000 // Instructions a lane runs before its counters are folded into the system
+
+// Run limits
+#define LIMIT_CHECK_INTERVAL (1 << 16) // Instructions between reads of the clock
+
+// Idle loops
+#define NO_IDLE_LOOP 0xFFFFFFFF // IdleLoop.head when no branch is being watched
+#define IDLE_LOOP_MAX_LENGTH 16 // Longest iteration, in instructions, compared for idleness
+
+// Assembler
+#define ASSEMBLER_LINE_SIZE 1024  // Longest source line
+#define ASSEMBLER_MAX_OPERANDS 64 // Per statement, the values of one .4byte included
+
+// Control flow analysis
+#define ANALYZED_WORDS (MEMORY_SIZE / 4)
+#define NO_ANALYZED_BLOCK 0xFFFFFFFF
+#define NO_ANALYZED_LOOP 0xFFFFFFFF
+#define ANALYZED_LEADER (NO_ANALYZED_BLOCK - 1) // blockOf marks while the code is being found
+#define ANALYZED_CODE (NO_ANALYZED_BLOCK - 2)
+
+// Translator
+#define TRANSLATED_WORDS (MEMORY_SIZE / 4)
+#define TRANSLATED_FLAGS (ZN_FLAG | ZD_FLAG | SN_FLAG | OV_FLAG | IV_FLAG | CY_FLAG) // SR bits tracked for liveness
+#define NO_TRANSLATED_BLOCK 0xFFFFFFFF
+
+/******************************************************
+ * Types
+ *******************************************************/
+
+typedef struct
+{
+  float f;
+  uint32_t u;
+} FPUOperand;
+
+typedef struct
+{
+  uint32_t registers[NUM_REGISTERS];
+} CPU;
+
+typedef struct
+{
+  uint32_t code; // Vector of the completion interrupt
+} FPUInterrupt;
+
+typedef struct
+{
+  uint32_t counter;
+  bool enabled;
+  FPUInterrupt interrupt;
+} FPUTimer;
+
+typedef struct
+{
+  FPUOperand x;
+  FPUOperand y;
+  FPUOperand z;
+  uint32_t control;
+} FPURegister;
+
+typedef struct
+{
+  uint32_t x;
+  uint32_t y;
+  uint32_t z;
+  uint32_t length;
+} FPUVector;
+
+typedef struct
+{
+  FPURegister registers;
+  FPUVector vector;
+  FPUTimer timer;
+  bool previousControlStatus;
+} FPU;
+
+typedef struct
+{
+  uint32_t source;
+  uint32_t destination;
+  uint32_t length;
+  uint32_t control;
+} DMA;
+
+typedef struct
+{
+  uint32_t control;
+  uint32_t reload;
+  uint32_t prescaler;
+  uint32_t compare;
+  uint64_t start;    // Clock when the current run started
+  uint64_t deadline; // Clock of the next compare match, UINT64_MAX when none is due
+} IntervalTimer;
+
+typedef struct
+{
+  uint8_t *data;   // Mapped file, NULL when no disk is attached
+  uint64_t size;   // Whole sectors only
+  bool writable;   // Mapped shared, so writes reach the file
+  uint32_t sector;
+  uint32_t address;
+  uint32_t count;
+  uint32_t control;
+} Disk;
+
+typedef struct
+{
+  int32_t registers;
+} Watchdog;
+
+typedef struct
+{
+  bool run;
+  bool pcAlreadyIncremented;
+  uint32_t oldPC;
+} Control;
+
+// Hardware interrupt sources, one bit each in the controller's registers
+typedef enum
+{
+  INTERRUPT_WATCHDOG, // HARDWARE1
+  INTERRUPT_FPU,      // HARDWARE2-4, taken even with IE clear
+  INTERRUPT_DMA,      // HARDWARE1, taken even with IE clear
+  INTERRUPT_TERMINAL, // HARDWARE1
+  INTERRUPT_TIMER,    // HARDWARE1
+  INTERRUPT_DISK,     // HARDWARE1
+  INTERRUPT_SOURCES
+} InterruptSource;
+
+#define INTERRUPT_NON_MASKABLE ((1u << INTERRUPT_FPU) | (1u << INTERRUPT_DMA))
+
+// Devices only raise and clear their pending bit; instructions pay for a
+// single test of pending & enabled and one interrupt is taken per instruction
+typedef struct
+{
+  uint32_t pending;
+  uint32_t enabled;    // Sources the guest has not masked
+  uint32_t priorities; // Four bits per source; ties go to the lower source
+} InterruptController;
+
+typedef struct
+{
+  char *data;
+  size_t size;
+  size_t capacity;
+} TerminalBuffer;
+
+typedef struct
+{
+  PoximTerminalCallback callback; // NULL when output is kept in the buffer
+  void *context;
+  uint64_t since; // Instruction count when the oldest buffered character was written
+  size_t size;
+  char data[TERMINAL_STREAM_SIZE];
+} TerminalStream;
+
+typedef struct
+{
+  PoximInputCallback callback; // NULL when nothing feeds the terminal
+  void *context;
+  char *data;      // TERMINAL_INPUT_SIZE bytes, allocated when a callback is first set
+  size_t size;     // Bytes fetched by the last refill
+  size_t position; // Next byte handed to the guest
+  bool end;        // The callback reported the end of the input
+  bool interrupt;  // TERMINAL_STATUS_INTERRUPT
+  bool inService;  // Interrupt taken and its handler not yet returned from
+} TerminalInput;
+
+typedef struct
+{
+  uint32_t registers;
+  TerminalBuffer buffer;
+  TerminalStream stream;
+  TerminalInput input;
+} Terminal;
+
+typedef struct
+{
+  uint32_t alu;
+  uint32_t mulDiv;
+  uint32_t memory; // Per load/store, per register for push/pop
+  uint32_t branchTaken;
+  uint32_t branchNotTaken;
+  uint32_t call; // call, ret and reti
+  uint32_t interrupt;
+} TimingCosts;
+
+typedef struct
+{
+  bool enabled;
+  bool timersUseCycles; // Watchdog and FPU timers advance by modeled cycles
+
+  uint64_t instructions;
+  uint64_t cycles;
+  uint64_t interrupts;
+  uint64_t lastTick; // Cycle count at the previous device timer update
+
+  TimingCosts costs;
+  uint32_t opcodeCycles[64]; // Cost of every non-branch opcode
+} Timing;
+
+typedef enum
+{
+  BRANCH_CONDITIONAL,
+  BRANCH_DIRECT,
+  BRANCH_CALL,
+  BRANCH_INDIRECT_CALL,
+  BRANCH_RETURN
+} BranchKind;
+
+typedef struct
+{
+  uint64_t branches;
+  uint64_t mispredictions;
+} BranchStats;
+
+typedef struct TBranchPredictor
+{
+  bool enabled;
+  char name[16];
+
+  // Direction predictor for conditional branches, update may be NULL
+  bool (*predict)(struct TBranchPredictor *predictor, uint32_t pc, uint32_t target);
+  void (*update)(struct TBranchPredictor *predictor, uint32_t pc, bool taken);
+
+  uint8_t *counters; // 2-bit saturating counters
+  uint32_t indexBits;
+  uint32_t history; // Global history for gshare
+
+  uint32_t *returnStack; // Circular return address stack
+  uint32_t returnCapacity;
+  uint32_t returnDepth;
+  uint32_t returnTop;
+
+  uint32_t *targetsByPC; // Last target of indirect calls, indexed by PC / 4
+
+  uint32_t penalty;
+  bool mispredicted; // Last control transfer was mispredicted
+  BranchStats stats[5];
+  BranchStats *statsByPC;
+} BranchPredictor;
+
+typedef struct
+{
+  uint64_t loads;
+  uint64_t stores;
+  uint64_t takenBranches;
+  uint64_t reads; // Of registers that change between reads: the counters themselves and terminal input
+  uint64_t base[PERF_COUNTER_COUNT]; // Raw value of each counter at its last reset
+  uint32_t latch;                    // High word latched by the last low word read
+} PerformanceCounters;
+
+typedef struct
+{
+  uint64_t loadUse;
+  uint64_t data;
+  uint64_t branch;
+  uint64_t interrupt;
+} PipelineStalls;
+
+typedef struct
+{
+  bool enabled;
+  bool forwarding;
+
+  uint32_t writes[2]; // Registers written by the instructions in EX and MEM
+  bool previousLoad;  // The instruction in EX is a load
+  uint64_t lastInterrupts;
+
+  uint64_t instructions;
+  uint64_t cycles;
+  uint64_t branchFlushes;
+  uint64_t interruptFlushes;
+  PipelineStalls total;
+  PipelineStalls *stallsByPC; // Stall cycles indexed by PC / 4
+} Pipeline;
+
+// Straight-line run of words [first, end) of the loaded program, entered
+// only at first
+typedef struct
+{
+  uint32_t first;
+  uint32_t end;
+  uint32_t successors[2];    // Blocks control may reach next, NO_ANALYZED_BLOCK when absent
+  uint32_t firstPredecessor; // Into Analysis.predecessors
+  uint32_t predecessorCount;
+  uint32_t dominator; // Immediate dominator, NO_ANALYZED_BLOCK for the entry points
+  uint32_t loop;      // Innermost loop holding the block, NO_ANALYZED_LOOP outside loops
+} AnalyzedBlock;
+
+// Natural loop: the header and the blocks that reach one of its back edges
+// without passing through it
+typedef struct
+{
+  uint32_t header; // Block, which dominates the others
+  uint32_t parent; // Innermost enclosing loop, NO_ANALYZED_LOOP at the top level
+  uint32_t depth;  // 1 at the top level
+  uint32_t blocks; // Blocks in the body, header and nested loops included
+  uint32_t backEdges;
+} AnalyzedLoop;
+
+// Control flow of the code reached from the entry point and the interrupt
+// vectors
+typedef struct
+{
+  uint32_t blockOf[ANALYZED_WORDS]; // Block holding each word, NO_ANALYZED_BLOCK for words not reached
+  AnalyzedBlock *blocks;            // In address order
+  uint32_t blockCount;
+  uint32_t *predecessors;
+  AnalyzedLoop *loops; // A loop comes before the loops nested inside it
+  uint32_t loopCount;
+} Analysis;
+
+typedef struct
+{
+  uint64_t instructions;
+  uint64_t cycles;
+} ProfilerCost;
+
+typedef struct
+{
+  uint64_t entries;    // Times the header ran coming from outside the loop
+  uint64_t iterations; // Times it ran again through a back edge
+  ProfilerCost self;   // Cost of the loop, nested loops excluded
+} ProfilerLoop;
+
+typedef struct
+{
+  uint32_t function;     // Entry address of the guest function
+  uint32_t callSite;     // Address of the first call that reached this context
+  uint32_t parent;       // Calling context (0 is the entry point)
+  uint32_t firstChild;   // 0 when there are no callees
+  uint32_t nextSibling;  // 0 when this is the last callee of the parent
+  uint64_t calls;        // Times this context was entered
+  ProfilerCost self;     // Cost of this context (exclusive)
+} ProfilerNode;
+
+typedef struct
+{
+  uint32_t node;
+  uint32_t returnAddress;
+} ProfilerFrame;
+
+typedef struct
+{
+  uint32_t address;
+  uint64_t calls;
+  ProfilerCost exclusive;
+  ProfilerCost inclusive;
+} ProfilerFunction;
+
+typedef struct
+{
+  bool enabled;
+  bool countCycles;    // Attribute modeled cycles as well as instructions
+  uint64_t lastCycles; // Cycle count at the end of the previous instruction
+
+  // Calling context tree, nodes[0] is the program entry point
+  ProfilerNode *nodes;
+  size_t size;
+  size_t capacity;
+
+  // Shadow call stack, stack[0] always refers to nodes[0]
+  ProfilerFrame *stack;
+  size_t depth;
+  size_t stackCapacity;
+
+  // Set by handlePrepareForISR, consumed at the end of the instruction cycle
+  bool interruptEntered;
+  uint32_t interruptReturn;
+
+  // Loops of the loaded program, NULL until one is analyzed
+  const Analysis *analysis;
+  ProfilerLoop *loops; // Indexed like analysis->loops
+  uint32_t block;      // Block of the previous instruction
+} Profiler;
+
+typedef enum
+{
+  IDLE_LOOPS_OFF,     // Run every iteration
+  IDLE_LOOPS_SKIP,    // Fast-forward idle loops when not tracing
+  IDLE_LOOPS_COLLAPSE // Also when tracing, with one summary line per skip
+} IdleLoopMode;
+
+// A label of an assembled program
+typedef struct
+{
+  uint32_t address;
+  char *name;
+} Symbol;
+
+// Labels sorted by address, in definition order among equal addresses
+typedef struct TPoximSymbols
+{
+  Symbol *symbols;
+  size_t count;
+} SymbolTable;
+
+// Operands an instruction takes in the .s dialect
+typedef enum
+{
+  OPERANDS_MOVE,              // mov, movs: z, value
+  OPERANDS_REGISTERS,         // add, sub, and, or, xor: z, x, y
+  OPERANDS_COMPARE,           // cmp: x, y
+  OPERANDS_NOT,               // not: z, x
+  OPERANDS_EXTENDED,          // mul, muls, div, divs: l, z, x, y
+  OPERANDS_SHIFT,             // sll, sla, srl, sra: z, x, y, amount
+  OPERANDS_IMMEDIATE,         // addi, subi, muli, divi, modi: z, x, value
+  OPERANDS_COMPARE_IMMEDIATE, // cmpi: x, value
+  OPERANDS_LOAD,              // z, [address]
+  OPERANDS_STORE,             // [address], z
+  OPERANDS_BRANCH,            // label or word offset
+  OPERANDS_CALL,              // label, word offset or [address]
+  OPERANDS_NONE,              // ret, reti
+  OPERANDS_STACK,             // push, pop: one to five registers
+  OPERANDS_BIT,               // cbr, sbr: register[bit]
+  OPERANDS_INTERRUPT          // int: value
+} OperandFormat;
+
+typedef struct
+{
+  const char *mnemonic;
+  uint8_t opcode;
+  uint8_t function; // Sub-opcode of the extended and shift group, access size of loads and stores, bit 0 of cbr/sbr
+  OperandFormat format;
+} AssemblerInstruction;
+
+// State of one pass over the source: the first only places labels, the
+// second encodes into memory
+typedef struct
+{
+  uint8_t *memory;  // MEMORY_SIZE bytes, NULL in the first pass
+  uint32_t address; // Location counter
+  Symbol *labels;   // In definition order
+  size_t labelCount;
+  size_t labelCapacity;
+  unsigned int line;
+  bool failed; // An error was reported; stops the pass
+} Assembler;
+
+typedef struct
+{
+  char *profileFile;   // Flat profile with inclusive/exclusive counts
+  char *foldedFile;    // Folded stacks for flamegraph tools
+  char *callgrindFile; // Callgrind-compatible profile
+  char *symbolFile;    // Labels of an assembled program, for trace tools
+
+  bool timing;          // Enable the cycle timing model
+  char *timingCosts;    // Comma separated class=cycles overrides
+  bool timersUseCycles; // Device timers count modeled cycles
+
+  bool pipeline;      // Enable the 5-stage pipeline model
+  char *pipelineFile; // Pipeline report, stderr when NULL
+  bool forwarding;    // EX/MEM and MEM/WB forwarding paths
+
+  char *predictor;           // <btfn|bimodal|gshare>[:<index bits>]
+  char *predictorFile;       // Predictor report, stderr when NULL
+  uint32_t predictorPenalty; // Cycles lost per misprediction
+
+  PoximLimits limits; // --max-instructions, --max-trace-bytes, --max-seconds
+
+  IdleLoopMode idleLoops;
+
+  bool simd; // Vector kernels when the CPU has them
+
+  char *diskFile;    // Block device image
+  bool diskReadOnly; // Map it read only and reject guest writes
+} Options;
+
+typedef struct
+{
+  PoximTraceCallback callback; // NULL when tracing is off
+  void *context;
+  uint64_t bytes; // Delivered since the last reset, newlines included
+} Trace;
+
+// A loop whose iterations change nothing but the device timers. Between two
+// arrivals at head from the same backward branch execution only moved
+// forward, since any other backward transfer restarts the watch; so when no
+// store, no performance counter read and no register change happened in
+// between, every further iteration repeats the same one until a device
+// event.
+typedef struct
+{
+  bool enabled;   // No timing, pipeline, predictor or profiler model to keep in step
+  uint32_t head;  // Loop entry, the branch target
+  uint32_t branch; // Address of the backward branch
+  bool compared;   // registers holds the previous arrival; only kept for short iterations
+  uint32_t registers[NUM_REGISTERS];
+
+  // Counters at the previous arrival
+  uint64_t instructions;
+  uint64_t loads;
+  uint64_t stores;
+  uint64_t takenBranches;
+  uint64_t counterReads;
+} IdleLoop;
+
+typedef struct
+{
+  PoximLimits limits;
+  uint64_t deadline;       // Monotonic nanoseconds, 0 until the first run
+  uint64_t nextClockCheck; // Instruction count at which the clock is read next
+  PoximStatus reason;      // Reported once the system stops
+} RunLimits;
+
+// Fields touched by every instruction come first, so that switching between
+// resident systems pulls in as few cache lines as possible
+typedef struct TSystem
+{
+  CPU cpu;
+  Control control;
+  InterruptController interrupts;
+  uint8_t *memory;
+  Trace trace;
+  RunLimits limits;
+  IdleLoop idle;
+  Watchdog watchdog;
+  FPU fpu;
+  DMA dma;
+  IntervalTimer timer;
+  Disk disk;
+  Timing timing;
+  PerformanceCounters counters;
+
+  Terminal terminal;
+  Pipeline pipeline;
+  BranchPredictor predictor;
+  Profiler profiler;
+
+  // Labels of the loaded program when it was assembled, NULL otherwise
+  SymbolTable *symbols;
+  bool ownsSymbols; // Assembled by poxim_load_asm rather than shared with an image
+
+  PoximTranslation translation; // Native code for the loaded program, NULL to interpret
+  Analysis *analysis;           // Control flow of the loaded program when the profiler needs it, NULL otherwise
+
+  Options options;
+  char **arguments; // Option strings referenced by options, NULL in a pool
+  int argumentCount;
+} System;
+
+// Systems allocated together: one array of systems and one block holding
+// the guest memory of all of them, a guard page apart
+typedef struct TPoximPool
+{
+  System *systems;
+  size_t count;
+  uint8_t *memory;
+  size_t stride; // Bytes from one guest memory to the next
+
+  Options options;
+  char **arguments;
+  int argumentCount;
+} SystemPool;
+
+// A parsed program shared by many systems
+typedef struct TPoximImage
+{
+  uint8_t *memory; // MEMORY_SIZE bytes
+  int file;        // memfd holding memory, mapped privately by each system; -1 to copy instead
+  SymbolTable *symbols; // NULL unless the program was assembled
+} ProgramImage;
+
+// Guests run together by the lockstep engine. Each register is a row of
+// lanes, so that one row loads into one vector.
+typedef struct
+{
+  uint32_t registers[NUM_REGISTERS][LOCKSTEP_LANES] __attribute__((aligned(32)));
+  uint32_t pending[LOCKSTEP_LANES] __attribute__((aligned(32))); // Instructions not yet added to the system
+  uint32_t budget[LOCKSTEP_LANES] __attribute__((aligned(32)));  // Pending count at which the lane is flushed
+  uint64_t remaining[LOCKSTEP_LANES];                            // Instructions left before the limit
+  System *systems[LOCKSTEP_LANES];
+  uint32_t active; // Lanes executed by the group
+  uint32_t split;  // Lanes handed back to the scalar interpreter
+} LockstepGroup;
+
+// How the translator emits one instruction
+typedef enum
+{
+  TRANSLATE_INLINE,     // C on the register locals
+  TRANSLATE_GUARDED,    // Inline behind a check that hands devices and stack overruns to the interpreter
+  TRANSLATE_INTERPRETED // Always through executeInstruction; ends its block
+} TranslationKind;
+
+// One word of the program being translated
+typedef struct
+{
+  uint32_t ir;
+  TranslationKind kind;
+  uint8_t reads; // SR flags the instruction reads
+  uint8_t kills; // SR flags it always overwrites
+  uint8_t live;  // Flags read after it before being overwritten
+  bool reached;  // Decoded as code from the entry point or an interrupt vector
+  bool leader;   // Starts a block
+  uint32_t block;
+} TranslatedWord;
+
+// Straight-line run of words [first, end), entered only at first
+typedef struct
+{
+  uint32_t first;
+  uint32_t end;
+} TranslatedBlock;
+
+typedef struct
+{
+  TranslatedWord words[TRANSLATED_WORDS];
+  TranslatedBlock *blocks;
+  uint32_t blockCount;
+  Analysis *analysis;
+} Translator;
+
+/******************************************************
+ * Instruction handlers
+ *******************************************************/
+
+// Handlers come in two flavours: those that only touch the register file
+// and those that need the whole system (memory, interrupts, models)
+typedef void (*CPUInstructionHandler)(CPU *cpu, Trace *output);
+typedef void (*SystemInstructionHandler)(System *system, Trace *output);
+
+typedef struct
+{
+  const char *name;
+  uint32_t encoding; // Opcode and sub-opcode bits selecting the handler
+  uint32_t mask;     // Bits of IR compared against the encoding
+  bool memory;       // Operand x addresses memory through (rx + i)
+  CPUInstructionHandler cpuHandler;
+  SystemInstructionHandler systemHandler;
+} InstructionHandler;
+
+extern const InstructionHandler instructionHandlers[];
+extern const size_t instructionHandlerCount;
+
+/******************************************************
+ * Functin Signature
+ *******************************************************/
+void initOptions(Options *options);
+bool parseUnsigned(const char *text, uint64_t maximum, uint64_t *value);
+bool parseSeconds(const char *text, double *value);
+bool parseOption(char *argument, Options *options);
+bool parseArguments(int optionCount, const char *const options[], char ***arguments, Options *parsed);
+void freeArguments(char **arguments, int argumentCount);
+bool parseHex(const char *text, size_t length, uint8_t *memory);
+uint8_t *allocateMemory(size_t size);
+uint8_t *allocateGuardedMemory(size_t count, size_t *stride);
+void releaseMemory(uint8_t *memory, size_t size);
+void clearMemory(uint8_t *memory);
+ProgramImage *createImage(uint8_t *memory);
+void releaseSymbols(System *system);
+void initSystem(System *system, uint8_t *memory);
+void resetSystem(System *system);
+void freeSystem(System *system);
+void executeInstruction(System *system);
+uint64_t monotonicNanoseconds(void);
+void startLimits(System *system);
+void checkLimits(System *system);
+void raiseMemoryFault(System *system, uint32_t address);
+uint64_t limitSlice(System *system, uint64_t slice);
+void resetIdleLoop(System *system);
+uint64_t watchIdleLoop(System *system, uint64_t bound);
+uint64_t nextDeviceEvent(System *system);
+uint64_t skipIdleLoop(System *system, uint64_t iterations);
+void advanceDeviceTimers(System *system, uint64_t instructions);
+
+const InstructionHandler *findInstructionHandler(const char *name);
+const InstructionHandler *decodeInstructionHandler(uint32_t ir);
+void executeInstructionHandler(System *system, const InstructionHandler *handler, Trace *output);
+
+void initTerminalBuffer(TerminalBuffer *buffer, size_t initialCapacity);
+void addToBuffer(TerminalBuffer *buffer, char character);
+void freeBuffer(TerminalBuffer *buffer);
+void writeTerminal(System *system, char character);
+void flushTerminal(System *system);
+bool terminalInputReady(System *system);
+uint8_t readTerminalInput(System *system);
+uint8_t readTerminalStatus(System *system);
+void writeTerminalStatus(System *system, uint8_t value);
+void updateTerminalInterrupt(System *system);
+void enterTerminalInterrupt(System *system, Trace *output);
+
+void resetInterrupts(InterruptController *interrupts);
+void raiseInterrupt(System *system, InterruptSource source);
+void clearInterrupt(System *system, InterruptSource source);
+uint32_t takeableInterrupts(System *system);
+void dispatchInterrupt(System *system, Trace *output);
+uint32_t readInterruptRegister(System *system, uint32_t address);
+void writeInterruptRegister(System *system, uint32_t address, uint32_t value);
+
+uint64_t deviceClock(System *system);
+uint32_t readIntervalTimerRegister(System *system, uint32_t address);
+void writeIntervalTimerRegister(System *system, uint32_t address, uint32_t value);
+void scheduleIntervalTimer(System *system);
+void updateIntervalTimer(System *system);
+void enterTimerInterrupt(System *system, Trace *output);
+
+bool attachDisk(Disk *disk, const char *path, bool writable);
+void detachDisk(Disk *disk);
+uint32_t readDiskRegister(System *system, uint32_t address);
+void writeDiskRegister(System *system, uint32_t address, uint32_t value);
+void startDiskTransfer(System *system);
+void enterDiskInterrupt(System *system, Trace *output);
+
+void updateWatchdog(System *system, uint32_t ticks);
+void enterWatchdogInterrupt(System *system, Trace *output);
+
+void initTiming(Timing *timing, Options *options);
+bool parseTimingCosts(char *specification, TimingCosts *costs);
+void accountCycles(System *system, uint8_t opcode);
+uint32_t elapsedTicks(Timing *timing);
+void printTimingReport(Timing *timing, FILE *output);
+
+void countEvents(System *system, uint8_t opcode);
+uint64_t readPerformanceCounter(System *system, uint8_t index);
+bool isPerformanceCounterAddress(uint32_t memoryAddress);
+uint32_t readPerformanceCounterRegister(System *system, uint32_t memoryAddress);
+void writePerformanceCounterRegister(System *system, uint32_t memoryAddress, uint32_t value);
+
+void initPipeline(Pipeline *pipeline, Options *options);
+void resetPipeline(Pipeline *pipeline);
+void freePipeline(Pipeline *pipeline);
+uint32_t registerBit(uint8_t index);
+void decodeRegisterUsage(uint32_t ir, uint32_t *reads, uint32_t *writes, bool *load);
+void simulatePipeline(System *system, uint8_t opcode);
+void writePipelineReport(Pipeline *pipeline, FILE *output);
+
+bool parsePredictorSpecification(const char *specification, char *model, uint32_t *bits);
+void initBranchPredictor(BranchPredictor *predictor, Options *options);
+void resetBranchPredictor(BranchPredictor *predictor);
+void freeBranchPredictor(BranchPredictor *predictor);
+bool predictBTFN(BranchPredictor *predictor, uint32_t pc, uint32_t target);
+bool predictBimodal(BranchPredictor *predictor, uint32_t pc, uint32_t target);
+void updateBimodal(BranchPredictor *predictor, uint32_t pc, bool taken);
+bool predictGshare(BranchPredictor *predictor, uint32_t pc, uint32_t target);
+void updateGshare(BranchPredictor *predictor, uint32_t pc, bool taken);
+void predictBranch(System *system, BranchKind kind, uint32_t pc, uint32_t target, bool taken);
+void writeBranchPredictorReport(BranchPredictor *predictor, FILE *output);
+
+void initProfiler(Profiler *profiler, bool enabled, bool countCycles);
+void resetProfiler(Profiler *profiler);
+void freeProfiler(Profiler *profiler);
+uint32_t findProfilerNode(Profiler *profiler, uint32_t parent, uint32_t function, uint32_t callSite);
+void profilerEnter(Profiler *profiler, uint32_t function, uint32_t callSite, uint32_t returnAddress);
+void profilerReturn(Profiler *profiler, uint32_t returnAddress);
+void profileInstruction(System *system, uint8_t opcode);
+void attachProfilerLoops(Profiler *profiler, const Analysis *analysis);
+void profileLoops(Profiler *profiler, uint32_t address, uint64_t cycles);
+ProfilerCost *computeProfilerTotals(Profiler *profiler);
+int compareProfilerFunctions(const void *a, const void *b);
+const char *formatFunction(const SymbolTable *symbols, uint32_t address, char *buffer);
+void writeProfile(Profiler *profiler, const SymbolTable *symbols, FILE *output);
+void writeLoopProfile(Profiler *profiler, const SymbolTable *symbols, const ProfilerCost *total, FILE *output);
+void writeProfiledLoop(Profiler *profiler, const SymbolTable *symbols, uint32_t loop, const ProfilerCost *inclusive,
+                       const ProfilerCost *total, int width, FILE *output);
+void writeFoldedStacks(Profiler *profiler, const SymbolTable *symbols, FILE *output);
+void writeCallgrind(Profiler *profiler, const SymbolTable *symbols, FILE *output);
+void writeProfilerReports(Profiler *profiler, Options *options, const SymbolTable *symbols);
+void writeSymbolMap(const SymbolTable *symbols, FILE *output);
+
+bool assembleProgram(const char *text, size_t length, uint8_t *memory, uint32_t *size, SymbolTable **symbols);
+void runAssemblerPass(Assembler *assembler, const char *text, size_t length);
+void assembleStatement(Assembler *assembler, char *statement);
+void assembleDirective(Assembler *assembler, const char *directive, char *arguments);
+void assembleInstruction(Assembler *assembler, const char *mnemonic, char *arguments);
+int splitOperands(char *text, char **operands);
+char *trimSpaces(char *text);
+void reportAssemblerError(Assembler *assembler, const char *message, const char *token);
+void defineLabel(Assembler *assembler, const char *name);
+Symbol *findLabel(Assembler *assembler, const char *name);
+bool parseRegister(const char *token, uint8_t *number);
+bool parseValue(Assembler *assembler, const char *token, uint32_t *value, bool *label);
+bool parseMemoryOperand(Assembler *assembler, char *token, uint32_t scale, uint8_t *base, uint32_t *offset);
+bool parseBitOperand(const char *token, uint8_t *number, uint8_t *bit);
+bool parseString(Assembler *assembler, const char *token);
+const AssemblerInstruction *findAssemblerInstruction(const char *mnemonic);
+void emitByte(Assembler *assembler, uint8_t value);
+void emitWord(Assembler *assembler, uint32_t word);
+SymbolTable *createSymbolTable(Assembler *assembler);
+const char *findSymbol(const SymbolTable *symbols, uint32_t address);
+void freeSymbolTable(SymbolTable *symbols);
+
+void executeFPU(System *system, uint32_t ticks);
+void addFPU(FPU *fpu);
+void subtractFPU(FPU *fpu);
+void multiplyFPU(FPU *fpu);
+void divideFPU(FPU *fpu);
+void assignXFromZFPU(FPU *fpu);
+void assignYFromZFPU(FPU *fpu);
+void ceilingZFPU(FPU *fpu);
+void floorZFPU(FPU *fpu);
+void roundZFPU(FPU *fpu);
+bool getFPUControlSTField(FPU *fpu);
+void setFPUControlSTField(FPU *fpu, bool enable);
+void resetFPUControlOPCodeField(FPU *fpu);
+void handleFPUErrors(System *system, Trace *output);
+void completeFPUOperation(FPU *fpu);
+void rejectFPUOperation(FPU *fpu);
+void executeVectorFPU(System *system, uint8_t opcode);
+bool overlapsPartially(uint32_t first, uint32_t second, uint64_t bytes);
+void runVectorFPUKernel(uint8_t *memory, const FPUVector *vector, uint8_t opcode, bool simd);
+#ifdef AVX2_KERNELS
+uint32_t runVectorFPUKernelAVX2(uint8_t *memory, const FPUVector *vector, uint8_t opcode);
+bool hasAVX2(void);
+#endif
+void setFPUTimerVariableCycle(System *system);
+bool decrementFPUTimer(FPUTimer *timer, uint32_t ticks);
+uint32_t convertToIEEE754(float *x);
+uint32_t calculateExponentDifference(uint32_t x, uint32_t y);
+
+uint32_t readDMARegister(System *system, uint32_t address);
+void writeDMARegister(System *system, uint32_t address, uint32_t value);
+void startDMATransfer(System *system);
+void handleDMAInterrupt(System *system, Trace *output);
+
+uint32_t loadLane32(const uint8_t *memory, uint32_t address);
+void storeLane32(uint8_t *memory, uint32_t address, uint32_t value);
+bool isLockstepEligible(System *system);
+bool isLockstepQuiet(System *system);
+void initLockstepGroup(LockstepGroup *group, System *const systems[], uint32_t count, uint64_t limit);
+void flushLockstepLane(LockstepGroup *group, uint32_t lane);
+void retireLockstepLane(LockstepGroup *group, uint32_t lane, bool split);
+void stepLockstepScalar(LockstepGroup *group, uint32_t lane);
+void stepLockstep(LockstepGroup *group);
+#ifdef AVX2_KERNELS
+void stepLockstepAVX2(LockstepGroup *group);
+#endif
+
+Analysis *analyzeProgram(System *system);
+void freeAnalysis(Analysis *analysis);
+void analyzeLoadedProgram(System *system);
+uint32_t branchTarget(uint32_t address, uint32_t ir);
+uint32_t findSuccessors(uint32_t address, uint32_t ir, uint32_t *successors);
+bool endsAnalyzedBlock(uint32_t ir);
+void findReachableCode(Analysis *analysis, const uint32_t *code);
+void formAnalyzedBlocks(Analysis *analysis, const uint32_t *code);
+uint32_t intersectDominators(const uint32_t *dominators, const uint32_t *order, uint32_t a, uint32_t b);
+void computeDominators(Analysis *analysis);
+bool dominatesBlock(const Analysis *analysis, uint32_t dominator, uint32_t block);
+int compareAnalyzedLoops(const void *a, const void *b);
+uint32_t collectLoopBody(Analysis *analysis, uint32_t header, uint32_t loop, uint32_t *marks, uint32_t stamp, uint32_t *pending);
+void findNaturalLoops(Analysis *analysis);
+bool isInAnalyzedLoop(const Analysis *analysis, uint32_t block, uint32_t loop);
+
+bool isTranslationEligible(System *system);
+uint64_t translatedFuel(System *system, uint64_t remaining);
+void classifyTranslatedWord(TranslatedWord *word);
+bool endsTranslatedBlock(const TranslatedWord *word);
+void findTranslatedCode(Translator *translator, const Analysis *analysis);
+uint32_t findTranslatedBlock(Translator *translator, uint32_t address);
+void formTranslatedBlocks(Translator *translator);
+void computeTranslatedLiveness(Translator *translator);
+const char *translatedRegister(uint8_t index);
+void writeTranslation(Translator *translator, const uint8_t *memory, FILE *output);
+void emitTranslatedBlock(Translator *translator, uint32_t block, FILE *output);
+void emitTranslatedInstruction(Translator *translator, uint32_t index, uint32_t refund, FILE *output);
+void emitTranslatedFlags(uint8_t flags, const char *zero, const char *sign, const char *overflow, const char *carry, FILE *output);
+void emitTranslatedFallback(const char *condition, uint32_t address, uint32_t refund, FILE *output);
+void emitTranslatedJump(Translator *translator, uint32_t address, const char *indent, FILE *output);
+
+void mov(CPU *cpu, Trace *output);
+void movs(CPU *cpu, Trace *output);
+void add(CPU *cpu, Trace *output);
+void sub(CPU *cpu, Trace *output);
+void mul(CPU *cpu, Trace *output);
+void sll(CPU *cpu, Trace *output);
+void muls(CPU *cpu, Trace *output);
+void sla(CPU *cpu, Trace *output);
+void divv(System *system, Trace *output);
+void srl(CPU *cpu, Trace *output);
+void divs(System *system, Trace *output);
+void sra(CPU *cpu, Trace *output);
+void cmp(CPU *cpu, Trace *output);
+void and (CPU * cpu, Trace *output);
+void or (CPU * cpu, Trace *output);
+void not(CPU * cpu, Trace *output);
+void xor (CPU * cpu, Trace *output);
+void addi(CPU *cpu, Trace *output);
+void subi(CPU *cpu, Trace *output);
+void muli(CPU *cpu, Trace *output);
+void divi(System *system, Trace *output);
+void modi(System *system, Trace *output);
+void cmpi(CPU *cpu, Trace *output);
+
+void bae(System *system, Trace *output);
+void bat(System *system, Trace *output);
+void bbe(System *system, Trace *output);
+void bbt(System *system, Trace *output);
+void beq(System *system, Trace *output);
+void bge(System *system, Trace *output);
+void bgt(System *system, Trace *output);
+void biv(System *system, Trace *output);
+void ble(System *system, Trace *output);
+void blt(System *system, Trace *output);
+void bne(System *system, Trace *output);
+void bni(System *system, Trace *output);
+void bnz(System *system, Trace *output);
+void bzd(System *system, Trace *output);
+void bun(System *system, Trace *output);
+
+void l8(System *system, Trace *output);
+void l16(System *system, Trace *output);
+void l32(System *system, Trace *output);
+void s8(System *system, Trace *output);
+void s16(System *system, Trace *output);
+void s32(System *system, Trace *output);
+
+void callf(System *system, Trace *output);
+void calls(System *system, Trace *output);
+void ret(System *system, Trace *output);
+void push(System *system, Trace *output);
+void pop(System *system, Trace *output);
+
+void reti(System *system, Trace *output);
+void cbr(CPU *cpu, Trace *output);
+void sbr(CPU *cpu, Trace *output);
+void interrupt(System *system, Trace *output);
+
+void unknownInstruction(System *system, Trace *output);
+
+void handleDivideByZero(System *system, Trace *output);
+void handleInvalidInstruction(System *system, Trace *output);
+void handleInterrupt(System *system, Trace *output);
+bool handlePrepareForISR(System *system);
+
+int isZNSet(CPU *cpu);
+int isZDSet(CPU *cpu);
+int isSNSet(CPU *cpu);
+int isOVSet(CPU *cpu);
+int isIVSet(CPU *cpu);
+int isIESet(CPU *cpu);
+int isCYSet(CPU *cpu);
+
+int32_t extendSign32(uint32_t value, uint8_t significantBit);
+int64_t extendSign64(uint32_t value, uint8_t significantBit);
+
+const char *formatRegisterName(uint8_t registerNumber, bool lower);
+
+void emitTraceLine(Trace *output, const char *line);
+void printInstruction(uint32_t pc, Trace *output, char *instruction, char *additionalInfo);
+void printInterruptMessage(uint32_t code, Trace *output);
+
+uint32_t readMemory32(System *system, uint32_t memoryAddress);
+
+#endif
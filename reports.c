@@ -0,0 +1,458 @@
+#include "poxim_internal.h"
+
+/******************************************************
+ * Reports
+ *******************************************************/
+
+void poxim_write_reports(PoximSystem *system)
+{
+  Options *options = &system->options;
+
+  if (system->timing.enabled)
+    printTimingReport(&system->timing, stderr);
+
+  if (system->pipeline.enabled)
+  {
+    FILE *report = (options->pipelineFile != NULL) ? fopen(options->pipelineFile, "w") : stderr;
+
+    if (report != NULL)
+    {
+      writePipelineReport(&system->pipeline, report);
+
+      if (report != stderr)
+        fclose(report);
+    }
+    else
+      fprintf(stderr, "Failed to open %s.\n", options->pipelineFile);
+  }
+
+  if (system->predictor.enabled)
+  {
+    FILE *report = (options->predictorFile != NULL) ? fopen(options->predictorFile, "w") : stderr;
+
+    if (report != NULL)
+    {
+      writeBranchPredictorReport(&system->predictor, report);
+
+      if (report != stderr)
+        fclose(report);
+    }
+    else
+      fprintf(stderr, "Failed to open %s.\n", options->predictorFile);
+  }
+
+  writeProfilerReports(&system->profiler, options, system->symbols);
+
+  if (options->symbolFile != NULL)
+  {
+    FILE *map = fopen(options->symbolFile, "w");
+
+    if (map != NULL)
+    {
+      writeSymbolMap(system->symbols, map);
+      fclose(map);
+    }
+    else
+      fprintf(stderr, "Failed to open %s.\n", options->symbolFile);
+  }
+}
+
+void printTimingReport(Timing *timing, FILE *output)
+{
+  fprintf(output, "[TIMING]\n");
+  fprintf(output, "Instructions: %" PRIu64 "\n", timing->instructions);
+  fprintf(output, "Cycles: %" PRIu64 "\n", timing->cycles);
+  fprintf(output, "CPI: %.3f\n", timing->instructions > 0 ? (double)timing->cycles / timing->instructions : 0.0);
+}
+
+void writePipelineReport(Pipeline *pipeline, FILE *output)
+{
+  const PipelineStalls *total = &pipeline->total;
+
+  fprintf(output, "[PIPELINE]\n");
+  fprintf(output, "Forwarding: %s\n", pipeline->forwarding ? "on" : "off");
+  fprintf(output, "Instructions: %" PRIu64 "\n", pipeline->instructions);
+  fprintf(output, "Cycles: %" PRIu64 "\n", pipeline->cycles);
+  fprintf(output, "CPI: %.3f\n", pipeline->instructions > 0 ? (double)pipeline->cycles / pipeline->instructions : 0.0);
+  fprintf(output, "Load-use stall cycles: %" PRIu64 "\n", total->loadUse);
+  fprintf(output, "Data hazard stall cycles: %" PRIu64 "\n", total->data);
+  fprintf(output, "Branch flush cycles: %" PRIu64 " (%" PRIu64 " flushes)\n", total->branch, pipeline->branchFlushes);
+  fprintf(output, "Interrupt flush cycles: %" PRIu64 " (%" PRIu64 " flushes)\n", total->interrupt, pipeline->interruptFlushes);
+
+  fprintf(output, "%-12s %10s %10s %10s %10s\n", "PC", "Load-use", "Data", "Branch", "Interrupt");
+  for (uint32_t i = 0; i < MEMORY_SIZE / 4; i++)
+  {
+    const PipelineStalls *stalls = &pipeline->stallsByPC[i];
+
+    if (stalls->loadUse + stalls->data + stalls->branch + stalls->interrupt > 0)
+      fprintf(output, "0x%08X   %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %10" PRIu64 "\n", i * 4, stalls->loadUse, stalls->data, stalls->branch, stalls->interrupt);
+  }
+}
+
+void writeBranchPredictorReport(BranchPredictor *predictor, FILE *output)
+{
+  const char *kinds[] = {"Conditional", "Direct", "Call", "Indirect call", "Return"};
+  uint64_t branches = 0;
+  uint64_t mispredictions = 0;
+
+  fprintf(output, "[BRANCH PREDICTOR]\n");
+  fprintf(output, "Model: %s (%u index bits, %u-entry return stack)\n", predictor->name, predictor->indexBits, predictor->returnCapacity);
+
+  for (uint8_t kind = 0; kind < 5; kind++)
+  {
+    const BranchStats *stats = &predictor->stats[kind];
+
+    fprintf(output, "%s: %" PRIu64 " branches, %" PRIu64 " mispredicted (%.2f%%)\n", kinds[kind], stats->branches, stats->mispredictions,
+            stats->branches > 0 ? 100.0 * stats->mispredictions / stats->branches : 0.0);
+
+    branches += stats->branches;
+    mispredictions += stats->mispredictions;
+  }
+
+  fprintf(output, "Overall: %" PRIu64 " branches, %" PRIu64 " mispredicted (%.2f%%)\n", branches, mispredictions,
+          branches > 0 ? 100.0 * mispredictions / branches : 0.0);
+  fprintf(output, "Mispredict penalty: %" PRIu64 " cycles (%u per misprediction)\n", mispredictions * predictor->penalty, predictor->penalty);
+
+  fprintf(output, "%-12s %12s %12s %8s\n", "PC", "Branches", "Mispredicted", "Rate");
+  for (uint32_t i = 0; i < MEMORY_SIZE / 4; i++)
+  {
+    const BranchStats *stats = &predictor->statsByPC[i];
+
+    if (stats->branches > 0)
+      fprintf(output, "0x%08X   %12" PRIu64 " %12" PRIu64 " %7.2f%%\n", i * 4, stats->branches, stats->mispredictions,
+              100.0 * stats->mispredictions / stats->branches);
+  }
+}
+
+ProfilerCost *computeProfilerTotals(Profiler *profiler)
+{
+  ProfilerCost *totals = (ProfilerCost *)calloc(profiler->size, sizeof(ProfilerCost));
+  if (totals == NULL)
+  {
+    fprintf(stderr, "Failed to allocate memory for profiler.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  // Callees are always created after their callers
+  for (size_t i = profiler->size; i-- > 0;)
+  {
+    totals[i].instructions += profiler->nodes[i].self.instructions;
+    totals[i].cycles += profiler->nodes[i].self.cycles;
+
+    if (i > 0)
+    {
+      totals[profiler->nodes[i].parent].instructions += totals[i].instructions;
+      totals[profiler->nodes[i].parent].cycles += totals[i].cycles;
+    }
+  }
+
+  return totals;
+}
+
+int compareProfilerFunctions(const void *a, const void *b)
+{
+  const ProfilerFunction *x = (const ProfilerFunction *)a;
+  const ProfilerFunction *y = (const ProfilerFunction *)b;
+
+  if (x->exclusive.cycles != y->exclusive.cycles)
+    return x->exclusive.cycles < y->exclusive.cycles ? 1 : -1;
+
+  if (x->exclusive.instructions != y->exclusive.instructions)
+    return x->exclusive.instructions < y->exclusive.instructions ? 1 : -1;
+
+  return x->address < y->address ? -1 : (x->address > y->address);
+}
+
+// The label at address when the program was assembled, its address otherwise
+const char *formatFunction(const SymbolTable *symbols, uint32_t address, char *buffer)
+{
+  const char *name = findSymbol(symbols, address);
+
+  if (name != NULL)
+    return name;
+
+  sprintf(buffer, "0x%08X", address);
+
+  return buffer;
+}
+
+void writeProfile(Profiler *profiler, const SymbolTable *symbols, FILE *output)
+{
+  char name[16];
+  ProfilerCost *totals = computeProfilerTotals(profiler);
+  ProfilerFunction *functions = (ProfilerFunction *)calloc(profiler->size, sizeof(ProfilerFunction));
+  size_t count = 0;
+
+  if (functions == NULL)
+  {
+    fprintf(stderr, "Failed to allocate memory for profiler.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  for (size_t i = 0; i < profiler->size; i++)
+  {
+    const ProfilerNode *node = &profiler->nodes[i];
+
+    size_t f = 0;
+    while (f < count && functions[f].address != node->function)
+      f++;
+
+    if (f == count)
+      functions[count++].address = node->function;
+
+    functions[f].calls += node->calls;
+    functions[f].exclusive.instructions += node->self.instructions;
+    functions[f].exclusive.cycles += node->self.cycles;
+
+    // Recursive contexts are already included by their outermost activation
+    bool recursive = false;
+    for (uint32_t parent = i; parent != 0 && !recursive;)
+    {
+      parent = profiler->nodes[parent].parent;
+      recursive = profiler->nodes[parent].function == node->function;
+    }
+
+    if (!recursive)
+    {
+      functions[f].inclusive.instructions += totals[i].instructions;
+      functions[f].inclusive.cycles += totals[i].cycles;
+    }
+  }
+
+  qsort(functions, count, sizeof(ProfilerFunction), compareProfilerFunctions);
+
+  // Wide enough for the longest label
+  int width = 12;
+  for (size_t f = 0; f < count; f++)
+  {
+    const int length = strlen(formatFunction(symbols, functions[f].address, name));
+    width = (length > width) ? length : width;
+  }
+
+  const double totalInstructions = totals[0].instructions > 0 ? (double)totals[0].instructions : 1.0;
+  const double totalCycles = totals[0].cycles > 0 ? (double)totals[0].cycles : 1.0;
+
+  fprintf(output, "[PROFILE]\n");
+  fprintf(output, "%-*s %12s %14s %8s %14s %8s", width, "Function", "Calls", "Exclusive", "Excl%", "Inclusive", "Incl%");
+  if (profiler->countCycles)
+    fprintf(output, " %14s %8s %14s %8s", "ExclCycles", "Excl%", "InclCycles", "Incl%");
+  fprintf(output, "\n");
+
+  for (size_t f = 0; f < count; f++)
+  {
+    fprintf(output, "%-*s %12" PRIu64 " %14" PRIu64 " %7.2f%% %14" PRIu64 " %7.2f%%",
+            width, formatFunction(symbols, functions[f].address, name), functions[f].calls,
+            functions[f].exclusive.instructions, 100.0 * functions[f].exclusive.instructions / totalInstructions,
+            functions[f].inclusive.instructions, 100.0 * functions[f].inclusive.instructions / totalInstructions);
+
+    if (profiler->countCycles)
+      fprintf(output, " %14" PRIu64 " %7.2f%% %14" PRIu64 " %7.2f%%",
+              functions[f].exclusive.cycles, 100.0 * functions[f].exclusive.cycles / totalCycles,
+              functions[f].inclusive.cycles, 100.0 * functions[f].inclusive.cycles / totalCycles);
+
+    fprintf(output, "\n");
+  }
+
+  fprintf(output, "Total instructions: %" PRIu64 "\n", totals[0].instructions);
+  if (profiler->countCycles)
+    fprintf(output, "Total cycles: %" PRIu64 "\n", totals[0].cycles);
+
+  if (profiler->analysis != NULL && profiler->analysis->loopCount > 0)
+    writeLoopProfile(profiler, symbols, &totals[0], output);
+
+  free(functions);
+  free(totals);
+}
+
+// Natural loops found when the program was loaded, each under the loop
+// holding it, named after the label or address of their header. A loop is
+// charged for its own instructions only, not for the functions it calls.
+void writeLoopProfile(Profiler *profiler, const SymbolTable *symbols, const ProfilerCost *total, FILE *output)
+{
+  const Analysis *analysis = profiler->analysis;
+  char name[16];
+  ProfilerCost *inclusive = (ProfilerCost *)calloc(analysis->loopCount, sizeof(ProfilerCost));
+
+  if (inclusive == NULL)
+  {
+    fprintf(stderr, "Failed to allocate memory for profiler.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  // Nested loops come after the loops holding them
+  int width = 12;
+  for (uint32_t l = analysis->loopCount; l-- > 0;)
+  {
+    const AnalyzedLoop *loop = &analysis->loops[l];
+    const int length = 2 * (loop->depth - 1) + strlen(formatFunction(symbols, analysis->blocks[loop->header].first * 4, name));
+
+    inclusive[l].instructions += profiler->loops[l].self.instructions;
+    inclusive[l].cycles += profiler->loops[l].self.cycles;
+
+    if (loop->parent != NO_ANALYZED_LOOP)
+    {
+      inclusive[loop->parent].instructions += inclusive[l].instructions;
+      inclusive[loop->parent].cycles += inclusive[l].cycles;
+    }
+
+    width = (length > width) ? length : width;
+  }
+
+  fprintf(output, "\n[LOOPS]\n");
+  fprintf(output, "%-*s %6s %12s %12s %14s %8s %14s %8s", width, "Loop", "Blocks", "Entries", "Iterations", "Exclusive", "Excl%",
+          "Inclusive", "Incl%");
+  if (profiler->countCycles)
+    fprintf(output, " %14s %8s %14s %8s", "ExclCycles", "Excl%", "InclCycles", "Incl%");
+  fprintf(output, "\n");
+
+  for (uint32_t l = 0; l < analysis->loopCount; l++)
+  {
+    if (analysis->loops[l].parent == NO_ANALYZED_LOOP)
+      writeProfiledLoop(profiler, symbols, l, inclusive, total, width, output);
+  }
+
+  free(inclusive);
+}
+
+// One line for the loop, then its nested loops
+void writeProfiledLoop(Profiler *profiler, const SymbolTable *symbols, uint32_t loop, const ProfilerCost *inclusive,
+                       const ProfilerCost *total, int width, FILE *output)
+{
+  const Analysis *analysis = profiler->analysis;
+  const AnalyzedLoop *current = &analysis->loops[loop];
+  const ProfilerLoop *counts = &profiler->loops[loop];
+  const int indent = 2 * (current->depth - 1);
+  const double totalInstructions = total->instructions > 0 ? (double)total->instructions : 1.0;
+  const double totalCycles = total->cycles > 0 ? (double)total->cycles : 1.0;
+  char name[16];
+
+  fprintf(output, "%*s%-*s %6u %12" PRIu64 " %12" PRIu64 " %14" PRIu64 " %7.2f%% %14" PRIu64 " %7.2f%%", indent, "", width - indent,
+          formatFunction(symbols, analysis->blocks[current->header].first * 4, name), current->blocks, counts->entries,
+          counts->iterations, counts->self.instructions, 100.0 * counts->self.instructions / totalInstructions,
+          inclusive[loop].instructions, 100.0 * inclusive[loop].instructions / totalInstructions);
+
+  if (profiler->countCycles)
+    fprintf(output, " %14" PRIu64 " %7.2f%% %14" PRIu64 " %7.2f%%", counts->self.cycles, 100.0 * counts->self.cycles / totalCycles,
+            inclusive[loop].cycles, 100.0 * inclusive[loop].cycles / totalCycles);
+
+  fprintf(output, "\n");
+
+  for (uint32_t l = loop + 1; l < analysis->loopCount; l++)
+  {
+    if (analysis->loops[l].parent == loop)
+      writeProfiledLoop(profiler, symbols, l, inclusive, total, width, output);
+  }
+}
+
+void writeFoldedStacks(Profiler *profiler, const SymbolTable *symbols, FILE *output)
+{
+  char name[16];
+
+  uint32_t *path = (uint32_t *)calloc(profiler->size, sizeof(uint32_t));
+  if (path == NULL)
+  {
+    fprintf(stderr, "Failed to allocate memory for profiler.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  for (size_t i = 0; i < profiler->size; i++)
+  {
+    if (profiler->nodes[i].self.instructions == 0)
+      continue;
+
+    size_t length = 0;
+    for (uint32_t node = i; node != 0; node = profiler->nodes[node].parent)
+      path[length++] = profiler->nodes[node].function;
+    path[length++] = profiler->nodes[0].function;
+
+    while (length-- > 0)
+      fprintf(output, "%s%s", formatFunction(symbols, path[length], name), length > 0 ? ";" : "");
+
+    // Flamegraphs show modeled time when the timing model is enabled
+    fprintf(output, " %" PRIu64 "\n", profiler->countCycles ? profiler->nodes[i].self.cycles : profiler->nodes[i].self.instructions);
+  }
+
+  free(path);
+}
+
+void writeCallgrind(Profiler *profiler, const SymbolTable *symbols, FILE *output)
+{
+  char name[16];
+  ProfilerCost *totals = computeProfilerTotals(profiler);
+
+  fprintf(output, "# callgrind format\n");
+  fprintf(output, "version: 1\n");
+  fprintf(output, "creator: poxim\n");
+  fprintf(output, "positions: instr\n");
+
+  if (profiler->countCycles)
+  {
+    fprintf(output, "events: Ir Cycles\n");
+    fprintf(output, "summary: %" PRIu64 " %" PRIu64 "\n", totals[0].instructions, totals[0].cycles);
+  }
+  else
+  {
+    fprintf(output, "events: Ir\n");
+    fprintf(output, "summary: %" PRIu64 "\n", totals[0].instructions);
+  }
+
+  // One block per calling context; callgrind merges blocks of the same function
+  for (size_t i = 0; i < profiler->size; i++)
+  {
+    const ProfilerNode *node = &profiler->nodes[i];
+
+    fprintf(output, "\nfn=%s\n", formatFunction(symbols, node->function, name));
+    fprintf(output, "0x%08X %" PRIu64, node->function, node->self.instructions);
+    if (profiler->countCycles)
+      fprintf(output, " %" PRIu64, node->self.cycles);
+    fprintf(output, "\n");
+
+    for (uint32_t child = node->firstChild; child != 0; child = profiler->nodes[child].nextSibling)
+    {
+      fprintf(output, "cfn=%s\n", formatFunction(symbols, profiler->nodes[child].function, name));
+      fprintf(output, "calls=%" PRIu64 " 0x%08X\n", profiler->nodes[child].calls, profiler->nodes[child].function);
+      fprintf(output, "0x%08X %" PRIu64, profiler->nodes[child].callSite, totals[child].instructions);
+      if (profiler->countCycles)
+        fprintf(output, " %" PRIu64, totals[child].cycles);
+      fprintf(output, "\n");
+    }
+  }
+
+  free(totals);
+}
+
+void writeProfilerReports(Profiler *profiler, Options *options, const SymbolTable *symbols)
+{
+  if (!profiler->enabled)
+    return;
+
+  const char *files[] = {options->profileFile, options->foldedFile, options->callgrindFile};
+  void (*writers[])(Profiler *, const SymbolTable *, FILE *) = {writeProfile, writeFoldedStacks, writeCallgrind};
+
+  for (uint8_t i = 0; i < 3; i++)
+  {
+    if (files[i] == NULL)
+      continue;
+
+    FILE *report = fopen(files[i], "w");
+    if (report == NULL)
+    {
+      fprintf(stderr, "Failed to open %s.\n", files[i]);
+      continue;
+    }
+
+    writers[i](profiler, symbols, report);
+    fclose(report);
+  }
+}
+
+// One "<address> <label>" line per label, in address order, for resolving
+// addresses in traces and reports; empty when the program was not assembled
+void writeSymbolMap(const SymbolTable *symbols, FILE *output)
+{
+  if (symbols == NULL)
+    return;
+
+  for (size_t i = 0; i < symbols->count; i++)
+    fprintf(output, "0x%08X %s\n", symbols->symbols[i].address, symbols->symbols[i].name);
+}
@@ -0,0 +1,49 @@
+// Nested and sibling loops for the load-time loop analysis: outer runs 5
+// times around inner, which runs 3 times around innermost (2 times), and
+// calls fill, whose loop runs 6 times; then after runs 10 times on its own
+.text
+  bun main
+  .align 5
+
+// Stores r3 into the 6 words from buffer
+fill:
+  mov r4, buffer
+  srl r0, r4, r4, 1
+  mov r5, 6
+store:
+  s32 [r4], r3
+  addi r4, r4, 1
+  subi r5, r5, 1
+  cmpi r5, 0
+  bne store
+  ret
+
+main:
+  mov sp, 0x7FFC
+  mov r1, 5
+outer:
+  mov r2, 3
+inner:
+  mov r6, 2
+innermost:
+  addi r3, r3, 1
+  subi r6, r6, 1
+  cmpi r6, 0
+  bne innermost
+  subi r2, r2, 1
+  cmpi r2, 0
+  bne inner
+  call fill
+  subi r1, r1, 1
+  cmpi r1, 0
+  bne outer
+
+  mov r1, 10
+after:
+  subi r1, r1, 1
+  cmpi r1, 0
+  bne after
+  int 0
+.data
+buffer:
+  .fill 24, 1, 0
@@ -0,0 +1,43 @@
+#!/bin/sh
+# Loop analysis test
+#
+# Usage: tests/analysis.sh <simulator>
+#
+# Profiles analysis.s, whose nested, sibling and called loops are known in
+# advance, and checks the loops section of the profile: the nesting found
+# when the program was loaded, the blocks of each loop and the entries,
+# iterations and instructions counted for it. Exits with status 1 when the
+# section differs.
+
+set -u
+
+SIMULATOR=${1:?usage: analysis.sh <simulator>}
+DIRECTORY=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+FAILED=0
+
+cat > "$WORK/expected.txt" << 'END'
+[LOOPS]
+Loop          Blocks      Entries   Iterations      Exclusive    Excl%      Inclusive    Incl%
+outer              6            1            4             25    6.10%            205   50.00%
+  inner            3            5           10             60   14.63%            180   43.90%
+    innermost      1           15           15            120   29.27%            120   29.27%
+store              1            5           25            150   36.59%            150   36.59%
+after              1            1            9             30    7.32%             30    7.32%
+END
+
+"$SIMULATOR" "$DIRECTORY/analysis.s" "$WORK/output.txt" --no-trace --profile="$WORK/profile.txt" > /dev/null
+status=$?
+sed -n '/^\[LOOPS\]$/,$p' "$WORK/profile.txt" > "$WORK/loops.txt"
+if [ $status -eq 0 ] && cmp -s "$WORK/expected.txt" "$WORK/loops.txt"
+then
+  echo "loops: ok"
+else
+  echo "loops: FAILED (status $status)"
+  diff "$WORK/expected.txt" "$WORK/loops.txt"
+  FAILED=1
+fi
+
+exit $FAILED
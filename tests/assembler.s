@@ -0,0 +1,35 @@
+// Exercises the directives: prints the string at message, then the byte
+// after a .fill, then the low byte of the word after an .align 4 (16 bytes)
+.text
+  bun main
+  .align 5
+main:
+  mov sp, 0x7FFC
+  mov sr, 0
+  l32 r1, [term]
+  mov r2, message
+print:
+  l8 r3, [r2]
+  cmpi r3, 0
+  beq filled
+  s8 [r1], r3
+  addi r2, r2, 1
+  bun print
+filled:
+  l8 r3, [marker]
+  s8 [r1], r3
+  l32 r3, [aligned]
+  s8 [r1], r3
+  int 0
+.data
+term:
+  .4byte 0x8888888B
+message:
+  .asciz "asm"
+padding:
+  .fill 5, 1, 0x2D
+marker:
+  .fill 1, 1, 0x21
+  .align 4
+aligned:
+  .4byte 0x3F
@@ -0,0 +1,71 @@
+#!/bin/sh
+# Assembler test
+#
+# Usage: tests/assembler.sh <simulator>
+#
+# Runs assembler.s, whose terminal output and symbol map depend on where
+# .text, .data, .align, .fill and .asciz place things, and checks both. Then
+# runs each benchmark from its .s source and from its .hex image for 20000
+# instructions, which must give identical traces, and checks that a program
+# with an unknown instruction is reported by line and not run. Exits with
+# status 1 when a check fails.
+
+set -u
+
+SIMULATOR=${1:?usage: assembler.sh <simulator>}
+DIRECTORY=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+FAILED=0
+
+cat > "$WORK/expected.txt" << 'END'
+0x00000020 main
+0x00000030 print
+0x00000048 filled
+0x0000005C term
+0x00000060 message
+0x00000064 padding
+0x00000069 marker
+0x00000070 aligned
+END
+
+"$SIMULATOR" "$DIRECTORY/assembler.s" "$WORK/assembler.txt" --symbol-map="$WORK/map.txt" > /dev/null
+status=$?
+terminal=$(sed -n '/^\[TERMINAL\]$/{n;p;}' "$WORK/assembler.txt")
+if [ $status -eq 0 ] && [ "$terminal" = "asm!?" ] && cmp -s "$WORK/expected.txt" "$WORK/map.txt"
+then
+  echo "directives: ok"
+else
+  echo "directives: FAILED (status $status, terminal '$terminal', symbol map:)"
+  cat "$WORK/map.txt"
+  FAILED=1
+fi
+
+for benchmark in alu fpu interrupts memory pushpop recursion
+do
+  source="$DIRECTORY/../benchmarks/$benchmark.s"
+  "$SIMULATOR" "$source" "$WORK/$benchmark-s.txt" --max-instructions=20000 > /dev/null
+  "$SIMULATOR" "${source%.s}.hex" "$WORK/$benchmark-hex.txt" --max-instructions=20000 > /dev/null
+  if cmp -s "$WORK/$benchmark-s.txt" "$WORK/$benchmark-hex.txt"
+  then
+    echo "$benchmark: ok"
+  else
+    echo "$benchmark: FAILED (the .s and .hex traces differ)"
+    FAILED=1
+  fi
+done
+
+printf 'main:\n  frob r1\n' > "$WORK/unknown.s"
+"$SIMULATOR" "$WORK/unknown.s" "$WORK/unknown.txt" > /dev/null 2> "$WORK/errors.txt"
+status=$?
+if [ $status -eq 1 ] && grep -q '^Line 2: Unknown instruction: frob$' "$WORK/errors.txt"
+then
+  echo "unknown instruction: ok"
+else
+  echo "unknown instruction: FAILED (status $status)"
+  cat "$WORK/errors.txt"
+  FAILED=1
+fi
+
+exit $FAILED
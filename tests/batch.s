@@ -0,0 +1,22 @@
+// Sums 1 to seed and prints the sum modulo 26 as a letter
+.text
+  bun main
+  .align 5
+main:
+  l32 r1, [term]
+  l32 r2, [seed]
+  mov r3, 0
+loop:
+  add r3, r3, r2
+  subi r2, r2, 1
+  cmpi r2, 0
+  bne loop
+  modi r4, r3, 26
+  addi r4, r4, 0x41
+  s8 [r1], r4
+  int 0
+.data
+seed:
+  .4byte 5
+term:
+  .4byte 0x8888888B
@@ -0,0 +1,57 @@
+#!/bin/sh
+# Batch mode test
+#
+# Usage: tests/batch.sh <simulator>
+#
+# Runs batch.s with six different seeds, each listed twice in the manifest,
+# as a batch on one worker and on three. Every traced output must match the
+# output of running that program on its own, and every terminal must show
+# the letter for the sum of 1 to its seed. Exits with status 1 when an output
+# differs.
+
+set -u
+
+SIMULATOR=${1:?usage: batch.sh <simulator>}
+DIRECTORY=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+SEEDS="1 2 3 10 50 100"
+FAILED=0
+
+mkdir "$WORK/reference"
+for seed in $SEEDS
+do
+  sed "/^seed:/{n;s/.*/  .4byte $seed/;}" "$DIRECTORY/batch.s" > "$WORK/seed$seed.s"
+  "$SIMULATOR" "$WORK/seed$seed.s" "$WORK/reference/seed$seed.a.out" > /dev/null
+  cp "$WORK/reference/seed$seed.a.out" "$WORK/reference/seed$seed.b.out"
+
+  expected=$(awk -v seed=$seed 'BEGIN { printf "%c", 65 + (seed * (seed + 1) / 2) % 26 }')
+  terminal=$(sed -n '/^\[TERMINAL\]$/{n;p;}' "$WORK/reference/seed$seed.a.out")
+  if [ "$terminal" != "$expected" ]
+  then
+    echo "seed $seed: FAILED (terminal '$terminal', expected '$expected')"
+    FAILED=1
+  fi
+done
+
+for jobs in 1 3
+do
+  mkdir "$WORK/jobs$jobs"
+  for seed in $SEEDS
+  do
+    echo "$WORK/seed$seed.s $WORK/jobs$jobs/seed$seed.a.out"
+    echo "$WORK/seed$seed.s $WORK/jobs$jobs/seed$seed.b.out"
+  done > "$WORK/jobs$jobs.txt"
+
+  "$SIMULATOR" --batch="$WORK/jobs$jobs.txt" --jobs=$jobs > /dev/null
+  if diff -r "$WORK/reference" "$WORK/jobs$jobs" > /dev/null
+  then
+    echo "jobs=$jobs: ok"
+  else
+    echo "jobs=$jobs: FAILED (output differs from the single runs)"
+    FAILED=1
+  fi
+done
+
+exit $FAILED
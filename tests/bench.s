@@ -0,0 +1,15 @@
+// Runs a loop of 100 iterations of four instructions and stops after
+// 405 instructions in all
+.text
+  bun main
+  .align 5
+main:
+  mov r1, 100
+loop:
+  addi r2, r2, 3
+  subi r1, r1, 1
+  cmpi r1, 0
+  bne loop
+  mov r3, 1
+  mov r4, 2
+  int 0
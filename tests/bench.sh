@@ -0,0 +1,65 @@
+#!/bin/sh
+# Benchmark harness test
+#
+# Usage: tests/bench.sh <simulator>
+#
+# Checks that --stats counts the 405 instructions of bench.s, then runs
+# benchmarks/run.sh with small budgets against two made-up baselines: one far
+# slower than any machine, which must pass, and one far faster, which must
+# report a regression for every run and exit with status 1. The recorded
+# baseline.txt is left alone. Exits with status 1 when a check fails.
+
+set -u
+
+SIMULATOR=${1:?usage: bench.sh <simulator>}
+DIRECTORY=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+FAILED=0
+
+counted=$("$SIMULATOR" "$DIRECTORY/bench.s" /dev/null --stats --no-trace 2>&1 > /dev/null | awk '$1 == "Instructions:" { print $2 }')
+if [ "$counted" = "405" ]
+then
+  echo "stats: ok"
+else
+  echo "stats: FAILED (counted '$counted' instructions, expected 405)"
+  FAILED=1
+fi
+
+# Writes a baseline with the given MIPS and peak RSS for every run
+baseline()
+{
+  for name in alu memory recursion pushpop fpu interrupts
+  do
+    echo "$name no-trace $2 $3"
+    echo "$name trace $2 $3"
+  done > "$WORK/$1.txt"
+}
+
+baseline slow 0.001 1000000
+baseline fast 1000000 1
+
+# Runs the harness against a baseline; prints its exit status and the number
+# of regressions it reported
+harness()
+{
+  BASELINE="$WORK/$1.txt" BUDGET_NO_TRACE=100000 BUDGET_TRACE=10000 REPEAT=1 \
+    "$DIRECTORY/../benchmarks/run.sh" "$SIMULATOR" > "$WORK/$1.out" 2>&1
+  echo "$? $(grep -c REGRESSION "$WORK/$1.out")"
+}
+
+for check in "slow 0 0" "fast 1 12"
+do
+  set -- $check
+  result=$(harness $1)
+  if [ "$result" = "$2 $3" ]
+  then
+    echo "$1 baseline: ok"
+  else
+    echo "$1 baseline: FAILED (exit status and regressions '$result', expected '$2 $3')"
+    FAILED=1
+  fi
+done
+
+exit $FAILED
@@ -0,0 +1,40 @@
+// Resets every performance counter, runs a loop of four iterations with a
+// load, a store and a software interrupt each, then reads the counters
+.text
+  bun main
+  bun main
+  bun main
+  bun interrupt
+  .align 5
+interrupt:
+  reti
+main:
+  mov sp, 0x7FFC
+  l32 r1, [counters]
+  mov r2, 0x3F
+  s32 [r1+12], r2
+
+  mov r5, 4
+loop:
+  l32 r3, [value]
+  s32 [scratch], r3
+  int 1
+  subi r5, r5, 1
+  cmpi r5, 0
+  bne loop
+
+  l32 r10, [r1]
+  l32 r11, [r1+2]
+  l32 r12, [r1+4]
+  l32 r13, [r1+6]
+  l32 r14, [r1+8]
+  l32 r15, [r1+10]
+  l32 r16, [r1+11]
+  int 0
+.data
+counters:
+  .4byte 0x20202240
+value:
+  .4byte 5
+scratch:
+  .4byte 0
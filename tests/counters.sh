@@ -0,0 +1,43 @@
+#!/bin/sh
+# Performance counter test
+#
+# Usage: tests/counters.sh <simulator>
+#
+# Runs counters.s, which resets the counters through the control register,
+# runs a loop with known loads, stores, taken branches and interrupts, and
+# reads each counter back. The values the trace shows for those reads must
+# match, with cycles equal to instructions without the timing model and the
+# modelled cycles with it. Exits with status 1 when a value differs.
+
+set -u
+
+SIMULATOR=${1:?usage: counters.sh <simulator>}
+DIRECTORY=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+FAILED=0
+
+# Runs the program with the given options and compares the values read from
+# the counters: instructions, cycles, loads, stores, taken branches,
+# interrupts and the high word of the interrupt counter
+check()
+{
+  name=$1
+  expected=$2
+  shift 2
+  "$SIMULATOR" "$DIRECTORY/counters.s" "$WORK/output.txt" "$@" > /dev/null 2>&1
+  values=$(sed -n 's/.*=MEM\[0x808089[0-2][0-9A-F]\]=0x\([0-9A-F]*\)$/\1/p' "$WORK/output.txt" | tr '\n' ' ')
+  if [ "$values" = "$expected " ]
+  then
+    echo "$name: ok"
+  else
+    echo "$name: FAILED (read '$values', expected '$expected')"
+    FAILED=1
+  fi
+}
+
+check untimed "00000022 00000023 00000006 00000005 00000007 00000004 00000000"
+check timed "00000022 0000005B 00000006 00000005 00000007 00000004 00000000" --timing
+
+exit $FAILED
@@ -0,0 +1,46 @@
+// Writes 'W' over sector 0, then reads the sector back. Prints S when the
+// write was rejected (ST set) or N when it went through, followed by the
+// first byte of the sector as read back.
+.text
+  bun main
+  .align 5
+main:
+  l32 r1, [term]
+  l32 r2, [disk]
+
+  // Sector 0 <-> 0x4000, one sector
+  mov r3, 0
+  s32 [r2], r3
+  mov r3, 0x4000
+  s32 [r2+1], r3
+  mov r3, 1
+  s32 [r2+2], r3
+
+  mov r4, 0x4000
+  mov r3, 0x57
+  s8 [r4], r3
+
+  // Write
+  mov r3, 2
+  s32 [r2+3], r3
+  l32 r5, [r2+3]
+
+  mov r3, 0x4E
+  cmpi r5, 0x20
+  bne status
+  mov r3, 0x53
+status:
+  s8 [r1], r3
+
+  // Read back over the 'W'
+  mov r3, 1
+  s32 [r2+3], r3
+  l8 r3, [r4]
+  s8 [r1], r3
+
+  int 0
+.data
+disk:
+  .4byte 0x202022B0
+term:
+  .4byte 0x8888888B
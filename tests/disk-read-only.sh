@@ -0,0 +1,44 @@
+#!/bin/sh
+# Read-only disk test
+#
+# Usage: tests/disk-read-only.sh <simulator>
+#
+# Runs disk-read-only.s against a disk image of 'R' bytes, once with
+# --disk-read-only and once writable. The read-only run must reject the write
+# (ST set, sector still 'R', image unchanged); the writable run must store the
+# 'W' in the image. Exits with status 1 when either run misbehaves.
+
+set -u
+
+SIMULATOR=${1:?usage: disk-read-only.sh <simulator>}
+DIRECTORY=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+FAILED=0
+
+# Runs the program on a fresh image and checks its terminal and the image's
+# first byte
+check()
+{
+  name=$1
+  expected=$2
+  first=$3
+  shift 3
+  head -c 1024 /dev/zero | tr '\0' 'R' > "$WORK/disk.img"
+  "$SIMULATOR" "$DIRECTORY/disk-read-only.s" "$WORK/output.txt" --no-trace --disk="$WORK/disk.img" "$@" > /dev/null
+  terminal=$(sed -n '/^\[TERMINAL\]$/{n;p;}' "$WORK/output.txt")
+  stored=$(head -c 1 "$WORK/disk.img")
+  if [ "$terminal" = "$expected" ] && [ "$stored" = "$first" ]
+  then
+    echo "$name: ok"
+  else
+    echo "$name: FAILED (terminal '$terminal', expected '$expected'; image starts with '$stored', expected '$first')"
+    FAILED=1
+  fi
+}
+
+check read-only SR R --disk-read-only
+check writable NW W
+
+exit $FAILED
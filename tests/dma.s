@@ -0,0 +1,96 @@
+// Fills a buffer with dashes, copies the alphabet into it with the end of
+// transfer interrupt, copies part of it over itself, prints it, and then
+// prints S for each rejected transfer: a fill past the end of memory and a
+// transfer asking for both a copy and a fill
+.text
+  bun main
+  bun main
+  bun main
+  bun main
+  bun hardware1
+  .align 5
+hardware1:
+  add r9, cr, r0
+  reti
+main:
+  mov sp, 0x7FFC
+  l32 r1, [dma]
+  mov r10, buffer
+
+  // Fill 30 bytes with '-'
+  mov r2, 0x2D
+  s32 [r1], r2
+  s32 [r1+1], r10
+  mov r2, 30
+  s32 [r1+2], r2
+  mov r2, 2
+  s32 [r1+3], r2
+
+  // Copy the alphabet to buffer + 2, with the interrupt
+  mov sr, 2
+  mov r2, alphabet
+  s32 [r1], r2
+  addi r2, r10, 2
+  s32 [r1+1], r2
+  mov r2, 26
+  s32 [r1+2], r2
+  mov r2, 5
+  s32 [r1+3], r2
+
+  // Overlapping copy of 10 bytes from buffer + 2 to buffer + 5
+  addi r2, r10, 2
+  s32 [r1], r2
+  addi r2, r10, 5
+  s32 [r1+1], r2
+  mov r2, 10
+  s32 [r1+2], r2
+  mov r2, 1
+  s32 [r1+3], r2
+
+  l32 r3, [term]
+  mov r4, 30
+print:
+  l8 r5, [r10]
+  s8 [r3], r5
+  addi r10, r10, 1
+  subi r4, r4, 1
+  cmpi r4, 0
+  bne print
+
+  // Fill 10 bytes past the end of memory
+  l32 r2, [outside]
+  s32 [r1+1], r2
+  mov r2, 1
+  s32 [r1+3], r2
+  l32 r2, [r1+3]
+  mov r5, 0x4E
+  cmpi r2, 0x20
+  bne status
+  mov r5, 0x53
+status:
+  s8 [r3], r5
+
+  // Copy and fill at once
+  mov r2, buffer
+  s32 [r1+1], r2
+  mov r2, 3
+  s32 [r1+3], r2
+  l32 r2, [r1+3]
+  mov r5, 0x4E
+  cmpi r2, 0x20
+  bne both
+  mov r5, 0x53
+both:
+  s8 [r3], r5
+  int 0
+.data
+dma:
+  .4byte 0x20202280
+term:
+  .4byte 0x8888888B
+outside:
+  .4byte 0x7FFA
+alphabet:
+  .asciz "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+buffer:
+  .fill 32, 1, 0
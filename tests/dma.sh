@@ -0,0 +1,35 @@
+#!/bin/sh
+# DMA controller test
+#
+# Usage: tests/dma.sh <simulator>
+#
+# Runs dma.s, which fills, copies and copies over an overlapping range with
+# the DMA controller and then starts two transfers it must reject. The
+# terminal must show the buffer as memmove and memset leave it followed by
+# an S for each rejected transfer, and the copy asking for the interrupt must
+# raise exactly one hardware interrupt 1 with the DMA cause. Exits with
+# status 1 when the run misbehaves.
+
+set -u
+
+SIMULATOR=${1:?usage: dma.sh <simulator>}
+DIRECTORY=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+FAILED=0
+
+"$SIMULATOR" "$DIRECTORY/dma.s" "$WORK/dma.txt" > /dev/null
+status=$?
+terminal=$(sed -n '/^\[TERMINAL\]$/{n;p;}' "$WORK/dma.txt")
+interrupts=$(grep -c '^\[HARDWARE INTERRUPTION 1\]$' "$WORK/dma.txt")
+cause=$(grep -c 'R9=CR+R0=0x0D3A0D3A' "$WORK/dma.txt")
+if [ $status -eq 0 ] && [ "$terminal" = "--ABCABCDEFGHIJNOPQRSTUVWXYZ--SS" ] && [ "$interrupts" = "1" ] && [ "$cause" = "1" ]
+then
+  echo "dma: ok"
+else
+  echo "dma: FAILED (status $status, terminal '$terminal', $interrupts interrupts, $cause with the DMA cause)"
+  FAILED=1
+fi
+
+exit $FAILED
@@ -0,0 +1,57 @@
+#!/bin/sh
+# Handler microbenchmark test
+#
+# Usage: tests/handlers.sh <handlers>
+#
+# Runs the microbenchmark briefly over every handler and over two named
+# ones. The full table must list each instruction handler once, in decoding
+# order, with positive timings; naming handlers must select exactly those,
+# and zero iterations must be rejected. Exits with status 1 when a check
+# fails.
+
+set -u
+
+HANDLERS=${1:?usage: handlers.sh <handlers>}
+
+FAILED=0
+
+EXPECTED="mov movs add sub mul sll muls sla div srl divs sra cmp and or not xor addi subi muli divi modi cmpi l8 l16 l32 s8 s16 s32 bae bat bbe bbt beq bge bgt biv ble blt bne bni bnz bun bzd callf calls ret push pop reti cbr sbr int"
+
+# Prints the handler names of a run, or "bad timing" for a row whose
+# timings are not positive numbers
+rows()
+{
+  "$HANDLERS" --iterations=1000 "$@" | awk '
+    NR == 1 { next }
+    !($2 > 0 && $3 > 0) { print "bad timing"; next }
+    { print $1 }
+  ' | tr '\n' ' '
+}
+
+table=$(rows)
+if [ "$table" = "$EXPECTED " ]
+then
+  echo "table: ok"
+else
+  echo "table: FAILED (listed '$table')"
+  FAILED=1
+fi
+
+selected=$(rows ret add)
+if [ "$selected" = "add ret " ]
+then
+  echo "selection: ok"
+else
+  echo "selection: FAILED (listed '$selected', expected 'add ret')"
+  FAILED=1
+fi
+
+if "$HANDLERS" --iterations=0 > /dev/null 2>&1
+then
+  echo "zero iterations: FAILED (accepted)"
+  FAILED=1
+else
+  echo "zero iterations: ok"
+fi
+
+exit $FAILED
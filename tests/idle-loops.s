@@ -0,0 +1,105 @@
+// Waits in idle loops for a watchdog, a one-shot interval timer and an FPU
+// division, noting the instruction counter when each interrupt arrives, then
+// prints the three counts in hex
+.text
+  bun main
+  bun main
+  bun main
+  bun main
+  bun hardware1
+  bun main
+  bun fpu
+  bun main
+  .align 5
+// Watchdog or interval timer
+hardware1:
+  l32 r20, [timerCode]
+  cmp cr, r20
+  beq timer
+  l32 r5, [r9]
+  reti
+timer:
+  l32 r6, [r9]
+  reti
+fpu:
+  l32 r7, [r9]
+  reti
+// Prints r10 as eight hex digits and a space
+printHex:
+  mov r11, 8
+nextDigit:
+  srl r0, r12, r10, 27
+  sll r0, r10, r10, 3
+  cmpi r12, 10
+  blt decimal
+  addi r12, r12, 55
+  bun digit
+decimal:
+  addi r12, r12, 48
+digit:
+  s8 [r1], r12
+  subi r11, r11, 1
+  cmpi r11, 0
+  bne nextDigit
+  mov r12, 32
+  s8 [r1], r12
+  ret
+main:
+  mov sp, 0x7FFC
+  l32 r9, [counters]
+  mov sr, 2
+
+  l32 r1, [watchdogAddress]
+  l32 r2, [watchdogArm]
+  s32 [r1], r2
+waitWatchdog:
+  cmpi r5, 0
+  beq waitWatchdog
+
+  l32 r1, [timerAddress]
+  mov r2, 50
+  s32 [r1+1], r2
+  mov r2, 3
+  s32 [r1+2], r2
+  mov r2, 40
+  s32 [r1+3], r2
+  mov r2, 7
+  s32 [r1], r2
+waitTimer:
+  cmpi r6, 0
+  beq waitTimer
+
+  l32 r1, [fpuAddress]
+  mov r2, 3
+  s32 [r1], r2
+  mov r2, 7
+  s32 [r1+1], r2
+  mov r2, 4
+  s32 [r1+3], r2
+waitFPU:
+  cmpi r7, 0
+  beq waitFPU
+
+  l32 r1, [term]
+  add r10, r5, r0
+  call printHex
+  add r10, r6, r0
+  call printHex
+  add r10, r7, r0
+  call printHex
+  int 0
+.data
+counters:
+  .4byte 0x20202240
+watchdogAddress:
+  .4byte 0x20202020
+watchdogArm:
+  .4byte 0x8000012C
+timerAddress:
+  .4byte 0x202022A0
+timerCode:
+  .4byte 0x71E3E200
+fpuAddress:
+  .4byte 0x20202220
+term:
+  .4byte 0x8888888B
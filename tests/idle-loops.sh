@@ -0,0 +1,78 @@
+#!/bin/sh
+# Idle loop test
+#
+# Usage: tests/idle-loops.sh <simulator>
+#
+# Runs idle-loops.s, which waits in idle loops for a watchdog, an interval
+# timer and an FPU interrupt and prints the instruction count at which each
+# arrived, with --idle-loops=off, skip and collapse (traced), on the
+# instruction clock and on the cycle clock. Fast-forwarding must not move any
+# interrupt: every terminal and instruction count must match the run with
+# idle loops off. The traced collapse run must show the skipped loops, so
+# the fast-forward path is known to have run. Exits with status 1 when a run
+# differs.
+
+set -u
+
+SIMULATOR=${1:?usage: idle-loops.sh <simulator>}
+DIRECTORY=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+FAILED=0
+
+# Prints the terminal and the instruction count of a run with the given
+# options
+run()
+{
+  "$SIMULATOR" "$DIRECTORY/idle-loops.s" "$WORK/output.txt" --stats "$@" > /dev/null 2> "$WORK/stats.txt"
+  terminal=$(sed -n '/^\[TERMINAL\]$/{n;p;}' "$WORK/output.txt")
+  instructions=$(awk '$1 == "Instructions:" { print $2 }' "$WORK/stats.txt")
+  echo "$terminal/$instructions"
+}
+
+for clock in instructions cycles
+do
+  if [ $clock = cycles ]
+  then
+    set -- --timing --timer-clock=cycles
+  else
+    set --
+  fi
+
+  reference=$(run --no-trace --idle-loops=off "$@")
+  for mode in skip collapse
+  do
+    if [ $mode = skip ]
+    then
+      result=$(run --no-trace --idle-loops=skip "$@")
+    else
+      result=$(run --idle-loops=collapse "$@")
+    fi
+
+    if [ "$result" = "$reference" ]
+    then
+      echo "$mode on $clock: ok"
+    else
+      echo "$mode on $clock: FAILED (interrupts and instructions '$result', expected '$reference')"
+      FAILED=1
+    fi
+  done
+done
+
+if [ "$(run --no-trace --idle-loops=off)" != "00000137 000001E7 000001F6 /744" ]
+then
+  echo "arrival: FAILED (interrupts did not arrive at instructions 0x137, 0x1E7 and 0x1F6)"
+  FAILED=1
+fi
+
+run --idle-loops=collapse > /dev/null
+if grep -q '^\[IDLE LOOP .* ITERATIONS SKIPPED\]$' "$WORK/output.txt"
+then
+  echo "skipped: ok"
+else
+  echo "skipped: FAILED (no idle loop was fast-forwarded)"
+  FAILED=1
+fi
+
+exit $FAILED
@@ -0,0 +1,42 @@
+// Counts software interrupts until a watchdog of seed instructions expires,
+// then prints the count modulo 26 as a letter
+.text
+  bun main
+  bun main
+  bun main
+  bun software
+  bun watchdog
+  .align 5
+software:
+  addi r3, r3, 1
+  reti
+watchdog:
+  mov r4, 1
+  reti
+main:
+  mov sp, 0x7FFC
+  l32 r1, [watchdogAddress]
+  l32 r2, [seed]
+  l32 r5, [enable]
+  or r2, r2, r5
+  mov sr, 2
+  s32 [r1], r2
+loop:
+  int 1
+  cmpi r4, 0
+  beq loop
+
+  l32 r1, [term]
+  modi r3, r3, 26
+  addi r3, r3, 0x41
+  s8 [r1], r3
+  int 0
+.data
+seed:
+  .4byte 40
+enable:
+  .4byte 0x80000000
+watchdogAddress:
+  .4byte 0x20202020
+term:
+  .4byte 0x8888888B
@@ -0,0 +1,56 @@
+#!/bin/sh
+# Interleaved batch test
+#
+# Usage: tests/interleave.sh <simulator>
+#
+# Runs interleave.s, which takes software interrupts until its watchdog
+# expires, with five watchdog counts as interleaved batches: one instruction
+# per turn with every guest resident, seven per turn with two resident, and
+# three per turn with one resident on two workers. A guest must resume at the
+# exact instruction where its turn ended, so every traced output must match
+# the output of running that program on its own. Exits with status 1 when an
+# output differs.
+
+set -u
+
+SIMULATOR=${1:?usage: interleave.sh <simulator>}
+DIRECTORY=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+SEEDS="10 40 100 1000 5000"
+FAILED=0
+
+mkdir "$WORK/reference"
+for seed in $SEEDS
+do
+  sed "/^seed:/{n;s/.*/  .4byte $seed/;}" "$DIRECTORY/interleave.s" > "$WORK/seed$seed.s"
+  "$SIMULATOR" "$WORK/seed$seed.s" "$WORK/reference/seed$seed.out" > /dev/null
+done
+
+# Runs the seeds as one batch with the given options, outputs in $WORK/<name>
+run()
+{
+  name=$1
+  shift
+  mkdir "$WORK/$name"
+  for seed in $SEEDS
+  do
+    echo "$WORK/seed$seed.s $WORK/$name/seed$seed.out"
+  done > "$WORK/$name.txt"
+  "$SIMULATOR" --batch="$WORK/$name.txt" "$@" > /dev/null
+
+  if diff -r "$WORK/reference" "$WORK/$name" > /dev/null
+  then
+    echo "$name: ok"
+  else
+    echo "$name: FAILED (output differs from the single runs)"
+    FAILED=1
+  fi
+}
+
+run quantum1 --jobs=1 --quantum=1
+run quantum7 --jobs=1 --quantum=7 --resident=2
+run quantum3 --jobs=2 --quantum=3 --resident=1
+
+exit $FAILED
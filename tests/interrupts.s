@@ -0,0 +1,154 @@
+// Raises the watchdog and interval timer interrupts together with every
+// source masked in the enable register, prints P when the pending register
+// shows exactly those two, and then unmasks them: first with the timer
+// above the watchdog in the priority register, then with the default
+// priorities. The handler prints T, W or D for the timer, watchdog and DMA;
+// taking an interrupt leaves IE set, so the second one nests right after
+// the vector's branch and the source taken first prints last. Then raises
+// the DMA and timer interrupts with IE clear in SR: only the DMA interrupt,
+// which ignores IE, is taken before the program prints - and sets IE again.
+// Last, masks every source again, prints M when the FPU and DMA bits stayed
+// set, and runs an FPU addition: its handler prints F, and the program
+// prints . once the opcode has been reset.
+.text
+  bun main
+  bun main
+  bun main
+  bun main
+  bun hardware1
+  bun fpu
+  bun fpu
+  .align 5
+hardware1:
+  l32 r9, [dmacode]
+  cmp cr, r9
+  mov r9, 0x44
+  beq put
+  l32 r9, [watchdogcode]
+  cmp cr, r9
+  mov r9, 0x57
+  beq put
+  mov r9, 0x54
+put:
+  s8 [r3], r9
+  reti
+fpu:
+  mov r9, 0x46
+  s8 [r3], r9
+  reti
+main:
+  mov sp, 0x7FFC
+  l32 r1, [controller]
+  l32 r3, [term]
+  mov sr, 2
+
+  l32 r2, [swapped]
+  call raise
+  l32 r2, [defaults]
+  call raise
+
+  mov sr, 0
+  call start
+  call timer
+wait:
+  l32 r4, [r1]
+  cmpi r4, 0x10
+  bne wait
+  mov r9, 0x2D
+  s8 [r3], r9
+  mov sr, 2
+
+  mov r4, 0
+  s32 [r1+1], r4
+  l32 r4, [r1+1]
+  mov r9, 0x4E
+  cmpi r4, 0x06
+  bne masked
+  mov r9, 0x4D
+masked:
+  s8 [r3], r9
+  l32 r5, [fpuregisters]
+  mov r6, 1
+  s32 [r5], r6
+  s32 [r5+1], r6
+  s32 [r5+3], r6
+opcode:
+  l32 r6, [r5+3]
+  mov r4, 0x1F
+  and r6, r6, r4
+  cmpi r6, 0
+  bne opcode
+  mov r9, 0x2E
+  s8 [r3], r9
+  int 0
+
+// Raises the watchdog and timer interrupts with everything masked, checks
+// the pending register and unmasks everything with the priorities in r2
+raise:
+  mov r4, 0
+  s32 [r1+1], r4
+  l32 r5, [watchdog]
+  l32 r6, [watchdogcount]
+  s32 [r5], r6
+  call timer
+pending:
+  l32 r4, [r1]
+  cmpi r4, 0x11
+  bne pending
+  mov r9, 0x50
+  s8 [r3], r9
+  s32 [r1+2], r2
+  mov r4, 0x3F
+  s32 [r1+1], r4
+  ret
+
+// Fills four bytes with the DMA interrupt
+start:
+  l32 r5, [dma]
+  mov r6, 0x78
+  s32 [r5], r6
+  mov r6, buffer
+  s32 [r5+1], r6
+  mov r6, 4
+  s32 [r5+2], r6
+  mov r6, 6
+  s32 [r5+3], r6
+  ret
+
+// Starts a one-shot timer that matches after three ticks
+timer:
+  l32 r5, [intervaltimer]
+  mov r6, 100
+  s32 [r5+1], r6
+  mov r6, 0
+  s32 [r5+2], r6
+  mov r6, 3
+  s32 [r5+3], r6
+  mov r6, 7
+  s32 [r5], r6
+  ret
+.data
+controller:
+  .4byte 0x20202290
+dma:
+  .4byte 0x20202280
+intervaltimer:
+  .4byte 0x202022A0
+watchdog:
+  .4byte 0x20202020
+fpuregisters:
+  .4byte 0x20202220
+term:
+  .4byte 0x8888888B
+dmacode:
+  .4byte 0x0D3A0D3A
+watchdogcode:
+  .4byte 0xE1AC04DA
+watchdogcount:
+  .4byte 0x80000003
+swapped:
+  .4byte 0xAFCDEB
+defaults:
+  .4byte 0xABCDEF
+buffer:
+  .4byte 0
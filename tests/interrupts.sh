@@ -0,0 +1,38 @@
+#!/bin/sh
+# Interrupt controller test
+#
+# Usage: tests/interrupts.sh <simulator>
+#
+# Runs interrupts.s, which raises the watchdog and interval timer interrupts
+# together while the enable register masks them and unmasks them under two
+# priority settings, then raises the DMA and timer interrupts with IE clear,
+# and last runs an FPU operation with every source masked. The terminal must
+# show both pending each time, the higher priority source taken first (and
+# so printed last by the nested handlers), only the DMA interrupt taken
+# while IE is clear, and the FPU and DMA bits left set in the enable
+# register, so the FPU still completes, interrupts and resets its opcode.
+# The run is capped at 100000 instructions in case the FPU stalls. Exits
+# with status 1 when the run misbehaves.
+
+set -u
+
+SIMULATOR=${1:?usage: interrupts.sh <simulator>}
+DIRECTORY=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+FAILED=0
+
+"$SIMULATOR" "$DIRECTORY/interrupts.s" "$WORK/interrupts.txt" --max-instructions=100000 > /dev/null
+status=$?
+terminal=$(sed -n '/^\[TERMINAL\]$/{n;p;}' "$WORK/interrupts.txt")
+interrupts=$(grep '^\[HARDWARE INTERRUPTION' "$WORK/interrupts.txt" | tr -dc '0-9')
+if [ $status -eq 0 ] && [ "$terminal" = "PWTPTWD-TMF." ] && [ "$interrupts" = "1111113" ]
+then
+  echo "interrupts: ok"
+else
+  echo "interrupts: FAILED (status $status, terminal '$terminal', interrupts $interrupts)"
+  FAILED=1
+fi
+
+exit $FAILED
@@ -0,0 +1,7 @@
+// Counts in r1 forever
+.text
+  bun main
+  .align 5
+main:
+  addi r1, r1, 1
+  bun main
@@ -0,0 +1,58 @@
+#!/bin/sh
+# Run limit test
+#
+# Usage: tests/limits.sh <simulator>
+#
+# Runs limits.s, which counts forever, under each limit. The instruction
+# limit must stop it after exactly 100 traced instructions, the trace limit
+# on the line that crosses 1000 bytes (the sixteenth instruction), and the
+# time limit well before the five seconds the test allows. Each run must end
+# with its limit marker and exit with status 2, and malformed limits must be
+# rejected. Exits with status 1 when a run misbehaves.
+
+set -u
+
+SIMULATOR=${1:?usage: limits.sh <simulator>}
+DIRECTORY=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+FAILED=0
+
+# Runs the program with the given option and checks the exit status, the
+# marker before the end and the number of traced instructions
+check()
+{
+  name=$1
+  marker=$2
+  traced=$3
+  shift 3
+  timeout 5 "$SIMULATOR" "$DIRECTORY/limits.s" "$WORK/output.txt" "$@" > /dev/null
+  status=$?
+  reported=$(tail -n 2 "$WORK/output.txt" | head -n 1)
+  lines=$(grep -c '^0x' "$WORK/output.txt")
+  if [ $status -eq 2 ] && [ "$reported" = "$marker" ] && [ "$lines" = "$traced" ]
+  then
+    echo "$name: ok"
+  else
+    echo "$name: FAILED (status $status, marker '$reported', $lines instructions traced, expected '$marker' and $traced)"
+    FAILED=1
+  fi
+}
+
+check instructions "[INSTRUCTION LIMIT REACHED]" 100 --max-instructions=100
+check trace "[TRACE LIMIT REACHED]" 16 --max-trace-bytes=1000
+check seconds "[TIME LIMIT REACHED]" 0 --max-seconds=0.2 --no-trace
+
+for option in --max-instructions=abc --max-instructions=-1 --max-trace-bytes=1e3 --max-seconds=-1 --max-seconds=inf
+do
+  if timeout 5 "$SIMULATOR" "$DIRECTORY/limits.s" "$WORK/output.txt" "$option" > /dev/null 2>&1
+  then
+    echo "$option: FAILED (accepted)"
+    FAILED=1
+  else
+    echo "$option: ok"
+  fi
+done
+
+exit $FAILED
@@ -0,0 +1,46 @@
+// Follows the Collatz sequence from seed, storing each value in a ring of
+// eight words, and prints the step count and the last stored word modulo 26
+// as letters
+.text
+  bun main
+  .align 5
+main:
+  l32 r2, [seed]
+  mov r3, 0
+  mov r6, ring
+  divi r6, r6, 4
+step:
+  cmpi r2, 1
+  beq done
+  mov r7, 7
+  and r8, r3, r7
+  add r8, r8, r6
+  s32 [r8], r2
+  addi r3, r3, 1
+  mov r7, 1
+  and r4, r2, r7
+  cmpi r4, 0
+  beq even
+  muli r2, r2, 3
+  addi r2, r2, 1
+  bun step
+even:
+  divi r2, r2, 2
+  bun step
+done:
+  l32 r1, [term]
+  modi r4, r3, 26
+  addi r4, r4, 0x41
+  s8 [r1], r4
+  l32 r5, [r8]
+  modi r5, r5, 26
+  addi r5, r5, 0x41
+  s8 [r1], r5
+  int 0
+.data
+seed:
+  .4byte 27
+term:
+  .4byte 0x8888888B
+ring:
+  .fill 8, 4, 0
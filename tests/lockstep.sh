@@ -0,0 +1,66 @@
+#!/bin/sh
+# Lockstep test
+#
+# Usage: tests/lockstep.sh <simulator>
+#
+# Runs lockstep.s, a Collatz walk whose branches and stores depend on the
+# seed, with eleven seeds: one full group of eight lanes and a partial one,
+# whose lanes diverge and leave the group for the terminal at different
+# times. The untraced lockstep outputs, with AVX2 and portable lanes and on
+# two workers, must match the plain batch, and seed 27 must print HC (111
+# steps, last value 2). Exits with status 1 when an output differs.
+
+set -u
+
+SIMULATOR=${1:?usage: lockstep.sh <simulator>}
+DIRECTORY=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+SEEDS="1 2 3 6 7 9 27 97 871 6171 77031"
+FAILED=0
+
+for seed in $SEEDS
+do
+  sed "/^seed:/{n;s/.*/  .4byte $seed/;}" "$DIRECTORY/lockstep.s" > "$WORK/seed$seed.s"
+done
+
+# Runs the seeds as one untraced batch with the given options, outputs in
+# $WORK/<name>
+run()
+{
+  name=$1
+  shift
+  mkdir "$WORK/$name"
+  for seed in $SEEDS
+  do
+    echo "$WORK/seed$seed.s $WORK/$name/seed$seed.out"
+  done > "$WORK/$name.txt"
+  "$SIMULATOR" --batch="$WORK/$name.txt" --no-trace "$@" > /dev/null
+}
+
+run reference --jobs=1
+
+terminal=$(sed -n '/^\[TERMINAL\]$/{n;p;}' "$WORK/reference/seed27.out")
+if [ "$terminal" != "HC" ]
+then
+  echo "reference: FAILED (seed 27 printed '$terminal', expected 'HC')"
+  FAILED=1
+fi
+
+run avx2 --jobs=1 --lockstep --simd=on
+run portable --jobs=1 --lockstep --simd=off
+run workers --jobs=2 --lockstep
+
+for name in avx2 portable workers
+do
+  if diff -r "$WORK/reference" "$WORK/$name" > /dev/null
+  then
+    echo "$name: ok"
+  else
+    echo "$name: FAILED (output differs from the plain batch)"
+    FAILED=1
+  fi
+done
+
+exit $FAILED
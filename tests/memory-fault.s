@@ -0,0 +1,32 @@
+// Prints F and then, as mode says, calls past the end of memory (0), pushes
+// with the stack pointer past it (1) or returns through it (2)
+.text
+  bun main
+  .align 5
+main:
+  mov sp, 0x7FFC
+  l32 r1, [term]
+  mov r2, 0x46
+  s8 [r1], r2
+  l32 r3, [mode]
+  cmpi r3, 1
+  beq stack
+  cmpi r3, 2
+  beq return
+  l32 r4, [outside]
+  divi r4, r4, 4
+  call [r4]
+stack:
+  l32 sp, [outside]
+  push r2
+  int 0
+return:
+  l32 sp, [outside]
+  ret
+.data
+mode:
+  .4byte 0
+outside:
+  .4byte 0x00010000
+term:
+  .4byte 0x8888888B
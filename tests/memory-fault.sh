@@ -0,0 +1,63 @@
+#!/bin/sh
+# Memory fault test
+#
+# Usage: tests/memory-fault.sh <simulator>
+#
+# Runs memory-fault.s in its three modes: a call past the end of memory, a
+# push and a return with the stack pointer past it. Each run must keep the
+# terminal output, report the faulting address in the trace, end with
+# [MEMORY FAULT] and exit with status 3. The three runs as one batch must be
+# counted as faulted and exit with status 3 too. Exits with status 1 when a
+# run misbehaves.
+
+set -u
+
+SIMULATOR=${1:?usage: memory-fault.sh <simulator>}
+DIRECTORY=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+FAILED=0
+
+# Runs the program in the given mode and checks the fault line, the
+# terminal, the end marker and the exit status
+check()
+{
+  mode=$1
+  address=$2
+  sed "/^mode:/{n;s/.*/  .4byte $mode/;}" "$DIRECTORY/memory-fault.s" > "$WORK/mode$mode.s"
+  "$SIMULATOR" "$WORK/mode$mode.s" "$WORK/mode$mode.txt" > /dev/null
+  status=$?
+  fault=$(grep -c "^\[MEMORY FAULT @ $address\]$" "$WORK/mode$mode.txt")
+  terminal=$(sed -n '/^\[TERMINAL\]$/{n;p;}' "$WORK/mode$mode.txt")
+  marker=$(tail -n 2 "$WORK/mode$mode.txt" | head -n 1)
+  if [ $status -eq 3 ] && [ "$fault" = "1" ] && [ "$terminal" = "F" ] && [ "$marker" = "[MEMORY FAULT]" ]
+  then
+    echo "mode $mode: ok"
+  else
+    echo "mode $mode: FAILED (status $status, fault lines $fault at $address, terminal '$terminal', marker '$marker')"
+    FAILED=1
+  fi
+}
+
+check 0 0x00010000
+check 1 0x00010000
+check 2 0x00010004
+
+for mode in 0 1 2
+do
+  echo "$WORK/mode$mode.s $WORK/batch$mode.txt"
+done > "$WORK/manifest.txt"
+
+"$SIMULATOR" --batch="$WORK/manifest.txt" --jobs=2 --no-trace --stats > /dev/null 2> "$WORK/stats.txt"
+status=$?
+jobs=$(grep '^Jobs:' "$WORK/stats.txt")
+if [ $status -eq 3 ] && [ "$jobs" = "Jobs: 3 (0 failed, 0 stopped by a limit, 3 faulted) on 2 workers" ]
+then
+  echo "batch: ok"
+else
+  echo "batch: FAILED (status $status, '$jobs')"
+  FAILED=1
+fi
+
+exit $FAILED
@@ -0,0 +1,18 @@
+// A load followed by its use, an ALU result used by the next instruction
+// and a taken branch, three times round a loop
+.text
+  bun main
+  .align 5
+main:
+  mov r5, 3
+loop:
+  l32 r1, [value]
+  add r2, r1, r1
+  add r3, r2, r2
+  subi r5, r5, 1
+  cmpi r5, 0
+  bne loop
+  int 0
+.data
+value:
+  .4byte 7
@@ -0,0 +1,68 @@
+#!/bin/sh
+# Pipeline model test
+#
+# Usage: tests/pipeline.sh <simulator>
+#
+# Runs pipeline.s, a loop with a load-use pair, dependent ALU instructions
+# and a taken branch, with forwarding on and off. With forwarding only the
+# load-use pairs stall; without it every dependence waits for write back.
+# Each [PIPELINE] report must match the expected stalls and flushes per PC.
+# Exits with status 1 when a report differs.
+
+set -u
+
+SIMULATOR=${1:?usage: pipeline.sh <simulator>}
+DIRECTORY=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+FAILED=0
+
+cat > "$WORK/on.expected" << 'END'
+[PIPELINE]
+Forwarding: on
+Instructions: 21
+Cycles: 34
+CPI: 1.619
+Load-use stall cycles: 3
+Data hazard stall cycles: 0
+Branch flush cycles: 6 (3 flushes)
+Interrupt flush cycles: 0 (0 flushes)
+PC             Load-use       Data     Branch  Interrupt
+0x00000000            0          0          2          0
+0x00000028            3          0          0          0
+0x00000038            0          0          4          0
+END
+
+cat > "$WORK/off.expected" << 'END'
+[PIPELINE]
+Forwarding: off
+Instructions: 21
+Cycles: 55
+CPI: 2.619
+Load-use stall cycles: 6
+Data hazard stall cycles: 18
+Branch flush cycles: 6 (3 flushes)
+Interrupt flush cycles: 0 (0 flushes)
+PC             Load-use       Data     Branch  Interrupt
+0x00000000            0          0          2          0
+0x00000028            6          0          0          0
+0x0000002C            0          6          0          0
+0x00000034            0          6          0          0
+0x00000038            0          6          4          0
+END
+
+for forwarding in on off
+do
+  "$SIMULATOR" "$DIRECTORY/pipeline.s" "$WORK/output.txt" --no-trace --pipeline="$WORK/$forwarding.txt" --pipeline-forwarding=$forwarding > /dev/null
+  if diff "$WORK/$forwarding.expected" "$WORK/$forwarding.txt" > /dev/null
+  then
+    echo "forwarding $forwarding: ok"
+  else
+    echo "forwarding $forwarding: FAILED"
+    diff "$WORK/$forwarding.expected" "$WORK/$forwarding.txt"
+    FAILED=1
+  fi
+done
+
+exit $FAILED
@@ -0,0 +1,22 @@
+// A backward loop branch taken nine times out of ten, a forward branch
+// taken every other iteration and a call and return each iteration
+.text
+  bun main
+  .align 5
+leaf:
+  ret
+main:
+  mov sp, 0x7FFC
+  mov r5, 10
+loop:
+  mov r8, 1
+  and r6, r5, r8
+  cmpi r6, 0
+  beq even
+  addi r7, r7, 1
+even:
+  call leaf
+  subi r5, r5, 1
+  cmpi r5, 0
+  bne loop
+  int 0
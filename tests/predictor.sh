@@ -0,0 +1,50 @@
+#!/bin/sh
+# Branch predictor test
+#
+# Usage: tests/predictor.sh <simulator>
+#
+# Runs predictor.s, a ten-iteration loop with a forward branch taken every
+# other iteration and a call and return each iteration, under each predictor
+# model. The report must give the expected mispredictions of the forward beq
+# and the backward bne, and the return stack must predict every return.
+# Exits with status 1 when a report differs.
+
+set -u
+
+SIMULATOR=${1:?usage: predictor.sh <simulator>}
+DIRECTORY=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+FAILED=0
+
+# Runs the program with the given predictor and compares, from the report,
+# the mispredicted beq, bne and return counts and the penalty line
+check()
+{
+  model=$1
+  expected=$2
+  shift 2
+  "$SIMULATOR" "$DIRECTORY/predictor.s" "$WORK/output.txt" --no-trace --predictor=$model --predictor-report="$WORK/report.txt" "$@" > /dev/null
+  reported=$(awk '
+    $1 == "0x00000038" { beq = $3 }
+    $1 == "0x0000004C" { bne = $3 }
+    $1 == "Return:" { ret = $4 }
+    $1 == "Mispredict" { penalty = $3 }
+    END { print beq, bne, ret, penalty }
+  ' "$WORK/report.txt")
+  if [ "$reported" = "$expected" ]
+  then
+    echo "$model: ok"
+  else
+    echo "$model: FAILED (beq, bne, return mispredictions and penalty '$reported', expected '$expected')"
+    FAILED=1
+  fi
+}
+
+check btfn "5 1 0 12"
+check bimodal "10 2 0 24"
+check gshare:4 "2 6 0 16"
+check btfn "5 1 0 30" --predictor-penalty=5
+
+exit $FAILED
@@ -0,0 +1,19 @@
+// main calls leaf three times and outer twice; outer calls leaf once
+.text
+  bun main
+  .align 5
+leaf:
+  addi r1, r1, 1
+  ret
+outer:
+  call leaf
+  addi r2, r2, 1
+  ret
+main:
+  mov sp, 0x7FFC
+  call leaf
+  call leaf
+  call leaf
+  call outer
+  call outer
+  int 0
@@ -0,0 +1,51 @@
+#!/bin/sh
+# Profiler test
+#
+# Usage: tests/profile.sh <simulator>
+#
+# Runs profile.s, where main calls leaf three times and outer twice and outer
+# calls leaf once, with --profile and --profile-folded. The flat profile must
+# attribute the calls and instructions to each function by label, and the
+# folded stacks must split leaf's instructions between its two call paths.
+# Exits with status 1 when either report differs.
+
+set -u
+
+SIMULATOR=${1:?usage: profile.sh <simulator>}
+DIRECTORY=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+FAILED=0
+
+cat > "$WORK/profile.expected" << 'END'
+[PROFILE]
+Function            Calls      Exclusive    Excl%      Inclusive    Incl%
+leaf                    5             10   41.67%             10   41.67%
+0x00000000              1              8   33.33%             24  100.00%
+outer                   2              6   25.00%             10   41.67%
+Total instructions: 24
+END
+
+cat > "$WORK/folded.expected" << 'END'
+0x00000000 8
+0x00000000;leaf 6
+0x00000000;outer 6
+0x00000000;outer;leaf 4
+END
+
+"$SIMULATOR" "$DIRECTORY/profile.s" "$WORK/output.txt" --no-trace --profile="$WORK/profile.txt" --profile-folded="$WORK/folded.txt" > /dev/null
+
+for name in profile folded
+do
+  if diff "$WORK/$name.expected" "$WORK/$name.txt" > /dev/null
+  then
+    echo "$name: ok"
+  else
+    echo "$name: FAILED"
+    diff "$WORK/$name.expected" "$WORK/$name.txt"
+    FAILED=1
+  fi
+done
+
+exit $FAILED
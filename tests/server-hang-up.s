@@ -0,0 +1,20 @@
+// Prints S and stops, or spins forever when forever is set
+.text
+  bun main
+  .align 5
+main:
+  l32 r1, [forever]
+  cmpi r1, 0
+  beq done
+spin:
+  bun spin
+done:
+  l32 r1, [term]
+  mov r2, 0x53
+  s8 [r1], r2
+  int 0
+.data
+forever:
+  .4byte 0
+term:
+  .4byte 0x8888888B
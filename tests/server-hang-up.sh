@@ -0,0 +1,43 @@
+#!/bin/sh
+# Server hang-up test
+#
+# Usage: tests/server-hang-up.sh <simulator> <client>
+#
+# Starts a one-worker server and sends it server-hang-up.s with forever set
+# and --no-trace, from a client killed after a second. The worker must notice
+# the hang-up and serve the next client, which runs the program with forever
+# clear and must get its S back. Exits with status 1 when it does not.
+
+set -u
+
+SIMULATOR=${1:?usage: server-hang-up.sh <simulator> <client>}
+CLIENT=${2:?usage: server-hang-up.sh <simulator> <client>}
+DIRECTORY=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+SOCKET="$WORK/poxim.sock"
+
+"$SIMULATOR" --serve="$SOCKET" --jobs=1 &
+SERVER=$!
+trap 'kill $SERVER; rm -rf "$WORK"' EXIT
+
+sed "/^forever:/{n;s/.*/  .4byte 1/;}" "$DIRECTORY/server-hang-up.s" > "$WORK/forever.s"
+
+for attempt in 1 2 3 4 5 6 7 8 9 10
+do
+  [ -S "$SOCKET" ] && break
+  sleep 0.1
+done
+
+timeout 1 "$CLIENT" "$WORK/forever.s" "$WORK/forever.txt" --no-trace --socket="$SOCKET" > /dev/null
+timeout 5 "$CLIENT" "$DIRECTORY/server-hang-up.s" "$WORK/output.txt" --socket="$SOCKET" > /dev/null
+status=$?
+
+terminal=$(sed -n '/^\[TERMINAL\]$/{n;p;}' "$WORK/output.txt" 2> /dev/null)
+
+if [ $status -eq 0 ] && [ "$terminal" = "S" ]
+then
+  echo "hang-up: ok"
+else
+  echo "hang-up: FAILED (next client exited with $status, terminal '$terminal', expected 'S')"
+  exit 1
+fi
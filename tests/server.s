@@ -0,0 +1,30 @@
+// Prints SERVED a character at a time and stops, or spins forever before
+// printing when spin is set
+.text
+  bun main
+  .align 5
+main:
+  l32 r1, [term]
+  l32 r2, [spin]
+  cmpi r2, 0
+  beq print
+forever:
+  bun forever
+print:
+  mov r3, text
+next:
+  l8 r4, [r3]
+  cmpi r4, 0
+  beq done
+  s8 [r1], r4
+  addi r3, r3, 1
+  bun next
+done:
+  int 0
+.data
+spin:
+  .4byte 0
+term:
+  .4byte 0x8888888B
+text:
+  .asciz "SERVED"
@@ -0,0 +1,69 @@
+#!/bin/sh
+# Server mode test
+#
+# Usage: tests/server.sh <simulator> <client>
+#
+# Starts a two-worker server and runs, through the client and on the command
+# line, server.s traced and untraced, server.s with spin set under an
+# instruction limit, and benchmarks/pushpop.hex under a limit. The client's
+# output file and exit status must match the command line's each time, the
+# status being 2 for the limited runs. Malformed client options must be
+# rejected. Exits with status 1 when a run differs.
+
+set -u
+
+SIMULATOR=${1:?usage: server.sh <simulator> <client>}
+CLIENT=${2:?usage: server.sh <simulator> <client>}
+DIRECTORY=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+SOCKET="$WORK/poxim.sock"
+
+"$SIMULATOR" --serve="$SOCKET" --jobs=2 &
+SERVER=$!
+trap 'kill $SERVER; rm -rf "$WORK"' EXIT
+
+FAILED=0
+
+sed "/^spin:/{n;s/.*/  .4byte 1/;}" "$DIRECTORY/server.s" > "$WORK/spin.s"
+
+for attempt in 1 2 3 4 5 6 7 8 9 10
+do
+  [ -S "$SOCKET" ] && break
+  sleep 0.1
+done
+
+# Runs the input on the server and on the command line with the given
+# options and compares the output files and exit statuses
+check()
+{
+  name=$1
+  input=$2
+  expected=$3
+  shift 3
+  timeout 10 "$CLIENT" "$input" "$WORK/$name.client" --socket="$SOCKET" "$@" > /dev/null
+  served=$?
+  "$SIMULATOR" "$input" "$WORK/$name.local" "$@" > /dev/null
+  direct=$?
+  if [ $served -eq $expected ] && [ $direct -eq $expected ] && cmp -s "$WORK/$name.client" "$WORK/$name.local"
+  then
+    echo "$name: ok"
+  else
+    echo "$name: FAILED (client status $served, command line status $direct, expected $expected, or the outputs differ)"
+    FAILED=1
+  fi
+}
+
+check traced "$DIRECTORY/server.s" 0
+check untraced "$DIRECTORY/server.s" 0 --no-trace
+check limited "$WORK/spin.s" 2 --max-instructions=500
+check hex "$DIRECTORY/../benchmarks/pushpop.hex" 2 --max-instructions=300
+
+if "$CLIENT" "$DIRECTORY/server.s" "$WORK/bad.txt" --socket="$SOCKET" --max-instructions=-1 > /dev/null 2>&1
+then
+  echo "bad limit: FAILED (--max-instructions=-1 accepted)"
+  FAILED=1
+else
+  echo "bad limit: ok"
+fi
+
+exit $FAILED
@@ -0,0 +1,22 @@
+// Prints the letter for value, increments value and overwrites the first
+// word of main, then prints the letter for value again
+.text
+  bun main
+  .align 5
+main:
+  l32 r1, [term]
+  l32 r2, [value]
+  addi r3, r2, 0x41
+  s8 [r1], r3
+  addi r2, r2, 1
+  s32 [value], r2
+  s32 [main], r2
+  l32 r4, [value]
+  addi r4, r4, 0x41
+  s8 [r1], r4
+  int 0
+.data
+value:
+  .4byte 0
+term:
+  .4byte 0x8888888B
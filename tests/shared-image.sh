@@ -0,0 +1,64 @@
+#!/bin/sh
+# Shared program image test
+#
+# Usage: tests/shared-image.sh <simulator>
+#
+# Lists shared-image.s twelve times in one manifest, so every job loads the
+# same shared image, and runs it one job at a time, with all twelve guests
+# resident and interleaved two instructions per turn, and in lockstep. Each
+# guest writes its data and code pages; if a write reached the image or
+# another guest, a later job would print other letters. Every traced output
+# must match the output of running the program on its own. Exits with status
+# 1 when an output differs.
+
+set -u
+
+SIMULATOR=${1:?usage: shared-image.sh <simulator>}
+DIRECTORY=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+FAILED=0
+
+"$SIMULATOR" "$DIRECTORY/shared-image.s" "$WORK/reference.out" > /dev/null
+
+terminal=$(sed -n '/^\[TERMINAL\]$/{n;p;}' "$WORK/reference.out")
+if [ "$terminal" != "AB" ]
+then
+  echo "reference: FAILED (terminal '$terminal', expected 'AB')"
+  FAILED=1
+fi
+
+# Runs the twelve jobs with the given options and compares each output with
+# the single run
+run()
+{
+  name=$1
+  shift
+  mkdir "$WORK/$name"
+  for job in 1 2 3 4 5 6 7 8 9 10 11 12
+  do
+    echo "$DIRECTORY/shared-image.s $WORK/$name/job$job.out"
+  done > "$WORK/$name.txt"
+  "$SIMULATOR" --batch="$WORK/$name.txt" "$@" > /dev/null
+
+  differing=0
+  for job in 1 2 3 4 5 6 7 8 9 10 11 12
+  do
+    cmp -s "$WORK/reference.out" "$WORK/$name/job$job.out" || differing=$((differing + 1))
+  done
+
+  if [ $differing -eq 0 ]
+  then
+    echo "$name: ok"
+  else
+    echo "$name: FAILED ($differing of 12 outputs differ from the single run)"
+    FAILED=1
+  fi
+}
+
+run sequential --jobs=1
+run interleaved --jobs=1 --quantum=2 --resident=12
+run lockstep --jobs=1 --lockstep
+
+exit $FAILED
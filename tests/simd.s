@@ -0,0 +1,145 @@
+// Counts the Collatz steps of the 200 values after seed, so lanes with
+// different seeds take different branches in a lockstep group. Then adds,
+// multiplies and divides two 13-element vectors (a group of eight and a tail
+// of five) on the vector FPU and prints the step count and the XOR of the
+// quotients in hex.
+.text
+  bun main
+  .4byte 0
+  .4byte 0
+  .4byte 0
+  bun isr
+  bun isr
+  bun isr
+  .align 5
+isr:
+  addi r5, r5, 1
+  reti
+main:
+  mov sp, 0x7FFC
+  l32 r1, [seed]
+  mov r10, 0
+  mov r11, 0
+next:
+  add r2, r1, r11
+step:
+  cmpi r2, 1
+  beq done
+  mov r6, 1
+  and r4, r2, r6
+  cmpi r4, 0
+  beq even
+  muli r2, r2, 3
+  addi r2, r2, 1
+  addi r10, r10, 1
+  bun step
+even:
+  srl r0, r2, r2, 0
+  addi r10, r10, 1
+  bun step
+done:
+  addi r11, r11, 1
+  cmpi r11, 200
+  bne next
+
+  // z = x + y, then z = z * y, then z = z / y
+  l32 r2, [fpu]
+  mov r3, xa
+  s32 [r2+4], r3
+  mov r3, ya
+  s32 [r2+5], r3
+  mov r3, 0x4000
+  s32 [r2+6], r3
+  mov r3, 13
+  s32 [r2+7], r3
+  mov r3, 0x41
+  s32 [r2+3], r3
+wait1:
+  cmpi r5, 0
+  beq wait1
+  mov r3, 0x4000
+  s32 [r2+4], r3
+  mov r3, 0x43
+  s32 [r2+3], r3
+wait2:
+  cmpi r5, 1
+  beq wait2
+  mov r3, 0x44
+  s32 [r2+3], r3
+wait3:
+  cmpi r5, 2
+  beq wait3
+
+  mov r12, 0
+  mov r13, 0x1000
+  mov r7, 13
+sum:
+  l32 r8, [r13]
+  xor r12, r12, r8
+  addi r13, r13, 1
+  subi r7, r7, 1
+  cmpi r7, 0
+  bne sum
+
+  l32 r1, [term]
+  add r9, r10, r0
+  call print
+  add r9, r12, r0
+  call print
+  int 0
+
+// r9 as eight hex digits and a newline
+print:
+  mov r7, 8
+digit:
+  srl r0, r8, r9, 27
+  sll r0, r9, r9, 3
+  cmpi r8, 10
+  blt number
+  addi r8, r8, 55
+  bun out
+number:
+  addi r8, r8, 48
+out:
+  s8 [r1], r8
+  subi r7, r7, 1
+  cmpi r7, 0
+  bne digit
+  mov r8, 10
+  s8 [r1], r8
+  ret
+.data
+seed:
+  .4byte 1
+fpu:
+  .4byte 0x20202220
+term:
+  .4byte 0x8888888B
+xa:
+  .4byte 0xC251A0D8
+  .4byte 0x410D8895
+  .4byte 0xC1D0125D
+  .4byte 0x41A645A6
+  .4byte 0x41C92709
+  .4byte 0xC2ADC9D8
+  .4byte 0xC2C2BB99
+  .4byte 0x4286FCD6
+  .4byte 0xC240844C
+  .4byte 0xC2548905
+  .4byte 0x42C64208
+  .4byte 0xC0BE5045
+  .4byte 0x428695A7
+ya:
+  .4byte 0xC2A104AE
+  .4byte 0xC2919CCA
+  .4byte 0xC2626913
+  .4byte 0x42BA312B
+  .4byte 0xC14C4833
+  .4byte 0x41CAA324
+  .4byte 0xC21F2DD6
+  .4byte 0x3FB96B9E
+  .4byte 0xC1B69D2E
+  .4byte 0xC1EE8B10
+  .4byte 0x41881E5B
+  .4byte 0x4186CD89
+  .4byte 0x42A1AE43
@@ -0,0 +1,61 @@
+#!/bin/sh
+# SIMD test
+#
+# Usage: tests/simd.sh <simulator>
+#
+# Runs simd.s with eight different seeds as a batch with --simd=off, which
+# is the scalar reference, then as a batch with --simd=on (the AVX2 vector
+# FPU kernel) and in lockstep with --simd=on and --simd=off (the AVX2 and
+# portable lane vectors). Every output must match the reference. Without
+# AVX2 on this CPU both settings run the portable code. Exits with status 1
+# when an output differs.
+
+set -u
+
+SIMULATOR=${1:?usage: simd.sh <simulator>}
+DIRECTORY=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+FAILED=0
+
+if ! grep -qw avx2 /proc/cpuinfo 2> /dev/null
+then
+  echo "note: no AVX2 on this CPU, only the portable code is checked"
+fi
+
+for seed in 1 7 27 97 871 6171 77031 837799
+do
+  sed "/^seed:/{n;s/.*/  .4byte $seed/;}" "$DIRECTORY/simd.s" > "$WORK/seed$seed.s"
+done
+
+# Runs the seeds as one batch with the given options, outputs in $WORK/<name>
+run()
+{
+  name=$1
+  shift
+  mkdir "$WORK/$name"
+  for seed in 1 7 27 97 871 6171 77031 837799
+  do
+    echo "$WORK/seed$seed.s $WORK/$name/seed$seed.out"
+  done > "$WORK/$name.txt"
+  "$SIMULATOR" --batch="$WORK/$name.txt" "$@" --no-trace > /dev/null
+}
+
+run reference --simd=off
+run batch --simd=on
+run lockstep --lockstep --simd=on
+run portable --lockstep --simd=off
+
+for name in batch lockstep portable
+do
+  if diff -r "$WORK/reference" "$WORK/$name" > /dev/null
+  then
+    echo "$name: ok"
+  else
+    echo "$name: FAILED (output differs from --simd=off)"
+    FAILED=1
+  fi
+done
+
+exit $FAILED
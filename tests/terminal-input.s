@@ -0,0 +1,67 @@
+// Copies terminal input to the terminal with lower case letters made upper
+// case, polling the status byte, or from the input interrupt when interrupt
+// is set
+.text
+  bun main
+  bun main
+  bun main
+  bun main
+  bun hardware1
+  .align 5
+hardware1:
+  call echo
+  reti
+// Reads one byte and writes it, upper case
+echo:
+  l8 r4, [r2]
+  cmpi r4, 0x61
+  blt write
+  cmpi r4, 0x7A
+  bgt write
+  subi r4, r4, 0x20
+write:
+  s8 [r3], r4
+  ret
+main:
+  mov sp, 0x7FFC
+  l32 r1, [status]
+  l32 r2, [input]
+  l32 r3, [term]
+  l32 r5, [interrupt]
+  cmpi r5, 0
+  beq poll
+
+  mov sr, 2
+  mov r6, 4
+  s8 [r1], r6
+wait:
+  l8 r6, [r1]
+  mov r7, 2
+  and r6, r6, r7
+  cmpi r6, 0
+  beq wait
+  int 0
+
+poll:
+  l8 r6, [r1]
+  mov r7, 1
+  and r7, r6, r7
+  cmpi r7, 0
+  beq empty
+  call echo
+  bun poll
+empty:
+  mov r7, 2
+  and r7, r6, r7
+  cmpi r7, 0
+  beq poll
+  int 0
+.data
+interrupt:
+  .4byte 0
+status:
+  .4byte 0x88888889
+input:
+  .4byte 0x8888888A
+term:
+  .4byte 0x8888888B
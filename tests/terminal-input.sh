@@ -0,0 +1,57 @@
+#!/bin/sh
+# Terminal input test
+#
+# Usage: tests/terminal-input.sh <simulator>
+#
+# Runs terminal-input.s, which copies its input to the terminal in upper
+# case, polling and from the input interrupt, on a short file, on 200000
+# bytes (several host refills) and on a named pipe written in two parts a
+# moment apart. The terminal must hold the input in upper case each time.
+# Exits with status 1 when an output differs.
+
+set -u
+
+SIMULATOR=${1:?usage: terminal-input.sh <simulator>}
+DIRECTORY=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+FAILED=0
+
+sed "/^interrupt:/{n;s/.*/  .4byte 1/;}" "$DIRECTORY/terminal-input.s" > "$WORK/interrupt.s"
+cp "$DIRECTORY/terminal-input.s" "$WORK/poll.s"
+
+printf 'Hello, Poxim!\nline two\n' > "$WORK/short.txt"
+awk 'BEGIN { for (i = 0; i < 5000; i++) printf "line %d of the long input\n", i }' | head -c 200000 > "$WORK/long.txt"
+
+# Runs the program with the given input and compares the streamed terminal
+# with the input in upper case
+check()
+{
+  name=$1
+  program=$2
+  input=$3
+  expected=$4
+  "$SIMULATOR" "$WORK/$program.s" "$WORK/output.txt" --no-trace --terminal-input="$input" --terminal-stream="$WORK/$name.out" > /dev/null
+  if tr a-z A-Z < "$expected" | cmp -s - "$WORK/$name.out"
+  then
+    echo "$name: ok"
+  else
+    echo "$name: FAILED (terminal differs from the input in upper case)"
+    FAILED=1
+  fi
+}
+
+for program in poll interrupt
+do
+  check "$program short" $program "$WORK/short.txt" "$WORK/short.txt"
+  check "$program long" $program "$WORK/long.txt" "$WORK/long.txt"
+
+  mkfifo "$WORK/pipe"
+  (head -c 100 "$WORK/long.txt"; sleep 0.3; tail -c +101 "$WORK/long.txt") > "$WORK/pipe" &
+  check "$program pipe" $program "$WORK/pipe" "$WORK/long.txt"
+  wait
+  rm "$WORK/pipe"
+done
+
+exit $FAILED
@@ -0,0 +1,48 @@
+// Prints count lines of the alphabet, then READY, then spins forever when
+// spin is set
+.text
+  bun main
+  .align 5
+main:
+  l32 r1, [term]
+  l32 r2, [count]
+line:
+  cmpi r2, 0
+  beq ready
+  mov r3, 0x41
+letter:
+  s8 [r1], r3
+  addi r3, r3, 1
+  cmpi r3, 0x5B
+  bne letter
+  mov r3, 10
+  s8 [r1], r3
+  subi r2, r2, 1
+  bun line
+ready:
+  mov r3, text
+next:
+  l8 r4, [r3]
+  cmpi r4, 0
+  beq done
+  s8 [r1], r4
+  addi r3, r3, 1
+  bun next
+done:
+  l32 r2, [spin]
+  cmpi r2, 0
+  beq stop
+forever:
+  addi r5, r5, 1
+  bun forever
+stop:
+  int 0
+.data
+count:
+  .4byte 100
+spin:
+  .4byte 0
+term:
+  .4byte 0x8888888B
+text:
+  .asciz "READY\n"
@@ -0,0 +1,55 @@
+#!/bin/sh
+# Terminal stream test
+#
+# Usage: tests/terminal-stream.sh <simulator>
+#
+# Runs terminal-stream.s, which prints a hundred lines and READY, with
+# --terminal-stream; the streamed file must hold exactly what the [TERMINAL]
+# section of a normal run holds. Then runs it with spin set, so it never
+# stops after READY: the whole text must reach the stream file while the
+# simulator is still running. Exits with status 1 when a check fails.
+
+set -u
+
+SIMULATOR=${1:?usage: terminal-stream.sh <simulator>}
+DIRECTORY=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+FAILED=0
+
+"$SIMULATOR" "$DIRECTORY/terminal-stream.s" "$WORK/buffered.txt" --no-trace > /dev/null
+# The front end ends the [TERMINAL] section with a newline of its own
+sed -n '/^\[TERMINAL\]$/,/^\[END OF SIMULATION\]$/p' "$WORK/buffered.txt" | sed '1d;$d' | head -c -1 > "$WORK/expected.txt"
+"$SIMULATOR" "$DIRECTORY/terminal-stream.s" "$WORK/output.txt" --no-trace --terminal-stream="$WORK/stream.txt" > /dev/null
+
+if [ "$(wc -c < "$WORK/expected.txt")" -eq 2706 ] && cmp -s "$WORK/expected.txt" "$WORK/stream.txt" && ! grep -q '^\[TERMINAL\]$' "$WORK/output.txt"
+then
+  echo "stream: ok"
+else
+  echo "stream: FAILED (streamed text differs from the [TERMINAL] section, or the output still has one)"
+  FAILED=1
+fi
+
+sed "/^spin:/{n;s/.*/  .4byte 1/;}" "$DIRECTORY/terminal-stream.s" > "$WORK/spin.s"
+"$SIMULATOR" "$WORK/spin.s" "$WORK/spin.txt" --no-trace --terminal-stream="$WORK/spin-stream.txt" > /dev/null &
+RUNNING=$!
+
+for attempt in 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20
+do
+  cmp -s "$WORK/expected.txt" "$WORK/spin-stream.txt" && break
+  sleep 0.25
+done
+
+if cmp -s "$WORK/expected.txt" "$WORK/spin-stream.txt" && kill $RUNNING 2> /dev/null
+then
+  echo "running: ok"
+else
+  echo "running: FAILED (the text did not reach the stream file while the guest ran)"
+  kill $RUNNING 2> /dev/null
+  FAILED=1
+fi
+
+wait $RUNNING 2> /dev/null
+
+exit $FAILED
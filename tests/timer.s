@@ -0,0 +1,56 @@
+// Runs the interval timer periodically with a reload of 25 counts, a
+// prescaler of 3 (four ticks per count) and a compare value of 10, so it
+// matches 40 ticks after it starts and every 100 after that. The handler
+// prints . when the count it reads is still 10, and after three matches the
+// program stops the timer and prints C when the count then reads 0.
+.text
+  bun main
+  bun main
+  bun main
+  bun main
+  bun hardware1
+  .align 5
+hardware1:
+  l32 r6, [r1+4]
+  addi r5, r5, 1
+  mov r9, 0x58
+  cmpi r6, 10
+  bne put
+  mov r9, 0x2E
+put:
+  s8 [r3], r9
+  // Leaves the flags the interrupted wait loop tests
+  cmpi r5, 3
+  reti
+main:
+  mov sp, 0x7FFC
+  l32 r1, [timer]
+  l32 r3, [term]
+  mov r5, 0
+  mov sr, 2
+  mov r2, 25
+  s32 [r1+1], r2
+  mov r2, 3
+  s32 [r1+2], r2
+  mov r2, 10
+  s32 [r1+3], r2
+  mov r2, 3
+  s32 [r1], r2
+wait:
+  cmpi r5, 3
+  bne wait
+  mov r2, 0
+  s32 [r1], r2
+  l32 r6, [r1+4]
+  mov r9, 0x58
+  cmpi r6, 0
+  bne stopped
+  mov r9, 0x43
+stopped:
+  s8 [r3], r9
+  int 0
+.data
+timer:
+  .4byte 0x202022A0
+term:
+  .4byte 0x8888888B
@@ -0,0 +1,36 @@
+#!/bin/sh
+# Interval timer test
+#
+# Usage: tests/timer.sh <simulator>
+#
+# Runs timer.s, which starts the interval timer in periodic mode with a
+# prescaler and waits for three compare matches. The terminal must show the
+# count read at each match and the count of the stopped timer, and the
+# matches must be taken 39, 139 and 239 instructions after the store that
+# starts the timer: the first at the compare value, the others a whole
+# period later. Exits with status 1 when the run misbehaves.
+
+set -u
+
+SIMULATOR=${1:?usage: timer.sh <simulator>}
+DIRECTORY=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+FAILED=0
+
+"$SIMULATOR" "$DIRECTORY/timer.s" "$WORK/timer.txt" > /dev/null
+status=$?
+terminal=$(sed -n '/^\[TERMINAL\]$/{n;p;}' "$WORK/timer.txt")
+matches=$(awk '/^\[HARDWARE INTERRUPTION 1\]$/ { printf "%s%d", separator, count - start; separator = " "; next }
+               /MEM\[0x80808A80\]=R2=0x00000003$/ { start = count + 1 }
+               /^0x/ { count++ }' "$WORK/timer.txt")
+if [ $status -eq 0 ] && [ "$terminal" = "...C" ] && [ "$matches" = "39 139 239" ]
+then
+  echo "timer: ok"
+else
+  echo "timer: FAILED (status $status, terminal '$terminal', matches after '$matches' instructions)"
+  FAILED=1
+fi
+
+exit $FAILED
@@ -0,0 +1,34 @@
+// One instruction of each timing class, then a watchdog of 12 ticks that
+// expires inside a loop of muli instructions
+.text
+  bun main
+  bun main
+  bun main
+  bun main
+  bun watchdog
+  .align 5
+leaf:
+  ret
+watchdog:
+  int 0
+main:
+  mov sp, 0x7FFC
+  muli r2, r1, 3
+  l32 r3, [value]
+  cmpi r3, 0
+  beq main
+  call leaf
+  l32 r1, [watchdogAddress]
+  l32 r2, [watchdogArm]
+  mov sr, 2
+  s32 [r1], r2
+spin:
+  muli r4, r4, 3
+  bun spin
+.data
+value:
+  .4byte 1
+watchdogAddress:
+  .4byte 0x20202020
+watchdogArm:
+  .4byte 0x8000000C
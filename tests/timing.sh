@@ -0,0 +1,51 @@
+#!/bin/sh
+# Timing model test
+#
+# Usage: tests/timing.sh <simulator>
+#
+# Runs timing.s with the default costs, with the watchdog counting cycles
+# instead of instructions, and with cheaper muldiv and taken costs. Each run
+# must report the expected instructions and cycles: on cycles the watchdog
+# expires after fewer instructions, and cheaper costs delay it again. A zero
+# cost must be rejected. Exits with status 1 when a run differs.
+
+set -u
+
+SIMULATOR=${1:?usage: timing.sh <simulator>}
+DIRECTORY=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+FAILED=0
+
+# Runs the program with the given options and compares the [TIMING] report
+check()
+{
+  name=$1
+  instructions=$2
+  cycles=$3
+  shift 3
+  "$SIMULATOR" "$DIRECTORY/timing.s" "$WORK/output.txt" --no-trace "$@" > /dev/null 2> "$WORK/report.txt"
+  reported=$(awk '$1 == "Instructions:" { i = $2 } $1 == "Cycles:" { c = $2 } END { print i, c }' "$WORK/report.txt")
+  if [ "$reported" = "$instructions $cycles" ]
+  then
+    echo "$name: ok"
+  else
+    echo "$name: FAILED (instructions and cycles '$reported', expected '$instructions $cycles')"
+    FAILED=1
+  fi
+}
+
+check instructions 26 77 --timing
+check cycles 17 46 --timing --timer-clock=cycles
+check costs 25 39 --timing=muldiv=1,taken=1 --timer-clock=cycles
+
+if "$SIMULATOR" "$DIRECTORY/timing.s" "$WORK/output.txt" --no-trace --timing=alu=0 > /dev/null 2>&1
+then
+  echo "zero cost: FAILED (--timing=alu=0 accepted)"
+  FAILED=1
+else
+  echo "zero cost: ok"
+fi
+
+exit $FAILED
@@ -0,0 +1,124 @@
+// Adds up the Collatz steps of 1 to 300, a recursive sum of 1 to 50 and
+// the absolute values of -20 to 20 while the interval timer interrupts
+// every 97 instructions, and prints the three results and the interrupt
+// count in hex
+.text
+  bun main
+  bun main
+  bun main
+  bun main
+  bun tick
+  .align 5
+tick:
+  push sr
+  addi r20, r20, 1
+  pop sr
+  reti
+
+// r2 = r1 + (r1 - 1) + ... + 1
+sum:
+  cmpi r1, 0
+  bne deeper
+  mov r2, 0
+  ret
+deeper:
+  push r1
+  subi r1, r1, 1
+  call sum
+  pop r1
+  add r2, r2, r1
+  ret
+
+main:
+  mov sp, 0x7FFC
+  mov r20, 0
+  mov sr, 2
+  l32 r1, [timer]
+  mov r2, 97
+  s32 [r1+1], r2
+  mov r2, 0
+  s32 [r1+3], r2
+  mov r2, 3
+  s32 [r1], r2
+
+  mov r10, 0
+  mov r11, 1
+seed:
+  add r2, r11, r0
+step:
+  cmpi r2, 1
+  beq next
+  modi r4, r2, 2
+  cmpi r4, 0
+  beq even
+  muli r2, r2, 3
+  addi r2, r2, 1
+  addi r10, r10, 1
+  bun step
+even:
+  divi r2, r2, 2
+  addi r10, r10, 1
+  bun step
+next:
+  addi r11, r11, 1
+  cmpi r11, 301
+  bne seed
+
+  mov r1, 50
+  call sum
+  add r11, r2, r0
+
+  mov r12, 0
+  mov r3, 0
+  subi r3, r3, 20
+absolute:
+  cmpi r3, 0
+  bge positive
+  sub r12, r12, r3
+  bun counted
+positive:
+  add r12, r12, r3
+counted:
+  addi r3, r3, 1
+  cmpi r3, 21
+  blt absolute
+
+  mov r2, 0
+  l32 r1, [timer]
+  s32 [r1], r2
+  l32 r1, [term]
+  add r9, r10, r0
+  call print
+  add r9, r11, r0
+  call print
+  add r9, r12, r0
+  call print
+  add r9, r20, r0
+  call print
+  int 0
+
+// r9 as eight hex digits and a newline
+print:
+  mov r7, 8
+digit:
+  srl r0, r8, r9, 27
+  sll r0, r9, r9, 3
+  cmpi r8, 10
+  blt number
+  addi r8, r8, 55
+  bun out
+number:
+  addi r8, r8, 48
+out:
+  s8 [r1], r8
+  subi r7, r7, 1
+  cmpi r7, 0
+  bne digit
+  mov r8, 10
+  s8 [r1], r8
+  ret
+.data
+timer:
+  .4byte 0x202022A0
+term:
+  .4byte 0x8888888B
@@ -0,0 +1,64 @@
+#!/bin/sh
+# Translator test
+#
+# Usage: tests/translator.sh <simulator> [compiler]
+#
+# Translates translator.s with --translate, builds the C file with the
+# library sources and runs it. Its output must be the expected terminal,
+# the same the interpreter writes with --no-trace, both for the whole run,
+# where the timer interrupts go through the interpreter, and for a run cut
+# short with --max-instructions. The compiler defaults to cc. Exits with
+# status 1 when a step fails or an output differs.
+
+set -u
+
+SIMULATOR=${1:?usage: translator.sh <simulator> [compiler]}
+COMPILER=${2:-cc}
+DIRECTORY=$(cd "$(dirname "$0")" && pwd)
+SOURCES=$(cd "$DIRECTORY/.." && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+FAILED=0
+
+if ! "$SIMULATOR" --translate="$WORK/translated.c" "$DIRECTORY/translator.s" ||
+   ! "$COMPILER" -O1 -I"$SOURCES" -o "$WORK/translated" "$WORK/translated.c" "$SOURCES/poxim.c" "$SOURCES/reports.c" \
+       "$SOURCES/lockstep.c" "$SOURCES/assembler.c" "$SOURCES/analysis.c" "$SOURCES/translator.c" -lm
+then
+  echo "translate: FAILED"
+  exit 1
+fi
+
+# Runs the translation and the interpreter with the same options and
+# compares their outputs and exit statuses
+check()
+{
+  name=$1
+  shift
+  "$WORK/translated" "$WORK/$name-translated.txt" "$@" > /dev/null
+  translated=$?
+  "$SIMULATOR" "$DIRECTORY/translator.s" "$WORK/$name-interpreted.txt" --no-trace "$@" > /dev/null
+  interpreted=$?
+  if [ $translated -eq $interpreted ] && cmp -s "$WORK/$name-translated.txt" "$WORK/$name-interpreted.txt"
+  then
+    echo "$name: ok"
+  else
+    echo "$name: FAILED (status $translated translated, $interpreted interpreted)"
+    diff "$WORK/$name-interpreted.txt" "$WORK/$name-translated.txt"
+    FAILED=1
+  fi
+}
+
+check whole
+check limit --max-instructions=5000
+
+terminal=$(sed -n '/^\[TERMINAL\]$/,/^$/p' "$WORK/whole-translated.txt" | tr '\n' ' ')
+if [ "$terminal" = "[TERMINAL] 00003757 000004FB 000001A4 0000051D  " ]
+then
+  echo "terminal: ok"
+else
+  echo "terminal: FAILED ('$terminal')"
+  FAILED=1
+fi
+
+exit $FAILED
@@ -0,0 +1,202 @@
+// Adds two 10-element vectors on the vector FPU into sum, multiplies sum by
+// y in place and checks both results against tables, printing . for each
+// element that matches and X for each one that does not. Then divides by a
+// vector holding a zero, which must end in the error interrupt and leave
+// its destination alone. Last, starts an operation whose z array partly
+// overlaps x and one on arrays past the end of memory, which must both be
+// rejected with the ST flag and the error interrupt, printing O and S, and
+// the first must leave sum alone.
+.text
+  bun main
+  .4byte 0
+  .4byte 0
+  .4byte 0
+  bun isr
+  bun error
+  bun done
+  .align 5
+isr:
+  reti
+error:
+  addi r6, r6, 1
+  reti
+done:
+  addi r5, r5, 1
+  reti
+main:
+  mov sp, 0x7FFC
+  l32 r1, [term]
+  l32 r2, [fpu]
+  mov r5, 0
+  mov r6, 0
+
+  // sum = x + y
+  mov r3, xa
+  s32 [r2+4], r3
+  mov r3, ya
+  s32 [r2+5], r3
+  mov r3, sum
+  s32 [r2+6], r3
+  mov r3, 10
+  s32 [r2+7], r3
+  mov r3, 0x41
+  s32 [r2+3], r3
+wait1:
+  cmpi r5, 1
+  bne wait1
+  mov r7, sum
+  mov r8, sums
+  call check
+
+  // sum = sum * y
+  mov r3, sum
+  s32 [r2+4], r3
+  mov r3, 0x43
+  s32 [r2+3], r3
+wait2:
+  cmpi r5, 2
+  bne wait2
+  mov r7, sum
+  mov r8, products
+  call check
+
+  // sum = x / zero, which must leave sum alone
+  mov r3, xa
+  s32 [r2+4], r3
+  mov r3, zero
+  s32 [r2+5], r3
+  mov r3, 0x44
+  s32 [r2+3], r3
+wait3:
+  cmpi r6, 1
+  bne wait3
+  mov r7, sum
+  mov r8, products
+  call check
+  mov r9, 0x45
+  s8 [r1], r9
+
+  // sum + 4 = sum + y, which partly overlaps and must be rejected
+  mov r3, sum
+  s32 [r2+4], r3
+  mov r3, ya
+  s32 [r2+5], r3
+  mov r3, sum
+  addi r3, r3, 4
+  s32 [r2+6], r3
+  mov r3, 0x41
+  s32 [r2+3], r3
+  l32 r3, [r2+3]
+  mov r4, 0x20
+  and r3, r3, r4
+  mov r9, 0x4E
+  cmpi r3, 0x20
+  bne overlap
+  mov r9, 0x4F
+overlap:
+  s8 [r1], r9
+wait4:
+  cmpi r6, 2
+  bne wait4
+  mov r7, sum
+  mov r8, products
+  call check
+
+  // Arrays past the end of memory
+  mov r3, 0x7FF0
+  s32 [r2+6], r3
+  mov r3, 0x41
+  s32 [r2+3], r3
+  l32 r3, [r2+3]
+  mov r4, 0x20
+  and r3, r3, r4
+  mov r9, 0x4E
+  cmpi r3, 0x20
+  bne status
+  mov r9, 0x53
+status:
+  s8 [r1], r9
+  int 0
+
+// Compares the ten words at byte address r7 with the ten at r8
+check:
+  srl r0, r7, r7, 1
+  srl r0, r8, r8, 1
+  mov r4, 10
+compare:
+  l32 r10, [r7]
+  l32 r11, [r8]
+  mov r9, 0x2E
+  cmp r10, r11
+  beq match
+  mov r9, 0x58
+match:
+  s8 [r1], r9
+  addi r7, r7, 1
+  addi r8, r8, 1
+  subi r4, r4, 1
+  cmpi r4, 0
+  bne compare
+  ret
+.data
+fpu:
+  .4byte 0x20202220
+term:
+  .4byte 0x8888888B
+xa:
+  .4byte 0x3F800000
+  .4byte 0x40000000
+  .4byte 0x40400000
+  .4byte 0x40800000
+  .4byte 0x40A00000
+  .4byte 0x40C00000
+  .4byte 0x40E00000
+  .4byte 0x41000000
+  .4byte 0x41100000
+  .4byte 0x41200000
+ya:
+  .4byte 0x3E800000
+  .4byte 0x3F000000
+  .4byte 0x3F400000
+  .4byte 0x3F800000
+  .4byte 0x3FA00000
+  .4byte 0x3FC00000
+  .4byte 0x3FE00000
+  .4byte 0x40000000
+  .4byte 0x40100000
+  .4byte 0x40200000
+zero:
+  .4byte 0x3F800000
+  .4byte 0x3F800000
+  .4byte 0x3F800000
+  .4byte 0x3F800000
+  .4byte 0x3F800000
+  .4byte 0x3F800000
+  .4byte 0x80000000
+  .4byte 0x3F800000
+  .4byte 0x3F800000
+  .4byte 0x3F800000
+sums:
+  .4byte 0x3FA00000
+  .4byte 0x40200000
+  .4byte 0x40700000
+  .4byte 0x40A00000
+  .4byte 0x40C80000
+  .4byte 0x40F00000
+  .4byte 0x410C0000
+  .4byte 0x41200000
+  .4byte 0x41340000
+  .4byte 0x41480000
+products:
+  .4byte 0x3EA00000
+  .4byte 0x3FA00000
+  .4byte 0x40340000
+  .4byte 0x40A00000
+  .4byte 0x40FA0000
+  .4byte 0x41340000
+  .4byte 0x41750000
+  .4byte 0x41A00000
+  .4byte 0x41CA8000
+  .4byte 0x41FA0000
+sum:
+  .fill 40, 1, 0
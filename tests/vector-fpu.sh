@@ -0,0 +1,42 @@
+#!/bin/sh
+# Vector FPU test
+#
+# Usage: tests/vector-fpu.sh <simulator>
+#
+# Runs vector-fpu.s with --simd=on and --simd=off. The terminal must show a
+# match for every element of the sum and the in-place product, then E for
+# the division by a vector holding a zero, O for the rejected operation whose
+# z array partly overlaps x, a match for every element it left alone and S
+# for the rejected operation past the end of memory. The first two finish
+# on the completion interrupt (hardware interrupt 3), the other three on the
+# error interrupt (hardware interrupt 2), and the 10-element sum
+# must complete three instructions after the store that starts it: one tick
+# plus one per group of eight elements. Exits with status 1 when a run
+# misbehaves.
+
+set -u
+
+SIMULATOR=${1:?usage: vector-fpu.sh <simulator>}
+DIRECTORY=$(cd "$(dirname "$0")" && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+FAILED=0
+
+for simd in on off
+do
+  "$SIMULATOR" "$DIRECTORY/vector-fpu.s" "$WORK/$simd.txt" --simd=$simd > /dev/null
+  status=$?
+  terminal=$(sed -n '/^\[TERMINAL\]$/{n;p;}' "$WORK/$simd.txt")
+  interrupts=$(grep '^\[HARDWARE INTERRUPTION' "$WORK/$simd.txt" | tr -dc '0-9')
+  latency=$(awk '/^\[HARDWARE INTERRUPTION 3\]$/ { print NR - start - 1; exit } /MEM\[0x8080888C\]=R3=0x00000041$/ { start = NR }' "$WORK/$simd.txt")
+  if [ $status -eq 0 ] && [ "$terminal" = "..............................EO..........S" ] && [ "$interrupts" = "33222" ] && [ "$latency" = "3" ]
+  then
+    echo "simd=$simd: ok"
+  else
+    echo "simd=$simd: FAILED (status $status, terminal '$terminal', interrupts $interrupts, latency $latency)"
+    FAILED=1
+  fi
+done
+
+exit $FAILED
@@ -0,0 +1,805 @@
+#include "poxim_internal.h"
+
+/******************************************************
+ * Ahead-of-time translator
+ *
+ * Writes the program in memory as one C function for the host compiler.
+ * The code and its basic blocks come from the control flow analysis
+ * (analysis.c), with a block also starting after every instruction left to
+ * the interpreter. Each block becomes a label that charges its instructions
+ * against a fuel count, the instructions left before a device needs the
+ * interpreter (nextDeviceEvent) or the run ends; a block that does not fit
+ * goes to the interpreter instead. Registers live in locals, and a backward
+ * liveness pass over SR decides which flags an instruction has to compute.
+ *
+ * Everything the interpreter models beyond the CPU stays with it: loads and
+ * stores outside memory, stack overruns, division, interrupts, special
+ * registers and code that was not found all run through executeInstruction,
+ * and translated code continues at the next block through the dispatch
+ * switch. Self-modifying code is not detected.
+ *******************************************************/
+
+bool poxim_translate(PoximSystem *system, const char *path)
+{
+  Translator *translator = (Translator *)calloc(1, sizeof(Translator));
+  if (translator == NULL)
+  {
+    fprintf(stderr, "Failed to allocate memory for translator.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  for (uint32_t index = 0; index < TRANSLATED_WORDS; index++)
+  {
+    translator->words[index].ir = readMemory32(system, index * 4);
+    translator->words[index].block = NO_TRANSLATED_BLOCK;
+    classifyTranslatedWord(&translator->words[index]);
+  }
+
+  translator->analysis = analyzeProgram(system);
+
+  findTranslatedCode(translator, translator->analysis);
+  formTranslatedBlocks(translator);
+  computeTranslatedLiveness(translator);
+
+  FILE *output = fopen(path, "w");
+
+  if (output != NULL)
+  {
+    writeTranslation(translator, system->memory, output);
+    fclose(output);
+  }
+
+  freeAnalysis(translator->analysis);
+  free(translator->blocks);
+  free(translator);
+
+  return output != NULL;
+}
+
+void poxim_set_translation(PoximSystem *system, PoximTranslation translation)
+{
+  system->translation = translation;
+}
+
+// Translated code models the CPU alone: no trace, no timing or statistics
+// models
+bool isTranslationEligible(System *system)
+{
+  return system->translation != NULL && system->control.run && system->trace.callback == NULL && !system->timing.enabled &&
+         !system->pipeline.enabled && !system->predictor.enabled && !system->profiler.enabled;
+}
+
+// Instructions translated code may run before the interpreter has to see
+// the devices again, at most remaining
+uint64_t translatedFuel(System *system, uint64_t remaining)
+{
+  if (!system->control.run)
+    return 0;
+
+  const uint64_t event = nextDeviceEvent(system);
+
+  return (event - 1 < remaining) ? event - 1 : remaining;
+}
+
+/******************************************************
+ * Analysis
+ *******************************************************/
+
+// Sets how the word is emitted and the flags it reads and overwrites. The
+// locals hold r0-r25, SP and SR; SR is only written by flag updates, so a
+// change to IE always goes through the interpreter and its interrupt checks.
+void classifyTranslatedWord(TranslatedWord *word)
+{
+  // Conditional branches and bun from bae, as opcode - 0b101010
+  static const uint8_t branchReads[] = {
+      CY_FLAG, ZN_FLAG | CY_FLAG, ZN_FLAG | CY_FLAG, CY_FLAG, ZN_FLAG, SN_FLAG | OV_FLAG, ZN_FLAG | SN_FLAG | OV_FLAG, IV_FLAG,
+      ZN_FLAG | SN_FLAG | OV_FLAG, SN_FLAG | OV_FLAG, ZN_FLAG, IV_FLAG, ZD_FLAG, 0, ZD_FLAG};
+  const uint32_t readable = 0xC3FFFFFF; // r0-r25, SP and SR
+  const uint32_t writable = 0x43FFFFFF; // r0-r25 and SP
+
+  const uint32_t ir = word->ir;
+  const uint8_t opcode = (ir >> 26) & 0x3F;
+  const uint8_t z = (ir >> 21) & 0x1F;
+  const uint8_t x = (ir >> 16) & 0x1F;
+  const uint8_t y = (ir >> 11) & 0x1F;
+  const uint8_t l = ir & 0x1F;
+  uint32_t reads = 0, writes = 0;
+
+  word->kind = TRANSLATE_INLINE;
+  word->reads = 0;
+  word->kills = 0;
+
+  if (ir == 0) // Idle
+    return;
+
+  switch (opcode)
+  {
+  case 0b000000: // mov
+  case 0b000001: // movs
+    writes = 1u << z;
+    break;
+  case 0b000010: // add
+  case 0b000011: // sub
+  case 0b000101: // cmp, which also writes rz
+    word->kills = ZN_FLAG | SN_FLAG | OV_FLAG | CY_FLAG;
+    reads = (1u << x) | (1u << y);
+    writes = 1u << z;
+    break;
+  case 0b000110: // and
+  case 0b000111: // or
+    word->kills = ZN_FLAG | SN_FLAG;
+    reads = (1u << x) | (1u << y);
+    writes = 1u << z;
+    break;
+  case 0b001000: // not
+    word->kills = ZN_FLAG | SN_FLAG;
+    reads = 1u << x;
+    writes = 1u << z;
+    break;
+  case 0b001001: // xor, which sets ZN on zero but never clears it
+    word->kills = SN_FLAG;
+    reads = (1u << x) | (1u << y);
+    writes = 1u << z;
+    break;
+  case 0b000100: // mul, sll, muls, sla, srl and sra run their handler; div and divs may interrupt
+    if (((ir >> 8) & 0x7) == 0b100 || ((ir >> 8) & 0x7) == 0b110)
+      word->kind = TRANSLATE_INTERPRETED;
+
+    writes = (1u << z) | (1u << x) | (1u << y) | (1u << l);
+    break;
+  case 0b010100: // muli
+    writes = (1u << z) | (1u << x);
+    break;
+  case 0b010010: // addi
+  case 0b010011: // subi
+    word->kills = ZN_FLAG | SN_FLAG | OV_FLAG | CY_FLAG;
+    reads = 1u << x;
+    writes = 1u << z;
+    break;
+  case 0b010111: // cmpi
+    word->kills = ZN_FLAG | SN_FLAG | OV_FLAG | CY_FLAG;
+    reads = 1u << x;
+    break;
+
+  case 0b011000: // l8
+  case 0b011001: // l16
+  case 0b011010: // l32
+  case 0b011011: // s8
+  case 0b011100: // s16
+  case 0b011101: // s32
+  {
+    const bool load = opcode <= 0b011010;
+    const uint8_t scale = (opcode - 0b011000) % 3;
+
+    if (load && z == 0) // Dropped before the address is decoded
+      break;
+
+    reads = (1u << x) | (load ? 0 : 1u << z);
+    writes = load ? 1u << z : 0;
+
+    // Fixed device addresses always take the interpreter
+    if (x != 0)
+      word->kind = TRANSLATE_GUARDED;
+    else if (((uint32_t)(ir & 0xFFFF) << scale) >= MEMORY_SIZE)
+      word->kind = TRANSLATE_INTERPRETED;
+
+    break;
+  }
+
+  case 0b011110: // callf
+    reads = 1u << x;
+    word->kind = TRANSLATE_GUARDED;
+    break;
+  case 0b111001: // calls
+  case 0b011111: // ret
+    word->kind = TRANSLATE_GUARDED;
+    break;
+  case 0b001010: // push
+  case 0b001011: // pop
+  {
+    const uint8_t operands[] = {(ir >> 6) & 0x1F, l, x, y, z};
+
+    uint32_t named = 0;
+
+    for (uint32_t i = 0; i < 5 && operands[i] != 0; i++)
+      named |= 1u << operands[i];
+
+    // Stacking SP itself, or popping into SR, is left to the interpreter
+    if ((named & (1u << SP)) || (opcode == 0b001011 && (named & (1u << SR))))
+      word->kind = TRANSLATE_INTERPRETED;
+    else
+      word->kind = TRANSLATE_GUARDED;
+
+    reads = named;
+    break;
+  }
+
+  default:
+    if (opcode >= 0b101010 && opcode <= 0b111000)
+      word->reads = branchReads[opcode - 0b101010];
+    else // reti, cbr, sbr, divi, modi, int and unknown instructions
+      word->kind = TRANSLATE_INTERPRETED;
+  }
+
+  if ((reads & ~readable) != 0 || (writes & ~writable) != 0)
+    word->kind = TRANSLATE_INTERPRETED;
+}
+
+// Whether control does not simply fall through to the next word
+bool endsTranslatedBlock(const TranslatedWord *word)
+{
+  const uint8_t opcode = (word->ir >> 26) & 0x3F;
+
+  return word->kind == TRANSLATE_INTERPRETED || (opcode >= 0b101010 && opcode <= 0b111001) || opcode == 0b011110 ||
+         opcode == 0b011111;
+}
+
+// Takes the code and its blocks from the control flow analysis, and also
+// starts a block after every instruction handed to the interpreter, where
+// the dispatch switch resumes
+void findTranslatedCode(Translator *translator, const Analysis *analysis)
+{
+  for (uint32_t index = 0; index < TRANSLATED_WORDS; index++)
+  {
+    TranslatedWord *word = &translator->words[index];
+    const uint32_t block = analysis->blockOf[index];
+
+    word->reached = block != NO_ANALYZED_BLOCK;
+    word->leader = word->reached && (analysis->blocks[block].first == index ||
+                                     (translator->words[index - 1].reached && endsTranslatedBlock(&translator->words[index - 1])));
+  }
+}
+
+// Block of the leader at address, NO_TRANSLATED_BLOCK when there is none
+uint32_t findTranslatedBlock(Translator *translator, uint32_t address)
+{
+  if (address > MEMORY_SIZE - 4 || !translator->words[address / 4].leader)
+    return NO_TRANSLATED_BLOCK;
+
+  return translator->words[address / 4].block;
+}
+
+void formTranslatedBlocks(Translator *translator)
+{
+  translator->blocks = (TranslatedBlock *)malloc(TRANSLATED_WORDS * sizeof(TranslatedBlock));
+  translator->blockCount = 0;
+
+  if (translator->blocks == NULL)
+  {
+    fprintf(stderr, "Failed to allocate memory for translator.\n");
+    exit(EXIT_FAILURE);
+  }
+
+  for (uint32_t index = 0; index < TRANSLATED_WORDS; index++)
+  {
+    if (!translator->words[index].leader)
+      continue;
+
+    TranslatedBlock *block = &translator->blocks[translator->blockCount];
+    uint32_t end = index;
+
+    do
+      translator->words[end++].block = translator->blockCount;
+    while (end < TRANSLATED_WORDS && !endsTranslatedBlock(&translator->words[end - 1]) && translator->words[end].reached &&
+           !translator->words[end].leader);
+
+    block->first = index;
+    block->end = end;
+    translator->blockCount++;
+    index = end - 1;
+  }
+}
+
+// Backward liveness of the SR flags within each block. Every flag is live
+// at block boundaries, where the fuel may run out and the interpreter or the
+// caller take over, and before any instruction that may fall back to the
+// interpreter.
+void computeTranslatedLiveness(Translator *translator)
+{
+  for (uint32_t b = 0; b < translator->blockCount; b++)
+  {
+    const TranslatedBlock *block = &translator->blocks[b];
+    uint8_t live = TRANSLATED_FLAGS;
+
+    for (uint32_t index = block->end; index-- > block->first;)
+    {
+      TranslatedWord *word = &translator->words[index];
+
+      word->live = live;
+      live = (word->kind == TRANSLATE_INLINE) ? (live & ~word->kills) | word->reads : TRANSLATED_FLAGS;
+    }
+  }
+}
+
+/******************************************************
+ * Code generation
+ *******************************************************/
+
+// Local holding the register; r0 is a constant zero
+const char *translatedRegister(uint8_t index)
+{
+  return (index == 0) ? "0u" : formatRegisterName(index, true);
+}
+
+void writeTranslation(Translator *translator, const uint8_t *memory, FILE *output)
+{
+  // Locals besides r0, and the system registers they mirror
+  static const uint8_t locals[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, IR, SP, SR};
+  const uint32_t localCount = sizeof(locals) / sizeof(locals[0]);
+
+  // The image up to its last non-zero word
+  uint32_t size = MEMORY_SIZE;
+
+  while (size > 4 && memcmp(memory + size - 4, "\0\0\0\0", 4) == 0)
+    size -= 4;
+
+  fprintf(output, "// Poxim program translated ahead of time by poxim_translate. Build it with the\n"
+                  "// simulator library: cc -O2 -I<poxim> <this file> poxim.c reports.c lockstep.c\n"
+                  "// assembler.c analysis.c translator.c -lm, and run it as <binary> <output> [options].\n\n");
+  fprintf(output, "#include \"poxim_internal.h\"\n\n");
+  fprintf(output, "#define TRANSLATED_LOAD32(a) (((uint32_t)memory[a] << 24) | ((uint32_t)memory[(a) + 1] << 16) | ((uint32_t)memory[(a) + 2] << 8) | memory[(a) + 3])\n");
+  fprintf(output, "#define TRANSLATED_STORE32(a, v) (memory[a] = (uint8_t)((v) >> 24), memory[(a) + 1] = (uint8_t)((v) >> 16), memory[(a) + 2] = (uint8_t)((v) >> 8), memory[(a) + 3] = (uint8_t)(v))\n\n");
+
+  fprintf(output, "const uint8_t translatedImage[%u] = {", size);
+
+  for (uint32_t i = 0; i < size; i++)
+    fprintf(output, "%s0x%02X,", (i % 16 == 0) ? "\n    " : " ", memory[i]);
+
+  fprintf(output, "\n};\n\n");
+
+  fprintf(output, "uint64_t translatedProgram(PoximSystem *system, uint64_t count)\n{\n");
+  fprintf(output, "  uint8_t *const memory __attribute__((unused)) = system->memory;\n");
+
+  for (uint32_t i = 0; i < localCount; i++)
+    fprintf(output, "  uint32_t %s = system->cpu.registers[%u];\n", formatRegisterName(locals[i], true), locals[i]);
+
+  fprintf(output, "  uint32_t pc = system->cpu.registers[PC];\n");
+  fprintf(output, "  uint64_t executed = 0, loads = 0, stores = 0, taken = 0;\n");
+  fprintf(output, "  uint64_t fuel = translatedFuel(system, count);\n");
+  fprintf(output, "  uint64_t charged = fuel; // Fuel when last back from the interpreter\n\n");
+
+  fprintf(output, "dispatch:\n  switch (pc)\n  {\n");
+
+  for (uint32_t b = 0; b < translator->blockCount; b++)
+    fprintf(output, "  case 0x%08X:\n    goto block_%08X;\n", translator->blocks[b].first * 4, translator->blocks[b].first * 4);
+
+  fprintf(output, "  default:\n    goto interpret;\n  }\n\n");
+
+  // One instruction through executeInstruction, with the system brought up
+  // to date before and the locals after
+  fprintf(output, "interpret:\n");
+  fprintf(output, "  executed += charged - fuel;\n");
+  fprintf(output, "  advanceDeviceTimers(system, charged - fuel);\n");
+  fprintf(output, "  system->counters.loads += loads;\n");
+  fprintf(output, "  system->counters.stores += stores;\n");
+  fprintf(output, "  system->counters.takenBranches += taken;\n");
+  fprintf(output, "  loads = stores = taken = 0;\n");
+
+  for (uint32_t i = 0; i < localCount; i++)
+    fprintf(output, "  system->cpu.registers[%u] = %s;\n", locals[i], formatRegisterName(locals[i], true));
+
+  fprintf(output, "  system->cpu.registers[PC] = pc;\n\n");
+  fprintf(output, "  if (executed >= count || !system->control.run)\n    return executed;\n\n");
+  fprintf(output, "  executeInstruction(system);\n  executed++;\n\n");
+
+  for (uint32_t i = 0; i < localCount; i++)
+    fprintf(output, "  %s = system->cpu.registers[%u];\n", formatRegisterName(locals[i], true), locals[i]);
+
+  fprintf(output, "  pc = system->cpu.registers[PC];\n");
+  fprintf(output, "  fuel = charged = translatedFuel(system, count - executed);\n");
+  fprintf(output, "  goto dispatch;\n");
+
+  for (uint32_t b = 0; b < translator->blockCount; b++)
+    emitTranslatedBlock(translator, b, output);
+
+  fprintf(output, "}\n\n");
+
+  // Runs like the front end does with --no-trace
+  fputs("int main(int argc, char *argv[])\n"
+        "{\n"
+        "  PoximSystem *system = (argc >= 2) ? poxim_create(argc - 2, (const char *const *)argv + 2) : NULL;\n"
+        "  FILE *output = (system != NULL) ? fopen(argv[1], \"w\") : NULL;\n"
+        "\n"
+        "  if (output == NULL)\n"
+        "  {\n"
+        "    fprintf(stderr, \"Usage: %s <output> [options]\\n\", argv[0]);\n"
+        "    return EXIT_FAILURE;\n"
+        "  }\n"
+        "\n"
+        "  poxim_load(system, translatedImage, sizeof(translatedImage));\n"
+        "  poxim_set_translation(system, translatedProgram);\n"
+        "\n"
+        "  printf(\"[START OF SIMULATION]\\n\");\n"
+        "  fprintf(output, \"[START OF SIMULATION]\\n\");\n"
+        "\n"
+        "  poxim_run(system, 0);\n"
+        "\n"
+        "  size_t length;\n"
+        "  const char *terminal = poxim_terminal(system, &length);\n"
+        "\n"
+        "  if (length > 0)\n"
+        "  {\n"
+        "    printf(\"[TERMINAL]\\n%.*s\\n\", (int)length, terminal);\n"
+        "    fprintf(output, \"[TERMINAL]\\n%.*s\\n\", (int)length, terminal);\n"
+        "  }\n"
+        "\n"
+        "  const PoximStatus status = poxim_status(system);\n"
+        "  const char *limit = (status == POXIM_INSTRUCTION_LIMIT) ? \"[INSTRUCTION LIMIT REACHED]\\n\"\n"
+        "                      : (status == POXIM_TIME_LIMIT)      ? \"[TIME LIMIT REACHED]\\n\"\n"
+        "                      : (status == POXIM_MEMORY_FAULT)    ? \"[MEMORY FAULT]\\n\"\n"
+        "                                                          : \"\";\n"
+        "\n"
+        "  printf(\"%s[END OF SIMULATION]\\n\", limit);\n"
+        "  fprintf(output, \"%s[END OF SIMULATION]\\n\", limit);\n"
+        "  fclose(output);\n"
+        "\n"
+        "  poxim_write_reports(system);\n"
+        "  poxim_destroy(system);\n"
+        "\n"
+        "  return (status == POXIM_HALTED) ? EXIT_SUCCESS : (status == POXIM_MEMORY_FAULT) ? 3 : 2;\n"
+        "}\n",
+        output);
+}
+
+void emitTranslatedBlock(Translator *translator, uint32_t block, FILE *output)
+{
+  const TranslatedBlock *current = &translator->blocks[block];
+  const TranslatedWord *last = &translator->words[current->end - 1];
+
+  // An interpreted instruction, always last, is counted by the interpreter
+  const uint32_t charged = current->end - current->first - (last->kind == TRANSLATE_INTERPRETED ? 1 : 0);
+
+  const Analysis *analysis = translator->analysis;
+  const uint32_t analyzed = analysis->blockOf[current->first];
+  const uint32_t loop = analysis->blocks[analyzed].loop;
+
+  fprintf(output, "\n");
+  if (loop != NO_ANALYZED_LOOP && analysis->loops[loop].header == analyzed && analysis->blocks[analyzed].first == current->first)
+    fprintf(output, "// Loop header, depth %u\n", analysis->loops[loop].depth);
+
+  fprintf(output, "block_%08X:\n", current->first * 4);
+
+  if (charged > 0)
+  {
+    fprintf(output, "  if (fuel < %u)\n  {\n    pc = 0x%08X;\n    goto interpret;\n  }\n", charged, current->first * 4);
+    fprintf(output, "  fuel -= %u;\n", charged);
+  }
+
+  for (uint32_t index = current->first; index < current->end; index++)
+  {
+    // IR keeps the last instruction the block ran, as after a fetch
+    if (charged > 0 && index == current->first + charged - 1)
+      fprintf(output, "  ir = 0x%08Xu;\n", translator->words[index].ir);
+
+    emitTranslatedInstruction(translator, index, charged - (index - current->first), output);
+  }
+
+  if (!endsTranslatedBlock(last))
+    emitTranslatedJump(translator, current->end * 4, "  ", output);
+}
+
+// Straight to the block at address, or through the dispatch switch
+void emitTranslatedJump(Translator *translator, uint32_t address, const char *indent, FILE *output)
+{
+  if (findTranslatedBlock(translator, address) != NO_TRANSLATED_BLOCK)
+    fprintf(output, "%sgoto block_%08X;\n", indent, address);
+  else
+    fprintf(output, "%spc = 0x%08X;\n%sgoto dispatch;\n", indent, address, indent);
+}
+
+// Hands the instruction at address to the interpreter when condition holds,
+// returning the fuel of the refund instructions the block did not run
+void emitTranslatedFallback(const char *condition, uint32_t address, uint32_t refund, FILE *output)
+{
+  fprintf(output, "    if (%s)\n    {\n      fuel += %u;\n      pc = 0x%08X;\n      goto interpret;\n    }\n", condition, refund, address);
+}
+
+// Recomputes the flags among the SR bits given, from C expressions over the
+// operands and result
+void emitTranslatedFlags(uint8_t flags, const char *zero, const char *sign, const char *overflow, const char *carry, FILE *output)
+{
+  if (flags == 0)
+    return;
+
+  fprintf(output, "    sr = (sr & ~0x%02Xu)", flags);
+
+  if (flags & ZN_FLAG)
+    fprintf(output, " | ((%s) ? ZN_FLAG : 0)", zero);
+
+  if (flags & SN_FLAG)
+    fprintf(output, " | ((%s) ? SN_FLAG : 0)", sign);
+
+  if (flags & OV_FLAG)
+    fprintf(output, " | ((%s) ? OV_FLAG : 0)", overflow);
+
+  if (flags & CY_FLAG)
+    fprintf(output, " | ((%s) ? CY_FLAG : 0)", carry);
+
+  fprintf(output, ";\n");
+}
+
+// The instruction at index, refund being the instructions of its block
+// from it to the end that are charged against the fuel
+void emitTranslatedInstruction(Translator *translator, uint32_t index, uint32_t refund, FILE *output)
+{
+  // Taken conditions of the conditional branches and bun, as opcode - 0b101010
+  static const char *conditions[] = {
+      "!(sr & CY_FLAG)",                                             // bae
+      "!(sr & (ZN_FLAG | CY_FLAG))",                                 // bat
+      "sr & (ZN_FLAG | CY_FLAG)",                                    // bbe
+      "sr & CY_FLAG",                                                // bbt
+      "sr & ZN_FLAG",                                                // beq
+      "!(sr & SN_FLAG) == !(sr & OV_FLAG)",                          // bge
+      "!(sr & ZN_FLAG) && !(sr & SN_FLAG) == !(sr & OV_FLAG)",       // bgt
+      "sr & IV_FLAG",                                                // biv
+      "(sr & ZN_FLAG) || !(sr & SN_FLAG) != !(sr & OV_FLAG)",        // ble
+      "!(sr & SN_FLAG) != !(sr & OV_FLAG)",                          // blt
+      "!(sr & ZN_FLAG)",                                             // bne
+      "!(sr & IV_FLAG)",                                             // bni
+      "!(sr & ZD_FLAG)",                                             // bnz
+      "1",                                                           // bun
+      "sr & ZD_FLAG"};                                               // bzd
+
+  const TranslatedWord *word = &translator->words[index];
+  const uint32_t address = index * 4;
+  const uint32_t ir = word->ir;
+  const uint8_t opcode = (ir >> 26) & 0x3F;
+  const uint8_t z = (ir >> 21) & 0x1F;
+  const uint8_t x = (ir >> 16) & 0x1F;
+  const uint8_t y = (ir >> 11) & 0x1F;
+  const uint8_t l = ir & 0x1F;
+  const int32_t i = extendSign32(ir & 0xFFFF, 16);
+  const InstructionHandler *handler = decodeInstructionHandler(ir);
+
+  fprintf(output, "  // 0x%08X: %s 0x%08X\n", address, (ir == 0) ? "idle" : (handler != NULL) ? handler->name : "unknown", ir);
+
+  if (word->kind == TRANSLATE_INTERPRETED)
+  {
+    fprintf(output, "  pc = 0x%08X;\n  goto interpret;\n", address);
+    return;
+  }
+
+  if (ir == 0)
+    return;
+
+  switch (opcode)
+  {
+  case 0b000000: // mov
+    if (z != 0)
+      fprintf(output, "  %s = 0x%08Xu;\n", translatedRegister(z), ir & 0x1FFFFF);
+    break;
+  case 0b000001: // movs
+    if (z != 0)
+      fprintf(output, "  %s = 0x%08Xu;\n", translatedRegister(z), (uint32_t)extendSign32(ir & 0x1FFFFF, 21));
+    break;
+
+  case 0b000010: // add
+  case 0b000011: // sub
+  case 0b000101: // cmp
+  case 0b000110: // and
+  case 0b000111: // or
+  case 0b001000: // not
+  case 0b001001: // xor
+  case 0b010010: // addi
+  case 0b010011: // subi
+  case 0b010111: // cmpi
+  {
+    // A negative immediate turns the carry of an addition into a borrow and
+    // back, and addi tests rz after the write
+    const char *result = "x - y", *zero = "result == 0", *overflow = NULL, *carry = NULL;
+
+    switch (opcode)
+    {
+    case 0b000010:
+      result = "x + y";
+      carry = "result < x";
+      overflow = "(~(x ^ y) & (x ^ result)) >> 31";
+      zero = "result == 0 && !(result < x)";
+      break;
+    case 0b010010:
+      result = "x + y";
+      carry = (i >= 0) ? "result < x" : "x < result";
+      overflow = "(~(x ^ y) & (x ^ result)) >> 31";
+      zero = (z == 0) ? "1" : "result == 0";
+      break;
+    case 0b000011:
+    case 0b000101:
+      carry = "x < y";
+      overflow = "((x ^ y) & (x ^ result)) >> 31";
+      zero = "result == 0 && !(x < y)";
+      break;
+    case 0b010011:
+    case 0b010111:
+      carry = (i >= 0) ? "x < y" : "result < x";
+      overflow = "((x ^ y) & (x ^ result)) >> 31";
+      zero = (i >= 0) ? "result == 0 && !(x < y)" : "result == 0 && !(result < x)";
+      break;
+    case 0b000110:
+      result = "x & y";
+      break;
+    case 0b000111:
+      result = "x | y";
+      break;
+    case 0b001000:
+      result = "~x";
+      break;
+    case 0b001001:
+      result = "x ^ y";
+      break;
+    }
+
+    const uint8_t flags = word->live & word->kills;
+    const bool setsZero = opcode == 0b001001 && (word->live & ZN_FLAG);
+
+    // Nothing to do for a comparison whose flags are all overwritten
+    if ((z == 0 || opcode == 0b010111) && flags == 0 && !setsZero)
+      break;
+
+    fprintf(output, "  {\n    const uint32_t x = %s", translatedRegister(x));
+
+    if (opcode >= 0b010010)
+      fprintf(output, ", y = 0x%08Xu", (uint32_t)i);
+    else if (opcode != 0b001000)
+      fprintf(output, ", y = %s", translatedRegister(y));
+
+    fprintf(output, ", result = %s;\n", result);
+
+    if (z != 0 && opcode != 0b010111)
+      fprintf(output, "    %s = result;\n", translatedRegister(z));
+
+    emitTranslatedFlags(flags, zero, "result >> 31", overflow, carry, output);
+
+    if (setsZero)
+      fprintf(output, "    if (result == 0)\n      sr |= ZN_FLAG;\n");
+
+    fprintf(output, "  }\n");
+    break;
+  }
+
+  case 0b000100: // mul, sll, muls, sla, srl, sra
+  case 0b010100: // muli
+  {
+    // Register-only handlers run on a copy of the registers they name
+    const uint8_t operands[] = {z, x, y, l};
+    const uint32_t operandCount = (opcode == 0b010100) ? 2 : 4;
+
+    fprintf(output, "  {\n    CPU cpu;\n    cpu.registers[IR] = 0x%08Xu;\n    cpu.registers[SR] = sr;\n", ir);
+
+    for (uint32_t operand = 0; operand < operandCount; operand++)
+      fprintf(output, "    cpu.registers[%u] = %s;\n", operands[operand], translatedRegister(operands[operand]));
+
+    fprintf(output, "    %s(&cpu, NULL);\n", handler->name);
+
+    for (uint32_t operand = 0; operand < operandCount; operand++)
+    {
+      if (operands[operand] != 0)
+        fprintf(output, "    %s = cpu.registers[%u];\n", translatedRegister(operands[operand]), operands[operand]);
+    }
+
+    fprintf(output, "    sr = cpu.registers[SR];\n  }\n");
+    break;
+  }
+
+  case 0b011000: // l8
+  case 0b011001: // l16
+  case 0b011010: // l32
+  case 0b011011: // s8
+  case 0b011100: // s16
+  case 0b011101: // s32
+  {
+    const bool load = opcode <= 0b011010;
+    const uint8_t scale = (opcode - 0b011000) % 3;
+    const char *target = translatedRegister(z);
+
+    if (load && z == 0)
+    {
+      fprintf(output, "  loads++;\n");
+      break;
+    }
+
+    if (x == 0)
+      fprintf(output, "  {\n    const uint32_t address = 0x%08Xu;\n", (uint32_t)(ir & 0xFFFF) << scale);
+    else
+    {
+      fprintf(output, "  {\n    const uint32_t address = (%s + 0x%04Xu) << %u;\n", translatedRegister(x), ir & 0xFFFF, scale);
+      emitTranslatedFallback("address >= MEMORY_SIZE", address, refund, output);
+    }
+
+    switch (opcode)
+    {
+    case 0b011000:
+      fprintf(output, "    %s = memory[address];\n", target);
+      break;
+    case 0b011001: // Upper halfword, as l16 does
+      fprintf(output, "    %s = ((uint32_t)memory[address] << 24) | ((uint32_t)memory[address + 1] << 16);\n", target);
+      break;
+    case 0b011010:
+      fprintf(output, "    %s = TRANSLATED_LOAD32(address);\n", target);
+      break;
+    case 0b011011:
+      fprintf(output, "    memory[address] = %s;\n", target);
+      break;
+    case 0b011100:
+      fprintf(output, "    memory[address] = %s >> 24;\n    memory[address + 1] = %s >> 16;\n", target, target);
+      break;
+    case 0b011101:
+      fprintf(output, "    TRANSLATED_STORE32(address, %s);\n", target);
+      break;
+    }
+
+    fprintf(output, "    %s++;\n  }\n", load ? "loads" : "stores");
+    break;
+  }
+
+  case 0b111001: // calls
+  case 0b011110: // callf
+    fprintf(output, "  {\n");
+    emitTranslatedFallback("sp > MEMORY_SIZE - 4", address, refund, output);
+
+    if (opcode == 0b011110)
+      fprintf(output, "    pc = (%s + 0x%08Xu) << 2;\n", translatedRegister(x), (uint32_t)i);
+
+    fprintf(output, "    TRANSLATED_STORE32(sp, 0x%08Xu);\n    sp -= 4;\n  }\n", address + 4);
+
+    if (opcode == 0b011110)
+      fprintf(output, "  goto dispatch;\n");
+    else
+      emitTranslatedJump(translator, branchTarget(address, ir), "  ", output);
+
+    break;
+  case 0b011111: // ret
+    fprintf(output, "  {\n");
+    emitTranslatedFallback("sp > MEMORY_SIZE - 8", address, refund, output);
+    fprintf(output, "    sp += 4;\n    pc = TRANSLATED_LOAD32(sp);\n  }\n  goto dispatch;\n");
+    break;
+  case 0b001010: // push
+  case 0b001011: // pop
+  {
+    const uint8_t operands[] = {(ir >> 6) & 0x1F, l, x, y, z};
+    uint32_t count = 0;
+    char condition[64];
+
+    while (count < 5 && operands[count] != 0)
+      count++;
+
+    // Lowest and highest stack word touched must be in memory
+    if (opcode == 0b001011)
+      snprintf(condition, sizeof(condition), "sp > MEMORY_SIZE - %u", 4 + 4 * count);
+    else if (count > 1)
+      snprintf(condition, sizeof(condition), "sp > MEMORY_SIZE - 4 || sp < %u", 4 * count - 4);
+    else
+      snprintf(condition, sizeof(condition), "sp > MEMORY_SIZE - 4");
+
+    fprintf(output, "  {\n");
+    emitTranslatedFallback(condition, address, refund, output);
+
+    for (uint32_t operand = 0; operand < count; operand++)
+    {
+      if (opcode == 0b001010)
+        fprintf(output, "    TRANSLATED_STORE32(sp, %s);\n    sp -= 4;\n", translatedRegister(operands[operand]));
+      else
+        fprintf(output, "    sp += 4;\n    %s = TRANSLATED_LOAD32(sp);\n", translatedRegister(operands[operand]));
+    }
+
+    fprintf(output, "    %s++;\n  }\n", (opcode == 0b001010) ? "stores" : "loads");
+    break;
+  }
+
+  default: // Conditional branches and bun
+  {
+    const uint32_t target = branchTarget(address, ir);
+
+    if (opcode == 0b110111)
+    {
+      fprintf(output, "  taken++;\n");
+      emitTranslatedJump(translator, target, "  ", output);
+      break;
+    }
+
+    fprintf(output, "  if (%s)\n  {\n    taken++;\n", conditions[opcode - 0b101010]);
+    emitTranslatedJump(translator, target, "    ", output);
+    fprintf(output, "  }\n");
+    emitTranslatedJump(translator, address + 4, "  ", output);
+  }
+  }
+}